@@ -145,6 +145,21 @@ void DeparserHdrEmitTranslator::processMethod(const P4::ExternMethod *method) {
             builder->blockEnd(true);
             builder->emitIndent();
             builder->newline();
+            cstring unchanged = deparser->unchangedHeaderCondition(expr);
+            if (!unchanged.isNullOrEmpty()) {
+                builder->emitIndent();
+                builder->appendFormat("if (%s) ", unchanged.c_str());
+                builder->blockStart();
+                msgStr = Util::printf_format("Deparser: header %s is unchanged, skipping it",
+                                             expr->toString().c_str());
+                builder->target->emitTraceMessage(builder, msgStr.c_str());
+                builder->emitIndent();
+                builder->appendFormat("%s += %d", program->offsetVar.c_str(), width);
+                builder->endOfStatement(true);
+                builder->blockEnd(false);
+                builder->append(" else ");
+                builder->blockStart();
+            }
             unsigned alignment = 0;
             for (auto f : headerToEmit->fields) {
                 auto ftype = deparser->program->typeMap->getType(f);
@@ -159,6 +174,7 @@ void DeparserHdrEmitTranslator::processMethod(const P4::ExternMethod *method) {
                 alignment += et->widthInBits();
                 alignment %= 8;
             }
+            if (!unchanged.isNullOrEmpty()) builder->blockEnd(true);
             builder->blockEnd(true);
         } else {
             BUG("emit() should only be invoked for packet_out");
@@ -225,6 +241,29 @@ void DeparserHdrEmitTranslator::emitField(CodeBuilder *builder, cstring field,
         builder->append(")");
         builder->endOfStatement(true);
     }
+    if (program->options.optimizeDeparser && alignment == 0 && widthToEmit % 8 == 0 &&
+        widthToEmit <= 64) {
+        // The field starts at a byte boundary and is already in the network byte order,
+        // so it is copied with as few stores as possible instead of byte by byte.
+        unsigned bytes = widthToEmit / 8;
+        for (unsigned i = 0; i < bytes;) {
+            unsigned chunk = bytes - i >= 8 ? 8 : bytes - i >= 4 ? 4 : bytes - i >= 2 ? 2 : 1;
+            builder->emitIndent();
+            builder->appendFormat("*(u%u *)((u8 *)%s + BYTES(%s) + %u) = *(u%u *)((u8 *)&",
+                                  chunk * 8, program->packetStartVar.c_str(),
+                                  program->offsetVar.c_str(), i, chunk * 8);
+            visit(hdrExpr);
+            builder->appendFormat(".%s + %u)", field, i);
+            builder->endOfStatement(true);
+            i += chunk;
+        }
+        builder->emitIndent();
+        builder->appendFormat("%s += %d", program->offsetVar.c_str(), widthToEmit);
+        builder->endOfStatement(true);
+        builder->newline();
+        return;
+    }
+
     unsigned bitsInFirstByte = widthToEmit % 8;
     if (bitsInFirstByte == 0) bitsInFirstByte = 8;
     unsigned bitsInCurrentByte = bitsInFirstByte;
@@ -87,6 +87,12 @@ class EBPFDeparser : public EBPFControl {
         controlBlock->container->body->apply(*codeGen);
         builder->newline();
     }
+    // Returns a condition, under which the header is already in the packet at the current
+    // output offset, so that it does not have to be written, or nullptr if there is none.
+    virtual cstring unchangedHeaderCondition(const IR::Expression *hdrExpr) const {
+        (void)hdrExpr;
+        return nullptr;
+    }
 
     void emitBufferAdjusts(CodeBuilder *builder) const;
 };
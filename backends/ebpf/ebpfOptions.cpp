@@ -70,6 +70,14 @@ EbpfOptions::EbpfOptions() {
         },
         "Set number of maximum possible masks for a ternary key"
         " in a single table");
+    registerOption(
+        "--tuple-bloom-filters", nullptr,
+        [this](const char *) {
+            tupleBloomFilters = true;
+            return true;
+        },
+        "Add a Bloom filter to every tuple of a ternary table, which is checked "
+        "before the tuple is probed");
     registerOption(
         "--xdp2tc", "MODE",
         [this](const char *arg) {
@@ -91,6 +99,60 @@ EbpfOptions::EbpfOptions() {
             return true;
         },
         "[psa only] Enable caching entries for tables with lpm or ternary key");
+    registerOption(
+        "--optimize-deparser", nullptr,
+        [this](const char *) {
+            optimizeDeparser = true;
+            return true;
+        },
+        "[psa only] Do not rewrite headers, which the pipeline does not modify and which stay "
+        "at the same position in the packet, and write byte-aligned fields with "
+        "2, 4 or 8-byte stores, which may be unaligned.");
+    registerOption(
+        "--flow-cache", "ENTRIES",
+        [this](const char *arg) {
+            flowCacheSize = std::strtoul(arg, nullptr, 0);
+            return true;
+        },
+        "[psa only] Put an LRU cache of ENTRIES flows in front of each control block, which "
+        "skips the control block for packets whose fields have been seen before. "
+        "The control plane must increment the generation of a table after each write to it, "
+        "e.g. with BPF_USER_FLOW_CACHE_TABLE_WRITTEN from ebpf_kernel.h.");
+    registerOption(
+        "--incremental-checksums", nullptr,
+        [this](const char *) {
+            incrementalChecksums = true;
+            return true;
+        },
+        "[psa only] Update an InternetChecksum incrementally (RFC 1624), if a deparser computes "
+        "it from scratch over header fields and the pipeline writes only a few of them. "
+        "Assumes that the checksum of the received packet is valid.");
+    registerOption(
+        "--per-cpu-counters", nullptr,
+        [this](const char *) {
+            perCPUCounters = true;
+            return true;
+        },
+        "Store indirect counters in per-CPU maps, which are updated without atomic "
+        "operations. Single counters can be made per-CPU with the @per_cpu annotation.");
+    registerOption(
+        "--parser-loops", nullptr,
+        [this](const char *) {
+            parserLoops = true;
+            return true;
+        },
+        "Do not unroll parser loops over header stacks. A parser state which extracts into "
+        "the next element of a stack and transitions to itself is emitted as a loop bounded "
+        "by the stack size.");
+    registerOption(
+        "--coalesce-bounds-checks", nullptr,
+        [this](const char *) {
+            coalesceBoundsChecks = true;
+            return true;
+        },
+        "[ebpf_model only] Check the packet length once for a parser state and the states "
+        "it transitions to unconditionally. A packet which is too short for a later header "
+        "is rejected before an earlier header is extracted.");
     registerOption(
         "--xdp", nullptr,
         [this](const char *) {
@@ -98,4 +160,13 @@ EbpfOptions::EbpfOptions() {
             return true;
         },
         "[psa only] Compile and generate the P4 prog for XDP hook");
+    registerOption(
+        "--xdp-only", nullptr,
+        [this](const char *) {
+            generateToXDP = true;
+            xdpOnly = true;
+            return true;
+        },
+        "[psa only] Run the ingress and egress pipelines back-to-back in a single XDP program, "
+        "without any TC program. Clone, multicast and resubmit are not supported in this mode.");
 }
@@ -35,12 +35,28 @@ class EbpfOptions : public CompilerOptions {
     bool emitTraceMessages = false;
     // generate program to XDP layer
     bool generateToXDP = false;
+    // run both PSA pipelines in XDP, without any TC program (implies generateToXDP)
+    bool xdpOnly = false;
     // XDP2TC mode for PSA-eBPF
     enum XDP2TC xdp2tcMode = XDP2TC_NONE;
     // maximum number of unique ternary masks
     unsigned int maxTernaryMasks = 128;
+    // Translate InternetChecksum recomputations as RFC 1624 incremental updates, if possible
+    bool incrementalChecksums = false;
+    // Check a Bloom filter before probing a tuple of a ternary table
+    bool tupleBloomFilters = false;
+    // Skip writing headers, which are unchanged and not moved, and write aligned fields in bulk
+    bool optimizeDeparser = false;
     // Enable table cache for LPM and ternary tables
     bool enableTableCache = false;
+    // Number of entries of the flow cache in front of each control block, 0 disables it
+    unsigned flowCacheSize = 0;
+    // Use per-CPU maps for all indirect counters
+    bool perCPUCounters = false;
+    // Keep parser loops over header stacks, instead of unrolling them in the midend
+    bool parserLoops = false;
+    // Check the packet length once for a parser state and the states it runs into
+    bool coalesceBoundsChecks = false;
 
     EbpfOptions();
 
@@ -48,6 +64,10 @@ class EbpfOptions : public CompilerOptions {
         if (arch != "psa") {
             return;
         }
+        if (xdpOnly) {
+            // packets never leave XDP for TC, so there is no XDP2TC metadata to pass.
+            return;
+        }
 
         if (generateToXDP && xdp2tcMode == XDP2TC_META) {
             std::cerr
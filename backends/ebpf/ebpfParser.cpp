@@ -16,6 +16,10 @@ limitations under the License.
 
 #include "ebpfParser.h"
 
+#include <algorithm>
+#include <map>
+#include <set>
+
 #include "ebpfModel.h"
 #include "ebpfType.h"
 #include "frontends/p4/coreLibrary.h"
@@ -23,6 +27,126 @@ limitations under the License.
 
 namespace EBPF {
 
+namespace {
+
+// To load some fields the compiler will use larger words than actual width of a field
+// (e.g. 48-bit field loaded using load_dword()), we must ensure that the larger word is not
+// outside of packet buffer. Returns the number of bits read after the end of header @p ht.
+// FIXME: this can fail if a packet does not contain additional payload after header.
+//  However, we don't have better solution in case of using load_X functions to parse packet.
+// TODO: consider using a collection of smaller widths.
+unsigned extractPadding(const P4::TypeMap *typeMap, const IR::Type_StructLike *ht) {
+    unsigned curr_padding = 0;
+    for (auto f : ht->fields) {
+        auto ftype = typeMap->getType(f);
+        auto etype = EBPFTypeFactory::instance->create(ftype);
+        if (etype->is<EBPFScalarType>()) {
+            auto scalarType = etype->to<EBPFScalarType>();
+            unsigned readWordSize = scalarType->alignment() * 8;
+            unsigned unaligned = scalarType->widthInBits() % readWordSize;
+            unsigned padding = readWordSize - unaligned;
+            if (padding == readWordSize) padding = 0;
+            if (scalarType->widthInBits() + padding >= curr_padding) {
+                curr_padding = padding;
+            }
+        }
+    }
+    return curr_padding;
+}
+
+// Returns the type of the header stack, if @p member is the next or last element of a stack,
+// or its lastIndex.
+const IR::Type_Stack *stackAccess(const P4::TypeMap *typeMap, const IR::Member *member) {
+    if (member->member != IR::Type_Stack::next && member->member != IR::Type_Stack::last &&
+        member->member != IR::Type_Stack::lastIndex)
+        return nullptr;
+    return typeMap->getType(member->expr, true)->to<IR::Type_Stack>();
+}
+
+bool hasStackAccess(const P4::TypeMap *typeMap, const IR::Node *node) {
+    bool found = false;
+    forAllMatching<IR::Member>(node, [&](const IR::Member *member) {
+        if (stackAccess(typeMap, member) != nullptr) found = true;
+    });
+    return found;
+}
+
+// Returns the next element of a header stack, if an extract into @p destination advances
+// the stack. The destination is either that element or, for a stack of header unions,
+// a header of that element.
+const IR::Member *stackNext(const P4::TypeMap *typeMap, const IR::Expression *destination) {
+    auto member = destination->to<IR::Member>();
+    if (member != nullptr && member->member != IR::Type_Stack::next)
+        member = member->expr->to<IR::Member>();
+    if (member == nullptr || member->member != IR::Type_Stack::next) return nullptr;
+    if (stackAccess(typeMap, member) == nullptr) return nullptr;
+    return member;
+}
+
+}  // namespace
+
+void StateTranslationVisitor::emitCheckPacketLength(cstring lastBit) {
+    builder->emitIndent();
+    builder->appendFormat("if (%s < %s + BYTES(%s)) ", state->parser->program->packetEndVar.c_str(),
+                          state->parser->program->packetStartVar.c_str(), lastBit.c_str());
+    builder->blockStart();
+
+    builder->target->emitTraceMessage(builder, "Parser: invalid packet (packet too short)");
+
+    builder->emitIndent();
+    builder->appendFormat("%s = %s;", state->parser->program->errorVar.c_str(),
+                          p4lib.packetTooShort.str());
+    builder->newline();
+
+    builder->emitIndent();
+    builder->appendFormat("goto %s;", IR::ParserState::reject.c_str());
+    builder->newline();
+    builder->blockEnd(true);
+}
+
+void StateTranslationVisitor::emitRejectStackOutOfBounds() {
+    builder->target->emitTraceMessage(builder, "Parser: header stack index out of bounds");
+    builder->emitIndent();
+    builder->appendFormat("%s = %s;", state->parser->program->errorVar.c_str(),
+                          p4lib.stackOutOfBounds.str());
+    builder->newline();
+    builder->emitIndent();
+    builder->appendFormat("goto %s;", IR::ParserState::reject.c_str());
+    builder->newline();
+}
+
+void StateTranslationVisitor::emitStackIndexChecks(const IR::Node *node) {
+    std::set<cstring> conditions;
+    forAllMatching<IR::Member>(node, [&](const IR::Member *member) {
+        auto stack = stackAccess(typeMap, member);
+        if (stack == nullptr || member->member == IR::Type_Stack::lastIndex) return;
+        cstring index = state->parser->getStackIndexVar(member->expr);
+        BUG_CHECK(!index.isNullOrEmpty(), "%1%: header stack without an index", member);
+        // The index is only incremented after a successful extract, so it never exceeds the size.
+        if (member->member == IR::Type_Stack::next)
+            conditions.insert(Util::printf_format("%s >= %zu", index, stack->getSize()));
+        else
+            conditions.insert(Util::printf_format("%s == 0", index));
+    });
+
+    for (auto condition : conditions) {
+        builder->emitIndent();
+        builder->appendFormat("if (%s) ", condition.c_str());
+        builder->blockStart();
+        emitRejectStackOutOfBounds();
+        builder->blockEnd(true);
+    }
+}
+
+void StateTranslationVisitor::compileTransition(const IR::PathExpression *nextState) {
+    if (state->loopBound > 0 && nextState->path->name.name == state->state->name.name) {
+        builder->append("continue");
+        return;
+    }
+    builder->append("goto ");
+    visit(nextState);
+}
+
 void StateTranslationVisitor::compileLookahead(const IR::Expression *destination) {
     cstring msgStr = Util::printf_format("Parser: lookahead for %s %s",
                                          state->parser->typeMap->getType(destination)->toString(),
@@ -65,23 +189,7 @@ void StateTranslationVisitor::compileAdvance(const P4::ExternMethod *extMethod)
     visit(argExpr);
     builder->endOfStatement(true);
 
-    builder->emitIndent();
-    builder->appendFormat("if (%s < %s + BYTES(%s)) ", state->parser->program->packetEndVar.c_str(),
-                          state->parser->program->packetStartVar.c_str(),
-                          state->parser->program->offsetVar.c_str());
-    builder->blockStart();
-
-    builder->target->emitTraceMessage(builder, "Parser: invalid packet (packet too short)");
-
-    builder->emitIndent();
-    builder->appendFormat("%s = %s;", state->parser->program->errorVar.c_str(),
-                          p4lib.packetTooShort.str());
-    builder->newline();
-
-    builder->emitIndent();
-    builder->appendFormat("goto %s;", IR::ParserState::reject.c_str());
-    builder->newline();
-    builder->blockEnd(true);
+    if (!state->boundsChecked) emitCheckPacketLength(state->parser->program->offsetVar);
 }
 
 void StateTranslationVisitor::compileVerify(const IR::MethodCallExpression *expression) {
@@ -147,29 +255,62 @@ bool StateTranslationVisitor::preorder(const IR::ParserState *parserState) {
     builder->spc();
     builder->blockStart();
 
+    // Each iteration extracts into the next element of a stack, so there can be no more
+    // iterations than elements.
+    if (state->loopBound > 0) {
+        cstring iteration =
+            state->parser->program->refMap->newName(parserState->name.name + "_iteration");
+        builder->emitIndent();
+        builder->appendLine("#pragma clang loop unroll(disable)");
+        builder->emitIndent();
+        builder->appendFormat("for (u32 %s = 0; %s < %u; %s++) ", iteration.c_str(),
+                              iteration.c_str(), state->loopBound, iteration.c_str());
+        builder->blockStart();
+    }
+
     cstring msgStr =
         Util::printf_format("Parser: state %s (curr_offset=%%u)", parserState->name.name);
     builder->target->emitTraceMessage(builder, msgStr.c_str(), 1,
                                       state->parser->program->offsetVar);
 
-    visit(parserState->components, "components");
+    if (state->boundsCheckBits > 0) {
+        auto program = state->parser->program;
+        cstring lastBit =
+            Util::printf_format("%s + %u", program->offsetVar, state->boundsCheckBits);
+        cstring offsetStr = Util::printf_format("BYTES(%s)", lastBit);
+        builder->target->emitTraceMessage(builder,
+                                          "Parser: check pkt_len=%d >= last_read_byte=%d", 2,
+                                          program->lengthVar.c_str(), offsetStr.c_str());
+        emitCheckPacketLength(lastBit);
+    }
+
+    for (auto component : parserState->components) {
+        emitStackIndexChecks(component);
+        visit(component);
+    }
     if (parserState->selectExpression == nullptr) {
         builder->emitIndent();
         builder->append("goto ");
         builder->append(IR::ParserState::reject);
         builder->endOfStatement(true);
     } else if (parserState->selectExpression->is<IR::SelectExpression>()) {
+        emitStackIndexChecks(parserState->selectExpression);
         visit(parserState->selectExpression);
     } else {
         // must be a PathExpression which is a state name
         if (!parserState->selectExpression->is<IR::PathExpression>())
             BUG("Expected a PathExpression, got a %1%", parserState->selectExpression);
         builder->emitIndent();
-        builder->append(" goto ");
-        visit(parserState->selectExpression);
+        compileTransition(parserState->selectExpression->to<IR::PathExpression>());
         builder->endOfStatement(true);
     }
 
+    if (state->loopBound > 0) {
+        builder->blockEnd(true);
+        // The last iteration filled the stack and transitioned to this state again.
+        emitRejectStackOutOfBounds();
+    }
+
     builder->blockEnd(true);
     return false;
 }
@@ -258,8 +399,7 @@ bool StateTranslationVisitor::preorder(const IR::SelectCase *selectCase) {
         visit(selectCase->keyset);
         builder->append(")");
     }
-    builder->append("goto ");
-    visit(selectCase->state);
+    compileTransition(selectCase->state);
     builder->endOfStatement(true);
     return false;
 }
@@ -373,8 +513,9 @@ void StateTranslationVisitor::compileExtractField(const IR::Expression *expr,
     builder->endOfStatement(true);
 
     // eBPF can pass 64 bits of data as one argument passed in 64 bit register,
-    // so value of the field is printed only when it fits into that register
-    if (widthToExtract <= 64) {
+    // so value of the field is printed only when it fits into that register.
+    // The P4 name of a header stack element indexed at runtime is not a C expression.
+    if (widthToExtract <= 64 && !hasStackAccess(typeMap, expr)) {
         cstring exprStr = expr->is<IR::PathExpression>()
                               ? expr->to<IR::PathExpression>()->path->name.name
                               : expr->toString();
@@ -410,51 +551,18 @@ void StateTranslationVisitor::compileExtract(const IR::Expression *destination)
     unsigned width = ht->width_bits();
     auto program = state->parser->program;
 
-    cstring offsetStr =
-        Util::printf_format("BYTES(%s + %s)", program->offsetVar, cstring::to_cstring(width));
-
-    builder->target->emitTraceMessage(builder, "Parser: check pkt_len=%d >= last_read_byte=%d", 2,
-                                      program->lengthVar.c_str(), offsetStr.c_str());
+    if (!state->boundsChecked) {
+        cstring offsetStr =
+            Util::printf_format("BYTES(%s + %s)", program->offsetVar, cstring::to_cstring(width));
+        builder->target->emitTraceMessage(builder,
+                                          "Parser: check pkt_len=%d >= last_read_byte=%d", 2,
+                                          program->lengthVar.c_str(), offsetStr.c_str());
 
-    // to load some fields the compiler will use larger words
-    // than actual width of a field (e.g. 48-bit field loaded using load_dword())
-    // we must ensure that the larger word is not outside of packet buffer.
-    // FIXME: this can fail if a packet does not contain additional payload after header.
-    //  However, we don't have better solution in case of using load_X functions to parse packet.
-    // TODO: consider using a collection of smaller widths.
-    unsigned curr_padding = 0;
-    for (auto f : ht->fields) {
-        auto ftype = state->parser->typeMap->getType(f);
-        auto etype = EBPFTypeFactory::instance->create(ftype);
-        if (etype->is<EBPFScalarType>()) {
-            auto scalarType = etype->to<EBPFScalarType>();
-            unsigned readWordSize = scalarType->alignment() * 8;
-            unsigned unaligned = scalarType->widthInBits() % readWordSize;
-            unsigned padding = readWordSize - unaligned;
-            if (padding == readWordSize) padding = 0;
-            if (scalarType->widthInBits() + padding >= curr_padding) {
-                curr_padding = padding;
-            }
-        }
+        unsigned curr_padding = extractPadding(state->parser->typeMap, ht);
+        emitCheckPacketLength(Util::printf_format("%s + %d + %u", program->offsetVar, width,
+                                                  curr_padding));
     }
 
-    builder->emitIndent();
-    builder->appendFormat("if (%s < %s + BYTES(%s + %d + %u)) ", program->packetEndVar.c_str(),
-                          program->packetStartVar.c_str(), program->offsetVar.c_str(), width,
-                          curr_padding);
-    builder->blockStart();
-
-    builder->target->emitTraceMessage(builder, "Parser: invalid packet (packet too short)");
-
-    builder->emitIndent();
-    builder->appendFormat("%s = %s;", program->errorVar.c_str(), p4lib.packetTooShort.str());
-    builder->newline();
-
-    builder->emitIndent();
-    builder->appendFormat("goto %s;", IR::ParserState::reject.c_str());
-    builder->newline();
-    builder->blockEnd(true);
-
     msgStr = Util::printf_format("Parser: extracting header %s", destination->toString());
     builder->target->emitTraceMessage(builder, msgStr.c_str());
     builder->newline();
@@ -506,7 +614,13 @@ void StateTranslationVisitor::processMethod(const P4::ExternMethod *method) {
                         "Variable-sized header fields not yet supported %1%", expression);
                 return;
             }
-            compileExtract(expression->arguments->at(0)->expression);
+            auto destination = expression->arguments->at(0)->expression;
+            compileExtract(destination);
+            if (auto next = stackNext(typeMap, destination)) {
+                builder->emitIndent();
+                builder->appendFormat("%s++", state->parser->getStackIndexVar(next->expr).c_str());
+                builder->endOfStatement(true);
+            }
             return;
         } else if (method->method->name.name == p4lib.packetIn.length.name) {
             builder->append(state->parser->program->lengthVar);
@@ -579,6 +693,21 @@ bool StateTranslationVisitor::preorder(const IR::MethodCallExpression *expressio
 }
 
 bool StateTranslationVisitor::preorder(const IR::Member *expression) {
+    if (stackAccess(typeMap, expression) != nullptr) {
+        cstring index = state->parser->getStackIndexVar(expression->expr);
+        BUG_CHECK(!index.isNullOrEmpty(), "%1%: header stack without an index", expression);
+        if (expression->member == IR::Type_Stack::lastIndex) {
+            builder->appendFormat("(%s - 1)", index.c_str());
+            return false;
+        }
+        visit(expression->expr);
+        if (expression->member == IR::Type_Stack::next)
+            builder->appendFormat("[%s]", index.c_str());
+        else
+            builder->appendFormat("[%s - 1]", index.c_str());
+        return false;
+    }
+
     if (expression->expr->is<IR::PathExpression>()) {
         auto pe = expression->expr->to<IR::PathExpression>();
         auto decl = state->parser->program->refMap->getDeclaration(pe->path, true);
@@ -620,6 +749,14 @@ void EBPFParser::emitDeclaration(CodeBuilder *builder, const IR::Declaration *de
     BUG("%1%: not yet handled", decl);
 }
 
+void EBPFParser::emitStackIndexVariables(CodeBuilder *builder) const {
+    for (auto it : stackIndexVars) {
+        builder->emitIndent();
+        builder->appendFormat("u32 %s = 0;", it.second.c_str());
+        builder->newline();
+    }
+}
+
 void EBPFParser::emit(CodeBuilder *builder) {
     for (auto l : parserBlock->container->parserLocals) emitDeclaration(builder, l);
 
@@ -678,9 +815,159 @@ bool EBPFParser::build() {
         }
     }
 
+    findStackLoops();
+    if (canCoalesceBoundsChecks()) coalesceBoundsChecks();
+
+    return true;
+}
+
+void EBPFParser::findStackLoops() {
+    auto &p4lib = P4::P4CoreLibrary::instance();
+    for (auto s : states) {
+        forAllMatching<IR::Member>(s->state, [&](const IR::Member *member) {
+            if (stackAccess(typeMap, member) == nullptr) return;
+            cstring stack = member->expr->toString();
+            if (stackIndexVars.count(stack) != 0) return;
+            cstring index = program->refMap->newName(stack.replace('.', '_') + "_next");
+            stackIndexVars.emplace(stack, index);
+        });
+
+        auto select = s->state->selectExpression;
+        if (select == nullptr) continue;
+        bool selfLoop = false;
+        if (auto path = select->to<IR::PathExpression>()) {
+            selfLoop = path->path->name.name == s->state->name.name;
+        } else if (auto se = select->to<IR::SelectExpression>()) {
+            for (auto selectCase : se->selectCases)
+                selfLoop |= selectCase->state->path->name.name == s->state->name.name;
+        }
+        if (!selfLoop) continue;
+
+        // Only extracts at the top level of the state run in every iteration.
+        for (auto component : s->state->components) {
+            auto statement = component->to<IR::MethodCallStatement>();
+            if (statement == nullptr || statement->methodCall->arguments->size() != 1) continue;
+            auto mi = P4::MethodInstance::resolve(statement->methodCall, program->refMap,
+                                                  program->typeMap);
+            auto extMethod = mi->to<P4::ExternMethod>();
+            if (extMethod == nullptr || extMethod->object != packet ||
+                extMethod->method->name.name != p4lib.packetIn.extract.name)
+                continue;
+            auto next = stackNext(typeMap, statement->methodCall->arguments->at(0)->expression);
+            if (next == nullptr) continue;
+            unsigned size = stackAccess(typeMap, next)->getSize();
+            if (s->loopBound == 0 || size < s->loopBound) s->loopBound = size;
+        }
+    }
+}
+
+bool EBPFParser::getPacketAccesses(const IR::ParserState *state, unsigned &consumedBits,
+                                   unsigned &accessedBits) const {
+    auto &p4lib = P4::P4CoreLibrary::instance();
+    consumedBits = 0;
+    accessedBits = 0;
+    for (auto component : state->components) {
+        const IR::MethodCallExpression *mce = nullptr;
+        const IR::Expression *destination = nullptr;
+        if (auto statement = component->to<IR::MethodCallStatement>()) {
+            mce = statement->methodCall;
+        } else if (auto statement = component->to<IR::AssignmentStatement>()) {
+            mce = statement->right->to<IR::MethodCallExpression>();
+            destination = statement->left;
+        } else if (!component->is<IR::Declaration>()) {
+            // Packet accesses in nested statements are not tracked.
+            return false;
+        }
+        if (mce == nullptr) continue;
+
+        auto mi = P4::MethodInstance::resolve(mce, program->refMap, program->typeMap);
+        if (auto function = mi->to<P4::ExternFunction>()) {
+            if (function->method->name.name == IR::ParserState::verify) return false;
+            continue;
+        }
+        auto extMethod = mi->to<P4::ExternMethod>();
+        if (extMethod == nullptr || extMethod->object != packet) continue;
+
+        cstring name = extMethod->method->name.name;
+        if (name == p4lib.packetIn.extract.name) {
+            if (mce->arguments->size() != 1) return false;
+            destination = mce->arguments->at(0)->expression;
+        } else if (name == p4lib.packetIn.advance.name) {
+            auto cnst = mce->arguments->at(0)->expression->to<IR::Constant>();
+            if (cnst == nullptr) return false;
+            consumedBits += cnst->asUnsigned();
+            accessedBits = std::max(accessedBits, consumedBits);
+            continue;
+        } else if (name != p4lib.packetIn.lookahead.name) {
+            continue;
+        }
+        if (destination == nullptr) return false;
+
+        auto ht = typeMap->getType(destination, true)->to<IR::Type_StructLike>();
+        if (ht == nullptr) return false;
+        unsigned width = ht->width_bits();
+        accessedBits =
+            std::max(accessedBits, consumedBits + width + extractPadding(typeMap, ht));
+        // lookahead does not consume the header
+        if (name == p4lib.packetIn.extract.name) consumedBits += width;
+    }
     return true;
 }
 
+void EBPFParser::coalesceBoundsChecks() {
+    struct Accesses {
+        bool fixed;
+        unsigned consumedBits;
+        unsigned accessedBits;
+    };
+    std::map<cstring, EBPFParserState *> stateByName;
+    std::map<const EBPFParserState *, Accesses> accesses;
+    // The start state is also entered from the beginning of the parser.
+    std::map<cstring, unsigned> incoming = {{IR::ParserState::start, 1}};
+    for (auto s : states) {
+        stateByName.emplace(s->state->name.name, s);
+        Accesses &a = accesses[s];
+        a.fixed = !s->state->isBuiltin() &&
+                  getPacketAccesses(s->state, a.consumedBits, a.accessedBits);
+        auto select = s->state->selectExpression;
+        if (select == nullptr) continue;
+        if (auto path = select->to<IR::PathExpression>()) {
+            incoming[path->path->name.name]++;
+        } else if (auto se = select->to<IR::SelectExpression>()) {
+            for (auto selectCase : se->selectCases) incoming[selectCase->state->path->name.name]++;
+        }
+    }
+
+    // Returns the state which @p s runs into unconditionally, if @p s is the only way to reach it
+    // and the packet accesses of both states are known.
+    auto successor = [&](const EBPFParserState *s) -> EBPFParserState * {
+        if (!accesses[s].fixed || s->state->selectExpression == nullptr) return nullptr;
+        auto path = s->state->selectExpression->to<IR::PathExpression>();
+        if (path == nullptr || incoming[path->path->name.name] != 1) return nullptr;
+        auto it = stateByName.find(path->path->name.name);
+        if (it == stateByName.end() || !accesses[it->second].fixed) return nullptr;
+        return it->second;
+    };
+
+    std::set<const EBPFParserState *> absorbed;
+    for (auto s : states) {
+        if (auto next = successor(s)) absorbed.insert(next);
+    }
+
+    for (auto head : states) {
+        if (!accesses[head].fixed || absorbed.count(head) != 0) continue;
+        unsigned consumedBits = 0;
+        unsigned accessedBits = 0;
+        for (auto s = head; s != nullptr && !s->boundsChecked; s = successor(s)) {
+            const Accesses &a = accesses[s];
+            accessedBits = std::max(accessedBits, consumedBits + a.accessedBits);
+            consumedBits += a.consumedBits;
+            s->boundsChecked = true;
+        }
+        head->boundsCheckBits = accessedBits;
+    }
+}
+
 void EBPFParser::emitTypes(CodeBuilder *builder) {
     for (auto pvs : valueSets) {
         pvs.second->emitTypes(builder);
@@ -38,10 +38,17 @@ class StateTranslationVisitor : public CodeGenInspector {
 
     void compileExtractField(const IR::Expression *expr, const IR::StructField *field,
                              unsigned alignment, EBPFType *type);
+    void emitCheckPacketLength(cstring lastBit);
+    void emitRejectStackOutOfBounds();
     virtual void compileExtract(const IR::Expression *destination);
     void compileLookahead(const IR::Expression *destination);
     void compileAdvance(const P4::ExternMethod *ext);
     void compileVerify(const IR::MethodCallExpression *expression);
+    /// Rejects the packet with StackOutOfBounds if an access to the next or last element of
+    /// a header stack in @p node is outside of the stack.
+    void emitStackIndexChecks(const IR::Node *node);
+    /// Emits a jump to @p nextState, which is a continue if the state is emitted as a loop.
+    void compileTransition(const IR::PathExpression *nextState);
 
     virtual void processFunction(const P4::ExternFunction *function);
     virtual void processMethod(const P4::ExternMethod *method);
@@ -69,6 +76,15 @@ class EBPFParserState : public EBPFObject {
     const IR::ParserState *state;
     const EBPFParser *parser;
 
+    /// True if all packet accesses of this state are covered by a single bounds check, which
+    /// is emitted when this state or a state that runs into it unconditionally is entered.
+    bool boundsChecked = false;
+    /// Number of bits after the current offset that are checked when this state is entered.
+    unsigned boundsCheckBits = 0;
+    /// If non-zero, this state extracts into the next element of a header stack and may
+    /// transition to itself, and it is emitted as a loop with at most loopBound iterations.
+    unsigned loopBound = 0;
+
     EBPFParserState(const IR::ParserState *state, EBPFParser *parser)
         : state(state), parser(parser) {}
     void emit(CodeBuilder *builder);
@@ -88,6 +104,9 @@ class EBPFParser : public EBPFObject {
     StateTranslationVisitor *visitor;
 
     std::map<cstring, EBPFValueSet *> valueSets;
+    /// Variables holding the next index of the header stacks accessed with next, last or
+    /// lastIndex, by stack expression. Present only if parser loops are not unrolled.
+    std::map<cstring, cstring> stackIndexVars;
 
     explicit EBPFParser(const EBPFProgram *program, const IR::ParserBlock *block,
                         const P4::TypeMap *typeMap);
@@ -98,8 +117,34 @@ class EBPFParser : public EBPFObject {
     virtual void emitTypes(CodeBuilder *builder);
     virtual void emitValueSetInstances(CodeBuilder *builder);
     virtual void emitRejectState(CodeBuilder *builder);
+    /// Declares the stack index variables. They must be emitted with the local variables of
+    /// the program, before the jump to the start state, or they are not initialized.
+    void emitStackIndexVariables(CodeBuilder *builder) const;
+
+    /// Allocates an index variable for each header stack accessed with next, last or lastIndex,
+    /// and computes the loop bound of the states which extract into the next element of a stack
+    /// and transition to themselves.
+    void findStackLoops();
 
     EBPFValueSet *getValueSet(cstring name) const { return ::get(valueSets, name); }
+    cstring getStackIndexVar(const IR::Expression *stack) const {
+        return ::get(stackIndexVars, stack->toString());
+    }
+
+ protected:
+    /// Returns true if a packet access may be checked together with the accesses that precede
+    /// it. A coalesced check rejects a packet which is too short for a later header before an
+    /// earlier header is extracted, which is only correct if rejected packets are dropped.
+    virtual bool canCoalesceBoundsChecks() const { return program->options.coalesceBoundsChecks; }
+    /// Computes the bounds checks of all states. Checks of the packet accesses in a state, and
+    /// in the states that follow it unconditionally, are replaced by a single check when the
+    /// state is entered.
+    void coalesceBoundsChecks();
+    /// Computes the number of bits that @p state consumes, and the number of bits after the
+    /// current offset it accesses. Returns false if these are not known at compile time, or if
+    /// the state calls verify, which must reject a packet before its length is checked.
+    bool getPacketAccesses(const IR::ParserState *state, unsigned &consumedBits,
+                           unsigned &accessedBits) const;
 };
 
 }  // namespace EBPF
@@ -245,6 +245,8 @@ void EBPFProgram::emitLocalVariables(CodeBuilder *builder) {
     builder->appendFormat("u32 %s = %s - %s", lengthVar.c_str(), packetEndVar.c_str(),
                           packetStartVar.c_str());
     builder->endOfStatement(true);
+
+    parser->emitStackIndexVariables(builder);
 }
 
 void EBPFProgram::emitHeaderInstances(CodeBuilder *builder) {
@@ -222,6 +222,12 @@ void EBPFTable::emitKeyType(CodeBuilder *builder) {
         builder->appendFormat("#define MAX_%s_MASKS %u", keyTypeName.toUpper(),
                               program->options.maxTernaryMasks);
         builder->newline();
+        if (program->options.tupleBloomFilters) {
+            builder->emitIndent();
+            builder->appendFormat("#define %s_BLOOM_BITS %u", keyTypeName.toUpper(),
+                                  tupleBloomFilterBits());
+            builder->newline();
+        }
 
         builder->emitIndent();
         builder->appendFormat("struct %s_mask ", keyTypeName.c_str());
@@ -234,6 +240,20 @@ void EBPFTable::emitKeyType(CodeBuilder *builder) {
         builder->blockEnd(false);
         builder->appendFormat(" __attribute__((aligned(%d)))", structAlignment);
         builder->endOfStatement(true);
+
+        if (program->options.tupleBloomFilters) {
+            // Bloom filter of masked keys, stored per tuple
+            builder->emitIndent();
+            builder->appendFormat("struct %s_bloom ", keyTypeName.c_str());
+            builder->blockStart();
+            builder->emitIndent();
+            builder->appendFormat("__u64 bits[%s_BLOOM_BITS / 64];", keyTypeName.toUpper());
+            builder->newline();
+            builder->emitIndent();
+            builder->appendLine("__u8 enabled;");
+            builder->blockEnd(false);
+            builder->endOfStatement(true);
+        }
     }
 }
 
@@ -283,6 +303,11 @@ void EBPFTable::emitValueType(CodeBuilder *builder) {
         builder->newline();
         builder->emitIndent();
         builder->appendLine("__u8 has_next;");
+        builder->emitIndent();
+        builder->appendLine("__u32 max_priority;");
+        builder->emitIndent();
+        builder->appendFormat("struct %s_mask last_ordered_mask;", keyTypeName.c_str());
+        builder->newline();
         builder->blockEnd(false);
         builder->endOfStatement(true);
     }
@@ -356,6 +381,21 @@ void EBPFTable::emitTernaryInstance(CodeBuilder *builder) {
     builder->target->emitMapInMapDecl(builder, instanceName + "_tuple", TableHash,
                                       "struct " + keyTypeName, "struct " + valueTypeName, size,
                                       instanceName + "_tuples_map", TableArray, "__u32", size);
+    if (program->options.tupleBloomFilters) {
+        // Indexed by tuple ID, like the tuples map.
+        builder->target->emitTableDecl(builder, instanceName + "_tuples_bloom", TableArray,
+                                       "u32", "struct " + keyTypeName + "_bloom", size);
+    }
+}
+
+unsigned EBPFTable::tupleBloomFilterBits() const {
+    // About 8 bits per entry give a false positive rate of a few percent with two hash
+    // functions, even if all entries of the table share a single mask. A filter is capped at
+    // 1 KiB and the filters of a table, one per tuple ID, at 1 MiB.
+    unsigned bits = 64;
+    while (bits < (1U << 13) && bits < size * 8ULL && bits * 2ULL * size <= (1ULL << 23))
+        bits <<= 1;
+    return bits;
 }
 
 void EBPFTable::emitInstance(CodeBuilder *builder) {
@@ -751,6 +791,10 @@ void EBPFTable::emitLookup(CodeBuilder *builder, cstring key, cstring value) {
     builder->emitIndent();
     builder->appendFormat("struct %s_mask next = val->next_tuple_mask;", keyTypeName);
     builder->newline();
+    // The head marks the tuples up to last_ordered_mask as ordered by max_priority,
+    // see the PSA README.
+    builder->emitIndent();
+    builder->appendLine("__u32 ordered = val->max_priority;");
     builder->emitIndent();
     builder->appendLine("#pragma clang loop unroll(disable)");
     builder->emitIndent();
@@ -767,6 +811,60 @@ void EBPFTable::emitLookup(CodeBuilder *builder, cstring key, cstring value) {
     builder->emitIndent();
     builder->appendLine("break;");
     builder->blockEnd(true);
+    // A tuple whose entries all have a priority not higher than the current best match cannot
+    // beat it. If the tuple is one of the ordered ones, neither can the remaining ordered tuples
+    // and the lookup continues after the last of them, where only tuples without max_priority
+    // are linked (e.g. by a control plane which does not maintain it). Otherwise only this
+    // tuple is skipped.
+    builder->emitIndent();
+    builder->appendFormat(
+        "if (%s != NULL && v->max_priority != 0 && v->max_priority <= %s->priority) ", value,
+        value);
+    builder->blockStart();
+    builder->emitIndent();
+    builder->append("if (ordered != 0) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->appendLine("ordered = 0;");
+    builder->emitIndent();
+    builder->appendFormat("struct %s_mask *", valueTypeName);
+    builder->target->emitTableLookup(builder, instanceName + "_prefixes",
+                                     "val->last_ordered_mask", "last");
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->append("if (last) ");
+    builder->blockStart();
+    builder->target->emitTraceMessage(
+        builder, "Control: [Ternary] Ordered tuples skipped, no entry with priority higher than %d",
+        1, (value + "->priority").c_str());
+    builder->emitIndent();
+    builder->append("if (last->has_next == 0) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->appendLine("break;");
+    builder->blockEnd(true);
+    builder->emitIndent();
+    builder->appendLine("next = last->next_tuple_mask;");
+    builder->emitIndent();
+    builder->append("continue;");
+    builder->newline();
+    builder->blockEnd(true);
+    builder->blockEnd(true);
+    builder->target->emitTraceMessage(
+        builder, "Control: [Ternary] Tuple skipped, no entry with priority higher than %d", 1,
+        (value + "->priority").c_str());
+    builder->emitIndent();
+    builder->appendLine("next = v->next_tuple_mask;");
+    builder->emitIndent();
+    builder->append("if (v->has_next == 0) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->appendLine("break;");
+    builder->blockEnd(true);
+    builder->emitIndent();
+    builder->append("continue;");
+    builder->newline();
+    builder->blockEnd(true);
     builder->emitIndent();
     cstring new_key = "k";
     builder->appendFormat("struct %s %s = {};", keyTypeName, new_key);
@@ -776,6 +874,10 @@ void EBPFTable::emitLookup(CodeBuilder *builder, cstring key, cstring value) {
     builder->newline();
     builder->emitIndent();
     builder->appendLine("__u32 *mask = ((__u32 *) &next);");
+    if (program->options.tupleBloomFilters) {
+        builder->emitIndent();
+        builder->appendLine("__u32 hash = BPF_BLOOM_HASH_INIT;");
+    }
     builder->emitIndent();
     builder->appendLine("#pragma clang loop unroll(disable)");
     builder->emitIndent();
@@ -789,6 +891,10 @@ void EBPFTable::emitLookup(CodeBuilder *builder, cstring key, cstring value) {
     builder->emitIndent();
     builder->appendFormat("chunk[i] = ((__u32 *) &%s)[i] & mask[i];", key);
     builder->newline();
+    if (program->options.tupleBloomFilters) {
+        builder->emitIndent();
+        builder->appendLine("hash = BPF_BLOOM_HASH_STEP(hash, chunk[i]);");
+    }
     builder->blockEnd(true);
 
     builder->emitIndent();
@@ -796,6 +902,31 @@ void EBPFTable::emitLookup(CodeBuilder *builder, cstring key, cstring value) {
     builder->emitIndent();
     builder->append("next = v->next_tuple_mask;");
     builder->newline();
+    if (program->options.tupleBloomFilters) {
+        builder->emitIndent();
+        builder->appendFormat("struct %s_bloom *", keyTypeName);
+        builder->target->emitTableLookup(builder, instanceName + "_tuples_bloom", "tuple_id",
+                                         "bloom");
+        builder->endOfStatement(true);
+        builder->emitIndent();
+        builder->appendFormat(
+            "if (bloom && bloom->enabled && !BPF_BLOOM_TEST(bloom->bits, %s_BLOOM_BITS, hash)) ",
+            keyTypeName.toUpper());
+        builder->blockStart();
+        builder->target->emitTraceMessage(builder,
+                                          "Control: [Ternary] Tuple %d skipped by Bloom filter",
+                                          1, "tuple_id");
+        builder->emitIndent();
+        builder->append("if (v->has_next == 0) ");
+        builder->blockStart();
+        builder->emitIndent();
+        builder->appendLine("break;");
+        builder->blockEnd(true);
+        builder->emitIndent();
+        builder->append("continue;");
+        builder->newline();
+        builder->blockEnd(true);
+    }
     builder->emitIndent();
     builder->append("struct bpf_elf_map *");
     builder->target->emitTableLookup(builder, instanceName + "_tuples_map", "tuple_id", "tuple");
@@ -930,11 +1061,40 @@ EBPFCounterTable::EBPFCounterTable(const EBPFProgram *program, const IR::ExternB
     }
 
     isHash = sprs->to<IR::BoolLiteral>()->value;
+    setPerCPU(block->node);
+}
+
+const cstring EBPFCounterTable::perCPUAnnotation = "per_cpu";
+
+void EBPFCounterTable::setPerCPU(const IR::Node *node) {
+    isPerCPU = program->options.perCPUCounters;
+    if (const auto *annotated = node->to<IR::IAnnotated>()) {
+        isPerCPU = isPerCPU || annotated->getAnnotation(perCPUAnnotation) != nullptr;
+    }
+}
+
+TableKind EBPFCounterTable::getTableKind() const {
+    if (isPerCPU) {
+        return isHash ? TablePerCPUHash : TablePerCPUArray;
+    }
+    return isHash ? TableHash : TableArray;
+}
+
+void EBPFCounterTable::emitIncrement(CodeBuilder *builder, cstring target,
+                                     cstring increment) const {
+    builder->emitIndent();
+    if (isPerCPU) {
+        builder->appendFormat("%s += %s;", target.c_str(), increment.c_str());
+    } else {
+        builder->appendFormat("__sync_fetch_and_add(&(%s), %s);", target.c_str(),
+                              increment.c_str());
+    }
+    builder->newline();
 }
 
 void EBPFCounterTable::emitInstance(CodeBuilder *builder) {
-    TableKind kind = isHash ? TableHash : TableArray;
-    builder->target->emitTableDecl(builder, dataMapName, kind, keyTypeName, valueTypeName, size);
+    builder->target->emitTableDecl(builder, dataMapName, getTableKind(), keyTypeName,
+                                   valueTypeName, size);
 }
 
 void EBPFCounterTable::emitCounterIncrement(CodeBuilder *builder,
@@ -974,9 +1134,7 @@ void EBPFCounterTable::emitCounterIncrement(CodeBuilder *builder,
     builder->appendFormat("if (%s != NULL)", valueName.c_str());
     builder->newline();
     builder->increaseIndent();
-    builder->emitIndent();
-    builder->appendFormat("__sync_fetch_and_add(%s, 1);", valueName.c_str());
-    builder->newline();
+    emitIncrement(builder, "*" + valueName, "1");
     builder->decreaseIndent();
 
     builder->emitIndent();
@@ -1037,9 +1195,7 @@ void EBPFCounterTable::emitCounterAdd(CodeBuilder *builder,
     builder->appendFormat("if (%s != NULL)", valueName.c_str());
     builder->newline();
     builder->increaseIndent();
-    builder->emitIndent();
-    builder->appendFormat("__sync_fetch_and_add(%s, %s);", valueName.c_str(), incName.c_str());
-    builder->newline();
+    emitIncrement(builder, "*" + valueName, incName);
     builder->decreaseIndent();
 
     builder->emitIndent();
@@ -78,6 +78,9 @@ class EBPFTable : public EBPFTableBase {
 
  protected:
     void emitTernaryInstance(CodeBuilder *builder);
+    /// @returns the number of bits of the Bloom filter of each tuple of a ternary table,
+    /// see the --tuple-bloom-filters option.
+    unsigned tupleBloomFilterBits() const;
 
     virtual void validateKeys() const;
     virtual ActionTranslationVisitor *createActionTranslationVisitor(
@@ -147,8 +150,20 @@ class EBPFCounterTable : public EBPFTableBase {
  protected:
     size_t size;
     bool isHash;
+    // Each CPU updates its own copy of the counters, without atomic operations.
+    // The control plane sums the copies when reading a counter.
+    bool isPerCPU = false;
+
+    /// Enables per-CPU counters if requested by the compiler options or by
+    /// the @per_cpu annotation of the counter declaration @p node.
+    void setPerCPU(const IR::Node *node);
+    TableKind getTableKind() const;
+    /// Emits code which adds @p increment to the counter @p target.
+    void emitIncrement(CodeBuilder *builder, cstring target, cstring increment) const;
 
  public:
+    static const cstring perCPUAnnotation;
+
     EBPFCounterTable(const EBPFProgram *program, const IR::ExternBlock *block, cstring name,
                      CodeGenInspector *codeGen);
     EBPFCounterTable(const EBPFProgram *program, cstring name, CodeGenInspector *codeGen,
@@ -105,7 +105,8 @@ const IR::ToplevelBlock *MidEnd::run(EbpfOptions &options, const IR::P4Program *
              new P4::TableHit(&refMap, &typeMap),
              new P4::RemoveLeftSlices(&refMap, &typeMap),
              new EBPF::Lower(&refMap, &typeMap),
-             new P4::ParsersUnroll(true, &refMap, &typeMap),
+             new PassIf([&options] { return !options.parserLoops; },
+                        {new P4::ParsersUnroll(true, &refMap, &typeMap)}),
              evaluator,
              new P4::MidEndLast()});
 
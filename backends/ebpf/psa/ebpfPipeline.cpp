@@ -92,6 +92,8 @@ void EBPFPipeline::emitLocalVariables(CodeBuilder *builder) {
     builder->appendFormat("u32 %s = %s;", inputPortVar.c_str(), ifindexVar.c_str());
     builder->newline();
     emitInputPortMapping(builder);
+
+    if (parser != nullptr) parser->emitStackIndexVariables(builder);
 }
 
 void EBPFPipeline::emitUserMetadataInstance(CodeBuilder *builder) {
@@ -245,6 +247,8 @@ void EBPFIngressPipeline::emit(CodeBuilder *builder) {
     builder->blockStart();
 
     emitLocalVariables(builder);
+    deparser->emitIncrementalChecksumVariables(builder);
+    deparser->emitParsedHeaderOffsetVariables(builder);
 
     builder->newline();
     emitUserMetadataInstance(builder);
@@ -277,6 +281,7 @@ void EBPFIngressPipeline::emit(CodeBuilder *builder) {
     builder->spc();
     builder->blockStart();
     emitPSAControlInputMetadata(builder);
+    deparser->emitIncrementalChecksumSnapshots(builder);
     msgStr = Util::printf_format("%s control: packet processing started", sectionName);
     builder->target->emitTraceMessage(builder, msgStr.c_str());
     control->emit(builder);
@@ -398,13 +403,17 @@ void EBPFEgressPipeline::emitCPUMAPLookup(CodeBuilder *builder) {
     builder->endOfStatement(true);
 }
 
+void EBPFEgressPipeline::emitFunctionSignature(CodeBuilder *builder) {
+    progTarget->emitCodeSection(builder, sectionName);
+    builder->emitIndent();
+    progTarget->emitMain(builder, functionName, model.CPacketName.str());
+}
+
 void EBPFEgressPipeline::emit(CodeBuilder *builder) {
     cstring msgStr, varStr;
 
     builder->newline();
-    progTarget->emitCodeSection(builder, sectionName);
-    builder->emitIndent();
-    progTarget->emitMain(builder, functionName, model.CPacketName.str());
+    emitFunctionSignature(builder);
     builder->spc();
     builder->blockStart();
 
@@ -412,6 +421,8 @@ void EBPFEgressPipeline::emit(CodeBuilder *builder) {
     emitCheckPacketMarkMetadata(builder);
 
     emitLocalVariables(builder);
+    deparser->emitIncrementalChecksumVariables(builder);
+    deparser->emitParsedHeaderOffsetVariables(builder);
     emitUserMetadataInstance(builder);
     builder->newline();
 
@@ -452,6 +463,7 @@ void EBPFEgressPipeline::emit(CodeBuilder *builder) {
     builder->emitIndent();
     builder->blockStart();
     builder->newline();
+    deparser->emitIncrementalChecksumSnapshots(builder);
     msgStr = Util::printf_format("%s control: packet processing started", sectionName);
     builder->target->emitTraceMessage(builder, msgStr.c_str());
     control->emit(builder);
@@ -706,6 +718,37 @@ void XDPIngressPipeline::emitTrafficManager(CodeBuilder *builder) {
     // do not handle multicast; it has been handled earlier by PreDeparser.
     cstring portVar =
         Util::printf_format("%s.egress_port", control->outputStandardMetadata->name.name);
+    if (options.xdpOnly) {
+        // Recirculation needs the TC layer. Writes of the recirculation port are not known at
+        // compile time in general, so the packet is dropped here instead of being redirected
+        // to whichever port the recirculation port maps to in the devmap.
+        builder->emitIndent();
+        builder->appendFormat("if (%s == P4C_PSA_PORT_RECIRCULATE) ", portVar);
+        builder->blockStart();
+        builder->target->emitTraceMessage(
+            builder, "IngressTM: Recirculation is not supported with --xdp-only, dropping packet");
+        builder->emitIndent();
+        builder->appendFormat("return %s;", dropReturnCode());
+        builder->newline();
+        builder->blockEnd(true);
+        // NTK path; in the other XDP modes it is taken in TC, before deparsing.
+        builder->emitIndent();
+        builder->appendFormat("if (%s == 0) ", portVar);
+        builder->blockStart();
+        builder->target->emitTraceMessage(builder,
+                                          "IngressTM: Sending packet up to the kernel stack");
+        builder->emitIndent();
+        builder->appendFormat("return %s;", forwardReturnCode());
+        builder->newline();
+        builder->blockEnd(true);
+        if (!egressFunctionName.isNullOrEmpty()) {
+            builder->emitIndent();
+            builder->appendFormat("return %s(%s, %s);", egressFunctionName,
+                                  model.CPacketName.str(), portVar);
+            builder->newline();
+            return;
+        }
+    }
     builder->target->emitTraceMessage(builder, "IngressTM: Sending packet out of port %u", 1,
                                       portVar);
     builder->emitIndent();
@@ -747,8 +790,27 @@ void XDPEgressPipeline::emitTrafficManager(CodeBuilder *builder) {
     varStr = Util::printf_format("%s.egress_port", control->inputStandardMetadata->name.name);
     builder->target->emitTraceMessage(builder, "EgressTM: output packet to port %d", 1, varStr);
     builder->emitIndent();
-    builder->appendFormat("return %s;", this->forwardReturnCode());
+    if (options.xdpOnly) {
+        // there is no devmap program to return to, so redirect the packet from here.
+        builder->appendFormat("return bpf_redirect_map(&tx_port, %s%s, 0);", varStr,
+                              "%DEVMAP_SIZE");
+    } else {
+        builder->appendFormat("return %s;", this->forwardReturnCode());
+    }
+    builder->newline();
+}
+
+void XDPEgressPipeline::emitFunctionSignature(CodeBuilder *builder) {
+    if (!options.xdpOnly) {
+        EBPFEgressPipeline::emitFunctionSignature(builder);
+        return;
+    }
+
+    builder->append("static __always_inline");
     builder->newline();
+    builder->appendFormat("int %s(%s *%s, u32 %s)", functionName,
+                          builder->target->packetDescriptorType(), model.CPacketName.str(),
+                          ifindexVar);
 }
 
 void XDPEgressPipeline::emitCheckPacketMarkMetadata(CodeBuilder *builder) {
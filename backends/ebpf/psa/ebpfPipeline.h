@@ -193,6 +193,8 @@ class EBPFEgressPipeline : public EBPFPipeline {
     void emitPSAControlOutputMetadata(CodeBuilder *builder) override;
     void emitCPUMAPLookup(CodeBuilder *builder) override;
 
+    /* Generates the section and the signature of the function running the pipeline. */
+    virtual void emitFunctionSignature(CodeBuilder *builder);
     virtual void emitCheckPacketMarkMetadata(CodeBuilder *builder) = 0;
 };
 
@@ -223,6 +225,10 @@ class TCEgressPipeline : public EBPFEgressPipeline {
 
 class XDPIngressPipeline : public EBPFIngressPipeline {
  public:
+    // In the XDP-only mode, the in-lined egress function called for unicast packets;
+    // nullptr if the egress pipeline is empty.
+    cstring egressFunctionName = nullptr;
+
     XDPIngressPipeline(cstring name, const EbpfOptions &options, P4::ReferenceMap *refMap,
                        P4::TypeMap *typeMap)
         : EBPFIngressPipeline(name, options, refMap, typeMap) {
@@ -243,6 +249,10 @@ class XDPEgressPipeline : public EBPFEgressPipeline {
         : EBPFEgressPipeline(name, options, refMap, typeMap) {
         sectionName = "xdp_devmap/" + name;
         ifindexVar = cstring("skb->egress_ifindex");
+        if (options.xdpOnly) {
+            // egress runs as a function called from the XDP ingress program with the output port.
+            ifindexVar = cstring("egress_port");
+        }
         // we do not support packet path, instance & priority in the XDP egress.
         packetPathVar = cstring("0");
         pktInstanceVar = cstring("0");
@@ -252,6 +262,7 @@ class XDPEgressPipeline : public EBPFEgressPipeline {
 
     void emitGlobalMetadataInitializer(CodeBuilder *builder) override;
     void emitTrafficManager(CodeBuilder *builder) override;
+    void emitFunctionSignature(CodeBuilder *builder) override;
     void emitCheckPacketMarkMetadata(CodeBuilder *builder) override;
 };
 
@@ -97,11 +97,14 @@ cstring ControlBodyTranslatorPSA::getParamName(const IR::PathExpression *expr) {
 
 void EBPFControlPSA::emit(CodeBuilder *builder) {
     for (auto h : hashes) h.second->emitVariables(builder);
+    if (flowCache != nullptr) flowCache->emitLookup(builder);
     EBPFControl::emit(builder);
+    if (flowCache != nullptr) flowCache->emitUpdate(builder);
 }
 
 void EBPFControlPSA::emitTableTypes(CodeBuilder *builder) {
     EBPFControl::emitTableTypes(builder);
+    if (flowCache != nullptr) flowCache->emitTypes(builder);
 
     for (auto it : registers) it.second->emitTypes(builder);
     for (auto it : meters) it.second->emitKeyType(builder);
@@ -117,6 +120,7 @@ void EBPFControlPSA::emitTableInstances(CodeBuilder *builder) {
     for (auto it : counters) it.second->emitInstance(builder);
     for (auto it : registers) it.second->emitInstance(builder);
     for (auto it : meters) it.second->emitInstance(builder);
+    if (flowCache != nullptr) flowCache->emitInstance(builder);
 }
 
 void EBPFControlPSA::emitTableInitializers(CodeBuilder *builder) {
@@ -21,6 +21,7 @@ limitations under the License.
 #include "backends/ebpf/psa/externs/ebpfPsaChecksum.h"
 #include "backends/ebpf/psa/externs/ebpfPsaRandom.h"
 #include "backends/ebpf/psa/externs/ebpfPsaRegister.h"
+#include "ebpfPsaFlowCache.h"
 #include "ebpfPsaTable.h"
 
 namespace EBPF {
@@ -69,6 +70,9 @@ class EBPFControlPSA : public EBPFControl {
     std::map<cstring, EBPFRegisterPSA *> registers;
     std::map<cstring, EBPFMeterPSA *> meters;
 
+    // Set if the control block is run behind a flow cache.
+    EBPFFlowCachePSA *flowCache = nullptr;
+
     EBPFControlPSA(const EBPFProgram *program, const IR::ControlBlock *control,
                    const IR::Parameter *parserHeaders)
         : EBPFControl(program, control, parserHeaders) {}
@@ -16,10 +16,169 @@ limitations under the License.
 */
 #include "ebpfPsaDeparser.h"
 
+#include <set>
+
 #include "ebpfPipeline.h"
+#include "frontends/p4/methodInstance.h"
 
 namespace EBPF {
 
+namespace {
+
+// Collects writes to the fields of headers, which are members of a headers parameter.
+class HeaderFieldWrites : public Inspector, P4WriteContext {
+    cstring headersName;
+
+    bool isHeadersPath(const IR::Expression *expr) const {
+        auto path = expr->to<IR::PathExpression>();
+        return path != nullptr && path->path->name.name == headersName;
+    }
+
+ public:
+    // Number of writes to every field, keyed by the header and field names.
+    std::map<std::pair<cstring, cstring>, unsigned> fields;
+    // Headers, which are written as a whole or whose validity may change.
+    std::set<cstring> headers;
+    // Whether the whole headers parameter may be written.
+    bool all = false;
+
+    void countWrites(const IR::Node *node, cstring name) {
+        headersName = name;
+        node->apply(*this);
+    }
+
+    bool preorder(const IR::PathExpression *path) override {
+        if (isHeadersPath(path) && isWrite()) all = true;
+        return false;
+    }
+
+    bool preorder(const IR::Member *member) override {
+        if (isHeadersPath(member->expr)) {
+            if (isWrite()) headers.insert(member->member.name);
+            return false;
+        }
+        auto header = member->expr->to<IR::Member>();
+        if (header == nullptr || !isHeadersPath(header->expr)) return true;
+
+        if (member->member == IR::Type_Header::setValid ||
+            member->member == IR::Type_Header::setInvalid) {
+            headers.insert(header->member.name);
+        } else if (member->member != IR::Type_Header::isValid && isWrite()) {
+            fields[{header->member.name, member->member.name}]++;
+        }
+        return false;
+    }
+};
+
+// Finds "ck.clear(); ck.add(data); hdr.h.f = ck.get();" sequences of an InternetChecksum.
+class FindChecksumRecomputations : public Inspector {
+    P4::ReferenceMap *refMap;
+    P4::TypeMap *typeMap;
+
+    const P4::ExternMethod *checksumMethod(const IR::Expression *expr, cstring name) const {
+        auto call = expr->to<IR::MethodCallExpression>();
+        if (call == nullptr) return nullptr;
+        auto mi = P4::MethodInstance::resolve(call, refMap, typeMap);
+        auto method = mi->to<P4::ExternMethod>();
+        if (method == nullptr || method->originalExternType->name.name != "InternetChecksum" ||
+            method->method->name.name != name) {
+            return nullptr;
+        }
+        return method;
+    }
+
+ public:
+    struct Recomputation {
+        cstring instance;
+        const IR::MethodCallExpression *addCall;
+        const IR::Member *checksumField;
+    };
+    std::vector<Recomputation> found;
+
+    FindChecksumRecomputations(P4::ReferenceMap *refMap, P4::TypeMap *typeMap)
+        : refMap(refMap), typeMap(typeMap) {}
+
+    bool preorder(const IR::BlockStatement *block) override {
+        const auto &components = block->components;
+        for (size_t i = 0; i + 2 < components.size(); ++i) {
+            auto clear = components.at(i)->to<IR::MethodCallStatement>();
+            auto add = components.at(i + 1)->to<IR::MethodCallStatement>();
+            auto assign = components.at(i + 2)->to<IR::AssignmentStatement>();
+            if (clear == nullptr || add == nullptr || assign == nullptr) continue;
+            auto checksumField = assign->left->to<IR::Member>();
+            auto clearMethod = checksumMethod(clear->methodCall, "clear");
+            auto addMethod = checksumMethod(add->methodCall, "add");
+            auto getMethod = checksumMethod(assign->right, "get");
+            if (checksumField == nullptr || clearMethod == nullptr || addMethod == nullptr ||
+                getMethod == nullptr || clearMethod->object != addMethod->object ||
+                addMethod->object != getMethod->object) {
+                continue;
+            }
+            found.push_back({addMethod->object->getName().name, add->methodCall, checksumField});
+        }
+        return true;
+    }
+};
+
+// Returns true if @p call is "packet.extract(...)" of the packet of @p parser.
+bool isPacketExtract(const EBPFParser *parser, const IR::MethodCallExpression *call) {
+    auto program = parser->program;
+    auto mi = P4::MethodInstance::resolve(call, program->refMap, program->typeMap);
+    auto method = mi->to<P4::ExternMethod>();
+    return method != nullptr && method->object == parser->packet &&
+           method->method->name.name == P4::P4CoreLibrary::instance().packetIn.extract.name;
+}
+
+// Collects writes to headers in all the states of a parser, including writes in nested
+// statements. Extracts are skipped, as they leave the content of the packet in the header.
+class ParserHeaderWrites : public HeaderFieldWrites {
+    const EBPFParser *parser;
+
+ public:
+    using HeaderFieldWrites::preorder;
+
+    explicit ParserHeaderWrites(const EBPFParser *parser) : parser(parser) {
+        countWrites(parser->parserBlock->container, parser->headers->name);
+    }
+
+    bool preorder(const IR::MethodCallExpression *call) override {
+        return !isPacketExtract(parser, call);
+    }
+
+    // Whether the parser may write @p header, its validity or any of its fields.
+    bool writes(cstring header) const {
+        if (all || headers.count(header) != 0) return true;
+        for (const auto &field : fields) {
+            if (field.first.first == header) return true;
+        }
+        return false;
+    }
+};
+
+// Finds the headers extracted by a parser with "packet.extract(hdr.h)".
+class FindExtractedHeaders : public Inspector {
+    const EBPFParser *parser;
+
+ public:
+    std::set<cstring> headers;
+
+    explicit FindExtractedHeaders(const EBPFParser *parser) : parser(parser) {}
+
+    bool preorder(const IR::MethodCallExpression *call) override {
+        if (!isPacketExtract(parser, call) || call->arguments->size() != 1) return false;
+        auto program = parser->program;
+        auto header = call->arguments->at(0)->expression->to<IR::Member>();
+        auto path = header != nullptr ? header->expr->to<IR::PathExpression>() : nullptr;
+        if (path != nullptr && path->path->name.name == parser->headers->name.name &&
+            program->typeMap->getType(header, true)->is<IR::Type_Header>()) {
+            headers.insert(header->member.name);
+        }
+        return false;
+    }
+};
+
+}  // namespace
+
 DeparserBodyTranslatorPSA::DeparserBodyTranslatorPSA(const EBPFDeparserPSA *deparser)
     : CodeGenInspector(deparser->program->refMap, deparser->program->typeMap),
       DeparserBodyTranslator(deparser) {
@@ -43,6 +202,14 @@ void DeparserBodyTranslatorPSA::processMethod(const P4::ExternMethod *method) {
     auto methodName = method->method->getName().name;
     cstring externalName = EBPFObject::externalName(method->object);
 
+    if (externName == "InternetChecksum" && methodName == "add") {
+        if (auto update = dprs->getIncrementalChecksum(method->expr)) {
+            auto checksum = dprs->getChecksum(instance)->to<EBPFInternetChecksumPSA>();
+            checksum->emitIncrementalUpdate(builder, update, this);
+            return;
+        }
+    }
+
     if (externName == "Checksum" || externName == "InternetChecksum") {
         dprs->getChecksum(instance)->processMethod(builder, methodName, method->expr, this);
         return;
@@ -88,6 +255,147 @@ void EBPFDeparserPSA::emitDeclaration(CodeBuilder *builder, const IR::Declaratio
     EBPFDeparser::emitDeclaration(builder, decl);
 }
 
+void EBPFDeparserPSA::findIncrementalChecksums() {
+    auto pipeline = program->to<EBPFPipeline>();
+    HeaderFieldWrites writes;
+    writes.countWrites(pipeline->control->controlBlock->container,
+                       pipeline->control->headers->name);
+    writes.countWrites(controlBlock->container->body, headers->name);
+    if (writes.all) return;
+    // The old sums are computed after the parser, so a header written by the parser no longer
+    // matches the checksum of the received packet.
+    ParserHeaderWrites parserWrites(pipeline->parser);
+
+    FindChecksumRecomputations finder(program->refMap, program->typeMap);
+    controlBlock->container->body->apply(finder);
+
+    for (auto recomputation : finder.found) {
+        auto addCall = recomputation.addCall;
+        auto checksumField = recomputation.checksumField;
+        auto header = checksumField->expr->to<IR::Member>();
+        auto path = header != nullptr ? header->expr->to<IR::PathExpression>() : nullptr;
+        if (path == nullptr || path->path->name.name != headers->name.name ||
+            writes.headers.count(header->member.name) != 0 ||
+            parserWrites.writes(header->member.name)) {
+            continue;
+        }
+        // The old checksum is still in the header, unless it is written somewhere else.
+        if (writes.fields[{header->member.name, checksumField->member.name}] != 1) continue;
+
+        // Split the data into groups of fields starting and ending at a word boundary.
+        auto update = new IncrementalChecksumUpdate{addCall, checksumField, {}, nullptr};
+        EBPFHashAlgorithmPSA::ArgumentsList word;
+        bool dirty = false, supported = true;
+        unsigned bits = 0, fieldCount = 0, dirtyFieldCount = 0;
+        for (auto field : EBPFHashAlgorithmPSA::unpackArguments(addCall, 0)) {
+            auto member = field->to<IR::Member>();
+            auto type = field->type->to<IR::Type_Bits>();
+            if (member == nullptr || type == nullptr || !member->expr->equiv(*header) ||
+                member->member == checksumField->member) {
+                supported = false;
+                break;
+            }
+            word.push_back(field);
+            bits += type->width_bits();
+            dirty = dirty || writes.fields.count({header->member.name, member->member.name}) != 0;
+            ++fieldCount;
+            if (bits % 16 == 0) {
+                if (dirty) {
+                    dirtyFieldCount += word.size();
+                    update->dirtyWords.push_back(word);
+                }
+                word.clear();
+                dirty = false;
+            }
+        }
+        // Nothing to gain if all the words are written.
+        if (!supported || !word.empty() || dirtyFieldCount == fieldCount) continue;
+
+        update->oldSumVar = program->refMap->newName(recomputation.instance + "_old");
+        incrementalChecksums.push_back(update);
+    }
+}
+
+const IncrementalChecksumUpdate *EBPFDeparserPSA::getIncrementalChecksum(
+    const IR::MethodCallExpression *addCall) const {
+    for (auto update : incrementalChecksums) {
+        if (update->addCall == addCall) return update;
+    }
+    return nullptr;
+}
+
+void EBPFDeparserPSA::emitIncrementalChecksumVariables(CodeBuilder *builder) const {
+    for (auto update : incrementalChecksums) {
+        builder->emitIndent();
+        builder->appendFormat("u16 %s = 0", update->oldSumVar.c_str());
+        builder->endOfStatement(true);
+    }
+}
+
+void EBPFDeparserPSA::emitIncrementalChecksumSnapshots(CodeBuilder *builder) const {
+    codeGen->setBuilder(builder);
+    for (auto update : incrementalChecksums) {
+        InternetChecksumAlgorithm oldSum(program, update->oldSumVar);
+        oldSum.setVisitor(codeGen);
+        for (const auto &word : update->dirtyWords) {
+            oldSum.emitUpdateSum(builder, update->oldSumVar, word, false);
+        }
+    }
+}
+
+void EBPFDeparserPSA::findUnchangedHeaders() {
+    auto pipeline = program->to<EBPFPipeline>();
+    auto parser = pipeline->parser;
+    HeaderFieldWrites writes;
+    writes.countWrites(pipeline->control->controlBlock->container,
+                       pipeline->control->headers->name);
+    writes.countWrites(controlBlock->container->body, headers->name);
+    if (writes.all) return;
+    ParserHeaderWrites parserWrites(parser);
+
+    FindExtractedHeaders extracted(parser);
+    parser->parserBlock->container->apply(extracted);
+    for (auto header : extracted.headers) {
+        if (writes.headers.count(header) != 0 || parserWrites.writes(header)) continue;
+        bool written = false;
+        for (const auto &field : writes.fields) written = written || field.first.first == header;
+        if (written) continue;
+        parsedHeaderOffsets.emplace(header,
+                                    program->refMap->newName("parsed_" + header + "_offset"));
+    }
+}
+
+cstring EBPFDeparserPSA::getParsedHeaderOffset(cstring header) const {
+    auto it = parsedHeaderOffsets.find(header);
+    return it != parsedHeaderOffsets.end() ? it->second : nullptr;
+}
+
+void EBPFDeparserPSA::emitParsedHeaderOffsetVariables(CodeBuilder *builder) const {
+    for (auto it : parsedHeaderOffsets) {
+        builder->emitIndent();
+        builder->appendFormat("int %s = -1", it.second.c_str());
+        builder->endOfStatement(true);
+    }
+}
+
+cstring EBPFDeparserPSA::unchangedHeaderCondition(const IR::Expression *hdrExpr) const {
+    auto header = hdrExpr->to<IR::Member>();
+    auto path = header != nullptr ? header->expr->to<IR::PathExpression>() : nullptr;
+    if (path == nullptr || path->path->name.name != headers->name.name) return nullptr;
+    cstring parsedOffset = getParsedHeaderOffset(header->member.name);
+    if (parsedOffset.isNullOrEmpty()) return nullptr;
+
+    // bpf_xdp_adjust_head() moves the whole packet, while bpf_skb_adjust_room() inserts or
+    // removes bytes after the L2 header, so in TC a header is only known to stay in place
+    // if the packet is not resized.
+    if (program->is<XDPIngressPipeline>() || program->is<XDPEgressPipeline>()) {
+        return Util::printf_format("(int)%s == %s + %s * 8", program->offsetVar, parsedOffset,
+                                   outerHdrOffsetVar);
+    }
+    return Util::printf_format("%s == 0 && (int)%s == %s", outerHdrOffsetVar, program->offsetVar,
+                               parsedOffset);
+}
+
 // =====================IngressDeparserPSA=============================
 bool IngressDeparserPSA::build() {
     auto pl = controlBlock->container->type->applyParams;
@@ -195,6 +503,19 @@ void TCIngressDeparserForTrafficManagerPSA::emitPreDeparser(CodeBuilder *builder
 
 // =====================XDPIngressDeparserPSA=============================
 void XDPIngressDeparserPSA::emitPreDeparser(CodeBuilder *builder) {
+    if (program->options.xdpOnly) {
+        // clone, multicast and resubmit are rejected at compile time, and NTK packets are
+        // deparsed in XDP, so only drop is left to handle here.
+        builder->emitIndent();
+        builder->appendFormat("if (%s->drop) ", istd->name.name);
+        builder->blockStart();
+        builder->target->emitTraceMessage(builder, "PreDeparser: dropping packet..");
+        builder->emitIndent();
+        builder->appendFormat("return %s;\n", builder->target->abortReturnCode().c_str());
+        builder->blockEnd(true);
+        return;
+    }
+
     builder->emitIndent();
     // Perform early multicast detection; if multicast is invoked, a packet will be
     // passed up anyway, so we can do deparsing entirely in TC.
@@ -42,6 +42,11 @@ class EBPFDeparserPSA : public EBPFDeparser {
     const IR::Parameter *resubmit_meta;
     std::map<cstring, EBPFChecksumPSA *> checksums;
     std::map<cstring, EBPFDigestPSA *> digests;
+    // InternetChecksum recomputations, which are translated as incremental updates.
+    std::vector<IncrementalChecksumUpdate *> incrementalChecksums;
+    // Variables holding the parser offsets of headers, which are never modified, keyed by
+    // the header names.
+    std::map<cstring, cstring> parsedHeaderOffsets;
 
     EBPFDeparserPSA(const EBPFProgram *program, const IR::ControlBlock *control,
                     const IR::Parameter *parserHeaders, const IR::Parameter *istd)
@@ -53,6 +58,25 @@ class EBPFDeparserPSA : public EBPFDeparser {
     void emitDigestInstances(CodeBuilder *builder) const;
     void emitDeclaration(CodeBuilder *builder, const IR::Declaration *decl) override;
 
+    /* Finds the InternetChecksum recomputations, which can be updated incrementally,
+     * because the pipeline control and the deparser write only a few of their fields. */
+    void findIncrementalChecksums();
+    const IncrementalChecksumUpdate *getIncrementalChecksum(
+        const IR::MethodCallExpression *addCall) const;
+    /* Generates variables for the old sums; they are declared before the parser. */
+    void emitIncrementalChecksumVariables(CodeBuilder *builder) const;
+    /* Generates the sums of the old field values; called before the pipeline control. */
+    void emitIncrementalChecksumSnapshots(CodeBuilder *builder) const;
+
+    /* Finds the extracted headers, which are not modified by the parser, the pipeline control
+     * and the deparser, so that they need not be written if they are not moved. */
+    void findUnchangedHeaders();
+    /* Returns the variable holding the parser offset of an unmodified header, or nullptr. */
+    cstring getParsedHeaderOffset(cstring header) const;
+    /* Generates variables for the parser offsets; they are declared before the parser. */
+    void emitParsedHeaderOffsetVariables(CodeBuilder *builder) const;
+    cstring unchangedHeaderCondition(const IR::Expression *hdrExpr) const override;
+
     EBPFChecksumPSA *getChecksum(cstring name) const {
         auto result = ::get(checksums, name);
         BUG_CHECK(result != nullptr, "No checksum named %1%", name);
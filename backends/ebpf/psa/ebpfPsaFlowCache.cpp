@@ -0,0 +1,346 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#include "ebpfPsaFlowCache.h"
+
+#include "ebpfPsaControl.h"
+#include "frontends/p4/methodInstance.h"
+#include "lib/ordered_map.h"
+
+namespace EBPF {
+
+namespace {
+
+// Key and value of the cache are kept on the BPF stack, which is limited to 512 bytes.
+constexpr unsigned maxCacheEntryBytes = 256;
+
+// Collects the header and metadata fields used by a control block. If the result of the
+// control block is not a function of these fields and of its tables, reason tells why.
+class FlowCacheFields : public Inspector, P4WriteContext {
+    P4::ReferenceMap *refMap;
+    P4::TypeMap *typeMap;
+    std::set<const IR::IDeclaration *> params;
+
+    const IR::Parameter *rootParameter(const IR::Expression *expr) const {
+        while (auto member = expr->to<IR::Member>()) expr = member->expr;
+        auto path = expr->to<IR::PathExpression>();
+        if (path == nullptr) return nullptr;
+        auto decl = refMap->getDeclaration(path->path, false);
+        if (decl == nullptr || params.count(decl) == 0) return nullptr;
+        return decl->to<IR::Parameter>();
+    }
+
+    // Timestamps are the ingress_timestamp and egress_timestamp fields of the input metadata
+    // declared in psa.p4, a user-defined field may have the same name.
+    bool isTimestamp(const IR::Member *m) const {
+        auto type = typeMap->getType(m->expr, true)->to<IR::Type_Struct>();
+        if (type == nullptr) return false;
+        return (type->name == "psa_ingress_input_metadata_t" &&
+                m->member == "ingress_timestamp") ||
+               (type->name == "psa_egress_input_metadata_t" && m->member == "egress_timestamp");
+    }
+
+    void unsupported(cstring why) {
+        if (reason.isNullOrEmpty()) reason = why;
+    }
+
+    void addField(const IR::Expression *expr, const IR::Type *type, cstring name, bool written) {
+        auto it = fields.find(name);
+        if (it != fields.end()) {
+            it->second.written |= written;
+            return;
+        }
+        cstring cName = name.replace('.', '_');
+        fields.emplace(name, EBPFFlowCachePSA::Field{expr, type, cName, written});
+    }
+
+ public:
+    ordered_map<cstring, EBPFFlowCachePSA::Field> fields;
+    cstring reason;
+
+    explicit FlowCacheFields(const EBPFControlPSA *control)
+        : refMap(control->program->refMap), typeMap(control->program->typeMap) {
+        params.insert(control->headers);
+        params.insert(control->user_metadata);
+        params.insert(control->inputStandardMetadata);
+        params.insert(control->outputStandardMetadata);
+    }
+
+    bool preorder(const IR::Node *) override { return reason.isNullOrEmpty(); }
+
+    bool preorder(const IR::MethodCallExpression *mce) override {
+        auto mi = P4::MethodInstance::resolve(mce, refMap, typeMap);
+        if (auto bim = mi->to<P4::BuiltInMethod>()) {
+            if (rootParameter(bim->appliedTo) == nullptr) return true;
+            if (bim->name == IR::Type_Header::isValid) {
+                addField(mce, IR::Type_Boolean::get(), bim->appliedTo->toString() + ".isValid",
+                         false);
+            } else {
+                unsupported("it changes the validity of a header");
+            }
+            return false;
+        }
+        if (mi->is<P4::ExternMethod>() || mi->is<P4::ExternFunction>()) {
+            unsupported("it calls " + mce->method->toString());
+            return false;
+        }
+        return true;
+    }
+
+    bool preorder(const IR::Member *m) override {
+        if (rootParameter(m) == nullptr) return true;
+        if (isTimestamp(m)) {
+            unsupported("it reads a timestamp");
+            return false;
+        }
+        auto type = typeMap->getType(m, true);
+        if (type->is<IR::Type_Boolean>() ||
+            (type->is<IR::Type_Bits>() && type->width_bits() <= 64)) {
+            addField(m, type, m->toString(), isWrite());
+        } else {
+            unsupported(m->toString() + " is not a field of at most 64 bits");
+        }
+        return false;
+    }
+
+    bool preorder(const IR::PathExpression *path) override {
+        if (rootParameter(path) != nullptr) {
+            unsupported(path->toString() + " is used as a whole");
+        }
+        return false;
+    }
+
+    bool preorder(const IR::ArrayIndex *) override {
+        unsupported("it uses a header stack");
+        return false;
+    }
+
+    bool preorder(const IR::ExitStatement *) override {
+        unsupported("it contains an exit statement");
+        return false;
+    }
+
+    bool preorder(const IR::ReturnStatement *) override {
+        unsupported("it contains a return statement");
+        return false;
+    }
+};
+
+unsigned fieldBytes(const IR::Type *type) {
+    unsigned width = type->is<IR::Type_Boolean>() ? 8 : type->width_bits();
+    if (width <= 8) return 1;
+    if (width <= 16) return 2;
+    if (width <= 32) return 4;
+    return 8;
+}
+
+}  // namespace
+
+EBPFFlowCachePSA::EBPFFlowCachePSA(const EBPFControlPSA *control, std::vector<Field> fields)
+    : control(control), fields(std::move(fields)) {
+    cstring prefix = EBPFObject::externalName(control->controlBlock->container) + "_flow_cache";
+    keyTypeName = prefix + "_key";
+    valueTypeName = prefix + "_value";
+    generationTypeName = prefix + "_generation";
+    cacheMapName = prefix;
+    generationMapName = prefix + "_generation";
+}
+
+EBPFFlowCachePSA *EBPFFlowCachePSA::create(const EBPFControlPSA *control) {
+    auto name = control->controlBlock->container->name;
+    cstring reason;
+    if (control->tables.empty()) reason = "it has no tables";
+    for (auto it : control->tables) {
+        auto table = it.second->to<EBPFTablePSA>();
+        if (!table->counters.empty() || !table->meters.empty()) {
+            reason = "table " + it.first + " has direct extern(s)";
+        } else if (table->implementation != nullptr) {
+            reason = "table " + it.first + " has an implementation";
+        }
+    }
+
+    FlowCacheFields collector(control);
+    if (reason.isNullOrEmpty()) {
+        control->controlBlock->container->apply(collector);
+        reason = collector.reason;
+    }
+
+    std::vector<Field> fields;
+    unsigned bytes = 4 * control->tables.size(), writtenBytes = 0;
+    for (auto it : collector.fields) {
+        fields.push_back(it.second);
+        bytes += fieldBytes(it.second.type);
+        if (it.second.written) writtenBytes += fieldBytes(it.second.type);
+    }
+    bytes += writtenBytes;
+    if (reason.isNullOrEmpty() && writtenBytes == 0) reason = "it does not write any field";
+    if (reason.isNullOrEmpty() && bytes > maxCacheEntryBytes) {
+        reason = "its cache entry would take more than " + Util::toString(maxCacheEntryBytes) +
+                 " bytes";
+    }
+
+    if (!reason.isNullOrEmpty()) {
+        ::warning(ErrorType::WARN_UNSUPPORTED, "%1%: flow cache can't be enabled, because %2%",
+                  name, reason);
+        return nullptr;
+    }
+    return new EBPFFlowCachePSA(control, std::move(fields));
+}
+
+void EBPFFlowCachePSA::emitTypes(CodeBuilder *builder) const {
+    builder->emitIndent();
+    builder->appendFormat("struct %s ", generationTypeName.c_str());
+    builder->blockStart();
+    for (auto it : control->tables) {
+        builder->emitIndent();
+        builder->appendFormat("u32 %s", it.second->instanceName.c_str());
+        builder->endOfStatement(true);
+    }
+    builder->blockEnd(false);
+    builder->endOfStatement(true);
+    builder->newline();
+
+    builder->emitIndent();
+    builder->appendFormat("struct %s ", keyTypeName.c_str());
+    builder->blockStart();
+    for (auto &field : fields) {
+        builder->emitIndent();
+        EBPFTypeFactory::instance->create(field.type)->declare(builder, field.name, false);
+        builder->endOfStatement(true);
+    }
+    builder->blockEnd(false);
+    builder->endOfStatement(true);
+    builder->newline();
+
+    builder->emitIndent();
+    builder->appendFormat("struct %s ", valueTypeName.c_str());
+    builder->blockStart();
+    builder->emitIndent();
+    builder->appendFormat("struct %s generation", generationTypeName.c_str());
+    builder->endOfStatement(true);
+    for (auto &field : fields) {
+        if (!field.written) continue;
+        builder->emitIndent();
+        EBPFTypeFactory::instance->create(field.type)->declare(builder, field.name, false);
+        builder->endOfStatement(true);
+    }
+    builder->blockEnd(false);
+    builder->endOfStatement(true);
+    builder->newline();
+}
+
+void EBPFFlowCachePSA::emitInstance(CodeBuilder *builder) const {
+    builder->target->emitTableDecl(builder, cacheMapName, TableHashLRU, "struct " + keyTypeName,
+                                   "struct " + valueTypeName,
+                                   control->program->options.flowCacheSize);
+    builder->target->emitTableDecl(builder, generationMapName, TableArray, "u32",
+                                   "struct " + generationTypeName, 1);
+}
+
+void EBPFFlowCachePSA::emitField(CodeBuilder *builder, const Field &field) const {
+    control->codeGen->setBuilder(builder);
+    field.expr->apply(*control->codeGen);
+}
+
+void EBPFFlowCachePSA::emitLookup(CodeBuilder *builder) const {
+    builder->emitIndent();
+    builder->appendFormat("struct %s flow_cache_key", keyTypeName.c_str());
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->appendFormat("__builtin_memset((void *) &flow_cache_key, 0, sizeof(struct %s))",
+                          keyTypeName.c_str());
+    builder->endOfStatement(true);
+    for (auto &field : fields) {
+        builder->emitIndent();
+        builder->appendFormat("flow_cache_key.%s = ", field.name.c_str());
+        emitField(builder, field);
+        builder->endOfStatement(true);
+    }
+
+    builder->emitIndent();
+    builder->append("u32 flow_cache_generation_idx = 0");
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->appendFormat("struct %s *flow_cache_generation = ", generationTypeName.c_str());
+    builder->target->emitTableLookup(builder, generationMapName, "flow_cache_generation_idx", "");
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->appendFormat("struct %s *flow_cache_value = NULL", valueTypeName.c_str());
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->append("if (flow_cache_generation != NULL) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->target->emitTableLookup(builder, cacheMapName, "flow_cache_key", "flow_cache_value");
+    builder->endOfStatement(true);
+    builder->blockEnd(true);
+
+    // An entry is stale if any table of the control block has been modified since it was stored.
+    builder->emitIndent();
+    builder->append("if (flow_cache_generation != NULL && flow_cache_value != NULL");
+    for (auto it : control->tables) {
+        cstring table = it.second->instanceName;
+        builder->append(" &&");
+        builder->newline();
+        builder->emitIndent();
+        builder->appendFormat("    flow_cache_value->generation.%s == flow_cache_generation->%s",
+                              table.c_str(), table.c_str());
+    }
+    builder->append(") ");
+    builder->blockStart();
+    builder->target->emitTraceMessage(builder, "Control: flow cache hit, skipping control block");
+    for (auto &field : fields) {
+        if (!field.written) continue;
+        builder->emitIndent();
+        emitField(builder, field);
+        builder->appendFormat(" = flow_cache_value->%s", field.name.c_str());
+        builder->endOfStatement(true);
+    }
+    builder->blockEnd(false);
+    builder->append(" else ");
+    builder->blockStart();
+    builder->target->emitTraceMessage(builder, "Control: flow cache miss");
+
+    // Generations are read before the tables are looked up, so that an entry computed
+    // during a control plane update is stale right after the update.
+    builder->emitIndent();
+    builder->appendFormat("struct %s flow_cache_update = {0}", valueTypeName.c_str());
+    builder->endOfStatement(true);
+    builder->emitIndent();
+    builder->append("if (flow_cache_generation != NULL) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->append("flow_cache_update.generation = *flow_cache_generation");
+    builder->endOfStatement(true);
+    builder->blockEnd(true);
+}
+
+void EBPFFlowCachePSA::emitUpdate(CodeBuilder *builder) const {
+    for (auto &field : fields) {
+        if (!field.written) continue;
+        builder->emitIndent();
+        builder->appendFormat("flow_cache_update.%s = ", field.name.c_str());
+        emitField(builder, field);
+        builder->endOfStatement(true);
+    }
+    builder->emitIndent();
+    builder->append("if (flow_cache_generation != NULL) ");
+    builder->blockStart();
+    builder->emitIndent();
+    builder->target->emitTableUpdate(builder, cacheMapName, "flow_cache_key", "flow_cache_update");
+    builder->newline();
+    builder->blockEnd(true);
+    builder->blockEnd(true);
+}
+
+}  // namespace EBPF
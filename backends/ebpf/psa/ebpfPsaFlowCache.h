@@ -0,0 +1,72 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+#ifndef BACKENDS_EBPF_PSA_EBPFPSAFLOWCACHE_H_
+#define BACKENDS_EBPF_PSA_EBPFPSAFLOWCACHE_H_
+
+#include "backends/ebpf/codeGen.h"
+#include "backends/ebpf/ebpfObject.h"
+
+namespace EBPF {
+
+class EBPFControlPSA;
+
+/**
+ * Flow cache in front of a whole PSA control block. The output of a control block, which
+ * does not use externs, is a function of the fields it reads and of the content of its tables.
+ * The cache is an exact match LRU map, whose key holds every header and metadata field the
+ * control block reads or writes, and whose value holds the fields written by the control block.
+ * On a hit, the written fields are restored from the cache and the control block is skipped.
+ *
+ * Each table of the control block has a generation counter, which the control plane increments
+ * after every write to the table. A cache entry is valid only if the generations stored with
+ * it are equal to the current ones.
+ */
+class EBPFFlowCachePSA : public EBPFObject {
+ public:
+    struct Field {
+        const IR::Expression *expr;
+        const IR::Type *type;
+        cstring name;
+        bool written;
+    };
+
+ protected:
+    const EBPFControlPSA *control;
+    std::vector<Field> fields;
+
+    cstring keyTypeName;
+    cstring valueTypeName;
+    cstring generationTypeName;
+    cstring cacheMapName;
+    cstring generationMapName;
+
+    EBPFFlowCachePSA(const EBPFControlPSA *control, std::vector<Field> fields);
+
+    void emitField(CodeBuilder *builder, const Field &field) const;
+
+ public:
+    /// @returns nullptr with a warning if the control block cannot be cached.
+    static EBPFFlowCachePSA *create(const EBPFControlPSA *control);
+
+    void emitTypes(CodeBuilder *builder) const;
+    void emitInstance(CodeBuilder *builder) const;
+    /// Emits the cache lookup. The control block must be emitted after it, followed by
+    /// emitUpdate(), which closes the block opened for a cache miss.
+    void emitLookup(CodeBuilder *builder) const;
+    void emitUpdate(CodeBuilder *builder) const;
+};
+
+}  // namespace EBPF
+
+#endif /* BACKENDS_EBPF_PSA_EBPFPSAFLOWCACHE_H_ */
@@ -16,6 +16,8 @@ limitations under the License.
 */
 #include "ebpfPsaGen.h"
 
+#include <set>
+
 #include "ebpfPsaControl.h"
 #include "ebpfPsaDeparser.h"
 #include "ebpfPsaParser.h"
@@ -60,6 +62,37 @@ class PSAErrorCodesGen : public Inspector {
     }
 };
 
+// Reports writes to the fields of the output metadata, which make a packet leave the XDP-only
+// pipeline for the TC layer (clone, multicast and resubmit).
+class CheckXDPOnlySupport : public Inspector {
+    const IR::Parameter *ostd;
+    const std::set<cstring> unsupportedFields;
+
+ public:
+    CheckXDPOnlySupport(const IR::Parameter *ostd, std::set<cstring> unsupportedFields)
+        : ostd(ostd), unsupportedFields(std::move(unsupportedFields)) {}
+
+    bool preorder(const IR::AssignmentStatement *assign) override {
+        auto member = assign->left->to<IR::Member>();
+        if (member == nullptr || unsupportedFields.count(member->member.name) == 0) return false;
+        auto path = member->expr->to<IR::PathExpression>();
+        if (path == nullptr || path->path->name.name != ostd->name.name) return false;
+
+        // psa.p4 helpers reset these fields to defaults, e.g. send_to_port() clears multicast.
+        auto boolean = assign->right->to<IR::BoolLiteral>();
+        auto constant = assign->right->to<IR::Constant>();
+        if ((boolean != nullptr && !boolean->value) ||
+            (constant != nullptr && constant->value == 0)) {
+            return false;
+        }
+
+        ::error(ErrorType::ERR_UNSUPPORTED_ON_TARGET,
+                "%1%: setting %2% requires the TC layer and is not supported with --xdp-only",
+                assign, member);
+        return false;
+    }
+};
+
 // =====================PSAEbpfGenerator=============================
 void PSAEbpfGenerator::emitPSAIncludes(CodeBuilder *builder) const {
     builder->appendLine("#include <stdbool.h>");
@@ -617,6 +650,63 @@ void PSAArchXDP::emitDummyProgram(CodeBuilder *builder) const {
     builder->blockEnd(true);  // end of function
 }
 
+// =====================PSAArchXDPOnly=============================
+void PSAArchXDPOnly::emit(CodeBuilder *builder) const {
+    builder->target->emitIncludes(builder);
+    emitPSAIncludes(builder);
+
+    emitPreamble(builder);
+
+    emitInternalStructures(builder);
+    emitTypes(builder);
+    emitGlobalHeadersMetadata(builder);
+
+    emitInstances(builder);
+
+    emitHelperFunctions(builder);
+
+    emitInitializer(builder);
+
+    // egress is in-lined into the ingress program, so it has to be defined first.
+    if (!egress->isEmpty()) {
+        egress->emit(builder);
+    }
+
+    builder->newline();
+
+    ingress->emit(builder);
+
+    builder->target->emitLicense(builder, ingress->license);
+}
+
+void PSAArchXDPOnly::emitPreamble(CodeBuilder *builder) const {
+    PSAEbpfGenerator::emitPreamble(builder);
+    builder->appendFormat("#define DEVMAP_SIZE %u", PSAArchXDP::egressDevmapSize);
+    builder->newline();
+    builder->newline();
+}
+
+void PSAArchXDPOnly::emitInstances(CodeBuilder *builder) const {
+    builder->newline();
+
+    builder->appendLine("REGISTER_START()");
+    emitPacketReplicationTables(builder);
+    emitPipelineInstances(builder);
+
+    // Entries of tx_port only hold the output interface; no program is attached to them.
+    builder->target->emitTableDecl(builder, "tx_port", TableDevmap, "u32", "struct bpf_devmap_val",
+                                   PSAArchXDP::egressDevmapSize);
+
+    emitCRC32LookupTableInstance(builder);
+
+    builder->appendLine("REGISTER_END()");
+    builder->newline();
+}
+
+void PSAArchXDPOnly::emitInitializerSection(CodeBuilder *builder) const {
+    builder->appendLine("SEC(\"xdp/map-initializer\")");
+}
+
 // =====================ConvertToEbpfPSA=============================
 const PSAEbpfGenerator *ConvertToEbpfPSA::build(const IR::ToplevelBlock *tlb) {
     /*
@@ -702,6 +792,19 @@ const PSAEbpfGenerator *ConvertToEbpfPSA::build(const IR::ToplevelBlock *tlb) {
         auto xdpEgress = egress_pipeline_converter->getEbpfPipeline();
         BUG_CHECK(xdpEgress != nullptr, "Cannot create xdpEgress block.");
 
+        if (options.xdpOnly) {
+            xdpIngress->control->controlBlock->container->apply(
+                CheckXDPOnlySupport(xdpIngress->control->outputStandardMetadata,
+                                    {"clone", "resubmit", "multicast_group"}));
+            xdpEgress->control->controlBlock->container->apply(
+                CheckXDPOnlySupport(xdpEgress->control->outputStandardMetadata, {"clone"}));
+            if (!xdpEgress->isEmpty()) {
+                xdpIngress->to<XDPIngressPipeline>()->egressFunctionName =
+                    xdpEgress->functionName;
+            }
+            return new PSAArchXDPOnly(options, ebpfTypes, xdpIngress, xdpEgress);
+        }
+
         auto tc_trafficmanager_converter = new ConvertToEbpfPipeline(
             "tc-ingress", TC_TRAFFIC_MANAGER, options, ingressParser->to<IR::ParserBlock>(),
             ingressControl->to<IR::ControlBlock>(), ingressDeparser->to<IR::ControlBlock>(), refmap,
@@ -759,6 +862,9 @@ bool ConvertToEbpfPipeline::preorder(const IR::PackageBlock *block) {
     controlBlock->apply(*control_converter);
     pipeline->control = control_converter->getEBPFControl();
     CHECK_NULL(pipeline->control);
+    if (options.flowCacheSize > 0 && type != TC_TRAFFIC_MANAGER) {
+        pipeline->control->flowCache = EBPFFlowCachePSA::create(pipeline->control);
+    }
 
     auto deparser_converter = new ConvertToEBPFDeparserPSA(
         pipeline, pipeline->parser->headers, pipeline->control->outputStandardMetadata, type);
@@ -807,6 +913,7 @@ bool ConvertToEBPFParserPSA::preorder(const IR::ParserBlock *prsr) {
     auto ht = typemap->getType(parser->headers);
     if (ht == nullptr) return false;
     parser->headerType = EBPFTypeFactory::instance->create(ht);
+    parser->findStackLoops();
 
     parser->visitor->useAsPointerVariable(resubmit_meta->name.name);
     parser->visitor->useAsPointerVariable(parser->user_metadata->name.name);
@@ -963,6 +1070,14 @@ bool ConvertToEBPFDeparserPSA::preorder(const IR::ControlBlock *ctrl) {
 
     this->visit(ctrl->container);
 
+    // The traffic manager for XDP gets headers already processed by the ingress control.
+    if (program->options.incrementalChecksums && pipelineType != TC_TRAFFIC_MANAGER) {
+        deparser->findIncrementalChecksums();
+    }
+    if (program->options.optimizeDeparser && pipelineType != TC_TRAFFIC_MANAGER) {
+        deparser->findUnchangedHeaders();
+    }
+
     return false;
 }
 
@@ -104,6 +104,21 @@ class PSAArchXDP : public PSAEbpfGenerator {
     void emitDummyProgram(CodeBuilder *builder) const;
 };
 
+// In the XDP-only mode, the egress pipeline is an in-lined function called by the XDP ingress
+// program, which then forwards the packet with bpf_redirect_map(). No TC program is generated.
+class PSAArchXDPOnly : public PSAEbpfGenerator {
+ public:
+    PSAArchXDPOnly(const EbpfOptions &options, std::vector<EBPFType *> &ebpfTypes,
+                   EBPFPipeline *xdpIngress, EBPFPipeline *xdpEgress)
+        : PSAEbpfGenerator(options, ebpfTypes, xdpIngress, xdpEgress) {}
+
+    void emit(CodeBuilder *builder) const override;
+
+    void emitPreamble(CodeBuilder *builder) const override;
+    void emitInstances(CodeBuilder *builder) const override;
+    void emitInitializerSection(CodeBuilder *builder) const override;
+};
+
 class ConvertToEbpfPSA : public Transform {
     const EbpfOptions &options;
     P4::TypeMap *typemap;
@@ -35,6 +35,23 @@ void PsaStateTranslationVisitor::processMethod(const P4::ExternMethod *ext) {
     StateTranslationVisitor::processMethod(ext);
 }
 
+void PsaStateTranslationVisitor::compileExtract(const IR::Expression *destination) {
+    StateTranslationVisitor::compileExtract(destination);
+
+    // Remember where an unmodified header was found, so that the deparser can skip it.
+    auto header = destination->to<IR::Member>();
+    auto path = header != nullptr ? header->expr->to<IR::PathExpression>() : nullptr;
+    if (path == nullptr || path->path->name.name != parser->headers->name.name) return;
+    auto deparser = parser->program->to<EBPFPipeline>()->deparser;
+    cstring parsedOffset = deparser->getParsedHeaderOffset(header->member.name);
+    if (parsedOffset.isNullOrEmpty()) return;
+    auto type = parser->typeMap->getType(destination)->to<IR::Type_StructLike>();
+    builder->emitIndent();
+    builder->appendFormat("%s = %s - %d", parsedOffset.c_str(), parser->program->offsetVar.c_str(),
+                          type->width_bits());
+    builder->endOfStatement(true);
+}
+
 // =====================EBPFPsaParser=============================
 EBPFPsaParser::EBPFPsaParser(const EBPFProgram *program, const IR::ParserBlock *block,
                              const P4::TypeMap *typeMap)
@@ -35,6 +35,7 @@ class PsaStateTranslationVisitor : public StateTranslationVisitor {
         : StateTranslationVisitor(refMap, typeMap), parser(prsr) {}
 
     void processMethod(const P4::ExternMethod *ext) override;
+    void compileExtract(const IR::Expression *destination) override;
 };
 
 class EBPFPsaParser : public EBPFParser {
@@ -55,6 +56,11 @@ class EBPFPsaParser : public EBPFParser {
         BUG_CHECK(result != nullptr, "No checksum named %1%", name);
         return result;
     }
+
+ protected:
+    // A packet rejected with an error is still processed with the headers extracted so far,
+    // so every header must be checked separately.
+    bool canCoalesceBoundsChecks() const override { return false; }
 };
 
 }  // namespace EBPF
@@ -716,7 +716,18 @@ void EBPFTablePSA::emitTernaryConstEntriesInitializer(CodeBuilder *builder) {
     cstring valueMask = program->refMap->newName("value_mask");
     cstring nextMask = keyMasksNames[0];
     int noTupleId = -1;
-    emitValueMask(builder, valueMask, nextMask, noTupleId);
+    // The max_priority of the head marks the tuples up to last_ordered_mask as ordered by
+    // max_priority. It holds if every tuple has a non-zero max_priority, since the groups are
+    // sorted by priority.
+    bool ordered = std::all_of(
+        entriesGroupedByMask.begin(), entriesGroupedByMask.end(),
+        [](const EntriesGroup_t &group) { return group.front().priority != 0; });
+    emitValueMask(builder, valueMask, nextMask, noTupleId, ordered ? 1 : 0);
+    if (ordered) {
+        builder->emitIndent();
+        builder->appendFormat("%s.last_ordered_mask = %s", valueMask, keyMasksNames.back());
+        builder->endOfStatement(true);
+    }
     builder->newline();
 
     builder->emitIndent();
@@ -740,7 +751,8 @@ void EBPFTablePSA::emitTernaryConstEntriesInitializer(CodeBuilder *builder) {
         } else {
             nextMask = nullptr;
         }
-        emitValueMask(builder, valueMask, nextMask, tuple_id);
+        // Entries of a tuple are sorted by priority, so the first one has the highest.
+        emitValueMask(builder, valueMask, nextMask, tuple_id, sameMaskEntries.front().priority);
         builder->newline();
         emitKeysAndValues(builder, sameMaskEntries, keyNames, valueNames);
 
@@ -840,7 +852,8 @@ void EBPFTablePSA::emitKeyMasks(CodeBuilder *builder, EntriesGroupedByMask_t &en
 }
 
 void EBPFTablePSA::emitValueMask(CodeBuilder *builder, const cstring valueMask,
-                                 const cstring nextMask, int tupleId) const {
+                                 const cstring nextMask, int tupleId,
+                                 unsigned maxPriority) const {
     builder->emitIndent();
     builder->appendFormat("struct %s_mask %s = {0}", valueTypeName, valueMask);
     builder->endOfStatement(true);
@@ -849,6 +862,9 @@ void EBPFTablePSA::emitValueMask(CodeBuilder *builder, const cstring valueMask,
     builder->appendFormat("%s.tuple_id = %s", valueMask, cstring::to_cstring(tupleId));
     builder->endOfStatement(true);
     builder->emitIndent();
+    builder->appendFormat("%s.max_priority = %u", valueMask, maxPriority);
+    builder->endOfStatement(true);
+    builder->emitIndent();
     if (nextMask.isNullOrEmpty()) {
         builder->appendFormat("%s.has_next = 0", valueMask);
         builder->endOfStatement(true);
@@ -874,8 +890,9 @@ EBPFTablePSA::EntriesGroupedByMask_t EBPFTablePSA::getConstEntriesGroupedByMask(
     if (!entries) return result;
 
     // Group entries by the same mask, container will do deduplication for us. The order of
-    // entries will be changed but this is not a problem because of priority. Ebpf algorithm use
-    // TSS, so every mask have to be tested and there is no strict requirements on masks order.
+    // entries will be changed but this is not a problem because of priority. Masks are ordered
+    // by the highest priority of their entries, so that masks which cannot contain a better
+    // match are more likely to be skipped by the lookup.
     // Priority of entries is equal to P4 program order (first defined has the highest priority).
     EBPFTablePSATernaryTableMaskGenerator maskGenerator(program->refMap, program->typeMap);
     std::unordered_map<cstring, std::vector<ConstTernaryEntryDesc>> entriesGroupedByMask;
@@ -892,6 +909,9 @@ EBPFTablePSA::EntriesGroupedByMask_t EBPFTablePSA::getConstEntriesGroupedByMask(
     for (auto &vec : entriesGroupedByMask) {
         result.emplace_back(std::move(vec.second));
     }
+    std::sort(result.begin(), result.end(), [](const EntriesGroup_t &a, const EntriesGroup_t &b) {
+        return a.front().priority > b.front().priority;
+    });
     return result;
 }
 
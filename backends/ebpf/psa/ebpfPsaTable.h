@@ -61,7 +61,7 @@ class EBPFTablePSA : public EBPFTable {
     void emitTernaryConstEntriesInitializer(CodeBuilder *builder);
     void emitMapUpdateTraceMsg(CodeBuilder *builder, cstring mapName, cstring returnCode) const;
     void emitValueMask(CodeBuilder *builder, cstring valueMask, cstring nextMask,
-                       int tupleId) const;
+                       int tupleId, unsigned maxPriority) const;
     void emitKeyMasks(CodeBuilder *builder, EntriesGroupedByMask_t &entriesGroupedByMask,
                       std::vector<cstring> &keyMasksNames);
     void emitKeysAndValues(CodeBuilder *builder, EntriesGroup_t &sameMaskEntries,
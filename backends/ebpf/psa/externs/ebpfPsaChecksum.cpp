@@ -85,6 +85,16 @@ void EBPFInternetChecksumPSA::processMethod(CodeBuilder *builder, cstring method
     }
 }
 
+void EBPFInternetChecksumPSA::emitIncrementalUpdate(CodeBuilder *builder,
+                                                    const IncrementalChecksumUpdate *update,
+                                                    Visitor *visitor) {
+    auto algorithm = engine->to<InternetChecksumAlgorithm>();
+    CHECK_NULL(algorithm);
+    algorithm->setVisitor(visitor);
+    algorithm->emitIncrementalUpdate(builder, update->checksumField, update->oldSumVar,
+                                     update->dirtyWords);
+}
+
 void EBPFHashPSA::processMethod(CodeBuilder *builder, cstring method,
                                 const IR::MethodCallExpression *expr, Visitor *visitor) {
     engine->setVisitor(visitor);
@@ -44,6 +44,20 @@ class EBPFChecksumPSA : public EBPFObject {
                                const IR::MethodCallExpression *expr, Visitor *visitor);
 };
 
+/* A recomputation of an InternetChecksum from scratch in a deparser,
+ *     ck.clear(); ck.add({hdr.h.f1, ..., hdr.h.fn}); hdr.h.csum = ck.get();
+ * where the pipeline writes only some of the fields. The add() call is translated as an
+ * incremental update (RFC 1624) over the words holding the written fields, whose old values are
+ * summed up before the control block runs. */
+struct IncrementalChecksumUpdate {
+    const IR::MethodCallExpression *addCall;
+    const IR::Member *checksumField;
+    // Word-aligned groups of the added fields, which contain a written field.
+    std::vector<EBPFHashAlgorithmPSA::ArgumentsList> dirtyWords;
+    // Sum of the negated values of dirtyWords, taken before the control block.
+    cstring oldSumVar;
+};
+
 class EBPFInternetChecksumPSA : public EBPFChecksumPSA {
  public:
     EBPFInternetChecksumPSA(const EBPFProgram *program, const IR::Declaration_Instance *block,
@@ -53,6 +67,9 @@ class EBPFInternetChecksumPSA : public EBPFChecksumPSA {
 
     void processMethod(CodeBuilder *builder, cstring method, const IR::MethodCallExpression *expr,
                        Visitor *visitor) override;
+
+    void emitIncrementalUpdate(CodeBuilder *builder, const IncrementalChecksumUpdate *update,
+                               Visitor *visitor);
 };
 
 class EBPFHashPSA : public EBPFChecksumPSA {
@@ -82,6 +82,16 @@ EBPFCounterPSA::EBPFCounterPSA(const EBPFProgram *program, const IR::Declaration
     // TODO: add more advance logic to decide whether used map will be HASH_MAP or ARRAY_MAP
     isHash = false;
 
+    if (isDirect) {
+        // Direct counters are stored in the entries of their table.
+        if (di->getAnnotation(perCPUAnnotation) != nullptr) {
+            ::warning(ErrorType::WARN_UNSUPPORTED,
+                      "%1%: per-CPU DirectCounter is not supported, ignoring annotation", di);
+        }
+    } else {
+        setPerCPU(di);
+    }
+
     // check index type
     indexWidthType = nullptr;
     if (!isDirect) {
@@ -166,8 +176,7 @@ void EBPFCounterPSA::emitValueType(CodeBuilder *builder) {
 }
 
 void EBPFCounterPSA::emitInstance(CodeBuilder *builder) {
-    TableKind kind = isHash ? TableHash : TableArray;
-    builder->target->emitTableDecl(builder, dataMapName, kind, keyTypeName,
+    builder->target->emitTableDecl(builder, dataMapName, getTableKind(), keyTypeName,
                                    "struct " + valueTypeName, size);
 }
 
@@ -258,18 +267,13 @@ void EBPFCounterPSA::emitCounterUpdate(CodeBuilder *builder, const cstring targe
     }
 
     if (type == CounterType::BYTES || type == CounterType::PACKETS_AND_BYTES) {
-        builder->emitIndent();
-        builder->appendFormat("__sync_fetch_and_add(&(%sbytes), %s)", targetWAccess.c_str(),
-                              program->lengthVar);
-        builder->endOfStatement(true);
+        emitIncrement(builder, targetWAccess + "bytes", program->lengthVar);
 
         varStr = Util::printf_format("%sbytes", targetWAccess.c_str());
         builder->target->emitTraceMessage(builder, "Counter: now bytes=%u", 1, varStr.c_str());
     }
     if (type == CounterType::PACKETS || type == CounterType::PACKETS_AND_BYTES) {
-        builder->emitIndent();
-        builder->appendFormat("__sync_fetch_and_add(&(%spackets), 1)", targetWAccess.c_str());
-        builder->endOfStatement(true);
+        emitIncrement(builder, targetWAccess + "packets", "1");
 
         varStr = Util::printf_format("%spackets", targetWAccess.c_str());
         builder->target->emitTraceMessage(builder, "Counter: now packets=%u", 1, varStr.c_str());
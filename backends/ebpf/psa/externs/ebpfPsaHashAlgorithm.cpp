@@ -358,8 +358,8 @@ void CRC32ChecksumAlgorithm::emitGlobals(CodeBuilder *builder) {
 
 // ===========================InternetChecksumAlgorithm===========================
 
-void InternetChecksumAlgorithm::updateChecksum(CodeBuilder *builder, const ArgumentsList &arguments,
-                                               bool addData) {
+void InternetChecksumAlgorithm::emitUpdateSum(CodeBuilder *builder, cstring sumVar,
+                                              const ArgumentsList &arguments, bool addData) {
     cstring tmpVar = program->refMap->newName(baseName + "_tmp");
 
     builder->emitIndent();
@@ -409,11 +409,11 @@ void InternetChecksumAlgorithm::updateChecksum(CodeBuilder *builder, const Argum
                                                   tmpVar.c_str());
                 builder->emitIndent();
                 if (addData) {
-                    builder->appendFormat("%s = csum16_add(%s, %s)", stateVar.c_str(),
-                                          stateVar.c_str(), tmpVar.c_str());
+                    builder->appendFormat("%s = csum16_add(%s, %s)", sumVar.c_str(),
+                                          sumVar.c_str(), tmpVar.c_str());
                 } else {
-                    builder->appendFormat("%s = csum16_sub(%s, %s)", stateVar.c_str(),
-                                          stateVar.c_str(), tmpVar.c_str());
+                    builder->appendFormat("%s = csum16_sub(%s, %s)", sumVar.c_str(),
+                                          sumVar.c_str(), tmpVar.c_str());
                 }
                 builder->endOfStatement(true);
             }
@@ -454,11 +454,11 @@ void InternetChecksumAlgorithm::updateChecksum(CodeBuilder *builder, const Argum
                                                       tmpVar.c_str());
                     builder->emitIndent();
                     if (addData) {
-                        builder->appendFormat("%s = csum16_add(%s, %s)", stateVar.c_str(),
-                                              stateVar.c_str(), tmpVar.c_str());
+                        builder->appendFormat("%s = csum16_add(%s, %s)", sumVar.c_str(),
+                                              sumVar.c_str(), tmpVar.c_str());
                     } else {
-                        builder->appendFormat("%s = csum16_sub(%s, %s)", stateVar.c_str(),
-                                              stateVar.c_str(), tmpVar.c_str());
+                        builder->appendFormat("%s = csum16_sub(%s, %s)", sumVar.c_str(),
+                                              sumVar.c_str(), tmpVar.c_str());
                     }
                     builder->endOfStatement(true);
                 }
@@ -467,7 +467,7 @@ void InternetChecksumAlgorithm::updateChecksum(CodeBuilder *builder, const Argum
     }
 
     builder->target->emitTraceMessage(builder, "InternetChecksum: new state=0x%llx", 1,
-                                      stateVar.c_str());
+                                      sumVar.c_str());
     builder->blockEnd(true);
 }
 
@@ -499,7 +499,7 @@ void InternetChecksumAlgorithm::emitClear(CodeBuilder *builder) {
 }
 
 void InternetChecksumAlgorithm::emitAddData(CodeBuilder *builder, const ArgumentsList &arguments) {
-    updateChecksum(builder, arguments, true);
+    emitUpdateSum(builder, stateVar, arguments, true);
 }
 
 void InternetChecksumAlgorithm::emitGet(CodeBuilder *builder) {
@@ -508,7 +508,7 @@ void InternetChecksumAlgorithm::emitGet(CodeBuilder *builder) {
 
 void InternetChecksumAlgorithm::emitSubtractData(CodeBuilder *builder,
                                                  const ArgumentsList &arguments) {
-    updateChecksum(builder, arguments, false);
+    emitUpdateSum(builder, stateVar, arguments, false);
 }
 
 void InternetChecksumAlgorithm::emitGetInternalState(CodeBuilder *builder) {
@@ -527,4 +527,20 @@ void InternetChecksumAlgorithm::emitSetInternalState(CodeBuilder *builder,
     builder->endOfStatement(true);
 }
 
+void InternetChecksumAlgorithm::emitIncrementalUpdate(CodeBuilder *builder,
+                                                      const IR::Expression *oldChecksum,
+                                                      cstring oldSumVar,
+                                                      const std::vector<ArgumentsList> &words) {
+    // HC' = ~(~HC + ~m + m'), the state is the part in parentheses.
+    builder->emitIndent();
+    builder->appendFormat("%s = csum16_add((u16) ~(", stateVar.c_str());
+    visitor->visit(oldChecksum);
+    builder->appendFormat("), %s)", oldSumVar.c_str());
+    builder->endOfStatement(true);
+    builder->target->emitTraceMessage(builder, "InternetChecksum: incremental update");
+    for (const auto &word : words) {
+        emitUpdateSum(builder, stateVar, word, true);
+    }
+}
+
 }  // namespace EBPF
@@ -32,9 +32,9 @@ class EBPFHashAlgorithmPSA : public EBPFObject {
     const EBPFProgram *program;
     Visitor *visitor;
 
-    ArgumentsList unpackArguments(const IR::MethodCallExpression *expr, int dataPos);
-
  public:
+    static ArgumentsList unpackArguments(const IR::MethodCallExpression *expr, int dataPos);
+
     // keep this enum in sync with psa.p4 file
     enum HashAlgorithm {
         IDENTITY,
@@ -151,8 +151,6 @@ class InternetChecksumAlgorithm : public EBPFHashAlgorithmPSA {
  protected:
     cstring stateVar;
 
-    void updateChecksum(CodeBuilder *builder, const ArgumentsList &arguments, bool addData);
-
  public:
     InternetChecksumAlgorithm(const EBPFProgram *program, cstring name)
         : EBPFHashAlgorithmPSA(program, name) {}
@@ -171,6 +169,15 @@ class InternetChecksumAlgorithm : public EBPFHashAlgorithmPSA {
 
     void emitGetInternalState(CodeBuilder *builder) override;
     void emitSetInternalState(CodeBuilder *builder, const IR::MethodCallExpression *expr) override;
+
+    // Adds (or subtracts) 16-bit words made of arguments to the ones' complement sum in sumVar.
+    // The first argument must start a new word.
+    void emitUpdateSum(CodeBuilder *builder, cstring sumVar, const ArgumentsList &arguments,
+                       bool addData);
+    // Sets the state to the RFC 1624 (eqn. 3) update of oldChecksum, where oldSumVar holds the
+    // sum of the negated old values of the words, and words gives their current values.
+    void emitIncrementalUpdate(CodeBuilder *builder, const IR::Expression *oldChecksum,
+                               cstring oldSumVar, const std::vector<ArgumentsList> &words);
 };
 
 class EBPFHashAlgorithmTypeFactoryPSA {
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+""" Measures the datapath cost of a P4 program on the userspace runtimes.
+    For each target (p4c-ebpf test target, p4c-ubpf):
+   1. Compiles the p4 file and links it against the userspace runtime.
+   2. Generates the input packets and table entries from an stf file,
+      or takes the input packets from a pcap file.
+   3. Replays the packets through the program many times.
+   The results of all targets are written as a single JSON document with the
+   cycles and nanoseconds per packet, the lookups of each table, and the
+   memory used by the maps.
+"""
+
+import argparse
+import importlib
+import json
+import logging
+import math
+import os
+import shutil
+import sys
+import tempfile
+from glob import glob
+from pathlib import Path
+
+import scapy.utils as scapy_util
+
+FILE_DIR = Path(__file__).resolve().parent
+sys.path.append(str(FILE_DIR.joinpath("../../tools")))
+import testutils
+
+run_ebpf_test = importlib.import_module("run-ebpf-test")
+
+# The userspace targets and their runtime folders
+RUNTIME_DIRS = {
+    "test": FILE_DIR.joinpath("runtime"),
+    "ubpf": FILE_DIR.joinpath("../ubpf/runtime").resolve(),
+}
+
+PARSER = argparse.ArgumentParser()
+PARSER.add_argument("p4filename", help="the p4 file to benchmark")
+PARSER.add_argument(
+    "-c",
+    "--compiler",
+    dest="compiler",
+    default="p4c-ebpf",
+    help="Specify the path to the p4c-ebpf binary, p4c-ubpf is expected in the same folder",
+)
+PARSER.add_argument(
+    "-tf",
+    "--testfile",
+    dest="testfile",
+    help="stf file providing the table entries and, unless --pcap is given, the input packets",
+)
+PARSER.add_argument(
+    "-p",
+    "--pcap",
+    dest="pcap",
+    help="pcap file providing the input packets, all received on interface 0",
+)
+PARSER.add_argument(
+    "-t",
+    "--targets",
+    dest="targets",
+    default="test,ubpf",
+    help="Comma-separated list of targets to benchmark, default is test,ubpf",
+)
+PARSER.add_argument(
+    "-i",
+    "--iterations",
+    dest="iterations",
+    type=int,
+    default=0,
+    help="Number of times the packets are replayed, by default enough to process --packets packets",
+)
+PARSER.add_argument(
+    "-n",
+    "--packets",
+    dest="packets",
+    type=int,
+    default=1000000,
+    help="Minimum number of packets to process if --iterations is not given",
+)
+PARSER.add_argument(
+    "-e",
+    "--extern-file",
+    dest="extern",
+    default="",
+    help="Specify path additional file with C extern function definition",
+)
+PARSER.add_argument(
+    "-o",
+    "--output",
+    dest="output",
+    help="Write the JSON results to this file instead of stdout",
+)
+PARSER.add_argument(
+    "-b",
+    "--nocleanup",
+    action="store_false",
+    help="do not remove temporary files",
+)
+PARSER.add_argument(
+    "-ll",
+    "--log_level",
+    dest="log_level",
+    default="WARNING",
+    choices=["CRITICAL", "ERROR", "WARNING", "INFO", "DEBUG", "NOTSET"],
+    help="The log level to choose.",
+)
+
+
+def count_packets(ebpf):
+    """Counts the packets of all the input pcap files of a target."""
+    count = 0
+    for infile in glob(ebpf.filename("*", "in")):
+        if os.stat(infile).st_size > 0:
+            count += len(scapy_util.rdpcap(infile))
+    return count
+
+
+def benchmark_target(options, args, argv):
+    """Compiles and benchmarks the program on options.target.
+    Returns the results of the runtime, or None if a step failed."""
+    template = options.testdir + "/" + "test"
+    ebpf = run_ebpf_test.EBPFFactory.create(options.testdir, options, template)
+    if ebpf is None:
+        return None
+
+    result, expected_error = ebpf.compile_p4(argv)
+    if result != testutils.SUCCESS or expected_error:
+        testutils.log.error("The program cannot be benchmarked on target %s", options.target)
+        return None
+
+    testfile = options.testfile
+    if not testfile:
+        # Without an stf file, the program runs with empty tables
+        testfile = options.testdir + "/empty.stf"
+        Path(testfile).touch()
+    if ebpf.generate_model_inputs(testfile) != testutils.SUCCESS:
+        return None
+    if args.pcap:
+        for infile in glob(ebpf.filename("*", "in")):
+            os.remove(infile)
+        shutil.copyfile(args.pcap, ebpf.filename(0, "in"))
+
+    num_packets = count_packets(ebpf)
+    if num_packets == 0:
+        testutils.log.error("No input packets to benchmark")
+        return None
+    iterations = args.iterations
+    if iterations <= 0:
+        iterations = math.ceil(args.packets / num_packets)
+
+    if ebpf.compile_dataplane() != testutils.SUCCESS:
+        return None
+    json_file = options.testdir + "/benchmark.json"
+    if ebpf.benchmark(iterations, json_file) != testutils.SUCCESS:
+        return None
+    with open(json_file) as results:
+        return json.load(results)
+
+
+def run_benchmarks(args, argv):
+    if args.extern:
+        argv.append("--emit-externs")
+    report = {
+        "program": os.path.basename(args.p4filename),
+        "testfile": os.path.basename(args.testfile) if args.testfile else None,
+        "pcap": os.path.basename(args.pcap) if args.pcap else None,
+        "targets": {},
+    }
+    status = testutils.SUCCESS
+    for target in args.targets.split(","):
+        if target not in RUNTIME_DIRS:
+            testutils.log.error("Target %s has no userspace runtime", target)
+            status = testutils.FAILURE
+            continue
+        options = run_ebpf_test.Options()
+        options.compiler = testutils.check_if_file(args.compiler).as_posix()
+        options.p4filename = testutils.check_if_file(args.p4filename).as_posix()
+        if args.testfile:
+            options.testfile = testutils.check_if_file(args.testfile).as_posix()
+        options.target = target
+        options.extern = args.extern
+        options.runtimedir = str(RUNTIME_DIRS[target])
+        options.testdir = tempfile.mkdtemp(dir=os.path.abspath("./"))
+        os.chmod(options.testdir, 0o755)
+        results = benchmark_target(options, args, list(argv))
+        if results is None:
+            testutils.log.error("Benchmark failed, see %s", options.testdir)
+            status = testutils.FAILURE
+            continue
+        report["targets"][target] = results
+        if args.nocleanup:
+            testutils.del_dir(options.testdir)
+
+    output = json.dumps(report, indent=2)
+    if args.output:
+        with open(args.output, "w") as out:
+            out.write(output + "\n")
+    else:
+        print(output)
+    return status
+
+
+if __name__ == "__main__":
+    # Parse options and process argv
+    args, argv = PARSER.parse_known_args()
+    if args.pcap:
+        args.pcap = testutils.check_if_file(args.pcap).as_posix()
+    logging.basicConfig(
+        format="%(levelname)s:%(message)s",
+        level=getattr(logging, args.log_level),
+    )
+    # All args after '--' are intended for the p4 compiler
+    argv = argv[1:]
+    sys.exit(run_benchmarks(args, argv))
@@ -69,6 +69,14 @@ PARSER.add_argument(
     default="",
     help="Specify path additional file with C extern function definition",
 )
+PARSER.add_argument(
+    "-a",
+    dest="compiler_options",
+    default=[],
+    action="append",
+    nargs="?",
+    help="Pass this option string to the compiler",
+)
 PARSER.add_argument(
     "-tf",
     "--testfile",
@@ -227,6 +235,8 @@ if __name__ == "__main__":
 
     # All args after '--' are intended for the p4 compiler
     argv = argv[1:]
+    for option in args.compiler_options:
+        argv += option.split()
     # Run the test with the extracted options and modified argv
     result = run_test(options, argv)
     sys.exit(result)
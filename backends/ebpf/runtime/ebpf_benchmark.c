@@ -0,0 +1,86 @@
+/*
+Copyright 2018 VMware, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <stdio.h>
+#include "ebpf_benchmark.h"
+#include "ebpf_registry.h"
+
+static void reset_table_stats(struct bpf_table *tbl, void *ctx) {
+    tbl->lookups = 0;
+    tbl->hits = 0;
+}
+
+void benchmark_reset_table_stats(void) {
+    registry_iterate(reset_table_stats, NULL);
+}
+
+struct table_stats_ctx {
+    FILE *out;
+    uint64_t processed;
+    uint64_t memory_bytes;
+    int first;
+};
+
+static void write_table_stats(struct bpf_table *tbl, void *ctx) {
+    struct table_stats_ctx *stats = ctx;
+    uint64_t memory_bytes = bpf_map_memory_usage(tbl->bpf_map);
+    stats->memory_bytes += memory_bytes;
+    fprintf(stats->out, "%s\n    {\"name\": \"%s\", \"lookups\": %llu, \"hits\": %llu, "
+            "\"lookups_per_packet\": %.3f, \"entries\": %u, \"memory_bytes\": %llu}",
+            stats->first ? "" : ",", tbl->name, tbl->lookups, tbl->hits,
+            stats->processed ? (double) tbl->lookups / stats->processed : 0.0,
+            tbl->bpf_map ? tbl->bpf_map->count : 0, (unsigned long long) memory_bytes);
+    stats->first = 0;
+}
+
+int benchmark_write_json(const char *json_file, const struct benchmark_result *result) {
+    FILE *out = stdout;
+    if (json_file) {
+        out = fopen(json_file, "w");
+        if (out == NULL) {
+            perror("Error: Failed to open the benchmark output file");
+            return EXIT_FAILURE;
+        }
+    }
+    uint64_t processed = result->iterations * result->packets;
+    double elapsed_ns = result->elapsed_ns;
+    fprintf(out, "{\n  \"packets\": %u,\n  \"iterations\": %llu,\n", result->packets,
+            (unsigned long long) result->iterations);
+    fprintf(out, "  \"processed\": %llu,\n  \"passed\": %llu,\n",
+            (unsigned long long) processed, (unsigned long long) result->passed);
+    fprintf(out, "  \"elapsed_ns\": %llu,\n", (unsigned long long) result->elapsed_ns);
+    if (processed && result->elapsed_ns) {
+        fprintf(out, "  \"ns_per_packet\": %.3f,\n  \"packets_per_second\": %.0f,\n",
+                elapsed_ns / processed, processed * 1e9 / elapsed_ns);
+    } else {
+        fprintf(out, "  \"ns_per_packet\": null,\n  \"packets_per_second\": null,\n");
+    }
+    if (processed && BENCHMARK_HAS_CYCLES)
+        fprintf(out, "  \"cycles_per_packet\": %.3f,\n",
+                (double) result->elapsed_cycles / processed);
+    else
+        fprintf(out, "  \"cycles_per_packet\": null,\n");
+
+    struct table_stats_ctx stats = { out, processed, 0, 1 };
+    fprintf(out, "  \"tables\": [");
+    registry_iterate(write_table_stats, &stats);
+    fprintf(out, "%s],\n", stats.first ? "" : "\n  ");
+    fprintf(out, "  \"map_memory_bytes\": %llu\n}\n", (unsigned long long) stats.memory_bytes);
+
+    if (json_file)
+        fclose(out);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/*
+Copyright 2018 VMware, Inc.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+/*
+ * Helpers shared by the userspace runtimes to benchmark a program. The runtimes
+ * replay the input packets through the program, time the program calls, and
+ * report the results together with the per-table statistics of the registry
+ * as a JSON document.
+ */
+
+#ifndef BACKENDS_EBPF_RUNTIME_EBPF_BENCHMARK_H_
+#define BACKENDS_EBPF_RUNTIME_EBPF_BENCHMARK_H_
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCHMARK_HAS_CYCLES 1
+#else
+#define BENCHMARK_HAS_CYCLES 0
+#endif
+
+struct benchmark_result {
+    uint32_t packets;           // number of distinct input packets
+    uint64_t iterations;        // number of times the input was replayed
+    uint64_t passed;            // number of program calls which did not drop the packet
+    uint64_t elapsed_ns;        // time spent in the program
+    uint64_t elapsed_cycles;    // cycles spent in the program, 0 if unavailable
+};
+
+static inline uint64_t benchmark_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static inline uint64_t benchmark_cycles(void) {
+#if BENCHMARK_HAS_CYCLES
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Reset the lookup statistics of all the registered tables.
+ * @details Called before the benchmark loop, so that the control plane
+ * setup is not accounted.
+ */
+void benchmark_reset_table_stats(void);
+
+/**
+ * @brief Write the benchmark result as a JSON document.
+ * @details Besides the timing results, lists for each registered table
+ * the number of lookups and hits and the memory used by its map.
+ *
+ * @param json_file Name of the file to write, stdout if Null.
+ * @param result The benchmark result.
+ *
+ * @return EXIT_FAILURE if the file cannot be written.
+ */
+int benchmark_write_json(const char *json_file, const struct benchmark_result *result);
+
+#endif  // BACKENDS_EBPF_RUNTIME_EBPF_BENCHMARK_H_
@@ -43,6 +43,25 @@ limitations under the License.
 #define load_dword(data, b) bpf_be64_to_cpu(*(u64 *)((u8*)(data) + (b)))
 
 
+/*
+ * Bloom filters of the tuples of ternary tables (see --tuple-bloom-filters).
+ * The hash of a key is FNV-1a over the masked key, taken as 32-bit words.
+ * Every key sets two bits, derived from the hash by double hashing.
+ * NBITS must be a power of two.
+ */
+#define BPF_BLOOM_HASH_INIT 0x811c9dc5U
+#define BPF_BLOOM_HASH_STEP(hash, word) (((hash) ^ (word)) * 0x01000193U)
+#define BPF_BLOOM_BIT(hash, i, nbits) \
+    (((hash) + (i) * ((((hash) >> 16) | ((hash) << 16)) | 1U)) & ((nbits) - 1))
+#define BPF_BLOOM_TEST_BIT(bits, bit) (((bits)[(bit) / 64] >> ((bit) % 64)) & 1)
+#define BPF_BLOOM_TEST(bits, nbits, hash) \
+    (BPF_BLOOM_TEST_BIT(bits, BPF_BLOOM_BIT(hash, 0U, nbits)) && \
+     BPF_BLOOM_TEST_BIT(bits, BPF_BLOOM_BIT(hash, 1U, nbits)))
+#define BPF_BLOOM_ADD(bits, nbits, hash) do { \
+    (bits)[BPF_BLOOM_BIT(hash, 0U, nbits) / 64] |= 1ULL << (BPF_BLOOM_BIT(hash, 0U, nbits) % 64); \
+    (bits)[BPF_BLOOM_BIT(hash, 1U, nbits) / 64] |= 1ULL << (BPF_BLOOM_BIT(hash, 1U, nbits) % 64); \
+} while (0)
+
 /* If we operate in user space we only need to include bpf.h and
  * define the userspace API macros.
  * For kernel programs we need to specify a list of kernel helpers. These are
@@ -50,13 +69,255 @@ limitations under the License.
  */
 #ifdef CONTROL_PLANE // BEGIN EBPF USER SPACE DEFINITIONS
 
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 #include <bpf/bpf.h> // bpf_obj_get/pin, bpf_map_update_elem
+#include <bpf/libbpf.h> // libbpf_num_possible_cpus
 
 #define BPF_USER_MAP_UPDATE_ELEM(index, key, value, flags)\
     bpf_map_update_elem(index, key, value, flags)
 #define BPF_OBJ_PIN(table, name) bpf_obj_pin(table, name)
 #define BPF_OBJ_GET(name) bpf_obj_get(name)
 
+/*
+ * Computes the Bloom filter hash of a masked key of a ternary table.
+ * SIZE is the size of the key structure, which is a multiple of 4 bytes.
+ */
+static inline u32 bpf_user_bloom_hash(const void *key, size_t size) {
+    u32 hash = BPF_BLOOM_HASH_INIT;
+    for (size_t i = 0; i < size / 4; i++) {
+        u32 word;
+        memcpy(&word, (const unsigned char *)key + i * 4, sizeof(word));
+        hash = BPF_BLOOM_HASH_STEP(hash, word);
+    }
+    return hash;
+}
+
+/*
+ * Adds the masked key KEY to the Bloom filter of the tuple ID, stored in the
+ * <TBL-NAME>_tuples_bloom map FD, and enables the filter. Every entry of the
+ * tuple must be added, starting from the first one, since an enabled filter
+ * skips the keys it does not contain.
+ */
+#define BPF_USER_BLOOM_ADD_ENTRY(fd, id, key, bloom_type, nbits)\
+    bpf_user_bloom_add_entry(fd, id, key, sizeof(*(key)), sizeof(struct bloom_type),\
+                             offsetof(struct bloom_type, enabled), nbits)
+
+static inline int bpf_user_bloom_add_entry(int fd, u32 tuple_id, const void *key,
+                                           size_t key_size, size_t bloom_size,
+                                           size_t enabled_offset, u32 nbits) {
+    u64 *bloom = calloc(1, bloom_size);
+    if (bloom == NULL)
+        return -1;
+    int ret = bpf_map_lookup_elem(fd, &tuple_id, bloom);
+    if (ret == 0) {
+        u32 hash = bpf_user_bloom_hash(key, key_size);
+        BPF_BLOOM_ADD(bloom, nbits, hash);
+        ((unsigned char *)bloom)[enabled_offset] = 1;
+        ret = bpf_map_update_elem(fd, &tuple_id, bloom, BPF_ANY);
+    }
+    free(bloom);
+    return ret;
+}
+
+/*
+ * Keeps the tuples of a ternary table ordered by max_priority when an entry
+ * with PRIORITY is added to the tuple ID of MASK. FD is the
+ * <TBL-NAME>_prefixes map. A new mask is linked at its place in the list;
+ * the max_priority of an existing mask is raised and the mask is moved
+ * forward if needed. Finally, the head mask records the last of the ordered
+ * tuples at the front of the list, which lets lookups skip the remaining
+ * ones as soon as a tuple cannot contain a better match. Moving a mask is not
+ * atomic: lookups in progress may miss its tuple.
+ */
+#define BPF_USER_TERNARY_ADD_ENTRY(fd, mask, id, priority, value_mask_type)\
+    bpf_user_ternary_add_entry(fd, mask, sizeof(*(mask)), id, priority,\
+        &(const struct bpf_user_ternary_layout){\
+            sizeof(struct value_mask_type),\
+            offsetof(struct value_mask_type, tuple_id),\
+            offsetof(struct value_mask_type, next_tuple_mask),\
+            offsetof(struct value_mask_type, has_next),\
+            offsetof(struct value_mask_type, max_priority),\
+            offsetof(struct value_mask_type, last_ordered_mask)})
+
+struct bpf_user_ternary_layout {
+    size_t value_size;
+    size_t tuple_id;
+    size_t next_tuple_mask;
+    size_t has_next;
+    size_t max_priority;
+    size_t last_ordered_mask;
+};
+
+#define BPF_USER_TERNARY_FIELD(value, layout, field, type)\
+    (*(type *)((unsigned char *)(value) + (layout)->field))
+
+static inline int bpf_user_ternary_add_entry(int fd, const void *mask, size_t mask_size,
+                                             u32 tuple_id, u32 priority,
+                                             const struct bpf_user_ternary_layout *l) {
+    unsigned char *head = calloc(1, mask_size);
+    unsigned char *key = malloc(mask_size);
+    unsigned char *val = calloc(1, l->value_size);
+    unsigned char *cur = malloc(l->value_size);
+    unsigned char *nv = malloc(l->value_size);
+    u32 ordered = 0, last = (u32)-1, max_priority;
+    int ret = -1;
+    if (head == NULL || key == NULL || val == NULL || cur == NULL || nv == NULL)
+        goto out;
+
+    if (bpf_map_lookup_elem(fd, mask, val) == 0) {
+        if (BPF_USER_TERNARY_FIELD(val, l, max_priority, u32) >= priority) {
+            ret = 0;
+            goto out;
+        }
+        /* unlink the mask, it is linked again at its new place */
+        memcpy(key, head, mask_size);
+        for (;;) {
+            if (bpf_map_lookup_elem(fd, key, cur) != 0 ||
+                BPF_USER_TERNARY_FIELD(cur, l, has_next, u8) == 0)
+                goto out;
+            if (memcmp(cur + l->next_tuple_mask, mask, mask_size) == 0)
+                break;
+            memcpy(key, cur + l->next_tuple_mask, mask_size);
+        }
+        memcpy(cur + l->next_tuple_mask, val + l->next_tuple_mask, mask_size);
+        BPF_USER_TERNARY_FIELD(cur, l, has_next, u8) = BPF_USER_TERNARY_FIELD(val, l, has_next, u8);
+        if (bpf_map_update_elem(fd, key, cur, BPF_ANY) != 0)
+            goto out;
+    } else {
+        BPF_USER_TERNARY_FIELD(val, l, tuple_id, u32) = tuple_id;
+    }
+    BPF_USER_TERNARY_FIELD(val, l, max_priority, u32) = priority;
+
+    /* link the mask after the last tuple with at least its max_priority */
+    memcpy(key, head, mask_size);
+    if (bpf_map_lookup_elem(fd, key, cur) != 0)
+        goto out;
+    while (BPF_USER_TERNARY_FIELD(cur, l, has_next, u8) != 0) {
+        if (bpf_map_lookup_elem(fd, cur + l->next_tuple_mask, nv) != 0)
+            goto out;
+        if (BPF_USER_TERNARY_FIELD(nv, l, max_priority, u32) < priority)
+            break;
+        memcpy(key, cur + l->next_tuple_mask, mask_size);
+        memcpy(cur, nv, l->value_size);
+    }
+    memcpy(val + l->next_tuple_mask, cur + l->next_tuple_mask, mask_size);
+    BPF_USER_TERNARY_FIELD(val, l, has_next, u8) = BPF_USER_TERNARY_FIELD(cur, l, has_next, u8);
+    if (bpf_map_update_elem(fd, mask, val, BPF_ANY) != 0)
+        goto out;
+    memcpy(cur + l->next_tuple_mask, mask, mask_size);
+    BPF_USER_TERNARY_FIELD(cur, l, has_next, u8) = 1;
+    if (bpf_map_update_elem(fd, key, cur, BPF_ANY) != 0)
+        goto out;
+
+    /* find the last of the ordered tuples at the front of the list */
+    if (bpf_map_lookup_elem(fd, head, cur) != 0)
+        goto out;
+    memcpy(val, cur, l->value_size);
+    while (BPF_USER_TERNARY_FIELD(cur, l, has_next, u8) != 0) {
+        if (bpf_map_lookup_elem(fd, cur + l->next_tuple_mask, nv) != 0)
+            goto out;
+        max_priority = BPF_USER_TERNARY_FIELD(nv, l, max_priority, u32);
+        if (max_priority == 0 || max_priority > last)
+            break;
+        memcpy(val + l->last_ordered_mask, cur + l->next_tuple_mask, mask_size);
+        ordered = 1;
+        last = max_priority;
+        memcpy(cur, nv, l->value_size);
+    }
+    BPF_USER_TERNARY_FIELD(val, l, max_priority, u32) = ordered;
+    ret = bpf_map_update_elem(fd, head, val, BPF_ANY);
+
+out:
+    free(head);
+    free(key);
+    free(val);
+    free(cur);
+    free(nv);
+    return ret;
+}
+
+/*
+ * Invalidates the flow cache entries computed with the old content of TABLE
+ * (see --flow-cache), by incrementing its generation. FD is the
+ * <control>_flow_cache_generation map of the control block of the table and
+ * GENERATION_TYPE is the structure of its value. It must be called after
+ * every change to the table (insert, update, delete, default action).
+ */
+#define BPF_USER_FLOW_CACHE_TABLE_WRITTEN(fd, generation_type, table)\
+    bpf_user_flow_cache_bump_generation(fd, sizeof(struct generation_type),\
+                                        offsetof(struct generation_type, table))
+
+static inline int bpf_user_flow_cache_bump_generation(int fd, size_t size, size_t offset) {
+    u32 index = 0, generation;
+    unsigned char *value = calloc(1, size);
+    if (value == NULL)
+        return -1;
+    int ret = bpf_map_lookup_elem(fd, &index, value);
+    if (ret == 0) {
+        memcpy(&generation, value + offset, sizeof(generation));
+        generation++;
+        memcpy(value + offset, &generation, sizeof(generation));
+        ret = bpf_map_update_elem(fd, &index, value, BPF_ANY);
+    }
+    free(value);
+    return ret;
+}
+
+/*
+ * Reads a counter from a per-CPU map and sums the copies of all CPUs.
+ * The value of a counter is a sequence of unsigned fields of FIELD_SIZE bytes
+ * each (e.g., the bytes and packets of a PSA counter), which are summed
+ * separately. The kernel returns one copy per possible CPU, each padded to a
+ * multiple of 8 bytes.
+ */
+#define BPF_USER_MAP_LOOKUP_PERCPU_SUM(index, key, value, field_size)\
+    bpf_user_map_lookup_percpu_sum(index, key, value, sizeof(*(value)), field_size)
+
+static inline u64 bpf_user_load_field(const unsigned char *data, size_t field_size) {
+    u8 v8; u16 v16; u32 v32; u64 v64 = 0;
+    switch (field_size) {
+    case sizeof(u8): memcpy(&v8, data, sizeof(v8)); return v8;
+    case sizeof(u16): memcpy(&v16, data, sizeof(v16)); return v16;
+    case sizeof(u32): memcpy(&v32, data, sizeof(v32)); return v32;
+    default: memcpy(&v64, data, sizeof(v64)); return v64;
+    }
+}
+
+static inline void bpf_user_store_field(unsigned char *data, size_t field_size, u64 value) {
+    u8 v8 = value; u16 v16 = value; u32 v32 = value;
+    switch (field_size) {
+    case sizeof(u8): memcpy(data, &v8, sizeof(v8)); break;
+    case sizeof(u16): memcpy(data, &v16, sizeof(v16)); break;
+    case sizeof(u32): memcpy(data, &v32, sizeof(v32)); break;
+    default: memcpy(data, &value, sizeof(value)); break;
+    }
+}
+
+static inline int bpf_user_map_lookup_percpu_sum(int fd, const void *key, void *value,
+                                                 size_t value_size, size_t field_size) {
+    int num_cpus = libbpf_num_possible_cpus();
+    size_t stride = (value_size + 7) & ~(size_t)7;
+    if (num_cpus <= 0 || (field_size != sizeof(u8) && field_size != sizeof(u16) &&
+                          field_size != sizeof(u32) && field_size != sizeof(u64)))
+        return -1;
+    unsigned char *values = calloc(num_cpus, stride);
+    if (values == NULL)
+        return -1;
+    int ret = bpf_map_lookup_elem(fd, key, values);
+    if (ret == 0) {
+        for (size_t offset = 0; offset + field_size <= value_size; offset += field_size) {
+            u64 sum = 0;
+            for (int cpu = 0; cpu < num_cpus; cpu++)
+                sum += bpf_user_load_field(values + cpu * stride + offset, field_size);
+            bpf_user_store_field((unsigned char *)value + offset, field_size, sum);
+        }
+    }
+    free(values);
+    return ret;
+}
+
 #else // BEGIN EBPF KERNEL DEFINITIONS
 
 #include <linux/pkt_cls.h>  // TC_ACT_OK, TC_ACT_SHOT
@@ -16,6 +16,9 @@ limitations under the License.
 
 /*
 Implementation of userlevel eBPF map structure. Emulates the linux kernel bpf maps.
+The map is an open addressing hash table with linear probing. Deleted slots are
+marked and reused by later insertions, the table is rehashed when more than 3/4 of
+the slots are in use.
 */
 
 #include <assert.h>
@@ -28,6 +31,101 @@ enum bpf_flags {
     USER_BPF_EXIST  // only update existing element
 };
 
+#define SLOT_EMPTY 0
+#define SLOT_DELETED 1
+#define MIN_CAPACITY 16
+
+/* FNV-1a. Hashes of live slots never collide with the empty and deleted markers. */
+static uint64_t hash_key(const void *key, unsigned int key_size) {
+    const uint8_t *bytes = key;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (unsigned int i = 0; i < key_size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash < 2 ? hash + 2 : hash;
+}
+
+static void *slot_key(const struct bpf_map *map, uint32_t idx) {
+    return map->keys + (size_t) idx * map->key_size;
+}
+
+/* Returns the slot holding the key, or the slot where it should be inserted. */
+static uint32_t find_slot(const struct bpf_map *map, const void *key, uint64_t hash, int *found) {
+    uint32_t mask = map->capacity - 1;
+    uint32_t idx = (uint32_t) hash & mask;
+    uint32_t insert_idx = UINT32_MAX;
+    while (1) {
+        uint64_t slot_hash = map->hashes[idx];
+        if (slot_hash == SLOT_EMPTY) {
+            *found = 0;
+            return insert_idx != UINT32_MAX ? insert_idx : idx;
+        }
+        if (slot_hash == SLOT_DELETED) {
+            if (insert_idx == UINT32_MAX)
+                insert_idx = idx;
+        } else if (slot_hash == hash && memcmp(slot_key(map, idx), key, map->key_size) == 0) {
+            *found = 1;
+            return idx;
+        }
+        idx = (idx + 1) & mask;
+    }
+}
+
+static int allocate_slots(struct bpf_map *map, uint32_t capacity) {
+    map->hashes = calloc(capacity, sizeof(uint64_t));
+    map->values = calloc(capacity, sizeof(void *));
+    map->keys = malloc((size_t) capacity * map->key_size);
+    if (!map->hashes || !map->values || !map->keys) {
+        free(map->hashes);
+        free(map->values);
+        free(map->keys);
+        return EXIT_FAILURE;
+    }
+    map->capacity = capacity;
+    map->count = 0;
+    map->used = 0;
+    return EXIT_SUCCESS;
+}
+
+static struct bpf_map *allocate_map(unsigned int key_size, unsigned int value_size) {
+    struct bpf_map *map = calloc(1, sizeof(struct bpf_map));
+    if (!map)
+        return NULL;
+    map->key_size = key_size;
+    map->value_size = value_size;
+    if (allocate_slots(map, MIN_CAPACITY)) {
+        free(map);
+        return NULL;
+    }
+    return map;
+}
+
+/* Moves all entries to a new slot array. Values are not copied, only their pointers. */
+static int rehash(struct bpf_map *map, uint32_t capacity) {
+    struct bpf_map old = *map;
+    if (allocate_slots(map, capacity)) {
+        *map = old;
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < old.capacity; i++) {
+        uint64_t hash = old.hashes[i];
+        if (hash == SLOT_EMPTY || hash == SLOT_DELETED)
+            continue;
+        int found;
+        uint32_t idx = find_slot(map, slot_key(&old, i), hash, &found);
+        map->hashes[idx] = hash;
+        map->values[idx] = old.values[i];
+        memcpy(slot_key(map, idx), slot_key(&old, i), map->key_size);
+        map->count++;
+        map->used++;
+    }
+    free(old.hashes);
+    free(old.values);
+    free(old.keys);
+    return EXIT_SUCCESS;
+}
+
 static int check_flags(void *elem, unsigned long long map_flags) {
     if (map_flags > USER_BPF_EXIST)
         /* unknown flags */
@@ -42,50 +140,89 @@ static int check_flags(void *elem, unsigned long long map_flags) {
 }
 
 void *bpf_map_lookup_elem(struct bpf_map *map, void *key, unsigned int key_size) {
-    struct bpf_map *tmp_map;
-    HASH_FIND(hh, map, key, key_size, tmp_map);
-    if (tmp_map == NULL)
+    if (map == NULL)
+        return NULL;
+    int found;
+    uint32_t idx = find_slot(map, key, hash_key(key, key_size), &found);
+    if (!found)
         return NULL;
-    return tmp_map->value;
+    return map->values[idx];
 }
 
 int bpf_map_update_elem(struct bpf_map **map, void *key, unsigned int key_size, void *value, unsigned int value_size, unsigned long long flags) {
-    struct bpf_map *tmp_map;
-    HASH_FIND(hh, *map, key, key_size, tmp_map);
-    int ret = check_flags(tmp_map, flags);
+    if (*map == NULL) {
+        *map = allocate_map(key_size, value_size);
+        if (*map == NULL)
+            return EXIT_FAILURE;
+    }
+    struct bpf_map *tmp_map = *map;
+    uint64_t hash = hash_key(key, key_size);
+    int found;
+    uint32_t idx = find_slot(tmp_map, key, hash, &found);
+    int ret = check_flags(found ? tmp_map->values[idx] : NULL, flags);
     if (ret)
         return ret;
-    if (tmp_map == NULL) {
-        tmp_map = (struct bpf_map *) malloc(sizeof(struct bpf_map));
-        tmp_map->key = malloc(key_size);
-        memcpy(tmp_map->key, key, key_size);
-        HASH_ADD_KEYPTR(hh, *map, tmp_map->key, key_size, tmp_map);
+    if (found) {
+        /* Overwrite in place, so that pointers to the value remain valid */
+        memcpy(tmp_map->values[idx], value, value_size);
+        return EXIT_SUCCESS;
+    }
+    void *new_value = malloc(value_size);
+    if (new_value == NULL)
+        return EXIT_FAILURE;
+    memcpy(new_value, value, value_size);
+    /* Keep the load factor below 3/4. If most used slots are deleted ones, rehashing
+     * with the same capacity is enough to reclaim them. */
+    if ((uint64_t) (tmp_map->used + 1) * 4 > (uint64_t) tmp_map->capacity * 3) {
+        uint32_t capacity = tmp_map->capacity;
+        if ((uint64_t) (tmp_map->count + 1) * 2 > capacity)
+            capacity *= 2;
+        if (rehash(tmp_map, capacity)) {
+            free(new_value);
+            return EXIT_FAILURE;
+        }
+        idx = find_slot(tmp_map, key, hash, &found);
     }
-    tmp_map->value = malloc(value_size);
-    memcpy(tmp_map->value, value, value_size);
+    if (tmp_map->hashes[idx] == SLOT_EMPTY)
+        tmp_map->used++;
+    tmp_map->count++;
+    tmp_map->hashes[idx] = hash;
+    tmp_map->values[idx] = new_value;
+    memcpy(slot_key(tmp_map, idx), key, key_size);
     return EXIT_SUCCESS;
 }
 
 int bpf_map_delete_elem(struct bpf_map *map, void *key, unsigned int key_size) {
-    struct bpf_map *tmp_map;
-    HASH_FIND(hh, map, key, key_size, tmp_map);
-    if (tmp_map != NULL) {
-        HASH_DEL(map, tmp_map);
-        free(tmp_map->value);
-        free(tmp_map->key);
-        free(tmp_map);
+    if (map == NULL)
+        return EXIT_SUCCESS;
+    int found;
+    uint32_t idx = find_slot(map, key, hash_key(key, key_size), &found);
+    if (found) {
+        free(map->values[idx]);
+        map->values[idx] = NULL;
+        map->hashes[idx] = SLOT_DELETED;
+        map->count--;
     }
     return EXIT_SUCCESS;
 }
 
 int bpf_map_delete_map(struct bpf_map *map) {
-    struct bpf_map *curr_map, *tmp_map;
-    HASH_ITER(hh, map, curr_map, tmp_map) {
-        HASH_DEL(map, curr_map);
-        free(curr_map->value);
-        free(curr_map->key);
-        free(curr_map);
-    }
+    if (map == NULL)
+        return EXIT_SUCCESS;
+    for (uint32_t i = 0; i < map->capacity; i++)
+        if (map->hashes[i] != SLOT_EMPTY && map->hashes[i] != SLOT_DELETED)
+            free(map->values[i]);
+    free(map->hashes);
+    free(map->values);
+    free(map->keys);
     free(map);
     return EXIT_SUCCESS;
 }
+
+size_t bpf_map_memory_usage(const struct bpf_map *map) {
+    if (map == NULL)
+        return 0;
+    size_t slot_size = sizeof(uint64_t) + sizeof(void *) + map->key_size;
+    return sizeof(struct bpf_map) + (size_t) map->capacity * slot_size +
+           (size_t) map->count * map->value_size;
+}
@@ -17,24 +17,36 @@ limitations under the License.
 /*
  * This file defines a library of simple hashmap operations which emulate the behavior
  * of the kernel ebpf map API. This library is currently not thread-safe.
+ * Maps use open addressing with linear probing. Keys are stored inline in the slot
+ * array, values are allocated once per entry, so pointers returned by a lookup stay
+ * valid until the entry is deleted, as in the kernel.
  */
 
 #ifndef BACKENDS_EBPF_RUNTIME_EBPF_MAP_H_
 #define BACKENDS_EBPF_RUNTIME_EBPF_MAP_H_
 
-#include "contrib/uthash.h"  // exports string.h, stddef.h, and stdlib.h
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 
 struct bpf_map {
-    void *key;
-    void *value;
-    UT_hash_handle hh;  // makes this structure hashable
+    unsigned int key_size;
+    unsigned int value_size;
+    uint32_t capacity;  // number of slots, always a power of two
+    uint32_t count;     // number of entries
+    uint32_t used;      // number of entries and deleted slots
+    uint64_t *hashes;   // hash of the key in each slot, or an empty/deleted marker
+    void **values;      // value of each slot
+    uint8_t *keys;      // capacity * key_size bytes of keys
 };
 
 /**
  * @brief Add/Update a value in the map
  * @details Updates a value in the map based on the provided key.
  * If the key does not exist, it depends the provided flags if the
- * element is added or the operation is rejected.
+ * element is added or the operation is rejected. The map is allocated on
+ * the first update. An existing value is overwritten in place.
  *
  * @return EXIT_FAILURE if update operation fails
  */
@@ -67,5 +79,13 @@ int bpf_map_delete_elem(struct bpf_map *map, void *key, unsigned int key_size);
  */
 int bpf_map_delete_map(struct bpf_map *map);
 
+/**
+ * @brief Memory used by the map.
+ * @details Counts the map descriptor, the slot arrays and the values.
+ *
+ * @return Size in bytes, 0 if the map is not allocated.
+ */
+size_t bpf_map_memory_usage(const struct bpf_map *map);
+
 
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_MAP_H_
@@ -84,6 +84,7 @@ void registry_delete() {
     HASH_ITER(h_name, reg_tables_name, curr_tbl, tmp_tbl) {
         HASH_DELETE(h_name, reg_tables_name, curr_tbl);
         bpf_map_delete_map(curr_tbl->tbl->bpf_map);
+        curr_tbl->tbl->bpf_map = NULL;
         free(curr_tbl);
     }
     curr_tbl = NULL;
@@ -97,6 +98,7 @@ int registry_delete_tbl(const char *name) {
     registry_entry *tmp_reg = find_register(name);
     if (tmp_reg != NULL) {
         bpf_map_delete_map(tmp_reg->tbl->bpf_map);
+        tmp_reg->tbl->bpf_map = NULL;
         HASH_DELETE(h_name, reg_tables_name, tmp_reg);
         HASH_DELETE(h_id, reg_tables_id, tmp_reg);
         free(tmp_reg);
@@ -157,7 +159,11 @@ void *registry_lookup_table_elem(const char *name, void *key) {
     if (tmp_tbl == NULL)
         /* not found, return */
         return NULL;
-    return bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    tmp_tbl->lookups++;
+    void *value = bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    if (value != NULL)
+        tmp_tbl->hits++;
+    return value;
 }
 
 void *registry_lookup_table_elem_id(int tbl_id, void *key) {
@@ -165,7 +171,11 @@ void *registry_lookup_table_elem_id(int tbl_id, void *key) {
     if (tmp_tbl == NULL)
         /* not found, return */
         return NULL;
-    return bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    tmp_tbl->lookups++;
+    void *value = bpf_map_lookup_elem(tmp_tbl->bpf_map, key, tmp_tbl->key_size);
+    if (value != NULL)
+        tmp_tbl->hits++;
+    return value;
 }
 
 int registry_get_id(const char *name) {
@@ -174,3 +184,10 @@ int registry_get_id(const char *name) {
         return -1;
     return tmp_reg->handle;
 }
+
+void registry_iterate(registry_callback callback, void *ctx) {
+    registry_entry *curr_reg, *tmp_reg;
+    HASH_ITER(h_id, reg_tables_id, curr_reg, tmp_reg) {
+        callback(curr_reg->tbl, ctx);
+    }
+}
@@ -24,6 +24,7 @@ limitations under the License.
 #ifndef BACKENDS_EBPF_RUNTIME_EBPF_REGISTRY_H_
 #define BACKENDS_EBPF_RUNTIME_EBPF_REGISTRY_H_
 
+#include "contrib/uthash.h"  // exports string.h, stddef.h, and stdlib.h
 #include "ebpf_map.h"
 
 #define MAX_TABLE_NAME_LENGTH 256  // maximum length of the table name
@@ -33,7 +34,7 @@ limitations under the License.
  * @details This structure describes various properties of the ebpf table
  * such as key and value size and the maximum amount of entries possible.
  * In userspace, this space is theoretically unlimited.
- * This table definition points to an actual hashmap managed by uthash,
+ * This table definition points to an actual hashmap defined in ebpf_map.h,
  * the relation is many-to-one.
  * "name" should not exceed VAR_SIZE. Functions using bpf_table also assume
  * that "name" is a conventional null-terminated string.
@@ -45,6 +46,8 @@ struct bpf_table {
     unsigned int value_size;    // size of the value structure
     unsigned int max_entries;   // Maximum of possible entries
     struct bpf_map *bpf_map;    // Pointer to the actual hash map
+    unsigned long long lookups; // Number of lookups, reported by benchmarks
+    unsigned long long hits;    // Number of lookups which found an entry
 };
 
 /**
@@ -159,4 +162,12 @@ void *registry_lookup_table_elem(const char *name, void *key);
  */
 void *registry_lookup_table_elem_id(int tbl_id, void *key);
 
+typedef void (*registry_callback)(struct bpf_table *tbl, void *ctx);
+
+/**
+ * @brief Call a function for each table in the registry.
+ * @details Tables are visited in the order in which they were added.
+ */
+void registry_iterate(registry_callback callback, void *ctx);
+
 #endif  // BACKENDS_EBPF_RUNTIME_EBPF_REGISTRY_H_
@@ -31,6 +31,8 @@ void run_and_record_output(pcap_list_t *pkt_list, char *pcap_base, uint16_t num_
 
 #define RUN(ebpf_filter, pcap_base, num_pcaps, input_list, debug) \
     run_and_record_output(input_list, pcap_base, num_pcaps, debug)
+#define BENCHMARK(ebpf_filter, input_list, iterations, json_file) \
+    (fprintf(stderr, "Benchmarks are not supported by the kernel target\n"), EXIT_FAILURE)
 #define INIT_EBPF_TABLES(debug)
 #define DELETE_EBPF_TABLES(debug)
 
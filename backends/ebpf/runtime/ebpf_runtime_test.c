@@ -18,18 +18,23 @@ limitations under the License.
 #include <ctype.h>      // isprint()
 #include <string.h>     // memcpy()
 #include <stdlib.h>     // malloc()
+#include <time.h>       // clock_gettime()
 #include "ebpf_test.h"
+#include "ebpf_benchmark.h"
 #include "ebpf_runtime_test.h"
 
 #define PCAPOUT "_out.pcap"
+#define BATCH_SIZE 64
 
 /**
  * @brief Feed a list packets into an eBPF program.
  * @details This is a mock function emulating the behavior of a running
- * eBPF program. It takes a list of input packets and iteratively parses them
- * using the given imported ebpf_filter function. The output defines whether
- * or not the packet is "dropped." If the packet is not dropped, its content is
- * copied and appended to an output packet list.
+ * eBPF program. It takes a list of input packets and parses them in batches
+ * of BATCH_SIZE using the given imported ebpf_filter function. The output
+ * defines whether or not the packet is "dropped." If the packet is not
+ * dropped, it is appended to an output packet list. The output list shares
+ * the packets of the input list, which must outlive it. Only the filter
+ * calls are timed, the processing rate is printed at the end of the run.
  *
  * @param pkt_list A list of input packets running through the filter.
  * @return The list of packets "surviving" the filter function
@@ -37,21 +42,35 @@ limitations under the License.
 pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int debug) {
     pcap_list_t *output_pkts = allocate_pkt_list();
     uint32_t list_len = get_pkt_list_length(pkt_list);
-    for (uint32_t i = 0; i < list_len; i++) {
-        /* Parse each packet in the list and check the result */
-        struct sk_buff skb;
-        pcap_pkt *input_pkt = get_packet(pkt_list, i);
-        skb.data = (void *) input_pkt->data;
-        skb.len = input_pkt->pcap_hdr.len;
-        int result = ebpf_filter(&skb);
-        if (result != 0) {
-            /* We copy the entire content to emulate an outgoing packet */
-            pcap_pkt *out_pkt = copy_pkt(input_pkt);
-            output_pkts = append_packet(output_pkts, out_pkt);
+    struct sk_buff skbs[BATCH_SIZE];
+    int results[BATCH_SIZE];
+    uint64_t elapsed_ns = 0;
+    for (uint32_t start = 0; start < list_len; start += BATCH_SIZE) {
+        uint32_t batch_len = list_len - start < BATCH_SIZE ? list_len - start : BATCH_SIZE;
+        for (uint32_t i = 0; i < batch_len; i++) {
+            pcap_pkt *input_pkt = get_packet(pkt_list, start + i);
+            skbs[i].data = (void *) input_pkt->data;
+            skbs[i].len = input_pkt->pcap_hdr.len;
+            skbs[i].ifindex = input_pkt->ifindex;
+        }
+        /* Parse each packet in the batch and check the result */
+        struct timespec begin, end;
+        clock_gettime(CLOCK_MONOTONIC, &begin);
+        for (uint32_t i = 0; i < batch_len; i++)
+            results[i] = ebpf_filter(&skbs[i]);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed_ns += (uint64_t) (end.tv_sec - begin.tv_sec) * 1000000000ULL + end.tv_nsec - begin.tv_nsec;
+        for (uint32_t i = 0; i < batch_len; i++) {
+            if (results[i] != 0)
+                output_pkts = append_packet(output_pkts, get_packet(pkt_list, start + i));
+            if (debug)
+                printf("Result of the eBPF parsing is: %d\n", results[i]);
         }
-        if (debug)
-            printf("Result of the eBPF parsing is: %d\n", result);
     }
+    if (list_len > 0 && elapsed_ns > 0)
+        printf("Processed %u packets in %.3f ms: %.0f packets/s, %.1f ns/packet\n",
+               list_len, elapsed_ns / 1e6, list_len * 1e9 / elapsed_ns,
+               (double) elapsed_ns / list_len);
     return output_pkts;
 }
 
@@ -76,8 +95,35 @@ void *run_and_record_output(packet_filter ebpf_filter, const char *pcap_base, pc
     output_array = split_and_delete_list(output_pkts, output_array);
     /* Write each list to a separate pcap output file */
     write_pkts_to_pcaps(pcap_base, output_array, debug);
-    /* Delete the array, including the data it is holding */
-    delete_array(output_array);
+    /* Delete the array. The packets are still held by the input list. */
+    delete_array_keep_pkts(output_array);
+}
+
+int benchmark_filter(packet_filter ebpf_filter, pcap_list_t *pkt_list, uint64_t iterations, const char *json_file) {
+    uint32_t list_len = get_pkt_list_length(pkt_list);
+    struct benchmark_result result = { .packets = list_len, .iterations = iterations };
+    struct sk_buff skbs[BATCH_SIZE];
+    benchmark_reset_table_stats();
+    /* Programs of the test target do not write to the packet, so the same
+       packet data can be replayed without restoring it. */
+    for (uint64_t it = 0; it < iterations; it++) {
+        for (uint32_t start = 0; start < list_len; start += BATCH_SIZE) {
+            uint32_t batch_len = list_len - start < BATCH_SIZE ? list_len - start : BATCH_SIZE;
+            for (uint32_t i = 0; i < batch_len; i++) {
+                pcap_pkt *input_pkt = get_packet(pkt_list, start + i);
+                skbs[i].data = (void *) input_pkt->data;
+                skbs[i].len = input_pkt->pcap_hdr.len;
+                skbs[i].ifindex = input_pkt->ifindex;
+            }
+            uint64_t begin_ns = benchmark_ns();
+            uint64_t begin_cycles = benchmark_cycles();
+            for (uint32_t i = 0; i < batch_len; i++)
+                result.passed += ebpf_filter(&skbs[i]) != 0;
+            result.elapsed_cycles += benchmark_cycles() - begin_cycles;
+            result.elapsed_ns += benchmark_ns() - begin_ns;
+        }
+    }
+    return benchmark_write_json(json_file, &result);
 }
 
 void init_ebpf_tables(int debug) {
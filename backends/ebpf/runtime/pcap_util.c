@@ -16,16 +16,52 @@ limitations under the License.
 
 #include <stdlib.h>     // EXIT_SUCCESS, EXIT_FAILURE
 #include <string.h>     // memcpy()
+#include <fcntl.h>      // open()
+#include <unistd.h>     // close(), ftruncate()
+#include <sys/mman.h>   // mmap()
+#include <sys/stat.h>   // fstat()
 #include "pcap_util.h"
 
 #define DLT_EN10MB 1        // Ethernet Link Type, see also 'man pcap-linktype'
 
+/* Native byte order magic numbers of the classic pcap format */
+#define PCAP_MAGIC_USEC 0xa1b2c3d4
+#define PCAP_MAGIC_NSEC 0xa1b23c4d
+
+/* On-disk headers of the classic pcap format, see 'man pcap-savefile' */
+struct pcap_file_hdr {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t linktype;
+};
+
+struct pcap_record_hdr {
+    uint32_t ts_sec;
+    uint32_t ts_frac;
+    uint32_t caplen;
+    uint32_t len;
+};
+
+/* A capture file mapped to memory. It owns the packet descriptors pointing
+   into it and is released when the last of them is deleted.
+ */
+struct pcap_mapping {
+    void *addr;
+    size_t size;
+    pcap_pkt *pkts;
+    uint32_t refs;
+};
 
 /* Dynamically-allocated list of packets.
  */
 struct pcap_list {
     pcap_pkt **pkts;
     uint32_t len;
+    uint32_t capacity;
 };
 
 /* An array of lists of packets */
@@ -38,14 +74,16 @@ pcap_list_t *append_packet(pcap_list_t *pkt_list, pcap_pkt *pkt) {
     if (!pkt_list)
         /* If the list is not allocated yet, create it */
         pkt_list = allocate_pkt_list();
-    pkt_list->len++;
-    pkt_list->pkts = realloc(pkt_list->pkts, pkt_list->len * sizeof(pcap_pkt *));
-    if (pkt_list->pkts == NULL) {
-        fprintf(stderr, "Fatal: Failed to expand the"
-            "packet list with size %u !\n", pkt_list->len);
-        exit(EXIT_FAILURE);
+    if (pkt_list->len == pkt_list->capacity) {
+        pkt_list->capacity = pkt_list->capacity ? pkt_list->capacity * 2 : 64;
+        pkt_list->pkts = realloc(pkt_list->pkts, pkt_list->capacity * sizeof(pcap_pkt *));
+        if (pkt_list->pkts == NULL) {
+            fprintf(stderr, "Fatal: Failed to expand the"
+                "packet list with size %u !\n", pkt_list->capacity);
+            exit(EXIT_FAILURE);
+        }
     }
-    pkt_list->pkts[pkt_list->len - 1] = pkt;
+    pkt_list->pkts[pkt_list->len++] = pkt;
     return pkt_list;
 }
 
@@ -105,8 +143,20 @@ pcap_list_array_t *allocate_pkt_list_array() {
     return pkt_list_arr;
 }
 
+static void release_mapping(struct pcap_mapping *mapping) {
+    if (--mapping->refs > 0)
+        return;
+    munmap(mapping->addr, mapping->size);
+    free(mapping->pkts);
+    free(mapping);
+}
+
 void delete_list(pcap_list_t *pkt_list) {
     for(uint32_t i = 0; i < pkt_list->len; i++) {
+        if (pkt_list->pkts[i]->mapping) {
+            release_mapping(pkt_list->pkts[i]->mapping);
+            continue;
+        }
         free(pkt_list->pkts[i]->data);
         /* Set the data pointer to NULL, to mitigate duplicate frees */
         pkt_list->pkts[i]->data = NULL;
@@ -124,7 +174,103 @@ void delete_array(pcap_list_array_t *pkt_list_array) {
     free(pkt_list_array);
 }
 
+void delete_array_keep_pkts(pcap_list_array_t *pkt_list_array) {
+    for(uint32_t i = 0; i < pkt_list_array->len; i++)
+        if (pkt_list_array->lists[i]) {
+            free(pkt_list_array->lists[i]->pkts);
+            free(pkt_list_array->lists[i]);
+        }
+    free(pkt_list_array->lists);
+    free(pkt_list_array);
+}
+
+/* Checks that the mapped file is a classic pcap file in native byte order whose
+   packets are not truncated, and returns the number of packets in it, or -1. */
+static int64_t count_mapped_pkts(const uint8_t *addr, size_t size) {
+    if (size < sizeof(struct pcap_file_hdr))
+        return -1;
+    const struct pcap_file_hdr *file_hdr = (const struct pcap_file_hdr *) addr;
+    if (file_hdr->magic != PCAP_MAGIC_USEC && file_hdr->magic != PCAP_MAGIC_NSEC)
+        return -1;
+    int64_t num_pkts = 0;
+    size_t offset = sizeof(struct pcap_file_hdr);
+    while (offset < size) {
+        struct pcap_record_hdr rec;
+        if (size - offset < sizeof(rec))
+            return -1;
+        memcpy(&rec, addr + offset, sizeof(rec));
+        offset += sizeof(rec);
+        if (rec.caplen != rec.len || size - offset < rec.caplen)
+            return -1;
+        offset += rec.caplen;
+        num_pkts++;
+    }
+    return num_pkts;
+}
+
+static pcap_list_t *map_pkts_from_pcap(const char *pcap_file_name, iface_index index) {
+    int fd = open(pcap_file_name, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    size_t size = st.st_size;
+    /* A private writable mapping lets programs modify packets without copying them */
+    uint8_t *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        return NULL;
+    int64_t num_pkts = count_mapped_pkts(addr, size);
+    if (num_pkts < 0) {
+        munmap(addr, size);
+        return NULL;
+    }
+    madvise(addr, size, MADV_SEQUENTIAL);
+
+    pcap_list_t *pkt_list = allocate_pkt_list();
+    if (num_pkts == 0) {
+        munmap(addr, size);
+        return pkt_list;
+    }
+    struct pcap_mapping *mapping = calloc(1, sizeof(struct pcap_mapping));
+    mapping->addr = addr;
+    mapping->size = size;
+    mapping->pkts = calloc(num_pkts, sizeof(pcap_pkt));
+    mapping->refs = num_pkts;
+    pkt_list->pkts = malloc(num_pkts * sizeof(pcap_pkt *));
+    if (mapping->pkts == NULL || pkt_list->pkts == NULL) {
+        fprintf(stderr, "Fatal: Failed to allocate %ld packets!\n", (long) num_pkts);
+        exit(EXIT_FAILURE);
+    }
+    pkt_list->capacity = num_pkts;
+
+    uint32_t nsec = ((const struct pcap_file_hdr *) addr)->magic == PCAP_MAGIC_NSEC;
+    size_t offset = sizeof(struct pcap_file_hdr);
+    for (int64_t i = 0; i < num_pkts; i++) {
+        struct pcap_record_hdr rec;
+        memcpy(&rec, addr + offset, sizeof(rec));
+        offset += sizeof(rec);
+        pcap_pkt *pkt = &mapping->pkts[i];
+        pkt->data = (char *) addr + offset;
+        pkt->pcap_hdr.ts.tv_sec = rec.ts_sec;
+        pkt->pcap_hdr.ts.tv_usec = nsec ? rec.ts_frac / 1000 : rec.ts_frac;
+        pkt->pcap_hdr.caplen = rec.caplen;
+        pkt->pcap_hdr.len = rec.len;
+        pkt->ifindex = index;
+        pkt->mapping = mapping;
+        pkt_list->pkts[pkt_list->len++] = pkt;
+        offset += rec.caplen;
+    }
+    return pkt_list;
+}
+
 pcap_list_t *read_pkts_from_pcap(const char *pcap_file_name, iface_index index) {
+    pcap_list_t *mapped_list = map_pkts_from_pcap(pcap_file_name, index);
+    if (mapped_list != NULL)
+        return mapped_list;
     struct pcap_pkthdr *pcap_hdr;
     const unsigned char *tmp_pkt;
     char errbuf[PCAP_ERRBUF_SIZE];
@@ -155,25 +301,48 @@ pcap_list_t *read_pkts_from_pcap(const char *pcap_file_name, iface_index index)
 }
 
 int write_pkts_to_pcap(const char *pcap_file_name, const pcap_list_t *list) {
-    pcap_t *in_handle;
-    pcap_dumper_t *out_handle;
-    in_handle = pcap_open_dead(DLT_EN10MB, UINT16_MAX);
-    if (in_handle == NULL) {
-        fprintf(stderr, "Error: Failed to open pcap file!\n");
+    size_t size = sizeof(struct pcap_file_hdr);
+    for (uint32_t i = 0; i < list->len; i++)
+        size += sizeof(struct pcap_record_hdr) + list->pkts[i]->pcap_hdr.caplen;
+    int fd = open(pcap_file_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        perror("Error: Failed to create pcap output file");
         return EXIT_FAILURE;
     }
-    /* Open pcap output file and store its pointer in the handles */
-    out_handle = pcap_dump_open(in_handle, pcap_file_name);
-    if (out_handle == NULL) {
-        pcap_perror(in_handle, "Error: Failed to create pcap output file ");
-        pcap_close(in_handle);
+    if (ftruncate(fd, size) < 0) {
+        perror("Error: Failed to resize pcap output file");
+        close(fd);
         return EXIT_FAILURE;
     }
-    for (uint32_t i = 0; i < list->len; i++)
-        pcap_dump((unsigned char *)out_handle,
-         &list->pkts[i]->pcap_hdr, list->pkts[i]->data);
-    pcap_close(in_handle);
-    pcap_dump_close(out_handle);
+    uint8_t *addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) {
+        perror("Error: Failed to map pcap output file");
+        return EXIT_FAILURE;
+    }
+    struct pcap_file_hdr file_hdr = {
+        .magic = PCAP_MAGIC_USEC,
+        .version_major = PCAP_VERSION_MAJOR,
+        .version_minor = PCAP_VERSION_MINOR,
+        .snaplen = UINT16_MAX,
+        .linktype = DLT_EN10MB,
+    };
+    memcpy(addr, &file_hdr, sizeof(file_hdr));
+    size_t offset = sizeof(file_hdr);
+    for (uint32_t i = 0; i < list->len; i++) {
+        const pcap_pkt *pkt = list->pkts[i];
+        struct pcap_record_hdr rec = {
+            .ts_sec = pkt->pcap_hdr.ts.tv_sec,
+            .ts_frac = pkt->pcap_hdr.ts.tv_usec,
+            .caplen = pkt->pcap_hdr.caplen,
+            .len = pkt->pcap_hdr.len,
+        };
+        memcpy(addr + offset, &rec, sizeof(rec));
+        offset += sizeof(rec);
+        memcpy(addr + offset, pkt->data, rec.caplen);
+        offset += rec.caplen;
+    }
+    munmap(addr, size);
     return EXIT_SUCCESS;
 }
 
@@ -226,6 +395,7 @@ pcap_pkt *copy_pkt(pcap_pkt *src_pkt) {
     memcpy(new_pkt->data, src_pkt->data, datalen);
     new_pkt->pcap_hdr = src_pkt->pcap_hdr;
     new_pkt->ifindex = src_pkt->ifindex;
+    new_pkt->mapping = NULL;
     return new_pkt;
 }
 
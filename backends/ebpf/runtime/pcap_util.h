@@ -29,14 +29,19 @@ limitations under the License.
 /* Interfaces are named by integers */
 typedef uint16_t iface_index;
 
+/* A memory-mapped capture file, see read_pkts_from_pcap() */
+struct pcap_mapping;
+
 /* A network packet.
    Contains packet content, timestamp and the interface where
-   the packet has been received/sent.
+   the packet has been received/sent. If mapping is set, the data points into
+   a memory-mapped capture file and the packet is owned by the mapping.
  */
 typedef struct {
     char *data;
     struct pcap_pkthdr pcap_hdr;
     iface_index ifindex;
+    struct pcap_mapping *mapping;
 } pcap_pkt;
 
 struct pcap_list;
@@ -48,10 +53,13 @@ typedef struct pcap_list_array pcap_list_array_t;
  * @brief Retrieve packets from a pcap file.
  * @details Retrieves a list of packets from a given pcap file.
  * Allocates a packet list and fills it with the packets from the
- * supplied pcap file. All data in the capture file is copied to the new list.
+ * supplied pcap file. The file is memory-mapped and packets point directly
+ * into the mapping, which is private, so packets may be modified in place.
+ * Files that cannot be mapped (e.g., pcapng or byte-swapped captures) are read
+ * with libpcap and their data is copied to the new list.
  * Each packet is assigned the given interface index as meta-information.
  * A list allocated by this function should subsequently be freed by
- * delete_list().
+ * delete_list(). The mapping is released with the last of its packets.
  *
  * @param pcap_file_name The exact name of the pcap file.
  * @param index Interface index of the file.
@@ -63,7 +71,8 @@ pcap_list_t *read_pkts_from_pcap(const char *pcap_file_name, iface_index index);
 
 /**
  * @brief Write a list of packets to a pcap file.
- * @details Iteratively dumps the packets to the given filename.
+ * @details Sizes the file for all the packets, maps it to memory and copies
+ * the packets into it.
  *
  * @param pcap_file_name Exact name of the file to create and write to.
  * @param pkt_list List of packets to write.
@@ -100,8 +109,8 @@ pcap_list_array_t *split_and_delete_list(pcap_list_t *input_list, pcap_list_arra
 /**
  * @brief Appends a  packet to a given list of packets.
  * @details This function takes a pointer to a packet and appends it to the
- * given list. If the list is Null, it is allocated. For each new packet
- * to append, the list is expanded by the size of the packet pointer.
+ * given list. If the list is Null, it is allocated. The list grows
+ * geometrically, so appending is amortized constant time.
  *
  * @param pkt_list List descriptor. Can be Null
  * @param pkt Pointer of the packet to append.
@@ -205,6 +214,14 @@ void delete_list(pcap_list_t *pkt_list);
  */
 void delete_array(pcap_list_array_t *pkt_list_array);
 
+/**
+ * @brief Erases a list array and the lists in the array, but not the packets.
+ * @details Used for lists which hold packets owned by another list.
+ *
+ * @param pkt_list_array A list array.
+ */
+void delete_array_keep_pkts(pcap_list_array_t *pkt_list_array);
+
 /**
  * @brief Sort a list in place.
  * @details Sorts a given list by the timestamp of the packets contained in it.
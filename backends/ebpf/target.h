@@ -34,7 +34,8 @@ enum TableKind {
     TableProgArray,
     TableLPMTrie,  // longest prefix match trie
     TableHashLRU,
-    TableDevmap
+    TableDevmap,
+    TablePerCPUHash
 };
 
 class Target {
@@ -133,6 +134,8 @@ class KernelSamplesTarget : public Target {
             return "BPF_MAP_TYPE_ARRAY";
         } else if (kind == TablePerCPUArray) {
             return "BPF_MAP_TYPE_PERCPU_ARRAY";
+        } else if (kind == TablePerCPUHash) {
+            return "BPF_MAP_TYPE_PERCPU_HASH";
         } else if (kind == TableLPMTrie) {
             return "BPF_MAP_TYPE_LPM_TRIE";
         } else if (kind == TableHashLRU) {
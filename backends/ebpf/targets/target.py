@@ -169,6 +169,24 @@ class EBPFTarget:
         """Runs the filter and feeds attached interfaces with packets"""
         raise NotImplementedError("Method run() not implemented!")
 
+    def benchmark(self, iterations, json_file):
+        """Replays the input packets through the filter the given number of
+        times and writes the results to a JSON file. Only supported by the
+        userspace targets."""
+        testutils.log.info("Benchmarking model")
+        direction = "in"
+        pcap_pattern = self.filename("", direction)
+        num_files = len(glob(self.filename("*", direction)))
+        args = f"{self.template} "
+        args += f"-f {pcap_pattern} "
+        args += f"-n {num_files} "
+        args += f"-b {iterations} "
+        args += f"-j {json_file}"
+        result = testutils.exec_process(args)
+        if result.returncode != testutils.SUCCESS:
+            testutils.log.error("Failed to benchmark the filter")
+        return result.returncode
+
     def check_outputs(self):
         """Checks if the output of the filter matches expectations"""
         testutils.log.info("Comparing outputs")
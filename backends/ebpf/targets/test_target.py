@@ -40,6 +40,7 @@ class Target(EBPFTarget):
         # these files are specific to the test target
         args += f"SOURCES+={ self.runtimedir}/ebpf_registry.c "
         args += f"SOURCES+={ self.runtimedir}/ebpf_map.c "
+        args += f"SOURCES+={self.runtimedir}/ebpf_benchmark.c "
         args += f"SOURCES+={self.template}.c "
         # include the src of libbpf directly, does not require installation
         args += f"INCLUDES+=-I{self.runtimedir}/contrib/libbpf/src "
@@ -67,6 +67,34 @@ class InternetChecksumPSATest(P4EbpfTest):
             testutils.verify_packet_any_port(self, pkt, PTF_PORTS)
 
 
+class IncrementalChecksumPSATest(P4EbpfTest):
+    """
+    Test the IPv4 checksum with --incremental-checksums.
+    1. Generate IP packet with random values in header.
+    2. Both pipelines decrement TTL. Ingress parser sets the identification, so the ingress
+     deparser recomputes the checksum fully, while egress updates it incrementally.
+    """
+
+    p4_file_path = "p4testdata/incremental-checksum.p4"
+    p4c_additional_args = "--incremental-checksums"
+
+    def random_ip(self):
+        return ".".join(str(random.randint(0, 255)) for _ in range(4))
+
+    def runTest(self):
+        pkt = testutils.simple_ip_packet(
+            ip_src=self.random_ip(),
+            ip_dst=self.random_ip(),
+            ip_ttl=random.randint(3, 255),
+            ip_id=random.randint(0, 0xFFFF),
+        )
+        testutils.send_packet(self, PORT0, pkt)
+        pkt[IP].ttl = pkt[IP].ttl - 2
+        pkt[IP].id = 0x1234
+        pkt[IP].chksum = None
+        testutils.verify_packet(self, pkt, PORT1)
+
+
 @xdp2tc_head_not_supported
 class HashCRC16PSATest(P4EbpfTest):
     p4_file_path = "p4testdata/hash-crc16.p4"
@@ -239,6 +239,36 @@ class P4EbpfTest(BaseTest):
                 )
             )
 
+    def read_percpu_map(self, name, key):
+        """Returns the value of every CPU of a per-CPU map entry, as bytes."""
+        cmd = "bpftool -j map lookup pinned {}/{} key {}".format(
+            PIPELINE_MAPS_MOUNT_PATH, name, key
+        )
+        _, stdout, _ = self.exec_ns_cmd(cmd, "Failed to read map {}".format(name))
+        return [bytes(int(v, 0) for v in cpu["value"]) for cpu in json.loads(stdout)["values"]]
+
+    def percpu_counter_verify(self, name, index, width, bytes=None, packets=None):
+        """
+        Verify a per-CPU counter, whose value is the sum of the values of all CPUs. The value
+        of a CPU is a `bytes` field followed by a `packets` field, or only one of them. Each
+        field is `width` bytes wide.
+        """
+        key = "hex " + " ".join(format(b, "02x") for b in index.to_bytes(4, "little"))
+        expected_values = {"bytes": bytes, "packets": packets}
+        fields = [field for field, value in expected_values.items() if value is not None]
+        totals = dict.fromkeys(fields, 0)
+        for value in self.read_percpu_map(name, key):
+            for idx, field in enumerate(fields):
+                totals[field] += int.from_bytes(value[idx * width : (idx + 1) * width], "little")
+        for field in fields:
+            expected = expected_values[field]
+            if totals[field] != expected:
+                self.fail(
+                    "Invalid per-CPU counter {} of {}, expected {}, got {}".format(
+                        field, name, expected, totals[field]
+                    )
+                )
+
     def xdp2tc_mode(self):
         return testutils.test_param_get("xdp2tc")
 
@@ -40,6 +40,25 @@ class SimpleForwardingPSATest(P4EbpfTest):
         testutils.verify_packet(self, pkt, PORT2)
 
 
+class XDPOnlyRecirculatePortPSATest(P4EbpfTest):
+    """
+    Recirculation is not supported with --xdp-only. A packet sent to the recirculation port
+    by a runtime action parameter must be dropped, not redirected to another port.
+    """
+
+    p4_file_path = "p4testdata/simple-fwd.p4"
+    p4c_additional_args = "--xdp-only"
+
+    def runTest(self):
+        pkt = testutils.simple_ip_packet()
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+        # PSA_PORT_RECIRCULATE in psa.p4
+        self.table_set_default(table="ingress_tbl_fwd", action=1, data=[0xFFFFFFFA])
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_no_other_packets(self)
+
+
 class PSAResubmitTest(P4EbpfTest):
     p4_file_path = "p4testdata/resubmit.p4"
 
@@ -69,6 +88,16 @@ class SimpleTunnelingPSATest(P4EbpfTest):
         testutils.verify_packet(self, pkt, PORT1)
 
 
+class OptimizedDeparserTunnelingPSATest(SimpleTunnelingPSATest):
+    """
+    Test tunneling in the same way as in the base class, but with the deparser skipping unmodified
+    headers and writing byte-aligned fields with wide stores. The IP header is moved to an offset
+    that is not aligned to 4 bytes, so its 4-byte addresses are written with unaligned stores.
+    """
+
+    p4c_additional_args = "--optimize-deparser"
+
+
 class PSACloneI2E(P4EbpfTest):
     p4_file_path = "p4testdata/clone-i2e.p4"
 
@@ -433,6 +462,27 @@ class CountersPSATest(P4EbpfTest):
         self.counter_verify(name="ingress_action_cnt", key=[DP_PORTS[1]], bytes=299, packets=2)
 
 
+class PerCPUCountersPSATest(P4EbpfTest):
+    """
+    Test counters annotated with @per_cpu. They are stored in per-CPU maps, and the value of
+    a counter is the sum of the values of all CPUs.
+    """
+
+    p4_file_path = "p4testdata/counters-per-cpu.p4"
+
+    def runTest(self):
+        for pktlen in [100, 150]:
+            pkt = testutils.simple_ip_packet(
+                eth_dst="00:11:22:33:44:55", eth_src="00:AA:00:00:00:01", pktlen=pktlen
+            )
+            testutils.send_packet(self, PORT0, pkt)
+            testutils.verify_packet(self, pkt, PORT1)
+
+        self.percpu_counter_verify(name="ingress_pcpu_cnt", index=1, width=4, bytes=250, packets=2)
+        self.percpu_counter_verify(name="ingress_pcpu_bytes_cnt", index=1, width=8, bytes=250)
+        self.counter_verify(name="ingress_shared_cnt", key=[1], bytes=250, packets=2)
+
+
 class DirectCountersPSATest(P4EbpfTest):
     p4_file_path = "p4testdata/direct-counters.p4"
 
@@ -720,6 +770,76 @@ class ConstEntryTernaryPSATest(P4EbpfTest):
         testutils.verify_packet(self, pkt, PORT1)
 
 
+class ConstEntryTernaryRuntimeEntryPSATest(P4EbpfTest):
+    """
+    Const entries set max_priority of their tuples, which are ordered by it, while an entry
+    added at runtime is stored in a tuple with max_priority 0 appended to the list. Ordered
+    tuples whose entries cannot beat the best match must not stop the lookup before the
+    runtime tuple is examined.
+    """
+
+    p4_file_path = "p4testdata/const-entry-ternary-runtime.p4"
+
+    def runTest(self):
+        pkt = testutils.simple_ip_packet(ip_dst="10.0.0.1")
+
+        # via the first const entry (priority 3), the second one (priority 2) is skipped
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT1)
+
+        # runtime entry in a new tuple, with a higher priority than the const entries
+        self.table_add(
+            table="ingress_tbl_ternary",
+            key=["10.0.0.0^0xffff0000"],
+            action=1,
+            data=[DP_PORTS[2]],
+            priority=10,
+        )
+        testutils.send_packet(self, PORT0, pkt)
+        testutils.verify_packet(self, pkt, PORT2)
+
+
+class FlowCachePSATest(P4EbpfTest):
+    """
+    Test the flow cache of a control block. Packets of a cached flow must be forwarded
+    like the first one, until the generation of the table is incremented after a write.
+    """
+
+    p4_file_path = "p4testdata/flow-cache.p4"
+    p4c_additional_args = "--flow-cache 64"
+
+    def runTest(self):
+        pkt1 = testutils.simple_ip_packet(ip_dst="10.0.0.1")
+        pkt2 = testutils.simple_ip_packet(ip_dst="10.0.0.2")
+        for _ in range(2):
+            testutils.send_packet(self, PORT0, pkt1)
+            testutils.verify_packet(self, pkt1, PORT1)
+            testutils.send_packet(self, PORT0, pkt2)
+            testutils.verify_packet(self, pkt2, PORT2)
+
+        # default action drops the packet, also on a cache hit
+        pkt3 = testutils.simple_ip_packet(ip_dst="10.0.0.3")
+        for _ in range(2):
+            testutils.send_packet(self, PORT0, pkt3)
+            testutils.verify_no_other_packets(self)
+
+        _, stdout, _ = self.exec_ns_cmd(
+            "bpftool -j map dump pinned {}/ingress_flow_cache".format(PIPELINE_MAPS_MOUNT_PATH),
+            "Failed to read the flow cache",
+        )
+        self.assertEqual(len(json.loads(stdout)), 3)
+
+        # a cached flow uses the new default action once the table generation is incremented
+        self.table_set_default(table="ingress_tbl_fwd", action=1, data=[DP_PORTS[2]])
+        self.exec_ns_cmd(
+            "bpftool map update pinned {}/ingress_flow_cache_generation "
+            "key 0 0 0 0 value 1 0 0 0".format(PIPELINE_MAPS_MOUNT_PATH),
+            "Failed to increment the table generation",
+        )
+        testutils.send_packet(self, PORT0, pkt3)
+        testutils.verify_packet(self, pkt3, PORT2)
+
+
 class PassToKernelStackTest(P4EbpfTest):
     p4_file_path = "p4testdata/pass-to-kernel.p4"
 
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+"""Measures the effect of the constraint simplifier of P4Testgen.
+
+Every program is run twice with the same seed, once with the simplifier and once with
+--disable-constraint-simplifier. The script reports the number of Z3 calls, the number of
+branches the simplifier decided, and the total and solver time of each run."""
+
+import argparse
+import csv
+import logging
+import re
+import sys
+import tempfile
+from pathlib import Path
+
+# Append tools to the import path.
+FILE_DIR = Path(__file__).resolve().parent
+TOOLS_PATH = FILE_DIR.joinpath("../../../tools")
+sys.path.append(str(TOOLS_PATH))
+import testutils
+
+TESTGEN_BIN = FILE_DIR.joinpath("../../../build/p4testgen")
+P4_PROGRAMS_DIR = FILE_DIR.joinpath("../modules/testgen/targets/bmv2/test/p4-programs")
+OUTPUT_DIR = FILE_DIR.joinpath("../../../build/results")
+MAX_TESTS = 0
+
+# Lines of the performance report, e.g., "z3_check_sat_calls: 42" or "z3: 120 ms (10.00 % of
+# parent)".
+REPORT_LINE = re.compile(r"^(?P<name>[\w.]+): (?P<value>\d+)( ms)?")
+
+PARSER = argparse.ArgumentParser()
+
+PARSER.add_argument(
+    "-p",
+    "--p4-programs",
+    dest="p4_programs",
+    nargs="+",
+    default=None,
+    help="The P4 files to measure. Defaults to the programs of the BMv2 test suite.",
+)
+PARSER.add_argument(
+    "-o",
+    "--out-dir",
+    dest="out_dir",
+    default=OUTPUT_DIR,
+    help="The output folder where the summary is written.",
+)
+PARSER.add_argument(
+    "-m",
+    "--max-tests",
+    dest="max_tests",
+    default=MAX_TESTS,
+    type=int,
+    help="How many tests to generate for each program. 0 explores all paths.",
+)
+PARSER.add_argument(
+    "-s",
+    "--seed",
+    dest="seed",
+    default=0,
+    type=int,
+    help="The random seed for the runs.",
+)
+PARSER.add_argument(
+    "-b",
+    "--testgen-bin",
+    dest="p4testgen_bin",
+    default=TESTGEN_BIN,
+    help="Specifies the testgen binary.",
+)
+PARSER.add_argument(
+    "-ll",
+    "--log_level",
+    dest="log_level",
+    default="WARNING",
+    choices=["CRITICAL", "ERROR", "WARNING", "INFO", "DEBUG", "NOTSET"],
+    help="The log level to choose.",
+)
+
+
+def parse_report(output):
+    """Collects the timers and counters of a performance report."""
+    report = {}
+    for line in output.splitlines():
+        match = REPORT_LINE.match(line.strip())
+        if match:
+            report[match.group("name")] = int(match.group("value"))
+    return report
+
+
+def run_testgen(options, p4_program, simplify):
+    with tempfile.TemporaryDirectory() as test_dir:
+        cmd = (
+            f"{options.p4testgen_bin} --target bmv2 --arch v1model --std p4-16"
+            f" --test-backend STF --seed {options.seed} --print-performance-report"
+            f" --max-tests {options.max_tests} --out-dir {test_dir}"
+        )
+        if not simplify:
+            cmd += " --disable-constraint-simplifier"
+        cmd += f" {p4_program}"
+        result = testutils.exec_process(cmd, capture_output=True)
+        if result.returncode != testutils.SUCCESS:
+            return None
+        return parse_report(result.output)
+
+
+def main(args):
+    args.p4testgen_bin = testutils.check_if_file(args.p4testgen_bin)
+    if args.p4testgen_bin is None:
+        sys.exit(1)
+    if args.p4_programs:
+        p4_programs = [Path(program) for program in args.p4_programs]
+    else:
+        p4_programs = sorted(P4_PROGRAMS_DIR.glob("*.p4"))
+    out_dir = Path(args.out_dir).absolute()
+    out_dir.mkdir(parents=True, exist_ok=True)
+
+    rows = []
+    for p4_program in p4_programs:
+        row = {"program": p4_program.stem}
+        for simplify, suffix in ((False, "baseline"), (True, "simplifier")):
+            report = run_testgen(args, p4_program, simplify)
+            if report is None:
+                logging.warning("P4Testgen failed on %s.", p4_program)
+                break
+            row[f"z3_calls_{suffix}"] = report.get("z3_check_sat_calls", 0)
+            # Solver time is reported under every timer the solver was invoked in.
+            row[f"z3_ms_{suffix}"] = sum(
+                value for name, value in report.items() if name == "z3" or name.endswith(".z3")
+            )
+            row[f"total_ms_{suffix}"] = report.get("Total", 0)
+            if simplify:
+                row["decided_branches"] = report.get("simplifier_decided_branches", 0)
+                row["folded_constraints"] = report.get("simplifier_folded_constraints", 0)
+        else:
+            rows.append(row)
+            print(
+                f"{row['program']}: Z3 calls {row['z3_calls_baseline']} ->"
+                f" {row['z3_calls_simplifier']}, total {row['total_ms_baseline']} ms ->"
+                f" {row['total_ms_simplifier']} ms"
+            )
+    if not rows:
+        return
+
+    summary = out_dir.joinpath("constraint_simplifier.csv")
+    with summary.open("w", encoding="utf-8") as summary_file:
+        writer = csv.DictWriter(summary_file, fieldnames=list(rows[0].keys()))
+        writer.writeheader()
+        writer.writerows(rows)
+
+    baseline_calls = sum(row["z3_calls_baseline"] for row in rows)
+    simplifier_calls = sum(row["z3_calls_simplifier"] for row in rows)
+    baseline_ms = sum(row["total_ms_baseline"] for row in rows)
+    simplifier_ms = sum(row["total_ms_simplifier"] for row in rows)
+    print(f"Programs: {len(rows)}")
+    print(f"Z3 calls removed: {baseline_calls - simplifier_calls} of {baseline_calls}")
+    print(f"Total time: {baseline_ms} ms -> {simplifier_ms} ms")
+    print(f"Summary written to {summary}")
+
+
+if __name__ == "__main__":
+    # Parse options and process argv
+    arguments, argv = PARSER.parse_known_args()
+    # Configure logging.
+    logging.basicConfig(
+        format="%(levelname)s:%(message)s",
+        level=getattr(logging, arguments.log_level),
+    )
+    main(arguments)
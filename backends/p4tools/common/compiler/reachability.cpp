@@ -1,8 +1,10 @@
 #include "backends/p4tools/common/compiler/reachability.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <iostream>
+#include <limits>
 #include <list>
 #include <string>
 #include <utility>
@@ -331,6 +333,120 @@ void P4ProgramDCGCreator::addEdge(const DCGVertexType *vertex, IR::ID vertexName
     dcg->addToHash(vertex, vertexName);
 }
 
+ReachabilityIndex::ReachabilityIndex(const NodesCallGraph &dcg,
+                                     const P4::Coverage::CoverageSet &coverableNodes) {
+    // Number the vertices and collect their successors.
+    std::vector<const DCGVertexType *> vertices;
+    std::unordered_map<const DCGVertexType *, size_t> vertexIds;
+    for (const auto *vertex : dcg.nodes) {
+        vertexIds.emplace(vertex, vertices.size());
+        vertices.push_back(vertex);
+    }
+    std::vector<std::vector<size_t>> successors(vertices.size());
+    for (const auto &[vertex, callees] : dcg) {
+        auto &vertexSuccessors = successors.at(vertexIds.at(vertex));
+        for (const auto *callee : *callees) {
+            vertexSuccessors.push_back(vertexIds.at(callee));
+        }
+    }
+
+    // Tarjan's algorithm, with an explicit stack to avoid deep recursion on large programs.
+    // Components are completed in reverse topological order, so the closure of every successor
+    // component is final when a component is completed.
+    constexpr size_t UNVISITED = std::numeric_limits<size_t>::max();
+    std::vector<size_t> order(vertices.size(), UNVISITED);
+    std::vector<size_t> lowLink(vertices.size(), 0);
+    std::vector<size_t> componentOf(vertices.size(), UNVISITED);
+    std::vector<size_t> open;
+    // Pairs of a vertex and the position of the next successor to visit.
+    std::vector<std::pair<size_t, size_t>> work;
+    size_t counter = 0;
+    auto visit = [&](size_t vertex) {
+        order[vertex] = lowLink[vertex] = counter++;
+        open.push_back(vertex);
+        work.emplace_back(vertex, 0);
+    };
+    for (size_t root = 0; root < vertices.size(); root++) {
+        if (order[root] != UNVISITED) {
+            continue;
+        }
+        visit(root);
+        while (!work.empty()) {
+            auto [vertex, position] = work.back();
+            if (position < successors[vertex].size()) {
+                work.back().second++;
+                auto successor = successors[vertex][position];
+                if (order[successor] == UNVISITED) {
+                    visit(successor);
+                } else if (componentOf[successor] == UNVISITED) {
+                    lowLink[vertex] = std::min(lowLink[vertex], order[successor]);
+                }
+                continue;
+            }
+            work.pop_back();
+            if (!work.empty()) {
+                auto parent = work.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[vertex]);
+            }
+            if (lowLink[vertex] != order[vertex]) {
+                continue;
+            }
+
+            // The vertex is the root of a component. All members are on top of the open stack.
+            size_t component = closure.size();
+            std::vector<size_t> members;
+            size_t top = 0;
+            do {
+                top = open.back();
+                open.pop_back();
+                componentOf[top] = component;
+                members.push_back(top);
+            } while (top != vertex);
+
+            bitvec componentClosure;
+            componentClosure.setbit(component);
+            P4::Coverage::CoverageSet componentNodes;
+            for (auto member : members) {
+                const auto *node = vertices[member];
+                components.emplace(node, component);
+                if (coverableNodes.count(node) != 0) {
+                    componentNodes.insert(node);
+                }
+                for (auto successor : successors[member]) {
+                    auto successorComponent = componentOf[successor];
+                    if (successorComponent != component) {
+                        componentClosure |= closure[successorComponent];
+                        componentNodes |= reachableNodes[successorComponent];
+                    }
+                }
+            }
+            closure.push_back(std::move(componentClosure));
+            reachableNodes.push_back(std::move(componentNodes));
+        }
+    }
+}
+
+std::optional<bool> ReachabilityIndex::isReachable(const DCGVertexType *start,
+                                                   const DCGVertexType *element) const {
+    CHECK_NULL(start);
+    CHECK_NULL(element);
+    auto startComponent = components.find(start);
+    auto elementComponent = components.find(element);
+    if (startComponent == components.end() || elementComponent == components.end()) {
+        return std::nullopt;
+    }
+    return closure.at(startComponent->second).getbit(elementComponent->second);
+}
+
+const P4::Coverage::CoverageSet *ReachabilityIndex::getReachableNodes(
+    const DCGVertexType *vertex) const {
+    auto component = components.find(vertex);
+    if (component == components.end()) {
+        return nullptr;
+    }
+    return &reachableNodes.at(component->second);
+}
+
 ReachabilityEngineState *ReachabilityEngineState::getInitial() {
     auto *newState = new ReachabilityEngineState();
     newState->prevNode = nullptr;
@@ -357,10 +473,10 @@ bool ReachabilityEngineState::isEmpty() { return state.empty(); }
 
 void ReachabilityEngineState::clear() { state.clear(); }
 
-ReachabilityEngine::ReachabilityEngine(const NodesCallGraph &dcg,
+ReachabilityEngine::ReachabilityEngine(const NodesCallGraph &dcg, const ReachabilityIndex &index,
                                        std::string reachabilityExpression,
                                        bool eliminateAnnotations)
-    : dcg(dcg), hash(dcg.getHash()) {
+    : dcg(dcg), hash(dcg.getHash()), index(index) {
     std::list<const DCGVertexType *> start;
     start.push_back(nullptr);
     size_t i = 0;
@@ -487,6 +603,15 @@ std::unordered_set<const DCGVertexType *> ReachabilityEngine::getName(std::strin
     return i->second;
 }
 
+bool ReachabilityEngine::isReachable(const DCGVertexType *start,
+                                     const DCGVertexType *element) const {
+    auto result = index.isReachable(start, element);
+    if (result.has_value()) {
+        return result.value();
+    }
+    return dcg.isReachable(start, element);
+}
+
 ReachabilityResult ReachabilityEngine::next(ReachabilityEngineState *state,
                                             const DCGVertexType *next) {
     CHECK_NULL(state);
@@ -499,7 +624,7 @@ ReachabilityResult ReachabilityEngine::next(ReachabilityEngineState *state,
     }
     if (state->getPrevNode() == nullptr) {
         state->setPrevNode(next);
-    } else if (dcg.isReachable(state->getPrevNode(), next)) {
+    } else if (isReachable(state->getPrevNode(), next)) {
         // Check to move in the same direction.
         state->setPrevNode(next);
     } else {
@@ -530,7 +655,7 @@ ReachabilityResult ReachabilityEngine::next(ReachabilityEngineState *state,
                         expr = addCondition(expr, n);
                         newState.push_back(n);
                     }
-                } else if (dcg.isReachable(next, k)) {
+                } else if (isReachable(next, k)) {
                     expr = addCondition(expr, k);
                     newState.push_back(k);
                 }
@@ -546,7 +671,7 @@ ReachabilityResult ReachabilityEngine::next(ReachabilityEngineState *state,
                 expr = addCondition(expr, n);
                 newState.push_back(n);
             }
-        } else if (dcg.isReachable(next, i)) {
+        } else if (isReachable(next, i)) {
             expr = addCondition(expr, i);
             newState.push_back(i);
         }
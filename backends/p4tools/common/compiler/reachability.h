@@ -1,7 +1,9 @@
 #ifndef COMMON_COMPILER_REACHABILITY_H_
 #define COMMON_COMPILER_REACHABILITY_H_
 
+#include <cstddef>
 #include <list>
+#include <optional>
 #include <set>
 #include <string>
 #include <unordered_map>
@@ -14,8 +16,10 @@
 #include "ir/ir.h"
 #include "ir/node.h"
 #include "ir/visitor.h"
+#include "lib/bitvec.h"
 #include "lib/cstring.h"
 #include "lib/null.h"
+#include "midend/coverage.h"
 
 namespace P4Tools {
 
@@ -86,6 +90,42 @@ class ExtendedCallGraph : public P4::CallGraph<T> {
 
 using NodesCallGraph = ExtendedCallGraph<DCGVertexType *>;
 
+/// Precomputed reachability over a DCG.
+/// The strongly connected components of the DCG are condensed into an acyclic graph, and the
+/// transitive closure of that graph is stored as one bit vector of components per component.
+/// Every vertex of a component reaches the same set of vertices, so a reachability query is a
+/// single bit test. In addition, each component stores the set of coverable nodes it reaches,
+/// which the coverage-guided strategies use as the lookahead of a branch.
+class ReachabilityIndex {
+    /// Maps each vertex of the DCG to its component.
+    std::unordered_map<const DCGVertexType *, size_t> components;
+
+    /// The components reachable from each component, including the component itself.
+    std::vector<bitvec> closure;
+
+    /// The coverable nodes reachable from each component.
+    std::vector<P4::Coverage::CoverageSet> reachableNodes;
+
+ public:
+    /// Builds the index for @p dcg. Only the members of @p coverableNodes are collected as
+    /// reachable nodes.
+    ReachabilityIndex(const NodesCallGraph &dcg,
+                      const P4::Coverage::CoverageSet &coverableNodes);
+
+    /// @returns whether @p element is reachable from @p start, or std::nullopt if one of them is
+    /// not a vertex of the DCG. A vertex always reaches itself.
+    [[nodiscard]] std::optional<bool> isReachable(const DCGVertexType *start,
+                                                  const DCGVertexType *element) const;
+
+    /// @returns the coverable nodes reachable from @p vertex, or nullptr if @p vertex is not a
+    /// vertex of the DCG.
+    [[nodiscard]] const P4::Coverage::CoverageSet *getReachableNodes(
+        const DCGVertexType *vertex) const;
+
+    /// @returns the number of strongly connected components of the DCG.
+    [[nodiscard]] size_t numComponents() const { return closure.size(); }
+};
+
 /// The main class for building control flow DCG.
 class P4ProgramDCGCreator : public Inspector {
     NodesCallGraph *dcg;
@@ -159,17 +199,19 @@ using ReachabilityResult = std::pair<bool, const IR::Expression *>;
 class ReachabilityEngine {
     const NodesCallGraph &dcg;
     const ReachabilityHashType &hash;
+    const ReachabilityIndex &index;
     std::unordered_map<const DCGVertexType *, std::list<const DCGVertexType *>> userTransitions;
     std::unordered_map<const DCGVertexType *, const IR::Expression *> conditions;
     std::unordered_set<const DCGVertexType *> forbiddenVertexes;
 
  public:
     /// Default constructor, where dcg is a control flow graph builded by P4ProgramDCGCreator,
+    /// index is the reachability index of dcg, which must outlive the engine,
     /// reachabilityExpression is a user's pattern wrote in the syntax presented above,
     /// eliminateAnnotations is true if after detection of the annotations it should to store
     /// corresponding parent IR::Node in a  reachability engine state.
-    ReachabilityEngine(const NodesCallGraph &dcg, std::string reachabilityExpression,
-                       bool eliminateAnnotations = false);
+    ReachabilityEngine(const NodesCallGraph &dcg, const ReachabilityIndex &index,
+                       std::string reachabilityExpression, bool eliminateAnnotations = false);
     /// Moves the next statement in a engine state. It returns a pair where the first argument
     /// is a flag for the possibility of such a movement and the second argument is an condition
     /// which should be checked additionally. If engine state is reachable from current node
@@ -180,6 +222,10 @@ class ReachabilityEngine {
     const NodesCallGraph &getDCG();
 
  protected:
+    /// Checks whether @p element is reachable from @p start. Uses the precomputed index and
+    /// falls back to a search of the DCG for nodes which are not vertices of the DCG.
+    bool isReachable(const DCGVertexType *start, const DCGVertexType *element) const;
+
     /// Translates current annotation into set of the parent nodes.
     void annotationToStatements(const DCGVertexType *node,
                                 std::unordered_set<const DCGVertexType *> &s);
@@ -0,0 +1,238 @@
+#include "backends/p4tools/common/core/caching_solver.h"
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "backends/p4tools/common/lib/util.h"
+#include "frontends/p4/optimizeExpressions.h"
+#include "ir/visitor.h"
+#include "lib/exceptions.h"
+
+namespace P4Tools {
+
+namespace {
+
+/// The maximum number of cached component results. The cache is cleared when it is full.
+constexpr size_t MAX_CACHE_SIZE = 1 << 16;
+
+/// Collects the symbolic variables of an expression.
+class CollectVariables : public Inspector {
+    SymbolicSet &result;
+
+    bool preorder(const IR::SymbolicVariable *var) override {
+        result.insert(var);
+        return false;
+    }
+
+ public:
+    explicit CollectVariables(SymbolicSet &result) : result(result) {}
+};
+
+/// Checks whether an expression only consists of nodes which constant folding evaluates with the
+/// same semantics as the solver. Everything else is left to the solver, e.g. division and modulo,
+/// which are defined for a zero divisor in Z3 but are errors when folded, or shifts, which the
+/// solver translation rewrites.
+class IsFoldable : public Inspector {
+    bool preorder(const IR::Node *) override {
+        foldable = false;
+        return false;
+    }
+    bool preorder(const IR::Type *) override { return false; }
+    bool preorder(const IR::Literal *) override { return false; }
+    bool preorder(const IR::SymbolicVariable *) override { return false; }
+    bool preorder(const IR::Operation_Relation *) override { return foldable; }
+    bool preorder(const IR::LAnd *) override { return foldable; }
+    bool preorder(const IR::LOr *) override { return foldable; }
+    bool preorder(const IR::LNot *) override { return foldable; }
+    bool preorder(const IR::BAnd *) override { return foldable; }
+    bool preorder(const IR::BOr *) override { return foldable; }
+    bool preorder(const IR::BXor *) override { return foldable; }
+    bool preorder(const IR::Cmpl *) override { return foldable; }
+    bool preorder(const IR::Add *) override { return foldable; }
+    bool preorder(const IR::Sub *) override { return foldable; }
+    bool preorder(const IR::Mul *) override { return foldable; }
+    bool preorder(const IR::Neg *) override { return foldable; }
+    bool preorder(const IR::Concat *) override { return foldable; }
+    bool preorder(const IR::Slice *) override { return foldable; }
+    bool preorder(const IR::Cast *) override { return foldable; }
+    bool preorder(const IR::Mux *) override { return foldable; }
+
+ public:
+    bool foldable = true;
+};
+
+/// Replaces the symbolic variables of an expression by their values in a model.
+class SubstituteModel : public Transform {
+    const SymbolicMapping &model;
+
+    const IR::Node *preorder(IR::SymbolicVariable *var) override {
+        prune();
+        return model.at(var);
+    }
+
+ public:
+    explicit SubstituteModel(const SymbolicMapping &model) : model(model) {}
+};
+
+}  // namespace
+
+CachingSolver::CachingSolver(AbstractSolver &solver) : solver(solver) {}
+
+void CachingSolver::comment(cstring comment) { solver.comment(comment); }
+
+void CachingSolver::seed(unsigned seed) { solver.seed(seed); }
+
+void CachingSolver::timeout(unsigned tm) { solver.timeout(tm); }
+
+void CachingSolver::toJSON(JSONGenerator &json) const { solver.toJSON(json); }
+
+bool CachingSolver::isInIncrementalMode() const { return solver.isInIncrementalMode(); }
+
+const SymbolicMapping &CachingSolver::getSymbolicMapping() const {
+    BUG_CHECK(lastResultSat, "CachingSolver: the last query has no model.");
+    return model;
+}
+
+const SymbolicSet &CachingSolver::getVariables(const Constraint *constraint) {
+    auto it = variables.find(constraint);
+    if (it != variables.end()) {
+        return it->second;
+    }
+    auto &result = variables[constraint];
+    constraint->apply(CollectVariables(result));
+    return result;
+}
+
+std::vector<std::vector<const Constraint *>> CachingSolver::partition(
+    const std::vector<const Constraint *> &asserts) {
+    // Union-find over the constraint indices.
+    std::vector<size_t> parent(asserts.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](size_t idx) {
+        while (parent[idx] != idx) {
+            parent[idx] = parent[parent[idx]];
+            idx = parent[idx];
+        }
+        return idx;
+    };
+    std::map<const IR::SymbolicVariable *, size_t, SymbolicVarComp> owner;
+    for (size_t idx = 0; idx < asserts.size(); idx++) {
+        for (const auto *var : getVariables(asserts[idx])) {
+            auto result = owner.emplace(var, idx);
+            if (!result.second) {
+                parent[find(idx)] = find(result.first->second);
+            }
+        }
+    }
+
+    std::vector<std::vector<const Constraint *>> components;
+    std::map<size_t, size_t> componentOfRoot;
+    for (size_t idx = 0; idx < asserts.size(); idx++) {
+        auto result = componentOfRoot.emplace(find(idx), components.size());
+        if (result.second) {
+            components.emplace_back();
+        }
+        components[result.first->second].push_back(asserts[idx]);
+    }
+    return components;
+}
+
+CachingSolver::ComponentKey CachingSolver::makeKey(std::vector<const Constraint *> constraints) {
+    std::sort(constraints.begin(), constraints.end());
+    constraints.erase(std::unique(constraints.begin(), constraints.end()), constraints.end());
+    return constraints;
+}
+
+bool CachingSolver::satisfies(const SymbolicMapping &candidate,
+                              const std::vector<const Constraint *> &constraints) {
+    for (const auto *constraint : constraints) {
+        for (const auto *var : getVariables(constraint)) {
+            if (candidate.find(var) == candidate.end()) {
+                return false;
+            }
+        }
+        IsFoldable isFoldable;
+        constraint->apply(isFoldable);
+        if (!isFoldable.foldable) {
+            return false;
+        }
+        const auto *evaluated = P4::optimizeExpression(constraint->apply(SubstituteModel(candidate)));
+        const auto *boolLiteral = evaluated->to<IR::BoolLiteral>();
+        if (boolLiteral == nullptr || !boolLiteral->value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::optional<bool> CachingSolver::checkComponent(
+    const std::vector<const Constraint *> &component) {
+    auto key = makeKey(component);
+    auto it = cache.find(key);
+    if (it != cache.end()) {
+        Utils::addToCounter("solver_query_cache_hits");
+        if (it->second.sat) {
+            model.insert(it->second.model.begin(), it->second.model.end());
+        }
+        return it->second.sat;
+    }
+    Utils::addToCounter("solver_query_cache_misses");
+
+    // Look at the component without its most recent constraint.
+    if (component.size() > 1) {
+        auto previousKey =
+            makeKey(std::vector<const Constraint *>(component.begin(), component.end() - 1));
+        auto previous = cache.find(previousKey);
+        if (previous != cache.end()) {
+            if (!previous->second.sat) {
+                Utils::addToCounter("solver_subset_unsat_reuses");
+                cache.emplace(std::move(key), CachedResult{false, {}});
+                return false;
+            }
+            if (satisfies(previous->second.model, {component.back()})) {
+                Utils::addToCounter("solver_model_reuses");
+                auto previousModel = previous->second.model;
+                model.insert(previousModel.begin(), previousModel.end());
+                cache.emplace(std::move(key), CachedResult{true, std::move(previousModel)});
+                return true;
+            }
+        }
+    }
+
+    auto result = solver.checkSat(component);
+    if (result == std::nullopt) {
+        return result;
+    }
+    CachedResult cached{*result, {}};
+    if (*result) {
+        cached.model = solver.getSymbolicMapping();
+        model.insert(cached.model.begin(), cached.model.end());
+    }
+    cache.emplace(std::move(key), std::move(cached));
+    return result;
+}
+
+std::optional<bool> CachingSolver::checkSat(const std::vector<const Constraint *> &asserts) {
+    model.clear();
+    lastResultSat = false;
+    if (cache.size() >= MAX_CACHE_SIZE) {
+        cache.clear();
+        variables.clear();
+    }
+    std::optional<bool> result = true;
+    for (const auto &component : partition(asserts)) {
+        auto componentResult = checkComponent(component);
+        if (componentResult == std::nullopt) {
+            result = std::nullopt;
+            continue;
+        }
+        if (!*componentResult) {
+            return false;
+        }
+    }
+    lastResultSat = result.value_or(false);
+    return result;
+}
+
+}  // namespace P4Tools
@@ -0,0 +1,104 @@
+#ifndef BACKENDS_P4TOOLS_COMMON_CORE_CACHING_SOLVER_H_
+#define BACKENDS_P4TOOLS_COMMON_CORE_CACHING_SOLVER_H_
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "backends/p4tools/common/core/solver.h"
+#include "ir/ir.h"
+#include "ir/json_generator.h"
+#include "lib/cstring.h"
+
+namespace P4Tools {
+
+/// A query layer in front of another solver, in the style of KLEE's independence and
+/// counterexample caches.
+///
+/// Each query is split into independent components: two constraints belong to the same component
+/// if they are (transitively) connected by a shared symbolic variable. Components are solved
+/// separately, and their results and models are cached. Since components do not share
+/// variables, the model of a query is the union of the models of its components.
+///
+/// Before the underlying solver is invoked for a component which is not in the cache, two cheap
+/// checks are made against the cached result of the component without its most recent
+/// constraint, which usually is the previous query along the same path:
+///   - if that component is unsatisfiable, so is the new one;
+///   - if its model satisfies the new constraints, the model is reused as a counterexample and
+///     the underlying solver is not invoked at all. The model is checked by substituting it into
+///     the new constraints and simplifying them, which is only attempted for constraints whose
+///     operations constant folding evaluates exactly like the solver.
+///
+/// Components are identified by the set of their constraint nodes. Path constraints of the
+/// states along a path share their nodes, so identical queries map to the same cache entries.
+class CachingSolver : public AbstractSolver {
+ public:
+    /// Creates a caching layer in front of @p solver, which must outlive this object.
+    explicit CachingSolver(AbstractSolver &solver);
+
+    void comment(cstring comment) override;
+
+    void seed(unsigned seed) override;
+
+    void timeout(unsigned tm) override;
+
+    std::optional<bool> checkSat(const std::vector<const Constraint *> &asserts) override;
+
+    [[nodiscard]] const SymbolicMapping &getSymbolicMapping() const override;
+
+    void toJSON(JSONGenerator &json) const override;
+
+    [[nodiscard]] bool isInIncrementalMode() const override;
+
+ private:
+    /// A sorted list of constraint nodes, which identifies a component.
+    using ComponentKey = std::vector<const Constraint *>;
+
+    /// The cached result of a component.
+    struct CachedResult {
+        /// Whether the component is satisfiable. Timeouts are not cached.
+        bool sat;
+
+        /// The model of the component, if it is satisfiable.
+        SymbolicMapping model;
+    };
+
+    /// @returns the symbolic variables occurring in @p constraint.
+    const SymbolicSet &getVariables(const Constraint *constraint);
+
+    /// Splits @p asserts into independent components. Each component keeps the relative order of
+    /// its constraints in @p asserts.
+    std::vector<std::vector<const Constraint *>> partition(
+        const std::vector<const Constraint *> &asserts);
+
+    /// Solves a single component, using the cache where possible.
+    std::optional<bool> checkComponent(const std::vector<const Constraint *> &component);
+
+    /// @returns true if @p candidate binds all variables of @p constraints and they all simplify
+    /// to true once @p candidate is substituted into them.
+    bool satisfies(const SymbolicMapping &candidate,
+                   const std::vector<const Constraint *> &constraints);
+
+    /// @returns the key for @p constraints.
+    static ComponentKey makeKey(std::vector<const Constraint *> constraints);
+
+    /// The solver which answers the queries that cannot be answered from the cache.
+    AbstractSolver &solver;
+
+    /// Results of the components solved so far.
+    std::map<ComponentKey, CachedResult> cache;
+
+    /// The variables occurring in each constraint.
+    std::unordered_map<const Constraint *, SymbolicSet> variables;
+
+    /// The model of the last satisfiable query.
+    SymbolicMapping model;
+
+    /// Whether the last query was satisfiable.
+    bool lastResultSat = false;
+};
+
+}  // namespace P4Tools
+
+#endif /* BACKENDS_P4TOOLS_COMMON_CORE_CACHING_SOLVER_H_ */
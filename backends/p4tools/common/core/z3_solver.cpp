@@ -13,6 +13,7 @@
 
 #include <boost/multiprecision/cpp_int.hpp>
 
+#include "backends/p4tools/common/lib/util.h"
 #include "ir/ir.h"
 #include "ir/irutils.h"
 #include "ir/json_loader.h"  // IWYU pragma: keep
@@ -27,6 +28,9 @@
 
 namespace P4Tools {
 
+/// The maximum number of entries in the translation cache of a Z3Solver.
+static constexpr size_t MAX_TRANSLATION_CACHE_SIZE = 1 << 20;
+
 /// Converts a Z3 expression to a string.
 const char *toString(const z3::expr &e) { return Z3_ast_to_string(e.ctx(), e); }
 
@@ -170,15 +174,52 @@ z3::expr Z3Solver::declareVar(const IR::SymbolicVariable &var) {
     BUG_CHECK(
         !declaredVarsById.empty(),
         "DeclaredVarsById should have at least one entry! Check if push() was used correctly.");
+    registerVar(expr.id(), &var);
+    return expr;
+}
+
+void Z3Solver::registerVar(unsigned id, const IR::SymbolicVariable *var) {
     // Need to take the reference here to avoid accidental copies.
     auto *latestVars = &declaredVarsById.back();
-    latestVars->emplace(expr.id(), &var);
-    return expr;
+    latestVars->emplace(id, var);
+    if (!pendingTranslationVars.empty()) {
+        pendingTranslationVars.back().emplace(id, var);
+    }
+}
+
+z3::expr Z3Solver::translate(const IR::Expression *expression) {
+    auto it = translationCache.find(expression);
+    if (it != translationCache.end()) {
+        Utils::addToCounter("z3_translation_cache_hits");
+        // The variables may have been declared in a context which has been popped since.
+        for (const auto &[id, var] : it->second.vars) {
+            registerVar(id, var);
+        }
+        return it->second.expr;
+    }
+    Utils::addToCounter("z3_translation_cache_misses");
+    pendingTranslationVars.emplace_back();
+    Z3Translator translator(*this);
+    expression->apply(translator);
+    auto result = translator.getResult();
+    auto vars = std::move(pendingTranslationVars.back());
+    pendingTranslationVars.pop_back();
+    // The enclosing translation contains the variables of this one.
+    if (!pendingTranslationVars.empty()) {
+        pendingTranslationVars.back().insert(vars.begin(), vars.end());
+    }
+    // The cache keeps the IR nodes alive. Start over if it grows too large.
+    if (translationCache.size() >= MAX_TRANSLATION_CACHE_SIZE) {
+        translationCache.clear();
+    }
+    translationCache.emplace(expression, CachedTranslation{result, std::move(vars)});
+    return result;
 }
 
 void Z3Solver::reset() {
     z3solver.reset();
     declaredVarsById.clear();
+    pendingTranslationVars.clear();
     checkpoints.clear();
     z3Assertions.resize(0);
 }
@@ -268,6 +309,7 @@ std::optional<bool> Z3Solver::checkSat(const std::vector<const Constraint *> &as
            isIncremental ? z3solver.assertions().size() : z3Assertions.size());
     Util::ScopedTimer ctZ3("z3");
     Util::ScopedTimer ctCheckSat("checkSat");
+    Utils::addToCounter("z3_check_sat_calls");
     z3::check_result result = isIncremental ? z3solver.check() : z3solver.check(z3Assertions);
     switch (result) {
         case z3::sat:
@@ -285,9 +327,7 @@ std::optional<bool> Z3Solver::checkSat(const std::vector<const Constraint *> &as
 
 void Z3Solver::asrt(const Constraint *assertion) {
     try {
-        Z3Translator z3translator(*this);
-        assertion->apply(z3translator);
-        auto expr = z3translator.getResult();
+        auto expr = translate(assertion);
 
         Z3_LOG("add assertion '%s'", toString(expr));
         if (isIncremental) {
@@ -439,11 +479,9 @@ bool Z3Translator::preorder(const IR::Node *node) {
 }
 
 bool Z3Translator::preorder(const IR::Cast *cast) {
-    Z3Translator tCast(solver);
-    cast->expr->apply(tCast);
     uint64_t exprSize = 0;
     const auto *const castExtrType = cast->expr->type;
-    auto castExpr = tCast.result;
+    auto castExpr = solver.translate(cast->expr);
     if (const auto *tb = cast->destType->to<IR::Type_Bits>()) {
         uint64_t destSize = tb->width_bits();
         if (const auto *exprType = castExtrType->to<IR::Type_Bits>()) {
@@ -553,9 +591,7 @@ const ShiftType *Z3Translator::rewriteShift(const ShiftType *shift) const {
 /// General function for unary operations.
 bool Z3Translator::recurseUnary(const IR::Operation_Unary *unary, Z3UnaryOp f) {
     BUG_CHECK(unary, "Z3Translator: encountered null node during translation");
-    Z3Translator tExpr(solver);
-    unary->expr->apply(tExpr);
-    result = f(tExpr.result);
+    result = f(solver.translate(unary->expr));
     return false;
 }
 
@@ -638,11 +674,7 @@ bool Z3Translator::preorder(const IR::Concat *op) { return recurseBinary(op, z3:
 /// general function for binary operations
 bool Z3Translator::recurseBinary(const IR::Operation_Binary *binary, Z3BinaryOp f) {
     BUG_CHECK(binary, "Z3Translator: encountered null node during translation");
-    Z3Translator tLeft(solver);
-    Z3Translator tRight(solver);
-    binary->left->apply(tLeft);
-    binary->right->apply(tRight);
-    result = f(tLeft.result, tRight.result);
+    result = f(solver.translate(binary->left), solver.translate(binary->right));
     return false;
 }
 
@@ -658,13 +690,8 @@ bool Z3Translator::preorder(const IR::Slice *op) {
 /// general function for ternary operations
 bool Z3Translator::recurseTernary(const IR::Operation_Ternary *ternary, Z3TernaryOp f) {
     BUG_CHECK(ternary, "Z3Translator: encountered null node during translation");
-    Z3Translator t0(solver);
-    Z3Translator t1(solver);
-    Z3Translator t2(solver);
-    ternary->e0->apply(t0);
-    ternary->e1->apply(t1);
-    ternary->e2->apply(t2);
-    result = f(t0.result, t1.result, t2.result);
+    result = f(solver.translate(ternary->e0), solver.translate(ternary->e1),
+               solver.translate(ternary->e2));
     return false;
 }
 
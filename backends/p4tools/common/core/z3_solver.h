@@ -5,8 +5,10 @@
 
 #include <cstddef>
 #include <iosfwd>
+#include <map>
 #include <optional>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "backends/p4tools/common/core/solver.h"
@@ -72,6 +74,14 @@ class Z3Solver : public AbstractSolver {
     /// Inserts an assertion into the topmost solver context.
     void asrt(const Constraint *assertion);
 
+    /// Translates a P4 expression into Z3, reusing the cached translation if there is one. The
+    /// variables of a cached translation are declared again in the topmost solver context.
+    z3::expr translate(const IR::Expression *expression);
+
+    /// Records @a var, whose Z3 expression ID is @a id, in the topmost solver context and in the
+    /// translation that is in progress, if any.
+    void registerVar(unsigned id, const IR::SymbolicVariable *var);
+
     /// Converts a P4 type to a Z3 sort.
     z3::sort toSort(const IR::Type *type);
 
@@ -123,6 +133,21 @@ class Z3Solver : public AbstractSolver {
 
     /// Stores the timeout, as last set by @ref timeout.
     std::optional<unsigned> timeout_;
+
+    /// A cached translation together with the variables occurring in it, by Z3 expression ID.
+    struct CachedTranslation {
+        z3::expr expr;
+        std::map<unsigned, const IR::SymbolicVariable *> vars;
+    };
+
+    /// Translations of P4 expressions (and all their subexpressions) into Z3, keyed on the IR
+    /// node. IR nodes are immutable and path constraints of different states share most of their
+    /// subexpressions, so translations stay valid across push and pop. They only depend on
+    /// @ref z3context and are never invalidated while the context lives.
+    std::unordered_map<const IR::Expression *, CachedTranslation> translationCache;
+
+    /// For each translation in progress, innermost last, the variables encountered so far.
+    std::vector<std::map<unsigned, const IR::SymbolicVariable *>> pendingTranslationVars;
 };
 
 }  // namespace P4Tools
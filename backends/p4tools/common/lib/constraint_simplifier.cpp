@@ -0,0 +1,252 @@
+#include "backends/p4tools/common/lib/constraint_simplifier.h"
+
+#include <cstddef>
+#include <unordered_map>
+
+#include "backends/p4tools/common/lib/util.h"
+#include "frontends/p4/optimizeExpressions.h"
+#include "ir/irutils.h"
+#include "ir/visitor.h"
+
+namespace P4Tools {
+
+namespace {
+
+/// The maximum number of rounds of optimization and rewriting applied to an expression.
+constexpr int MAX_ROUNDS = 4;
+
+/// The maximum number of memoized expressions. The memo table is cleared when it is full.
+constexpr size_t MAX_MEMO_SIZE = 1 << 16;
+
+/// Checks whether an expression contains a taint placeholder.
+class HasTaint : public Inspector {
+    bool preorder(const IR::Node *) override { return !result; }
+
+    bool preorder(const IR::TaintExpression *) override {
+        result = true;
+        return false;
+    }
+
+ public:
+    bool result = false;
+};
+
+bool hasTaint(const IR::Expression *expr) {
+    HasTaint hasTaint;
+    expr->apply(hasTaint);
+    return hasTaint.result;
+}
+
+/// @returns true if one of @p a and @p b is the logical negation of the other.
+bool isNegationOf(const IR::Expression *a, const IR::Expression *b) {
+    if (const auto *notA = a->to<IR::LNot>()) {
+        if (notA->expr->equiv(*b)) {
+            return true;
+        }
+    }
+    if (const auto *notB = b->to<IR::LNot>()) {
+        return notB->expr->equiv(*a);
+    }
+    return false;
+}
+
+/// Boolean rewrites which are not performed by constant folding and strength reduction.
+/// Two expressions with taint are never equal, since each taint stands for an unknown value.
+class BooleanRewrites : public Transform {
+    const IR::Node *postorder(IR::LAnd *expr) override {
+        if (expr->left->equiv(*expr->right)) {
+            return expr->left;
+        }
+        if (isNegationOf(expr->left, expr->right)) {
+            return IR::getBoolLiteral(false);
+        }
+        return expr;
+    }
+
+    const IR::Node *postorder(IR::LOr *expr) override {
+        if (expr->left->equiv(*expr->right)) {
+            return expr->left;
+        }
+        if (isNegationOf(expr->left, expr->right)) {
+            return IR::getBoolLiteral(true);
+        }
+        return expr;
+    }
+
+    const IR::Node *postorder(IR::Equ *expr) override {
+        if (expr->left->equiv(*expr->right) && !hasTaint(expr->left)) {
+            return IR::getBoolLiteral(true);
+        }
+        return expr;
+    }
+
+    const IR::Node *postorder(IR::Neq *expr) override {
+        if (expr->left->equiv(*expr->right) && !hasTaint(expr->left)) {
+            return IR::getBoolLiteral(false);
+        }
+        return expr;
+    }
+
+    const IR::Node *postorder(IR::Mux *expr) override {
+        if (expr->e1->equiv(*expr->e2) && !hasTaint(expr->e1)) {
+            return expr->e1;
+        }
+        const auto *trueValue = expr->e1->to<IR::BoolLiteral>();
+        const auto *falseValue = expr->e2->to<IR::BoolLiteral>();
+        if (trueValue != nullptr && falseValue != nullptr) {
+            // The two values differ, otherwise the first rewrite applies.
+            if (trueValue->value) {
+                return expr->e0;
+            }
+            return new IR::LNot(expr->srcInfo, IR::Type_Boolean::get(), expr->e0);
+        }
+        return expr;
+    }
+
+ public:
+    BooleanRewrites() { setName("BooleanRewrites"); }
+};
+
+/// A comparison of an expression with a constant.
+struct ConstantComparison {
+    const IR::Expression *operand;
+    const IR::Constant *constant;
+    /// Whether the comparison is an equality, as opposed to an inequality.
+    bool equal;
+};
+
+std::optional<ConstantComparison> matchConstantComparison(const IR::Expression *expr) {
+    const IR::Operation_Binary *comparison = expr->to<IR::Equ>();
+    bool equal = comparison != nullptr;
+    if (comparison == nullptr) {
+        comparison = expr->to<IR::Neq>();
+    }
+    if (comparison == nullptr) {
+        return std::nullopt;
+    }
+    if (const auto *constant = comparison->right->to<IR::Constant>()) {
+        return ConstantComparison{comparison->left, constant, equal};
+    }
+    if (const auto *constant = comparison->left->to<IR::Constant>()) {
+        return ConstantComparison{comparison->right, constant, equal};
+    }
+    return std::nullopt;
+}
+
+/// Decides @p goal under the assumption that @p fact holds.
+std::optional<bool> decideByFact(const IR::Expression *fact, const IR::Expression *goal) {
+    if (fact->equiv(*goal)) {
+        return true;
+    }
+    if (isNegationOf(fact, goal)) {
+        return false;
+    }
+    auto factComparison = matchConstantComparison(fact);
+    if (!factComparison.has_value()) {
+        return std::nullopt;
+    }
+    auto goalComparison = matchConstantComparison(goal);
+    if (!goalComparison.has_value() ||
+        !factComparison->operand->equiv(*goalComparison->operand)) {
+        return std::nullopt;
+    }
+    bool sameConstant = factComparison->constant->value == goalComparison->constant->value;
+    // The operand is known to be equal to the constant of the fact.
+    if (factComparison->equal) {
+        return sameConstant == goalComparison->equal;
+    }
+    // The operand is only known to differ from the constant of the fact.
+    if (sameConstant) {
+        return !goalComparison->equal;
+    }
+    return std::nullopt;
+}
+
+/// Appends the conjuncts of @p expr to @p conjuncts.
+void collectConjuncts(const IR::Expression *expr, std::vector<const IR::Expression *> &conjuncts) {
+    if (const auto *land = expr->to<IR::LAnd>()) {
+        collectConjuncts(land->left, conjuncts);
+        collectConjuncts(land->right, conjuncts);
+        return;
+    }
+    conjuncts.push_back(expr);
+}
+
+/// Decides @p goal by the first conjunct of @p fact which decides it.
+std::optional<bool> decideByConjuncts(const IR::Expression *fact, const IR::Expression *goal) {
+    if (const auto *land = fact->to<IR::LAnd>()) {
+        auto result = decideByConjuncts(land->left, goal);
+        if (result.has_value()) {
+            return result;
+        }
+        return decideByConjuncts(land->right, goal);
+    }
+    return decideByFact(fact, goal);
+}
+
+}  // namespace
+
+std::unordered_map<const IR::Expression *, const IR::Expression *> ConstraintSimplifier::memo;
+
+void ConstraintSimplifier::reset() { memo.clear(); }
+
+const IR::Expression *ConstraintSimplifier::simplify(const IR::Expression *expr) {
+    auto it = memo.find(expr);
+    if (it != memo.end()) {
+        Utils::addToCounter("simplifier_memo_hits");
+        return it->second;
+    }
+    Utils::addToCounter("simplifier_memo_misses");
+
+    const auto *result = expr;
+    for (int round = 0; round < MAX_ROUNDS; round++) {
+        const auto *optimized = P4::optimizeExpression(result);
+        const auto *rewritten = optimized->apply(BooleanRewrites());
+        result = rewritten;
+        // Constant folding and strength reduction have nothing left to do if the rewrites did
+        // not change anything.
+        if (rewritten == optimized) {
+            break;
+        }
+    }
+    if (result->is<IR::BoolLiteral>() && !expr->is<IR::BoolLiteral>()) {
+        Utils::addToCounter("simplifier_folded_constraints");
+    }
+
+    if (memo.size() >= MAX_MEMO_SIZE) {
+        memo.clear();
+    }
+    memo.emplace(expr, result);
+    memo.emplace(result, result);
+    return result;
+}
+
+std::optional<bool> ConstraintSimplifier::decide(PathIterator begin, PathIterator end,
+                                                 const Constraint *constraint) {
+    std::vector<const IR::Expression *> goals;
+    collectConjuncts(constraint, goals);
+
+    bool implied = true;
+    for (const auto *goal : goals) {
+        std::optional<bool> result;
+        if (const auto *boolLiteral = goal->to<IR::BoolLiteral>()) {
+            result = boolLiteral->value;
+        }
+        // The path constraint is walked in place rather than copied into a list of facts.
+        for (auto factIt = begin; !result.has_value() && factIt != end; ++factIt) {
+            result = decideByConjuncts(*factIt, goal);
+        }
+        if (result.has_value() && !*result) {
+            Utils::addToCounter("simplifier_decided_branches");
+            return false;
+        }
+        implied = implied && result.has_value();
+    }
+    if (implied) {
+        Utils::addToCounter("simplifier_decided_branches");
+        return true;
+    }
+    return std::nullopt;
+}
+
+}  // namespace P4Tools
@@ -0,0 +1,55 @@
+#ifndef BACKENDS_P4TOOLS_COMMON_LIB_CONSTRAINT_SIMPLIFIER_H_
+#define BACKENDS_P4TOOLS_COMMON_LIB_CONSTRAINT_SIMPLIFIER_H_
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "backends/p4tools/common/core/solver.h"
+#include "ir/ir.h"
+
+namespace P4Tools {
+
+/// Cheap simplifications of path constraints, which are applied before a constraint reaches the
+/// solver.
+///
+/// @ref simplify runs constant folding and strength reduction, followed by a few boolean
+/// rewrites which these passes do not perform (e.g., "a && !a" to false, or "c ? a : a" to a).
+/// The rewrites are repeated until a fixed point, but at most a bounded number of times.
+/// Results are memoized by node until @ref reset is called.
+///
+/// @ref decide checks a constraint against the conjuncts of a path constraint. Many branch
+/// conditions repeat or contradict a condition taken earlier on the same path, e.g., validity
+/// checks of the same header, or a select over a field that has already been compared with a
+/// constant. These branches are decided without a solver call.
+class ConstraintSimplifier {
+    /// The simplified form of each expression simplified so far.
+    static std::unordered_map<const IR::Expression *, const IR::Expression *> memo;
+
+ public:
+    using PathIterator = std::vector<const Constraint *>::const_iterator;
+
+    /// @returns the simplified form of @p expr.
+    static const IR::Expression *simplify(const IR::Expression *expr);
+
+    /// Forgets all memoized results. Must be called before the constraints of another program
+    /// are simplified, since the nodes of the previous program may be freed and reused.
+    static void reset();
+
+    /// Decides @p constraint under the assumption that all conditions in [@p begin, @p end) of
+    /// a path constraint hold.
+    /// @returns true if @p constraint is implied, false if it is contradicted, and std::nullopt if
+    /// a solver is needed.
+    static std::optional<bool> decide(PathIterator begin, PathIterator end,
+                                      const Constraint *constraint);
+
+    /// Decides @p constraint under the assumption that all of @p pathConstraint holds.
+    static std::optional<bool> decide(const std::vector<const Constraint *> &pathConstraint,
+                                      const Constraint *constraint) {
+        return decide(pathConstraint.begin(), pathConstraint.end(), constraint);
+    }
+};
+
+}  // namespace P4Tools
+
+#endif /* BACKENDS_P4TOOLS_COMMON_LIB_CONSTRAINT_SIMPLIFIER_H_ */
@@ -0,0 +1,121 @@
+#ifndef BACKENDS_P4TOOLS_COMMON_LIB_PERSISTENT_H_
+#define BACKENDS_P4TOOLS_COMMON_LIB_PERSISTENT_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace P4Tools {
+
+/// An append-only list whose copies share their common prefix. Copying a list is O(1) and
+/// appending to a copy does not affect the original. Lists are read as a whole through
+/// @ref toVector, or by their most recent elements through @ref suffix. @ref toVector
+/// materializes the elements on the first read and then keeps them up to date on later appends,
+/// so repeated reads are O(1). Copies do not take over the materialized elements, so lists which
+/// are only read through @ref suffix, such as those of pending branches, stay small.
+template <class T>
+class SharedTailList {
+    struct Node {
+        T value;
+        std::shared_ptr<const Node> prev;
+        size_t size;
+    };
+
+    /// The most recently appended element, or nullptr if the list is empty.
+    std::shared_ptr<const Node> last;
+
+    /// The elements of the list in order, or nullptr if they have not been read since the list
+    /// was created or copied.
+    mutable std::unique_ptr<std::vector<T>> elements;
+
+ public:
+    SharedTailList() = default;
+    SharedTailList(const SharedTailList &other) : last(other.last) {}
+    SharedTailList(SharedTailList &&) noexcept = default;
+    SharedTailList &operator=(const SharedTailList &other) {
+        last = other.last;
+        elements = nullptr;
+        return *this;
+    }
+    SharedTailList &operator=(SharedTailList &&) noexcept = default;
+
+    ~SharedTailList() {
+        // Release the nodes only owned by this list one by one. Letting the shared pointers
+        // release each other recursively overflows the stack on long paths.
+        while (last != nullptr && last.use_count() == 1) {
+            auto prev = last->prev;
+            last = std::move(prev);
+        }
+    }
+
+    /// Appends @p value to the list.
+    void push_back(T value) {
+        if (elements != nullptr) {
+            elements->push_back(value);
+        }
+        auto size = this->size() + 1;
+        last = std::make_shared<const Node>(Node{std::move(value), last, size});
+    }
+
+    [[nodiscard]] size_t size() const { return last == nullptr ? 0 : last->size; }
+
+    [[nodiscard]] bool empty() const { return last == nullptr; }
+
+    /// @returns the elements of the list, in the order they were appended. The reference is
+    /// valid until the list is appended to or destroyed.
+    [[nodiscard]] const std::vector<T> &toVector() const {
+        if (elements == nullptr) {
+            elements = std::make_unique<std::vector<T>>();
+            elements->reserve(size());
+            for (const auto *node = last.get(); node != nullptr; node = node->prev.get()) {
+                elements->push_back(node->value);
+            }
+            std::reverse(elements->begin(), elements->end());
+        }
+        return *elements;
+    }
+
+    /// @returns the elements after the first @p from ones, in the order they were appended.
+    /// Only walks these elements and does not materialize the list.
+    [[nodiscard]] std::vector<T> suffix(size_t from) const {
+        std::vector<T> result;
+        for (const auto *node = last.get(); node != nullptr && node->size > from;
+             node = node->prev.get()) {
+            result.push_back(node->value);
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    /// @returns the number of elements materialized by @ref toVector that this list owns.
+    [[nodiscard]] size_t materializedCapacity() const {
+        return elements == nullptr ? 0 : elements->capacity();
+    }
+};
+
+/// A value that is shared between copies until one of them is modified.
+template <class T>
+class CopyOnWrite {
+    std::shared_ptr<T> value = std::make_shared<T>();
+
+ public:
+    /// @returns the value for reading.
+    [[nodiscard]] const T &get() const { return *value; }
+
+    /// @returns the value for writing. The value is copied first if it is shared.
+    T &mutate() {
+        if (value.use_count() > 1) {
+            value = std::make_shared<T>(*value);
+        }
+        return *value;
+    }
+
+    /// @returns whether the value is shared with another copy.
+    [[nodiscard]] bool isShared() const { return value.use_count() > 1; }
+};
+
+}  // namespace P4Tools
+
+#endif /* BACKENDS_P4TOOLS_COMMON_LIB_PERSISTENT_H_ */
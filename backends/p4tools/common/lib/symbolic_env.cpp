@@ -17,15 +17,59 @@
 
 namespace P4Tools {
 
-const IR::Expression *SymbolicEnv::get(const IR::StateVariable &var) const {
+SymbolicEnv::SymbolicEnv(const SymbolicEnv &other) {
+    other.freeze();
+    frozen = other.frozen;
+}
+
+SymbolicEnv &SymbolicEnv::operator=(const SymbolicEnv &other) {
+    if (this != &other) {
+        other.freeze();
+        map.clear();
+        frozen = other.frozen;
+    }
+    return *this;
+}
+
+void SymbolicEnv::freeze() const {
+    if (map.empty()) {
+        return;
+    }
+    SymbolicMapType layerMap = std::move(map);
+    map.clear();
+    auto parent = frozen;
+    // Merge parent layers which are not much larger than the new layer. Existing keys are kept
+    // by insert, so the newer bindings shadow the older ones.
+    while (parent != nullptr && parent->map.size() <= 2 * layerMap.size()) {
+        layerMap.insert(parent->map.begin(), parent->map.end());
+        parent = parent->parent;
+    }
+    frozen = std::make_shared<const Layer>(Layer{std::move(layerMap), std::move(parent)});
+}
+
+const IR::Expression *SymbolicEnv::find(const IR::StateVariable &var) const {
     auto it = map.find(var);
     if (it != map.end()) {
         return it->second;
     }
+    for (const auto *layer = frozen.get(); layer != nullptr; layer = layer->parent.get()) {
+        auto layerIt = layer->map.find(var);
+        if (layerIt != layer->map.end()) {
+            return layerIt->second;
+        }
+    }
+    return nullptr;
+}
+
+const IR::Expression *SymbolicEnv::get(const IR::StateVariable &var) const {
+    const auto *result = find(var);
+    if (result != nullptr) {
+        return result;
+    }
     BUG("Unable to find var %s in the symbolic environment.", var);
 }
 
-bool SymbolicEnv::exists(const IR::StateVariable &var) const { return map.find(var) != map.end(); }
+bool SymbolicEnv::exists(const IR::StateVariable &var) const { return find(var) != nullptr; }
 
 void SymbolicEnv::set(const IR::StateVariable &var, const IR::Expression *value) {
     map[var] = P4::optimizeExpression(value);
@@ -35,13 +79,13 @@ Model *SymbolicEnv::complete(const Model &model) const {
     // Produce a new model based on the input model
     // Add the variables contained in this environment and try to complete them.
     auto *newModel = new Model(model);
-    newModel->complete(map);
+    newModel->complete(getInternalMap());
     return newModel;
 }
 
 Model *SymbolicEnv::evaluate(const Model &model) const {
     // Produce a new model based on the input model
-    return model.evaluate(map);
+    return model.evaluate(getInternalMap());
 }
 
 const IR::Expression *SymbolicEnv::subst(const IR::Expression *expr) const {
@@ -70,7 +114,15 @@ const IR::Expression *SymbolicEnv::subst(const IR::Expression *expr) const {
     return expr->apply(SubstVisitor(*this));
 }
 
-const SymbolicMapType &SymbolicEnv::getInternalMap() const { return map; }
+SymbolicMapType SymbolicEnv::getInternalMap() const {
+    SymbolicMapType result = map;
+    for (const auto *layer = frozen.get(); layer != nullptr; layer = layer->parent.get()) {
+        result.insert(layer->map.begin(), layer->map.end());
+    }
+    return result;
+}
+
+size_t SymbolicEnv::getOwnedSize() const { return map.size(); }
 
 bool SymbolicEnv::isSymbolicValue(const IR::Node *node) {
     // Check the obvious case first.
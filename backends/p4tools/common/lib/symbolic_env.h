@@ -1,6 +1,9 @@
 #ifndef BACKENDS_P4TOOLS_COMMON_LIB_SYMBOLIC_ENV_H_
 #define BACKENDS_P4TOOLS_COMMON_LIB_SYMBOLIC_ENV_H_
 
+#include <cstddef>
+#include <memory>
+
 #include "backends/p4tools/common/lib/model.h"
 #include "ir/ir.h"
 #include "ir/node.h"
@@ -9,11 +12,41 @@ namespace P4Tools {
 
 /// A symbolic environment maps variables to their symbolic value. A symbolic value is just an
 /// expression on the program's initial state.
+///
+/// Environments are persistent: copying an environment freezes its bindings into a layer that is
+/// shared by the original and the copy, and each of them records its later bindings separately.
+/// A copy therefore costs O(1), and each environment only owns the bindings it made since it was
+/// last copied. Small layers are merged into their parents when frozen, which keeps the number of
+/// layers logarithmic in the number of bindings.
 class SymbolicEnv {
  private:
-    SymbolicMapType map;
+    /// A frozen set of bindings. Bindings of a layer shadow those of its parent.
+    struct Layer {
+        SymbolicMapType map;
+        std::shared_ptr<const Layer> parent;
+    };
+
+    /// The bindings made since this environment was last copied. Mutable because copying an
+    /// environment freezes the bindings of the source.
+    mutable SymbolicMapType map;
+
+    /// The bindings shared with other environments.
+    mutable std::shared_ptr<const Layer> frozen;
+
+    /// Moves the bindings of @var map into a new frozen layer.
+    void freeze() const;
+
+    /// @returns the symbolic value of @p var, or nullptr if it is unbound.
+    [[nodiscard]] const IR::Expression *find(const IR::StateVariable &var) const;
 
  public:
+    SymbolicEnv() = default;
+    SymbolicEnv(const SymbolicEnv &other);
+    SymbolicEnv(SymbolicEnv &&) = default;
+    SymbolicEnv &operator=(const SymbolicEnv &other);
+    SymbolicEnv &operator=(SymbolicEnv &&) = default;
+    ~SymbolicEnv() = default;
+
     // Maybe coerce from Model for concrete execution?
 
     /// @returns the symbolic value for the given variable.
@@ -39,8 +72,12 @@ class SymbolicEnv {
     /// Variables that are unbound by this environment are left untouched.
     const IR::Expression *subst(const IR::Expression *expr) const;
 
-    /// @returns The immutable map that is internal to this symbolic environment.
-    [[nodiscard]] const SymbolicMapType &getInternalMap() const;
+    /// @returns all bindings of this symbolic environment as a single map. This is linear in the
+    /// size of the environment; use @ref get for individual variables.
+    [[nodiscard]] SymbolicMapType getInternalMap() const;
+
+    /// @returns the number of bindings owned by this environment, i.e., not shared with copies.
+    [[nodiscard]] size_t getOwnedSize() const;
 
     /// Determines whether the given node represents a symbolic value. Symbolic values may be
     /// stored in the symbolic environment.
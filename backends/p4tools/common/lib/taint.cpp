@@ -25,14 +25,14 @@ const IR::StringLiteral Taint::TAINTED_STRING_LITERAL = IR::StringLiteral(cstrin
 
 /// Returns a bitmask that indicates which bits of given expression are tainted given a complex
 /// expression.
-static bitvec computeTaintedBits(const SymbolicMapType &varMap, const IR::Expression *expr) {
+static bitvec computeTaintedBits(const SymbolicEnv &env, const IR::Expression *expr) {
     CHECK_NULL(expr);
     // TODO: Replace these two with IR::StateVariable.
     if (const auto *member = expr->to<IR::Member>()) {
-        expr = varMap.at(member);
+        expr = env.get(member);
     }
     if (const auto *path = expr->to<IR::PathExpression>()) {
-        expr = varMap.at(path);
+        expr = env.get(path);
     }
     if (expr->is<IR::SymbolicVariable>()) {
         return {};
@@ -43,12 +43,12 @@ static bitvec computeTaintedBits(const SymbolicMapType &varMap, const IR::Expres
     }
 
     if (const auto *concatExpr = expr->to<IR::Concat>()) {
-        auto lTaint = computeTaintedBits(varMap, concatExpr->left);
-        auto rTaint = computeTaintedBits(varMap, concatExpr->right);
+        auto lTaint = computeTaintedBits(env, concatExpr->left);
+        auto rTaint = computeTaintedBits(env, concatExpr->right);
         return (lTaint << concatExpr->right->type->width_bits()) | rTaint;
     }
     if (const auto *slice = expr->to<IR::Slice>()) {
-        auto subTaint = computeTaintedBits(varMap, slice->e0);
+        auto subTaint = computeTaintedBits(env, slice->e0);
         return subTaint.getslice(slice->getL(), slice->type->width_bits());
     }
     if (const auto *binaryExpr = expr->to<IR::Operation_Binary>()) {
@@ -56,35 +56,35 @@ static bitvec computeTaintedBits(const SymbolicMapType &varMap, const IR::Expres
         if (const auto *shl = binaryExpr->to<IR::Shl>()) {
             if (const auto *shiftConst = shl->right->to<IR::Constant>()) {
                 int shift = static_cast<int>(shiftConst->value);
-                return fullmask & (computeTaintedBits(varMap, shl->left) << shift);
+                return fullmask & (computeTaintedBits(env, shl->left) << shift);
             }
             return fullmask;
         }
         if (const auto *shr = binaryExpr->to<IR::Shr>()) {
             if (const auto *shiftConst = shr->right->to<IR::Constant>()) {
                 int shift = static_cast<int>(shiftConst->value);
-                return computeTaintedBits(varMap, shr->left) >> shift;
+                return computeTaintedBits(env, shr->left) >> shift;
             }
             return fullmask;
         }
         if (binaryExpr->is<IR::BAnd>() || binaryExpr->is<IR::BOr>() || binaryExpr->is<IR::BXor>()) {
             // Bitwise binary operations cannot taint other bits than those tainted in either lhs or
             // rhs.
-            return computeTaintedBits(varMap, binaryExpr->left) |
-                   computeTaintedBits(varMap, binaryExpr->right);
+            return computeTaintedBits(env, binaryExpr->left) |
+                   computeTaintedBits(env, binaryExpr->right);
         }
         // Be conservative here. If either of the expressions contain even a single tainted bit, the
         // entire operation is tainted. The reason is that we need to account for overflow. A
         // tainted MSB or LSB can cause an expression to overflow and underflow.
-        auto taintLeft = computeTaintedBits(varMap, binaryExpr->left);
-        auto taintRight = computeTaintedBits(varMap, binaryExpr->right);
+        auto taintLeft = computeTaintedBits(env, binaryExpr->left);
+        auto taintRight = computeTaintedBits(env, binaryExpr->right);
         if (taintLeft.empty() && taintRight.empty()) {
             return {};
         }
         return fullmask;
     }
     if (const auto *unaryExpr = expr->to<IR::Operation_Unary>()) {
-        return computeTaintedBits(varMap, unaryExpr->expr);
+        return computeTaintedBits(env, unaryExpr->expr);
     }
     if (expr->is<IR::Literal>()) {
         return {};
@@ -95,7 +95,7 @@ static bitvec computeTaintedBits(const SymbolicMapType &varMap, const IR::Expres
     BUG("Taint pair collection is unsupported for %1% of type %2%", expr, expr->node_type_name());
 }
 
-bool Taint::hasTaint(const SymbolicMapType &varMap, const IR::Expression *expr) {
+bool Taint::hasTaint(const SymbolicEnv &env, const IR::Expression *expr) {
     if (expr->is<IR::TaintExpression>()) {
         return true;
     }
@@ -104,14 +104,14 @@ bool Taint::hasTaint(const SymbolicMapType &varMap, const IR::Expression *expr)
     }
     // TODO: Replace these two with IR::StateVariable.
     if (const auto *member = expr->to<IR::Member>()) {
-        return hasTaint(varMap, varMap.at(member));
+        return hasTaint(env, env.get(member));
     }
     if (const auto *path = expr->to<IR::PathExpression>()) {
-        return hasTaint(varMap, varMap.at(path));
+        return hasTaint(env, env.get(path));
     }
     if (const auto *structExpr = expr->to<IR::StructExpression>()) {
         for (const auto *subExpr : structExpr->components) {
-            if (hasTaint(varMap, subExpr->expression)) {
+            if (hasTaint(env, subExpr->expression)) {
                 return true;
             }
         }
@@ -119,17 +119,17 @@ bool Taint::hasTaint(const SymbolicMapType &varMap, const IR::Expression *expr)
     }
     if (const auto *listExpr = expr->to<IR::ListExpression>()) {
         for (const auto *subExpr : listExpr->components) {
-            if (hasTaint(varMap, subExpr)) {
+            if (hasTaint(env, subExpr)) {
                 return true;
             }
         }
         return false;
     }
     if (const auto *binaryExpr = expr->to<IR::Operation_Binary>()) {
-        return hasTaint(varMap, binaryExpr->left) || hasTaint(varMap, binaryExpr->right);
+        return hasTaint(env, binaryExpr->left) || hasTaint(env, binaryExpr->right);
     }
     if (const auto *unaryExpr = expr->to<IR::Operation_Unary>()) {
-        return hasTaint(varMap, unaryExpr->expr);
+        return hasTaint(env, unaryExpr->expr);
     }
     if (expr->is<IR::Literal>()) {
         return false;
@@ -137,7 +137,7 @@ bool Taint::hasTaint(const SymbolicMapType &varMap, const IR::Expression *expr)
     if (const auto *slice = expr->to<IR::Slice>()) {
         auto slLeftInt = slice->e1->checkedTo<IR::Constant>()->asInt();
         auto slRightInt = slice->e2->checkedTo<IR::Constant>()->asInt();
-        auto taint = computeTaintedBits(varMap, slice->e0);
+        auto taint = computeTaintedBits(env, slice->e0);
         return !(taint & bitvec(slRightInt, slLeftInt - slRightInt + 1)).empty();
     }
     if (expr->is<IR::DefaultExpression>()) {
@@ -147,7 +147,7 @@ bool Taint::hasTaint(const SymbolicMapType &varMap, const IR::Expression *expr)
 }
 
 class TaintPropagator : public Transform {
-    const SymbolicMapType &varMap;
+    const SymbolicEnv &env;
 
     const IR::Node *postorder(IR::Expression *node) override {
         P4C_UNIMPLEMENTED("Taint transformation not supported for node %1% of type %2%", node,
@@ -176,7 +176,7 @@ class TaintPropagator : public Transform {
     const IR::Node *postorder(IR::Operation_Unary *unary_op) override { return unary_op->expr; }
 
     const IR::Node *postorder(IR::Cast *cast) override {
-        if (Taint::hasTaint(varMap, cast->expr)) {
+        if (Taint::hasTaint(env, cast->expr)) {
             // Try to cast the taint to whatever type is specified.
             auto *taintClone = cast->expr->clone();
             taintClone->type = cast->destType;
@@ -188,7 +188,7 @@ class TaintPropagator : public Transform {
     }
 
     const IR::Node *postorder(IR::Operation_Binary *bin_op) override {
-        if (Taint::hasTaint(varMap, bin_op->right)) {
+        if (Taint::hasTaint(env, bin_op->right)) {
             return bin_op->right;
         }
         return bin_op->left;
@@ -210,7 +210,7 @@ class TaintPropagator : public Transform {
         auto slRightInt = slice->e2->checkedTo<IR::Constant>()->asInt();
         auto width = 1 + slLeftInt - slRightInt;
         const auto *sliceTb = IR::getBitType(width);
-        if (Taint::hasTaint(varMap, slice)) {
+        if (Taint::hasTaint(env, slice)) {
             return ToolsVariables::getTaintExpression(sliceTb);
         }
         // Otherwise we convert the expression to a constant of the sliced type.
@@ -219,7 +219,7 @@ class TaintPropagator : public Transform {
     }
 
  public:
-    explicit TaintPropagator(const SymbolicMapType &varMap) : varMap(varMap) {
+    explicit TaintPropagator(const SymbolicEnv &env) : env(env) {
         visitDagOnce = false;
     }
 };
@@ -256,19 +256,18 @@ class MaskBuilder : public Transform {
     MaskBuilder() { visitDagOnce = false; }
 };
 
-const IR::Literal *Taint::buildTaintMask(const SymbolicMapType &varMap, const Model *completedModel,
+const IR::Literal *Taint::buildTaintMask(const SymbolicEnv &env, const Model *completedModel,
                                          const IR::Expression *programPacket) {
     // First propagate taint and simplify the packet.
-    const auto *taintedPacket = programPacket->apply(TaintPropagator(varMap));
+    const auto *taintedPacket = programPacket->apply(TaintPropagator(env));
     // Then create the mask based on the remaining expressions.
     const auto *mask = taintedPacket->apply(MaskBuilder());
     // Produce the evaluated literal. The hex expression should only have 0 or f.
     return completedModel->evaluate(mask);
 }
 
-const IR::Expression *Taint::propagateTaint(const SymbolicMapType &varMap,
-                                            const IR::Expression *expr) {
-    return expr->apply(TaintPropagator(varMap));
+const IR::Expression *Taint::propagateTaint(const SymbolicEnv &env, const IR::Expression *expr) {
+    return expr->apply(TaintPropagator(env));
 }
 
 const IR::Expression *buildMask(const IR::Expression *expr) { return expr->apply(MaskBuilder()); }
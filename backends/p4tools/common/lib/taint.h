@@ -2,6 +2,7 @@
 #define BACKENDS_P4TOOLS_COMMON_LIB_TAINT_H_
 
 #include "backends/p4tools/common/lib/model.h"
+#include "backends/p4tools/common/lib/symbolic_env.h"
 #include "ir/ir.h"
 
 namespace P4Tools {
@@ -14,17 +15,15 @@ class Taint {
     /// either return a literal, a Member/PathExpression, or a concatenation. Any non-tainted
     /// variable is replaced with a zero constant. This function is used for the generation of taint
     /// masks.
-    static const IR::Expression *propagateTaint(const SymbolicMapType &varMap,
-                                                const IR::Expression *expr);
+    static const IR::Expression *propagateTaint(const SymbolicEnv &env, const IR::Expression *expr);
 
     /// @returns whether the given expression is tainted. An expression is tainted if one or more
     /// bits of the expression are expected to evaluate to (possibly part of) IR::TaintExpression.
-    static bool hasTaint(const SymbolicMapType &varMap, const IR::Expression *expr);
+    static bool hasTaint(const SymbolicEnv &env, const IR::Expression *expr);
 
     /// @returns the mask for the corresponding program packet, indicating bits of the expression
     /// which are not tainted.
-    static const IR::Literal *buildTaintMask(const SymbolicMapType &varMap,
-                                             const Model *completedModel,
+    static const IR::Literal *buildTaintMask(const SymbolicEnv &env, const Model *completedModel,
                                              const IR::Expression *programPacket);
 };
 
@@ -8,6 +8,8 @@
 #include <iomanip>
 #include <optional>
 #include <ratio>
+#include <sstream>
+#include <string>
 
 #include <boost/multiprecision/cpp_int.hpp>
 #include <boost/multiprecision/cpp_int/add.hpp>
@@ -57,6 +59,19 @@ void Utils::setRandomSeed(int seed) {
 
 std::optional<uint32_t> Utils::getCurrentSeed() { return currentSeed; }
 
+std::string Utils::getRandomState() {
+    std::stringstream state;
+    state << rng;
+    return state.str();
+}
+
+void Utils::setRandomState(const std::string &state) {
+    BUG_CHECK(currentSeed.has_value(), "Restoring the random state requires a seed.");
+    std::stringstream stream(state);
+    stream >> rng;
+    BUG_CHECK(!stream.fail(), "Invalid random generator state.");
+}
+
 uint64_t Utils::getRandInt(uint64_t max) {
     if (!currentSeed) {
         return 0;
@@ -86,6 +101,18 @@ const IR::Constant *Utils::getRandConstantForType(const IR::Type_Bits *type) {
     return IR::getConstant(type, randInt);
 }
 
+/* =========================================================================================
+ *  Performance counters.
+ * ========================================================================================= */
+
+std::map<std::string, uint64_t> Utils::counters;
+
+bool Utils::collectCounters = false;
+
+void Utils::enableCounters() { collectCounters = true; }
+
+const std::map<std::string, uint64_t> &Utils::getCounters() { return counters; }
+
 /* =========================================================================================
  *  Other.
  * ========================================================================================= */
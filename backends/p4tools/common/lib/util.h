@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <map>
 #include <optional>
 #include <ostream>
 #include <string>
@@ -67,6 +68,14 @@ class Utils {
     /// @returns currentSeed.
     static std::optional<uint32_t> getCurrentSeed();
 
+    /// @returns the internal state of the random generator, in a textual form which can be
+    /// restored with @ref setRandomState.
+    static std::string getRandomState();
+
+    /// Restores a state of the random generator returned by @ref getRandomState. The generator
+    /// must already be seeded.
+    static void setRandomState(const std::string &state);
+
     /// @returns a random integer in the range [0, @param max]. Always return 0 if no seed is set.
     static uint64_t getRandInt(uint64_t max);
 
@@ -81,6 +90,35 @@ class Utils {
     /// @returns a IR::Constant with a random big integer that fits the specified @param type.
     static const IR::Constant *getRandConstantForType(const IR::Type_Bits *type);
 
+    /* =========================================================================================
+     *  Performance counters.
+     * ========================================================================================= */
+ private:
+    /// Event counters by name, e.g., cache hits and misses. They complement the timers in
+    /// performance reports.
+    static std::map<std::string, uint64_t> counters;
+
+    /// Whether counters are collected. Counting is off by default, because the counters are
+    /// updated on hot paths such as state clones and solver queries.
+    static bool collectCounters;
+
+ public:
+    /// Starts collecting performance counters.
+    static void enableCounters();
+
+    /// @returns true if performance counters are collected.
+    static bool countersEnabled() { return collectCounters; }
+
+    /// Adds @param amount to the performance counter @param name, if counters are enabled.
+    static void addToCounter(const char *name, uint64_t amount = 1) {
+        if (collectCounters) {
+            counters[name] += amount;
+        }
+    }
+
+    /// @returns all performance counters, ordered by name.
+    static const std::map<std::string, uint64_t> &getCounters();
+
     /* =========================================================================================
      *  Other.
      * ========================================================================================= */
@@ -0,0 +1,452 @@
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <inja/inja.hpp>
+
+#include "backends/p4tools/common/lib/util.h"
+#include "lib/crash.h"
+#include "lib/timer.h"
+
+#include "backends/p4tools/modules/testgen/testgen.h"
+
+/// A throughput benchmark for P4Testgen. Every path selection strategy is run on a fixed set of
+/// programs with fixed seeds. Each run is a separate process, so all runs start from the same
+/// global state and the peak memory of a run can be measured. The results are written as JSON
+/// and can be compared against a stored baseline.
+
+namespace P4Tools::P4Testgen::Benchmark {
+
+namespace {
+
+/// The programs of the default suite, relative to the source directory.
+const std::vector<std::string> DEFAULT_PROGRAMS = {
+    "testdata/p4_16_samples/action_profile-bmv2.p4",
+    "testdata/p4_16_samples/basic_routing-bmv2.p4",
+    "testdata/p4_16_samples/checksum1-bmv2.p4",
+    "testdata/p4_16_samples/flowlet_switching-bmv2.p4",
+    "testdata/p4_16_samples/header-stack-ops-bmv2.p4",
+    "testdata/p4_16_samples/stack_complex-bmv2.p4",
+    "testdata/p4_16_samples/table-entries-ternary-bmv2.p4",
+    "testdata/p4_16_samples/v1model-special-ops-bmv2.p4",
+};
+
+/// The path selection strategies of the default suite.
+const std::vector<std::string> DEFAULT_STRATEGIES = {
+    "DEPTH_FIRST",
+    "RANDOM_BACKTRACK",
+    "GREEDY_STATEMENT_SEARCH",
+    "RANDOM_STATEMENT_SEARCH",
+};
+
+/// The metrics which are compared against a baseline, and whether larger values are better.
+const std::vector<std::pair<std::string, bool>> COMPARED_METRICS = {
+    {"tests_per_second", true}, {"solver_calls", false}, {"solver_ms", false},
+    {"state_clones", false},    {"peak_rss_kb", false},
+};
+
+struct BenchmarkOptions {
+    /// The P4 programs to run.
+    std::vector<std::filesystem::path> programs;
+
+    /// The path selection strategies to run.
+    std::vector<std::string> strategies = DEFAULT_STRATEGIES;
+
+    /// Every program and strategy is run once per seed.
+    std::vector<uint32_t> seeds = {1};
+
+    /// The maximum number of tests of a run.
+    int64_t maxTests = 100;
+
+    /// The file the results are written to.
+    std::filesystem::path outputFile = "testgen_benchmark.json";
+
+    /// The directory for the generated tests and the logs of each run.
+    std::filesystem::path workDir = std::filesystem::temp_directory_path() / "p4testgen-benchmark";
+
+    /// The results to compare against.
+    std::optional<std::filesystem::path> baselineFile;
+
+    /// The relative change of a metric which is reported as a regression.
+    double tolerance = 0.1;
+};
+
+void printUsage(const char *name) {
+    std::cerr
+        << "Usage: " << name << " [options]\n"
+        << "  --programs <file>...     The P4 programs to run. Defaults to a fixed set of\n"
+        << "                           BMv2 programs of the p4c test suite.\n"
+        << "  --strategies <s>,...     The path selection strategies to run. Defaults to\n"
+        << "                           all of them.\n"
+        << "  --seeds <n>,...          The seeds of each program and strategy. Default: 1.\n"
+        << "  --max-tests <n>          The maximum number of tests of a run. Default: 100.\n"
+        << "  --output <file>          The JSON file the results are written to.\n"
+        << "                           Default: testgen_benchmark.json.\n"
+        << "  --work-dir <dir>         The directory for generated tests and logs.\n"
+        << "  --baseline <file>        Compares the results against a previous output and\n"
+        << "                           fails if a metric regressed.\n"
+        << "  --tolerance <percent>    The change of a metric which is reported as a\n"
+        << "                           regression. Default: 10.\n";
+}
+
+/// Splits a comma-separated list.
+std::vector<std::string> splitList(const std::string &list) {
+    std::vector<std::string> elements;
+    std::stringstream stream(list);
+    std::string element;
+    while (std::getline(stream, element, ',')) {
+        if (!element.empty()) {
+            elements.push_back(element);
+        }
+    }
+    return elements;
+}
+
+std::optional<BenchmarkOptions> parseOptions(int argc, char **argv) {
+    BenchmarkOptions options;
+    for (int idx = 1; idx < argc; idx++) {
+        std::string arg = argv[idx];
+        bool hasValue = idx + 1 < argc;
+        if (arg == "--programs" && hasValue) {
+            while (idx + 1 < argc && std::strncmp(argv[idx + 1], "--", 2) != 0) {
+                options.programs.emplace_back(argv[++idx]);
+            }
+        } else if (arg == "--strategies" && hasValue) {
+            options.strategies = splitList(argv[++idx]);
+        } else if (arg == "--seeds" && hasValue) {
+            options.seeds.clear();
+            for (const auto &seed : splitList(argv[++idx])) {
+                options.seeds.push_back(static_cast<uint32_t>(std::stoul(seed)));
+            }
+        } else if (arg == "--max-tests" && hasValue) {
+            options.maxTests = std::stoll(argv[++idx]);
+        } else if (arg == "--output" && hasValue) {
+            options.outputFile = argv[++idx];
+        } else if (arg == "--work-dir" && hasValue) {
+            options.workDir = argv[++idx];
+        } else if (arg == "--baseline" && hasValue) {
+            options.baselineFile = argv[++idx];
+        } else if (arg == "--tolerance" && hasValue) {
+            options.tolerance = std::stod(argv[++idx]) / 100;
+        } else {
+            printUsage(argv[0]);
+            return std::nullopt;
+        }
+    }
+    if (options.programs.empty()) {
+        for (const auto &program : DEFAULT_PROGRAMS) {
+            options.programs.emplace_back(std::filesystem::path(TESTGEN_BENCHMARK_SOURCE_DIR) /
+                                          program);
+        }
+    }
+    if (options.strategies.empty() || options.seeds.empty()) {
+        printUsage(argv[0]);
+        return std::nullopt;
+    }
+    return options;
+}
+
+/// Runs P4Testgen in this process and collects the metrics of the run.
+inja::json runTestgen(const std::filesystem::path &program, const std::string &strategy,
+                      uint32_t seed, int64_t maxTests, const std::filesystem::path &outDir) {
+    std::vector<std::string> args = {"p4testgen",
+                                     "--target",
+                                     "bmv2",
+                                     "--arch",
+                                     "v1model",
+                                     "--std",
+                                     "p4-16",
+                                     "--test-backend",
+                                     "STF",
+                                     "--seed",
+                                     std::to_string(seed),
+                                     "--max-tests",
+                                     std::to_string(maxTests),
+                                     "--path-selection",
+                                     strategy,
+                                     "--out-dir",
+                                     outDir.string(),
+                                     program.string()};
+    std::vector<const char *> argv;
+    argv.reserve(args.size());
+    for (const auto &arg : args) {
+        argv.push_back(arg.c_str());
+    }
+
+    inja::json result;
+    int exitCode = EXIT_FAILURE;
+    // Counters are off unless a performance report is requested.
+    Utils::enableCounters();
+    auto start = std::chrono::steady_clock::now();
+    try {
+        exitCode = Testgen().main(argv);
+    } catch (const std::exception &e) {
+        std::cerr << "Internal error: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "Internal error." << std::endl;
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    result["exit_code"] = exitCode;
+    result["seconds"] = elapsed.count();
+
+    const auto &counters = Utils::getCounters();
+    auto getCounter = [&counters](const std::string &name) -> uint64_t {
+        auto it = counters.find(name);
+        return it == counters.end() ? 0 : it->second;
+    };
+    result["solver_calls"] = getCounter("z3_check_sat_calls");
+    result["state_clones"] = getCounter("state_clones");
+    // The solver is timed wherever it is invoked. Every such timer is named "z3". The
+    // exploration, without the compilation of the program, is timed as "exploration".
+    uint64_t solverMs = 0;
+    uint64_t explorationMs = 0;
+    inja::json timers = inja::json::object();
+    for (const auto &timer : Util::getTimers()) {
+        if (timer.timerName.empty()) {
+            continue;
+        }
+        timers[timer.timerName] = timer.milliseconds;
+        auto pos = timer.timerName.rfind('.');
+        auto name = timer.timerName.substr(pos == std::string::npos ? 0 : pos + 1);
+        if (name == "z3") {
+            solverMs += timer.milliseconds;
+        } else if (name == "exploration") {
+            explorationMs += timer.milliseconds;
+        }
+    }
+    // Throughput is measured over the exploration only, so the compilation of the program does
+    // not dilute it.
+    auto tests = getCounter("generated_tests");
+    auto explorationSeconds = static_cast<double>(explorationMs) / 1000;
+    result["tests"] = tests;
+    result["exploration_seconds"] = explorationSeconds;
+    result["tests_per_second"] =
+        explorationSeconds > 0 ? static_cast<double>(tests) / explorationSeconds : 0.0;
+    result["solver_ms"] = solverMs;
+    result["timers"] = timers;
+    result["counters"] = counters;
+    return result;
+}
+
+/// Runs one configuration in a child process. @returns the metrics of the run.
+inja::json runBenchmark(const BenchmarkOptions &options, const std::filesystem::path &program,
+                        const std::string &strategy, uint32_t seed) {
+    inja::json result;
+    result["program"] = program.stem().string();
+    result["strategy"] = strategy;
+    result["seed"] = seed;
+
+    auto runName = program.stem().string() + "_" + strategy + "_" + std::to_string(seed);
+    auto outDir = options.workDir / runName;
+    std::filesystem::create_directories(outDir);
+    auto logFile = options.workDir / (runName + ".log");
+
+    int fds[2];
+    if (pipe(fds) < 0) {
+        std::cerr << "Unable to create a pipe: " << strerror(errno) << std::endl;
+        result["exit_code"] = EXIT_FAILURE;
+        return result;
+    }
+    // Flush before forking so buffered output is not duplicated in the child.
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        std::cerr << "Unable to start a run: " << strerror(errno) << std::endl;
+        close(fds[0]);
+        close(fds[1]);
+        result["exit_code"] = EXIT_FAILURE;
+        return result;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        // The output of P4Testgen goes to the log of the run.
+        int logFd = open(logFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (logFd >= 0) {
+            dup2(logFd, STDOUT_FILENO);
+            dup2(logFd, STDERR_FILENO);
+            close(logFd);
+        }
+        auto metrics = runTestgen(program, strategy, seed, options.maxTests, outDir).dump();
+        std::cout.flush();
+        std::cerr.flush();
+        const char *data = metrics.c_str();
+        size_t remaining = metrics.size();
+        while (remaining > 0) {
+            auto written = write(fds[1], data, remaining);
+            if (written <= 0) {
+                break;
+            }
+            data += written;
+            remaining -= written;
+        }
+        close(fds[1]);
+        // Do not run the parent's exit handlers in the child.
+        _exit(EXIT_SUCCESS);
+    }
+    close(fds[1]);
+    std::string metrics;
+    char buffer[4096];
+    ssize_t bytes = 0;
+    while ((bytes = read(fds[0], buffer, sizeof(buffer))) > 0) {
+        metrics.append(buffer, bytes);
+    }
+    close(fds[0]);
+
+    int status = 0;
+    struct rusage usage {};
+    if (wait4(pid, &status, 0, &usage) < 0 || !WIFEXITED(status) || metrics.empty()) {
+        std::cerr << runName << ": the run crashed. See " << logFile.string() << std::endl;
+        result["exit_code"] = EXIT_FAILURE;
+        return result;
+    }
+    try {
+        result.update(inja::json::parse(metrics));
+    } catch (const std::exception &e) {
+        std::cerr << runName << ": unable to read the results: " << e.what() << std::endl;
+        result["exit_code"] = EXIT_FAILURE;
+        return result;
+    }
+    // On Linux, ru_maxrss is measured in kilobytes.
+    result["peak_rss_kb"] = usage.ru_maxrss;
+    if (result["exit_code"] != EXIT_SUCCESS) {
+        std::cerr << runName << ": P4Testgen failed. See " << logFile.string() << std::endl;
+    }
+    return result;
+}
+
+/// @returns the key which identifies a run in a baseline.
+std::string getRunKey(const inja::json &run) {
+    return run.at("program").get<std::string>() + "/" + run.at("strategy").get<std::string>() +
+           "/" + std::to_string(run.at("seed").get<uint32_t>());
+}
+
+/// Compares @p results against @p baseline. @returns the number of regressions.
+size_t compareResults(const inja::json &results, const inja::json &baseline, double tolerance) {
+    std::map<std::string, inja::json> baselineRuns;
+    for (const auto &run : baseline.at("runs")) {
+        baselineRuns.emplace(getRunKey(run), run);
+    }
+    if (baseline.value("max_tests", int64_t(0)) != results.at("max_tests").get<int64_t>()) {
+        std::cerr << "The baseline was recorded with a different --max-tests." << std::endl;
+    }
+
+    size_t regressions = 0;
+    std::cout << "============ Comparison with the baseline ============\n";
+    for (const auto &run : results.at("runs")) {
+        auto key = getRunKey(run);
+        auto it = baselineRuns.find(key);
+        if (it == baselineRuns.end()) {
+            std::cout << key << ": not in the baseline\n";
+            continue;
+        }
+        const auto &previous = it->second;
+        if (run.value("exit_code", EXIT_FAILURE) != EXIT_SUCCESS ||
+            previous.value("exit_code", EXIT_FAILURE) != EXIT_SUCCESS) {
+            continue;
+        }
+        if (run.at("tests") != previous.at("tests")) {
+            std::cout << key << ": generated " << run.at("tests") << " tests instead of "
+                      << previous.at("tests") << "\n";
+        }
+        for (const auto &[metric, largerIsBetter] : COMPARED_METRICS) {
+            auto before = previous.value(metric, 0.0);
+            auto after = run.value(metric, 0.0);
+            if (before <= 0) {
+                continue;
+            }
+            auto change = (after - before) / before;
+            bool regressed = largerIsBetter ? change < -tolerance : change > tolerance;
+            if (!regressed) {
+                continue;
+            }
+            regressions++;
+            std::stringstream percentage;
+            percentage << std::showpos << std::fixed << std::setprecision(1) << change * 100;
+            std::cout << "REGRESSION " << key << ": " << metric << " " << before << " -> "
+                      << after << " (" << percentage.str() << " %)\n";
+        }
+    }
+    std::cout << regressions << " regressions\n";
+    return regressions;
+}
+
+int runBenchmarks(const BenchmarkOptions &options) {
+    std::filesystem::create_directories(options.workDir);
+    inja::json results;
+    results["max_tests"] = options.maxTests;
+    results["runs"] = inja::json::array();
+    bool failed = false;
+    for (const auto &program : options.programs) {
+        for (const auto &strategy : options.strategies) {
+            for (auto seed : options.seeds) {
+                auto run = runBenchmark(options, program, strategy, seed);
+                failed = failed || run.value("exit_code", EXIT_FAILURE) != EXIT_SUCCESS;
+                if (run.contains("tests_per_second")) {
+                    std::cout << getRunKey(run) << ": " << run.at("tests") << " tests, "
+                              << run.at("tests_per_second") << " tests/s, "
+                              << run.at("solver_calls") << " solver calls, "
+                              << run.at("solver_ms") << " ms in the solver, "
+                              << run.at("state_clones") << " state clones, "
+                              << run.at("peak_rss_kb") << " KB peak RSS" << std::endl;
+                }
+                results["runs"].push_back(run);
+            }
+        }
+    }
+
+    std::ofstream output(options.outputFile);
+    output << std::setw(2) << results << std::endl;
+    if (output.fail()) {
+        std::cerr << "Unable to write " << options.outputFile.string() << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "Results written to " << options.outputFile.string() << std::endl;
+
+    if (options.baselineFile.has_value()) {
+        std::ifstream baselineStream(options.baselineFile.value());
+        inja::json baseline;
+        try {
+            baselineStream >> baseline;
+        } catch (const std::exception &e) {
+            std::cerr << "Unable to read the baseline " << options.baselineFile.value().string()
+                      << ": " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (compareResults(results, baseline, options.tolerance) > 0) {
+            failed = true;
+        }
+    }
+    return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+}  // namespace
+
+}  // namespace P4Tools::P4Testgen::Benchmark
+
+int main(int argc, char **argv) {
+    setup_signals();
+
+    auto options = P4Tools::P4Testgen::Benchmark::parseOptions(argc, argv);
+    if (!options.has_value()) {
+        return EXIT_FAILURE;
+    }
+    return P4Tools::P4Testgen::Benchmark::runBenchmarks(options.value());
+}
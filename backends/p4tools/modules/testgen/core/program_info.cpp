@@ -30,7 +30,10 @@ ProgramInfo::ProgramInfo(const IR::P4Program *program) : concolicMethodImpls({})
     auto coverage = P4::Coverage::CollectNodes(TestgenOptions::get().coverageOptions);
     program->apply(coverage);
     auto coveredNodes = coverage.getCoverableNodes();
-    coverableNodes.insert(coveredNodes.begin(), coveredNodes.end());
+    coverableNodes |= coveredNodes;
+    if (dcg != nullptr) {
+        reachabilityIndex = new ReachabilityIndex(*dcg, coverableNodes);
+    }
 }
 
 /* =============================================================================================
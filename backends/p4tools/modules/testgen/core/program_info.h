@@ -50,7 +50,10 @@ class ProgramInfo : public ICastable {
     const IR::P4Program *program;
 
     /// The generated dcg.
-    const NodesCallGraph *dcg;
+    const NodesCallGraph *dcg = nullptr;
+
+    /// The reachability index of the dcg. Only set if the dcg is generated.
+    const ReachabilityIndex *reachabilityIndex = nullptr;
 
     /// @returns the series of nodes that has been computed by this particular target.
     [[nodiscard]] const std::vector<Continuation::Command> *getPipelineSequence() const;
@@ -328,14 +328,18 @@ const IR::Literal *AbstractStepper::evaluateExpression(
     const IR::Expression *expr, std::optional<const IR::Expression *> cond) const {
     BUG_CHECK(solver.isInIncrementalMode(),
               "Currently, expression valuation only supports an incremental solver.");
-    auto constraints = state.getPathConstraint();
+    const auto &pathConstraint = state.getPathConstraint();
     expr = state.getSymbolicEnv().subst(expr);
     expr = P4::optimizeExpression(expr);
     // Assert the path constraint to the solver and check whether it is satisfiable.
+    std::optional<bool> solverResult;
     if (cond) {
+        auto constraints = pathConstraint;
         constraints.push_back(*cond);
+        solverResult = solver.checkSat(constraints);
+    } else {
+        solverResult = solver.checkSat(pathConstraint);
     }
-    auto solverResult = solver.checkSat(constraints);
     // If the solver can find a solution under the given condition, get the model and return the
     // value.
     const IR::Literal *result = nullptr;
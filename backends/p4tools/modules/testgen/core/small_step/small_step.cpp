@@ -9,6 +9,7 @@
 
 #include "backends/p4tools/common/compiler/reachability.h"
 #include "backends/p4tools/common/core/solver.h"
+#include "backends/p4tools/common/lib/constraint_simplifier.h"
 #include "backends/p4tools/common/lib/symbolic_env.h"
 #include "backends/p4tools/common/lib/trace_event.h"
 #include "frontends/p4/optimizeExpressions.h"
@@ -29,6 +30,18 @@
 
 namespace P4Tools::P4Testgen {
 
+namespace {
+
+/// Simplifies a branch condition, which has been evaluated in the symbolic environment.
+const IR::Expression *simplifyConstraint(const IR::Expression *constraint) {
+    if (!TestgenOptions::get().simplifyConstraints) {
+        return P4::optimizeExpression(constraint);
+    }
+    return ConstraintSimplifier::simplify(constraint);
+}
+
+}  // namespace
+
 SmallStepEvaluator::Branch::Branch(ExecutionState &nextState)
     : constraint(IR::getBoolLiteral(true)), nextState(nextState) {}
 
@@ -40,7 +53,7 @@ SmallStepEvaluator::Branch::Branch(std::optional<const Constraint *> c,
         // Substitutes all variables to their symbolic value (expression on the program's initial
         // state).
         constraint = prevState.getSymbolicEnv().subst(*c);
-        constraint = P4::optimizeExpression(constraint);
+        constraint = simplifyConstraint(constraint);
         // Append the evaluated and optimized constraint to the next execution state's list of
         // path constraints.
         nextState.pushPathConstraint(constraint);
@@ -58,7 +71,7 @@ SmallStepEvaluator::Branch::Branch(std::optional<const Constraint *> c,
         // Substitutes all variables to their symbolic value (expression on the program's initial
         // state).
         constraint = prevState.getSymbolicEnv().subst(*c);
-        constraint = P4::optimizeExpression(constraint);
+        constraint = simplifyConstraint(constraint);
         // Append the evaluated and optimized constraint to the next execution state's list of
         // path constraints.
         nextState.pushPathConstraint(constraint);
@@ -68,8 +81,8 @@ SmallStepEvaluator::Branch::Branch(std::optional<const Constraint *> c,
 SmallStepEvaluator::SmallStepEvaluator(AbstractSolver &solver, const ProgramInfo &programInfo)
     : programInfo(programInfo), solver(solver) {
     if (!TestgenOptions::get().pattern.empty()) {
-        reachabilityEngine =
-            new ReachabilityEngine(*programInfo.dcg, TestgenOptions::get().pattern, true);
+        reachabilityEngine = new ReachabilityEngine(
+            *programInfo.dcg, *programInfo.reachabilityIndex, TestgenOptions::get().pattern, true);
     }
 }
 
@@ -201,12 +214,18 @@ class CommandVisitor {
         // If the guard condition is tainted, treat it equivalent to an invalid state.get().
         if (!state.get().hasTaint(cond)) {
             cond = state.get().getSymbolicEnv().subst(cond);
-            cond = P4::optimizeExpression(cond);
+            cond = simplifyConstraint(cond);
             // Check whether the condition is satisfiable in the current execution
             // state.get().
-            auto pathConstraints = state.get().getPathConstraint();
-            pathConstraints.push_back(cond);
-            solverResult = self.get().solver.checkSat(pathConstraints);
+            const auto &pathConstraint = state.get().getPathConstraint();
+            if (TestgenOptions::get().simplifyConstraints) {
+                solverResult = ConstraintSimplifier::decide(pathConstraint, cond);
+            }
+            if (!solverResult.has_value()) {
+                auto pathConstraints = pathConstraint;
+                pathConstraints.push_back(cond);
+                solverResult = self.get().solver.checkSat(pathConstraints);
+            }
         }
 
         auto &nextState = state.get().clone();
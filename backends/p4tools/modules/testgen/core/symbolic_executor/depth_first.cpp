@@ -39,6 +39,17 @@ bool DepthFirstSearch::pickSuccessor(StepResult successors) {
     return true;
 }
 
+std::optional<std::vector<std::vector<uint64_t>>> DepthFirstSearch::getPendingPaths() const {
+    std::vector<std::vector<uint64_t>> paths;
+    paths.reserve(unexploredBranches.size());
+    for (const auto &branch : unexploredBranches) {
+        paths.push_back(branch.nextState.get().getPathDecisions());
+    }
+    return paths;
+}
+
+void DepthFirstSearch::addPendingBranch(const Branch &branch) { unexploredBranches.push_back(branch); }
+
 void DepthFirstSearch::run(const Callback &callback) {
     while (true) {
         try {
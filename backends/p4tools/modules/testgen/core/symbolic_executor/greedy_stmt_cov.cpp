@@ -27,21 +27,13 @@ std::optional<SymbolicExecutor::Branch> GreedyStmtSelection::popPotentialBranch(
     for (size_t idx = 0; idx < candidateBranches.size(); ++idx) {
         auto branch = candidateBranches.at(idx);
         // First check all the potential set of statements we can cover by looking ahead.
-        for (const auto &stmt : branch.potentialStatements) {
-            if (coveredStatements.count(stmt) == 0U) {
-                candidateBranches[idx] = candidateBranches.back();
-                candidateBranches.pop_back();
-                return branch;
-            }
-        }
         // If we did not find anything, check whether this state covers any new statements
         // already.
-        for (const auto &stmt : branch.nextState.get().getVisited()) {
-            if (coveredStatements.count(stmt) == 0U) {
-                candidateBranches[idx] = candidateBranches.back();
-                candidateBranches.pop_back();
-                return branch;
-            }
+        if (branch.potentialStatements.hasNodesNotIn(coveredStatements) ||
+            branch.nextState.get().getVisited().hasNodesNotIn(coveredStatements)) {
+            candidateBranches[idx] = candidateBranches.back();
+            candidateBranches.pop_back();
+            return branch;
         }
     }
     return std::nullopt;
@@ -166,15 +166,9 @@ void RandomMaxStmtCoverage::updateBufferRankings() {
 void RandomMaxStmtCoverage::sortBranchesByCoverage(std::vector<Branch> &branches) {
     // Transfers branches to rankedBranches and sorts them by coverage
     for (const auto &localBranch : branches) {
-        // Calculate coverage for each branch:
-        uint64_t lookAheadCoverage = 0;
-        for (const auto &stmt : localBranch.potentialStatements) {
-            // We need to take into account the set of visitedNodes.
-            // We also need to ensure the statement is in allStatements.
-            if (visitedNodes.count(stmt) == 0U && stmt->getSourceInfo().isValid()) {
-                lookAheadCoverage++;
-            }
-        }
+        // Calculate coverage for each branch. We need to take into account the set of
+        // visitedNodes. The lookahead only collects statements with a valid source position.
+        uint64_t lookAheadCoverage = localBranch.potentialStatements.countNotIn(visitedNodes);
         auto coverage = lookAheadCoverage + visitedNodes.size();
 
         // If there's no element in bufferUnexploredBranches with the particular coverage
@@ -34,6 +34,17 @@ bool RandomBacktrack::pickSuccessor(StepResult successors) {
     return true;
 }
 
+std::optional<std::vector<std::vector<uint64_t>>> RandomBacktrack::getPendingPaths() const {
+    std::vector<std::vector<uint64_t>> paths;
+    paths.reserve(unexploredBranches.size());
+    for (const auto &branch : unexploredBranches) {
+        paths.push_back(branch.nextState.get().getPathDecisions());
+    }
+    return paths;
+}
+
+void RandomBacktrack::addPendingBranch(const Branch &branch) { unexploredBranches.push_back(branch); }
+
 void RandomBacktrack::run(const Callback &callback) {
     while (true) {
         try {
@@ -1,6 +1,8 @@
 #ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_RANDOM_BACKTRACK_H_
 #define BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_RANDOM_BACKTRACK_H_
 
+#include <cstdint>
+#include <optional>
 #include <vector>
 
 #include "backends/p4tools/common/core/solver.h"
@@ -21,9 +23,15 @@ class RandomBacktrack : public SymbolicExecutor {
     /// Otherwise, execution of the P4 program continues on a different random path.
     void run(const Callback &callBack) override;
 
+    [[nodiscard]] std::optional<std::vector<std::vector<uint64_t>>> getPendingPaths()
+        const override;
+
     /// Constructor for this strategy, considering inheritance
     RandomBacktrack(AbstractSolver &solver, const ProgramInfo &programInfo);
 
+ protected:
+    void addPendingBranch(const Branch &branch) override;
+
  private:
     /// General unexplored branches.
     // Each element on this vector represents a set of alternative choices that could have been
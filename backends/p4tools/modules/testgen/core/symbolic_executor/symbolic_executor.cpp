@@ -1,13 +1,17 @@
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/symbolic_executor.h"
 
 #include <algorithm>
+#include <deque>
 #include <fstream>
 #include <iterator>
+#include <map>
 #include <optional>
 #include <string>
+#include <variant>
 #include <vector>
 
 #include "backends/p4tools/common/core/solver.h"
+#include "backends/p4tools/common/lib/constraint_simplifier.h"
 #include "backends/p4tools/common/lib/util.h"
 #include "ir/ir.h"
 #include "lib/error.h"
@@ -16,23 +20,180 @@
 
 #include "backends/p4tools/modules/testgen/core/program_info.h"
 #include "backends/p4tools/modules/testgen/core/small_step/small_step.h"
+#include "backends/p4tools/modules/testgen/core/symbolic_executor/path_selection.h"
+#include "backends/p4tools/modules/testgen/lib/exceptions.h"
 #include "backends/p4tools/modules/testgen/lib/execution_state.h"
 #include "backends/p4tools/modules/testgen/lib/final_state.h"
 #include "backends/p4tools/modules/testgen/lib/logging.h"
+#include "backends/p4tools/modules/testgen/options.h"
 
 namespace P4Tools::P4Testgen {
 
 SymbolicExecutor::StepResult SymbolicExecutor::step(ExecutionState &state) {
     Util::ScopedTimer st("step");
+    // The successors extend the path constraint of the state, which may become one of them.
+    auto prefixSize = state.getPathConstraintSize();
     StepResult successors = evaluator.step(state);
-    // Remove any successors that are unsatisfiable.
-    successors->erase(
-        std::remove_if(successors->begin(), successors->end(),
-                       [this](const Branch &b) -> bool { return !evaluateBranch(b, solver); }),
-        successors->end());
+    // Remove any successors that are unsatisfiable. The shared path constraint is read once from
+    // the stepped state, so that the successors, which may stay pending for a long time, do not
+    // keep a copy of their whole path constraint.
+    std::vector<const IR::Expression *> query;
+    if (std::any_of(successors->begin(), successors->end(),
+                    [](const Branch &b) { return !b.constraint->is<IR::BoolLiteral>(); })) {
+        const auto &pathConstraint = state.getPathConstraint();
+        query.assign(pathConstraint.begin(), pathConstraint.begin() + prefixSize);
+    }
+    successors->erase(std::remove_if(successors->begin(), successors->end(),
+                                     [this, &query, prefixSize](const Branch &b) -> bool {
+                                         return !evaluateBranch(b, query, prefixSize, solver);
+                                     }),
+                      successors->end());
+    if (successors->size() > 1) {
+        for (uint64_t bIdx = 0; bIdx < successors->size(); ++bIdx) {
+            (*successors)[bIdx].nextState.get().pushPathDecision(bIdx + 1);
+        }
+        // Extend the lookahead of each branch with all coverable nodes the branch can still
+        // reach in the DCG. Only the coverage-guided strategies rank branches by these nodes.
+        const auto *reachabilityIndex = programInfo.reachabilityIndex;
+        if (reachabilityIndex != nullptr &&
+            requiresLookahead(TestgenOptions::get().pathSelectionPolicy)) {
+            for (auto &branch : *successors) {
+                auto nextCmd = branch.nextState.get().getNextCmd();
+                if (!nextCmd.has_value()) {
+                    continue;
+                }
+                const auto *const *node = std::get_if<const IR::Node *>(&nextCmd.value());
+                if (node == nullptr) {
+                    continue;
+                }
+                if (const auto *reachable = reachabilityIndex->getReachableNodes(*node)) {
+                    branch.potentialStatements |= *reachable;
+                }
+            }
+        }
+    }
+    // Track how much memory a pending branch costs. Most of a state is shared with its parent.
+    if (Utils::countersEnabled()) {
+        for (const auto &branch : *successors) {
+            Utils::addToCounter("branch_state_bytes", branch.nextState.get().getOwnedBytes());
+            Utils::addToCounter("branch_states");
+        }
+    }
     return successors;
 }
 
+std::optional<std::vector<std::vector<uint64_t>>> SymbolicExecutor::getPendingPaths() const {
+    return std::nullopt;
+}
+
+void SymbolicExecutor::addPendingBranch(const Branch & /*branch*/) {
+    BUG("This path selection strategy does not support checkpoints.");
+}
+
+void SymbolicExecutor::replayPaths(ExecutionState &state, const std::vector<size_t> &group,
+                                   size_t depth, const std::vector<std::vector<uint64_t>> &paths,
+                                   std::vector<std::optional<Branch>> &restored) {
+    std::reference_wrapper<ExecutionState> current = state;
+    while (true) {
+        StepResult successors = current.get().isTerminal() ? nullptr : step(current.get());
+        if (successors == nullptr || successors->empty()) {
+            ::warning("Unable to replay %1% pending paths: the path ends early.", group.size());
+            return;
+        }
+        if (successors->size() == 1) {
+            current = successors->at(0).nextState;
+            continue;
+        }
+        // Split the group by the decision taken at this branch point.
+        std::map<uint64_t, std::vector<size_t>> subgroups;
+        for (auto pathIdx : group) {
+            subgroups[paths[pathIdx][depth]].push_back(pathIdx);
+        }
+        for (const auto &[decision, subgroup] : subgroups) {
+            if (decision == 0 || decision > successors->size()) {
+                ::warning("Unable to replay %1% pending paths: branch %2% does not exist.",
+                          subgroup.size(), decision);
+                continue;
+            }
+            const auto &branch = successors->at(decision - 1);
+            std::vector<size_t> longer;
+            for (auto pathIdx : subgroup) {
+                if (paths[pathIdx].size() == depth + 1) {
+                    restored[pathIdx] = branch;
+                } else {
+                    longer.push_back(pathIdx);
+                }
+            }
+            if (!longer.empty()) {
+                // Replay the longer paths on a copy, the branch itself may be pending.
+                replayPaths(branch.nextState.get().clone(), longer, depth + 1, paths, restored);
+            }
+        }
+        return;
+    }
+}
+
+bool SymbolicExecutor::restorePendingPaths(const std::vector<std::vector<uint64_t>> &paths) {
+    std::vector<size_t> group;
+    for (size_t pathIdx = 0; pathIdx < paths.size(); pathIdx++) {
+        if (paths[pathIdx].empty()) {
+            ::warning("Ignoring an empty pending path.");
+            continue;
+        }
+        group.push_back(pathIdx);
+    }
+    std::vector<std::optional<Branch>> restored(paths.size());
+    if (!group.empty()) {
+        replayPaths(executionState, group, 0, paths, restored);
+    }
+    // Keep the order of the paths. The last one is explored next, like a branch which a strategy
+    // just took from its pending branches.
+    std::optional<Branch> last;
+    for (const auto &branch : restored) {
+        if (!branch.has_value()) {
+            continue;
+        }
+        if (last.has_value()) {
+            addPendingBranch(*last);
+        }
+        last = branch;
+    }
+    if (!last.has_value()) {
+        return false;
+    }
+    executionState = last->nextState;
+    return true;
+}
+
+std::vector<std::reference_wrapper<ExecutionState>> SymbolicExecutor::expandFrontier(
+    size_t minSize) {
+    std::vector<std::reference_wrapper<ExecutionState>> terminal;
+    std::deque<std::reference_wrapper<ExecutionState>> pending = {executionState};
+    while (!pending.empty() && terminal.size() + pending.size() < minSize) {
+        auto state = pending.front();
+        pending.pop_front();
+        if (state.get().isTerminal()) {
+            terminal.push_back(state);
+            continue;
+        }
+        try {
+            for (const auto &branch : *step(state)) {
+                pending.push_back(branch.nextState);
+            }
+        } catch (TestgenUnimplemented &e) {
+            // Like the strategies, drop the path unless strict is enabled.
+            if (TestgenOptions::get().strict) {
+                throw;
+            }
+            ::warning("Path encountered unimplemented feature. Message: %1%\n", e.what());
+        }
+    }
+    terminal.insert(terminal.end(), pending.begin(), pending.end());
+    return terminal;
+}
+
+void SymbolicExecutor::setInitialState(ExecutionState &state) { executionState = state; }
+
 bool SymbolicExecutor::handleTerminalState(const Callback &callback,
                                            const ExecutionState &terminalState) {
     // Check the solver for satisfiability. If it times out or reports non-satisfiability, issue
@@ -56,15 +217,33 @@ bool SymbolicExecutor::handleTerminalState(const Callback &callback,
 }
 
 bool SymbolicExecutor::evaluateBranch(const SymbolicExecutor::Branch &branch,
-                                      AbstractSolver &solver) {
+                                      std::vector<const IR::Expression *> &query,
+                                      size_t prefixSize, AbstractSolver &solver) {
     // Do not bother invoking the solver for a trivial case.
     // In either case (true or false), we do not need to add the assertion and check.
     if (const auto *boolLiteral = branch.constraint->to<IR::BoolLiteral>()) {
         return boolLiteral->value;
     }
 
+    // Complete the path constraint of the branch with the constraints added by this step.
+    query.resize(prefixSize);
+    auto newConstraints = branch.nextState.get().getPathConstraintSuffix(prefixSize);
+    query.insert(query.end(), newConstraints.begin(), newConstraints.end());
+
+    // The branch constraint is the last path constraint. States are only stepped once their
+    // path constraints are known to be satisfiable, so the branch is feasible iff the branch
+    // constraint is consistent with the constraints before it.
+    if (TestgenOptions::get().simplifyConstraints && !query.empty() &&
+        query.back() == branch.constraint) {
+        auto decided =
+            ConstraintSimplifier::decide(query.begin(), query.end() - 1, branch.constraint);
+        if (decided.has_value()) {
+            return *decided;
+        }
+    }
+
     // Check the consistency of the path constraints asserted so far.
-    auto solverResult = solver.checkSat(branch.nextState.get().getPathConstraint());
+    auto solverResult = solver.checkSat(query);
     if (solverResult == std::nullopt) {
         ::warning("Solver timed out");
     }
@@ -95,7 +274,7 @@ SymbolicExecutor::SymbolicExecutor(AbstractSolver &solver, const ProgramInfo &pr
 }
 
 void SymbolicExecutor::updateVisitedNodes(const P4::Coverage::CoverageSet &newNodes) {
-    visitedNodes.insert(newNodes.begin(), newNodes.end());
+    visitedNodes |= newNodes;
 }
 
 const P4::Coverage::CoverageSet &SymbolicExecutor::getVisitedNodes() { return visitedNodes; }
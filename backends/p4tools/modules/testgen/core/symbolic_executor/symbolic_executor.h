@@ -1,8 +1,10 @@
 #ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_SYMBOLIC_EXECUTOR_H_
 #define BACKENDS_P4TOOLS_MODULES_TESTGEN_CORE_SYMBOLIC_EXECUTOR_SYMBOLIC_EXECUTOR_H_
 
+#include <cstddef>
 #include <functional>
 #include <iosfwd>
+#include <optional>
 #include <vector>
 
 #include "backends/p4tools/common/core/solver.h"
@@ -56,6 +58,31 @@ class SymbolicExecutor {
     /// Update the set of visited statements.
     void updateVisitedNodes(const P4::Coverage::CoverageSet &newNodes);
 
+    /// Explores the top of the execution tree breadth-first from the current state, until at
+    /// least @p minSize states are found or every path has ended. @returns the reached states:
+    /// the terminal ones first, then the others in the order they were reached. Their subtrees
+    /// are disjoint and together cover the whole tree, so they can be explored independently,
+    /// e.g. by several workers. The order only depends on the program, the options and the seed.
+    std::vector<std::reference_wrapper<ExecutionState>> expandFrontier(size_t minSize);
+
+    /// Continues the exploration from @p state, e.g. one of the states returned by
+    /// @ref expandFrontier. The strategy must not have pending branches.
+    void setInitialState(ExecutionState &state);
+
+    /// @returns the branch decisions leading to each pending state of the exploration, in the
+    /// order in which the strategy keeps them, or std::nullopt if the strategy does not support
+    /// checkpoints. A decision is the 1-based index of the branch taken at a branch point, as
+    /// accepted by --input-branches.
+    [[nodiscard]] virtual std::optional<std::vector<std::vector<uint64_t>>> getPendingPaths()
+        const;
+
+    /// Continues an exploration saved by @ref getPendingPaths. The paths are replayed from the
+    /// initial state, sharing common prefixes. The last path becomes the current state and the
+    /// others are pending branches of the strategy. Paths which can not be replayed are dropped
+    /// with a warning.
+    /// @returns false if no path could be replayed.
+    bool restorePendingPaths(const std::vector<std::vector<uint64_t>> &paths);
+
  protected:
     /// Target-specific information about the P4 program.
     const ProgramInfo &programInfo;
@@ -79,12 +106,21 @@ class SymbolicExecutor {
     bool handleTerminalState(const Callback &callback, const ExecutionState &terminalState);
 
     /// Take one step in the program and return list of possible branches.
+    /// If there is more than one feasible branch, each records its index as a path decision.
     StepResult step(ExecutionState &state);
 
+    /// Adds @p branch to the pending branches of the strategy. Only called by
+    /// @ref restorePendingPaths, for strategies which implement @ref getPendingPaths.
+    virtual void addPendingBranch(const Branch &branch);
+
     /// Take a branch and a solver as input.
     /// Compute the branch's path conditions using the solver.
     /// Return true if the solver can find a solution and does not time out.
-    static bool evaluateBranch(const SymbolicExecutor::Branch &branch, AbstractSolver &solver);
+    /// The first @p prefixSize elements of @p query are the path constraint of the stepped state.
+    /// Only the constraints added by the step are read from the branch and appended to them.
+    static bool evaluateBranch(const SymbolicExecutor::Branch &branch,
+                               std::vector<const IR::Expression *> &query, size_t prefixSize,
+                               AbstractSolver &solver);
 
     /// Select a branch at random from the input @param candidateBranches.
     //  Remove the branch from the container.
@@ -93,6 +129,12 @@ class SymbolicExecutor {
 
  private:
     SmallStepEvaluator evaluator;
+
+    /// Replays the paths @p group of @p paths from @p state, whose first @p depth decisions have
+    /// already been taken. Replayed branches are stored in @p restored at the index of their path.
+    void replayPaths(ExecutionState &state, const std::vector<size_t> &group, size_t depth,
+                     const std::vector<std::vector<uint64_t>> &paths,
+                     std::vector<std::optional<Branch>> &restored);
 };
 
 }  // namespace P4Tools::P4Testgen
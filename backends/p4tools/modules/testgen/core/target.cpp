@@ -4,12 +4,14 @@
 #include <utility>
 
 #include "backends/p4tools/common/core/target.h"
+#include "backends/p4tools/common/lib/constraint_simplifier.h"
 #include "ir/declaration.h"
 #include "ir/ir.h"
 #include "ir/node.h"
 #include "lib/enumerator.h"
 #include "lib/exceptions.h"
 #include "lib/log.h"
+#include "midend/coverage.h"
 
 #include "backends/p4tools/modules/testgen/core/program_info.h"
 
@@ -47,6 +49,10 @@ TestBackEnd *TestgenTarget::getTestBackend(const ProgramInfo &programInfo, Symbo
 }
 
 const ProgramInfo *TestgenTarget::initProgram(const IR::P4Program *program) {
+    // Coverage numbers and memoized simplifications of a previous program must not leak into
+    // this one.
+    P4::Coverage::CoverageIndex::get().reset();
+    ConstraintSimplifier::reset();
     return get().initProgramImpl(program);
 }
 
@@ -0,0 +1,88 @@
+#include "backends/p4tools/modules/testgen/lib/checkpoint.h"
+
+#include <fstream>
+#include <system_error>
+
+#include "lib/error.h"
+#include "nlohmann/json.hpp"
+
+namespace P4Tools::P4Testgen {
+
+namespace {
+
+/// Version of the checkpoint format. Bumped whenever the format changes.
+constexpr int CHECKPOINT_VERSION = 3;
+
+}  // namespace
+
+P4::Coverage::CoverageSet Checkpoint::getCoveredNodes(
+    const P4::Coverage::CoverageSet &coverableNodes) const {
+    std::vector<std::string> unknownIds;
+    auto nodes = P4::Coverage::findStableIds(coverableNodes, coveredNodes, &unknownIds);
+    for (const auto &id : unknownIds) {
+        ::warning("Checkpoint: ignoring unknown covered node %1%.", id);
+    }
+    return nodes;
+}
+
+void Checkpoint::setCoveredNodes(const P4::Coverage::CoverageSet &nodes) {
+    coveredNodes = P4::Coverage::getStableIds(nodes);
+}
+
+bool Checkpoint::save(const std::filesystem::path &path) const {
+    nlohmann::json json;
+    json["version"] = CHECKPOINT_VERSION;
+    json["test_count"] = testCount;
+    json["seed"] = seed.has_value() ? nlohmann::json(*seed) : nlohmann::json();
+    json["random_state"] = randomState;
+    json["covered_nodes"] = coveredNodes;
+    json["pending_paths"] = pendingPaths;
+
+    auto tmpPath = path;
+    tmpPath += ".tmp";
+    {
+        std::ofstream file(tmpPath);
+        file << json;
+        if (!file.good()) {
+            ::warning("Unable to write checkpoint %1%.", tmpPath.string());
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        ::warning("Unable to write checkpoint %1%: %2%", path.string(), ec.message());
+        return false;
+    }
+    return true;
+}
+
+std::optional<Checkpoint> Checkpoint::load(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    if (!file.good()) {
+        ::error("Unable to read checkpoint %1%.", path.string());
+        return std::nullopt;
+    }
+    try {
+        auto json = nlohmann::json::parse(file);
+        if (json.at("version").get<int>() != CHECKPOINT_VERSION) {
+            ::error("Checkpoint %1% has an unsupported version.", path.string());
+            return std::nullopt;
+        }
+        Checkpoint checkpoint;
+        checkpoint.testCount = json.at("test_count").get<int64_t>();
+        if (!json.at("seed").is_null()) {
+            checkpoint.seed = json.at("seed").get<uint32_t>();
+        }
+        checkpoint.randomState = json.at("random_state").get<std::string>();
+        checkpoint.coveredNodes = json.at("covered_nodes").get<std::vector<std::string>>();
+        checkpoint.pendingPaths =
+            json.at("pending_paths").get<std::vector<std::vector<uint64_t>>>();
+        return checkpoint;
+    } catch (const nlohmann::json::exception &e) {
+        ::error("Checkpoint %1% is corrupted: %2%", path.string(), e.what());
+        return std::nullopt;
+    }
+}
+
+}  // namespace P4Tools::P4Testgen
@@ -0,0 +1,55 @@
+#ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_CHECKPOINT_H_
+#define BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_CHECKPOINT_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "midend/coverage.h"
+
+namespace P4Tools::P4Testgen {
+
+/// The state of an exploration which is needed to continue it in another process. Execution
+/// states are not saved directly. Instead, each pending state is described by the branch
+/// decisions leading to it, which are replayed when the exploration is resumed.
+///
+/// Checkpoints are only valid for the program and the options they were created with.
+struct Checkpoint {
+    /// The number of tests generated so far. This is also the index of the next test.
+    int64_t testCount = 0;
+
+    /// The seed of the run, if any. A resumed run must use the same seed.
+    std::optional<uint32_t> seed;
+
+    /// The state of the random number generator. Empty if no seed is set.
+    std::string randomState;
+
+    /// The stable identifiers of the nodes covered by the generated tests, see
+    /// P4::Coverage::getStableId.
+    std::vector<std::string> coveredNodes;
+
+    /// The branch decisions leading to each pending state, in the order of the strategy.
+    std::vector<std::vector<uint64_t>> pendingPaths;
+
+    /// @returns the members of @p coverableNodes covered by the generated tests.
+    [[nodiscard]] P4::Coverage::CoverageSet getCoveredNodes(
+        const P4::Coverage::CoverageSet &coverableNodes) const;
+
+    /// Records the nodes of @p nodes as covered.
+    void setCoveredNodes(const P4::Coverage::CoverageSet &nodes);
+
+    /// Writes the checkpoint to @p path. The file is replaced atomically, so an interrupted
+    /// write leaves the previous checkpoint intact.
+    /// @returns false if the file could not be written.
+    bool save(const std::filesystem::path &path) const;
+
+    /// @returns the checkpoint stored in @p path, or std::nullopt if it can not be read.
+    static std::optional<Checkpoint> load(const std::filesystem::path &path);
+};
+
+}  // namespace P4Tools::P4Testgen
+
+#endif /* BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_CHECKPOINT_H_ */
@@ -132,11 +132,11 @@ void CoverableNodesScanner::updateNodeCoverage(const IR::Node *node,
     // If the node is already in the cache, return it.
     auto it = CACHED_NODES.find(node);
     if (it != CACHED_NODES.end()) {
-        nodes.insert(it->second.begin(), it->second.end());
+        nodes |= it->second;
         return;
     }
     node->apply(*this);
-    nodes.insert(coverableNodes.begin(), coverableNodes.end());
+    nodes |= coverableNodes;
     // Store the result in the cache.
     CACHED_NODES.emplace(node, coverableNodes);
 }
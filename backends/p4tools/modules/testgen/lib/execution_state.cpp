@@ -20,6 +20,7 @@
 #include "backends/p4tools/common/lib/symbolic_env.h"
 #include "backends/p4tools/common/lib/taint.h"
 #include "backends/p4tools/common/lib/trace_event.h"
+#include "backends/p4tools/common/lib/util.h"
 #include "backends/p4tools/common/lib/variables.h"
 #include "ir/id.h"
 #include "ir/indexed_vector.h"
@@ -87,7 +88,13 @@ const std::vector<uint64_t> &ExecutionState::getSelectedBranches() const {
 }
 
 const std::vector<const IR::Expression *> &ExecutionState::getPathConstraint() const {
-    return pathConstraint;
+    return pathConstraint.toVector();
+}
+
+size_t ExecutionState::getPathConstraintSize() const { return pathConstraint.size(); }
+
+std::vector<const IR::Expression *> ExecutionState::getPathConstraintSuffix(size_t from) const {
+    return pathConstraint.suffix(from);
 }
 
 std::optional<const Continuation::Command> ExecutionState::getNextCmd() const {
@@ -143,7 +150,7 @@ void ExecutionState::markVisited(const IR::Node *node) {
 const P4::Coverage::CoverageSet &ExecutionState::getVisited() const { return visitedNodes; }
 
 bool ExecutionState::hasTaint(const IR::Expression *expr) const {
-    return Taint::hasTaint(env.getInternalMap(), expr);
+    return Taint::hasTaint(env, expr);
 }
 
 bool ExecutionState::exists(const IR::StateVariable &var) const { return env.exists(var); }
@@ -170,7 +177,7 @@ void ExecutionState::printSymbolicEnv(std::ostream &out) const {
 }
 
 const std::vector<std::reference_wrapper<const TraceEvent>> &ExecutionState::getTrace() const {
-    return trace;
+    return trace.toVector();
 }
 
 const Continuation::Body &ExecutionState::getBody() const { return body; }
@@ -181,16 +188,16 @@ const std::stack<std::reference_wrapper<const ExecutionState::StackFrame>>
 }
 
 void ExecutionState::setProperty(cstring propertyName, Continuation::PropertyValue property) {
-    stateProperties[propertyName] = property;
+    stateProperties.mutate()[propertyName] = property;
 }
 
 bool ExecutionState::hasProperty(cstring propertyName) const {
-    return stateProperties.count(propertyName) > 0;
+    return stateProperties.get().count(propertyName) > 0;
 }
 
 void ExecutionState::addTestObject(cstring category, cstring objectLabel,
                                    const TestObject *object) {
-    testObjects[category][objectLabel] = object;
+    testObjects.mutate()[category][objectLabel] = object;
 }
 
 const TestObject *ExecutionState::getTestObject(cstring category, cstring objectLabel,
@@ -208,22 +215,26 @@ const TestObject *ExecutionState::getTestObject(cstring category, cstring object
 }
 
 TestObjectMap ExecutionState::getTestObjectCategory(cstring category) const {
-    auto it = testObjects.find(category);
-    if (it != testObjects.end()) {
+    auto it = testObjects.get().find(category);
+    if (it != testObjects.get().end()) {
         return it->second;
     }
     return {};
 }
 
 void ExecutionState::deleteTestObject(cstring category, cstring objectLabel) {
-    auto it = testObjects.find(category);
-    if (it != testObjects.end()) {
+    if (testObjects.get().count(category) == 0) {
         return;
     }
-    it->second.erase(objectLabel);
+    testObjects.mutate().at(category).erase(objectLabel);
 }
 
-void ExecutionState::deleteTestObjectCategory(cstring category) { testObjects.erase(category); }
+void ExecutionState::deleteTestObjectCategory(cstring category) {
+    if (testObjects.get().count(category) == 0) {
+        return;
+    }
+    testObjects.mutate().erase(category);
+}
 
 void ExecutionState::setReachabilityEngineState(ReachabilityEngineState *newEngineState) {
     reachabilityEngineState = newEngineState;
@@ -237,7 +248,7 @@ ReachabilityEngineState *ExecutionState::getReachabilityEngineState() const {
  *  Trace events.
  * ============================================================================================= */
 
-void ExecutionState::add(const TraceEvent &event) { trace.emplace_back(event); }
+void ExecutionState::add(const TraceEvent &event) { trace.push_back(event); }
 
 /* =============================================================================================
  *  Namespaces and declarations
@@ -355,6 +366,10 @@ void ExecutionState::pushPathConstraint(const IR::Expression *e) { pathConstrain
 
 void ExecutionState::pushBranchDecision(uint64_t bIdx) { selectedBranches.push_back(bIdx); }
 
+const std::vector<uint64_t> &ExecutionState::getPathDecisions() const { return pathDecisions; }
+
+void ExecutionState::pushPathDecision(uint64_t bIdx) { pathDecisions.push_back(bIdx); }
+
 const IR::SymbolicVariable *ExecutionState::getInputPacketSizeVar() {
     return ToolsVariables::getSymbolicVariable(&PacketVars::PACKET_SIZE_VAR_TYPE, 0,
                                                "*packetLen_bits");
@@ -623,6 +638,30 @@ ExecutionState &ExecutionState::create(const IR::P4Program *program) {
     return *new ExecutionState(program);
 }
 
-ExecutionState &ExecutionState::clone() const { return *new ExecutionState(*this); }
+ExecutionState &ExecutionState::clone() const {
+    Utils::addToCounter("state_clones");
+    return *new ExecutionState(*this);
+}
+
+size_t ExecutionState::getOwnedBytes() const {
+    size_t bytes = sizeof(ExecutionState);
+    bytes += env.getOwnedSize() * sizeof(SymbolicMapType::value_type);
+    bytes += allocatedSymbolicVariables.size() * sizeof(const IR::SymbolicVariable *);
+    bytes += selectedBranches.capacity() * sizeof(uint64_t);
+    bytes += pathDecisions.capacity() * sizeof(uint64_t);
+    bytes += pathConstraint.materializedCapacity() * sizeof(const IR::Expression *);
+    bytes += trace.materializedCapacity() * sizeof(std::reference_wrapper<const TraceEvent>);
+    // Properties and test objects are small; count them only when they are not shared.
+    if (!stateProperties.isShared()) {
+        bytes += stateProperties.get().size() *
+                 sizeof(std::pair<const cstring, Continuation::PropertyValue>);
+    }
+    if (!testObjects.isShared()) {
+        for (const auto &category : testObjects.get()) {
+            bytes += category.second.size() * sizeof(TestObjectMap::value_type);
+        }
+    }
+    return bytes;
+}
 
 }  // namespace P4Tools::P4Testgen
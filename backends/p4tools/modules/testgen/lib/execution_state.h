@@ -15,6 +15,7 @@
 #include "backends/p4tools/common/compiler/reachability.h"
 #include "backends/p4tools/common/core/solver.h"
 #include "backends/p4tools/common/lib/namespace_context.h"
+#include "backends/p4tools/common/lib/persistent.h"
 #include "backends/p4tools/common/lib/symbolic_env.h"
 #include "backends/p4tools/common/lib/trace_event.h"
 #include "ir/declaration.h"
@@ -52,7 +53,9 @@ class ExecutionState {
               namespaces(namespaces) {}
     };
 
-    /// No move semantics because of constant members. We always need to clone a state.
+    /// No move semantics because of constant members. We always need to clone a state. Cloning is
+    /// cheap: the symbolic environment, the trace, the path constraint, the properties, and the
+    /// test objects are shared with the source state until they are modified.
     ExecutionState(ExecutionState &&) = delete;
     ExecutionState &operator=(ExecutionState &&) = delete;
     ~ExecutionState() = default;
@@ -70,9 +73,10 @@ class ExecutionState {
     SymbolicSet allocatedSymbolicVariables;
 
     /// The program trace for the current program point (i.e., how we got to the current state).
-    std::vector<std::reference_wrapper<const TraceEvent>> trace;
+    SharedTailList<std::reference_wrapper<const TraceEvent>> trace;
 
-    /// Set of visited nodes. Used for code coverage.
+    /// Set of visited nodes. Used for code coverage. This is a bit vector, so cloning a state only
+    /// copies a few words.
     P4::Coverage::CoverageSet visitedNodes;
 
     /// The remaining body of the current function being executed.
@@ -95,7 +99,7 @@ class ExecutionState {
     /// written while this variable is active is tainted. This property must be unset manually to
     /// resume normal operation by setting the property "false". Usually, this is done directly
     /// after the tainted sequence of commands has been executed.
-    std::map<cstring, Continuation::PropertyValue> stateProperties;
+    CopyOnWrite<std::map<cstring, Continuation::PropertyValue>> stateProperties;
 
     // Test objects are classes of variables that influence the execution of test frameworks. They
     // are collected during interpreter execution and consumed by the respective test framework. For
@@ -103,7 +107,7 @@ class ExecutionState {
     // which defines control plane match action entries. Once the interpreter has solved for the
     // variables used by these test objects and concretized the values, they can be used to generate
     // a test. Test objects are not constant because they may be manipulated by a target back end.
-    std::map<cstring, TestObjectMap> testObjects;
+    CopyOnWrite<std::map<cstring, TestObjectMap>> testObjects;
 
     /// The parserErrorLabel is set by the parser to indicate the variable corresponding to the
     /// parser error that is set by various built-in functions such as verify or extract.
@@ -117,11 +121,15 @@ class ExecutionState {
 
     /// List of path constraints - expressions that must all evaluate to true to reach this
     /// execution state.
-    std::vector<const IR::Expression *> pathConstraint;
+    SharedTailList<const IR::Expression *> pathConstraint;
 
     /// List of branch decisions leading into this state.
     std::vector<uint64_t> selectedBranches;
 
+    /// The 1-based indices of the successors taken at the branch points with more than one
+    /// feasible successor on the path leading into this state. Used to replay the path.
+    std::vector<uint64_t> pathDecisions;
+
     /// State that is needed to track reachability of statements given a query.
     ReachabilityEngineState *reachabilityEngineState = nullptr;
 
@@ -135,6 +143,13 @@ class ExecutionState {
     /// @returns list of paths constraints.
     [[nodiscard]] const std::vector<const IR::Expression *> &getPathConstraint() const;
 
+    /// @returns the number of path constraints.
+    [[nodiscard]] size_t getPathConstraintSize() const;
+
+    /// @returns the path constraints after the first @p from ones. Unlike
+    /// @ref getPathConstraint, this does not keep a copy of all path constraints in the state.
+    [[nodiscard]] std::vector<const IR::Expression *> getPathConstraintSuffix(size_t from) const;
+
     /// @returns list of branch decisions leading into this state.
     [[nodiscard]] const std::vector<uint64_t> &getSelectedBranches() const;
 
@@ -146,6 +161,14 @@ class ExecutionState {
     /// selected (input) branches features.
     void pushBranchDecision(uint64_t);
 
+    /// @returns the decisions recorded with pushPathDecision.
+    [[nodiscard]] const std::vector<uint64_t> &getPathDecisions() const;
+
+    /// Records the 1-based index of the successor taken at a branch point with more than one
+    /// feasible successor. Called by every strategy, the decisions of a pending state are saved
+    /// in checkpoints and replayed when the exploration is resumed.
+    void pushPathDecision(uint64_t bIdx);
+
     /// @returns the next command to be evaluated, if any.
     /// @returns std::nullopt if the current body is empty.
     [[nodiscard]] std::optional<const Continuation::Command> getNextCmd() const;
@@ -194,8 +217,8 @@ class ExecutionState {
     /// BUG, If the specified type does not match or the property is not found.
     template <class T>
     [[nodiscard]] T getProperty(cstring propertyName) const {
-        auto iterator = stateProperties.find(propertyName);
-        if (iterator != stateProperties.end()) {
+        auto iterator = stateProperties.get().find(propertyName);
+        if (iterator != stateProperties.get().end()) {
             auto val = iterator->second;
             try {
                 T resolvedVal = std::get<T>(val);
@@ -454,6 +477,10 @@ class ExecutionState {
     /// Returns a reference, not a pointer.
     [[nodiscard]] ExecutionState &clone() const;
 
+    /// @returns an estimate of the memory in bytes owned by this state, excluding the parts
+    /// shared with other states.
+    [[nodiscard]] size_t getOwnedBytes() const;
+
     /// Create a new execution state object from the input program.
     /// Returns a reference not a pointer.
     [[nodiscard]] static ExecutionState &create(const IR::P4Program *program);
@@ -0,0 +1,97 @@
+#include "backends/p4tools/modules/testgen/lib/shard.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "lib/error.h"
+#include "nlohmann/json.hpp"
+
+namespace P4Tools::P4Testgen {
+
+std::filesystem::path ShardCoverage::getDirectory(const std::filesystem::path &outputDir,
+                                                  uint64_t shardIndex) {
+    return outputDir / ("shard_" + std::to_string(shardIndex));
+}
+
+std::filesystem::path ShardCoverage::getFile(const std::filesystem::path &directory) {
+    return directory / "coverage.json";
+}
+
+bool ShardCoverage::save(const std::filesystem::path &path) const {
+    nlohmann::json json;
+    json["shard"] = shardIndex;
+    json["num_shards"] = numShards;
+    json["tests"] = testCount;
+    json["coverable_nodes"] = coverableNodes;
+    json["covered_nodes"] = coveredNodes;
+    std::ofstream file(path);
+    file << json.dump(2) << std::endl;
+    if (!file.good()) {
+        ::error("Unable to write coverage file %1%.", path.string());
+        return false;
+    }
+    return true;
+}
+
+std::optional<ShardCoverage> ShardCoverage::load(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    if (!file.good()) {
+        ::error("Unable to read coverage file %1%.", path.string());
+        return std::nullopt;
+    }
+    try {
+        auto json = nlohmann::json::parse(file);
+        ShardCoverage coverage;
+        coverage.shardIndex = json.at("shard").get<uint64_t>();
+        coverage.numShards = json.at("num_shards").get<uint64_t>();
+        coverage.testCount = json.at("tests").get<int64_t>();
+        coverage.coverableNodes = json.at("coverable_nodes").get<size_t>();
+        coverage.coveredNodes = json.at("covered_nodes").get<std::vector<std::string>>();
+        return coverage;
+    } catch (const nlohmann::json::exception &e) {
+        ::error("Coverage file %1% is corrupted: %2%", path.string(), e.what());
+        return std::nullopt;
+    }
+}
+
+std::optional<ShardCoverage> ShardCoverage::merge(const std::filesystem::path &outputDir,
+                                                  uint64_t numShards) {
+    ShardCoverage merged;
+    merged.numShards = numShards;
+    for (uint64_t shardIndex = 0; shardIndex < numShards; shardIndex++) {
+        auto coverage = load(getFile(getDirectory(outputDir, shardIndex)));
+        if (!coverage.has_value()) {
+            return std::nullopt;
+        }
+        if (coverage->shardIndex != shardIndex || coverage->numShards != numShards) {
+            ::error("Shard %1% was run as shard %2%/%3%.", shardIndex, coverage->shardIndex,
+                    coverage->numShards);
+            return std::nullopt;
+        }
+        if (shardIndex > 0 && coverage->coverableNodes != merged.coverableNodes) {
+            ::error("Shard %1% was run on a different program.", shardIndex);
+            return std::nullopt;
+        }
+        merged.coverableNodes = coverage->coverableNodes;
+        merged.testCount += coverage->testCount;
+        std::vector<std::string> united;
+        std::sort(coverage->coveredNodes.begin(), coverage->coveredNodes.end());
+        std::set_union(merged.coveredNodes.begin(), merged.coveredNodes.end(),
+                       coverage->coveredNodes.begin(), coverage->coveredNodes.end(),
+                       std::back_inserter(united));
+        merged.coveredNodes = std::move(united);
+    }
+    if (!merged.save(getFile(outputDir))) {
+        return std::nullopt;
+    }
+    return merged;
+}
+
+P4::Coverage::CoverageSet ShardCoverage::getCoveredNodes(
+    const P4::Coverage::CoverageSet &coverableNodes) const {
+    return P4::Coverage::findStableIds(coverableNodes, coveredNodes);
+}
+
+}  // namespace P4Tools::P4Testgen
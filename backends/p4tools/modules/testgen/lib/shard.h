@@ -0,0 +1,63 @@
+#ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_SHARD_H_
+#define BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_SHARD_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "midend/coverage.h"
+
+namespace P4Tools::P4Testgen {
+
+/// The coverage achieved by one shard of a sharded exploration. Shards are run by independent
+/// processes; each writes its coverage into its own directory, and a merge step combines them.
+///
+/// Nodes are identified by their stable identifiers (see P4::Coverage::getStableId), which are
+/// the same in all processes running the same program with the same options.
+struct ShardCoverage {
+    /// The index of the shard.
+    uint64_t shardIndex = 0;
+
+    /// The number of shards.
+    uint64_t numShards = 1;
+
+    /// The number of tests generated by the shard.
+    int64_t testCount = 0;
+
+    /// The number of coverable nodes in the program.
+    size_t coverableNodes = 0;
+
+    /// The stable identifiers of the nodes covered by the shard, sorted.
+    std::vector<std::string> coveredNodes;
+
+    /// @returns the directory of shard @p shardIndex in @p outputDir.
+    static std::filesystem::path getDirectory(const std::filesystem::path &outputDir,
+                                              uint64_t shardIndex);
+
+    /// @returns the coverage file in the directory @p directory.
+    static std::filesystem::path getFile(const std::filesystem::path &directory);
+
+    /// Writes the coverage to the file @p path. @returns false if the file could not be written.
+    bool save(const std::filesystem::path &path) const;
+
+    /// @returns the coverage stored in @p path, or std::nullopt if it can not be read.
+    static std::optional<ShardCoverage> load(const std::filesystem::path &path);
+
+    /// Merges the coverage of all @p numShards shards in @p outputDir and writes the result to
+    /// the coverage file of @p outputDir. Reports an error if a shard is missing or was run
+    /// with a different program or shard count.
+    /// @returns the merged coverage, or std::nullopt on errors.
+    static std::optional<ShardCoverage> merge(const std::filesystem::path &outputDir,
+                                              uint64_t numShards);
+
+    /// @returns the members of @p coverableNodes covered by the shards.
+    [[nodiscard]] P4::Coverage::CoverageSet getCoveredNodes(
+        const P4::Coverage::CoverageSet &coverableNodes) const;
+};
+
+}  // namespace P4Tools::P4Testgen
+
+#endif /* BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_SHARD_H_ */
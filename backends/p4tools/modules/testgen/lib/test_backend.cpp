@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <optional>
+#include <utility>
 
 #include "backends/p4tools/common/lib/format_int.h"
 #include "backends/p4tools/common/lib/model.h"
@@ -128,9 +129,12 @@ bool TestBackEnd::run(const FinalState &state) {
 
         printTraces("============ End Test %1% ============\n", testCount);
         testCount++;
+        Utils::addToCounter("generated_tests");
         P4::Coverage::printCoverageReport(coverableNodes, visitedNodes);
         printPerformanceReport(false);
 
+        checkpointIfDue();
+
         // If MAX_STATEMENT_COVERAGE is enabled, terminate early if we hit max coverage already.
         if (TestgenOptions::get().stopMetric == "MAX_STATEMENT_COVERAGE" && coverage == 1.0) {
             return true;
@@ -165,8 +169,8 @@ TestBackEnd::TestInfo TestBackEnd::produceTestInfo(
 
     const auto *outputPortVar = completedModel->evaluate(outputPortExpr);
     // Build the taint mask by dissecting the program packet variable
-    const auto *evalMask = Taint::buildTaintMask(executionState->getSymbolicEnv().getInternalMap(),
-                                                 completedModel, outputPacketExpr);
+    const auto *evalMask = Taint::buildTaintMask(executionState->getSymbolicEnv(), completedModel,
+                                                 outputPacketExpr);
 
     // Get the input/output port integers.
     auto inputPortInt = IR::getIntFromLiteral(inputPort);
@@ -230,6 +234,57 @@ void TestBackEnd::printPerformanceReport(bool write) const {
     testWriter->printPerformanceReport(write);
 }
 
+void TestBackEnd::flushTests() {
+    if (!testWriter->flush()) {
+        ::error("Testgen: Unable to write all generated tests.");
+    }
+}
+
+void TestBackEnd::enableCheckpoints(std::filesystem::path path) {
+    BUG_CHECK(symbex.getPendingPaths().has_value(),
+              "The symbolic executor does not support checkpoints.");
+    checkpointPath = std::move(path);
+    lastCheckpoint = std::chrono::steady_clock::now();
+}
+
+void TestBackEnd::checkpointIfDue() {
+    if (!checkpointPath.has_value()) {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    auto interval = std::chrono::seconds(TestgenOptions::get().checkpointInterval);
+    if (now - lastCheckpoint < interval) {
+        return;
+    }
+    saveCheckpoint();
+    lastCheckpoint = now;
+}
+
+void TestBackEnd::saveCheckpoint() {
+    BUG_CHECK(checkpointPath.has_value(), "Checkpoints are not enabled.");
+    Util::ScopedTimer timer("checkpoint");
+    flushTests();
+    Checkpoint checkpoint;
+    checkpoint.testCount = testCount;
+    checkpoint.seed = Utils::getCurrentSeed();
+    if (checkpoint.seed.has_value()) {
+        checkpoint.randomState = Utils::getRandomState();
+    }
+    checkpoint.setCoveredNodes(symbex.getVisitedNodes());
+    checkpoint.pendingPaths = symbex.getPendingPaths().value();
+    if (checkpoint.save(*checkpointPath)) {
+        printFeature("test_info", 4,
+                     "============ Checkpoint: %1% tests, %2% pending paths ============",
+                     testCount, checkpoint.pendingPaths.size());
+    }
+}
+
+void TestBackEnd::restoreCheckpoint(const Checkpoint &checkpoint) {
+    testCount = checkpoint.testCount;
+    testWriter->resume(checkpoint.testCount);
+    symbex.updateVisitedNodes(checkpoint.getCoveredNodes(programInfo.getCoverableNodes()));
+}
+
 int64_t TestBackEnd::getTestCount() const { return testCount; }
 
 }  // namespace P4Tools::P4Testgen
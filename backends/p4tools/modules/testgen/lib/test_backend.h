@@ -3,6 +3,8 @@
 
 #include <stdint.h>
 
+#include <chrono>  // NOLINT cpplint throws a warning because Google has a similar library...
+#include <filesystem>
 #include <functional>
 #include <optional>
 #include <vector>
@@ -13,6 +15,7 @@
 
 #include "backends/p4tools/modules/testgen/core/program_info.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/symbolic_executor.h"
+#include "backends/p4tools/modules/testgen/lib/checkpoint.h"
 #include "backends/p4tools/modules/testgen/lib/execution_state.h"
 #include "backends/p4tools/modules/testgen/lib/final_state.h"
 #include "backends/p4tools/modules/testgen/lib/test_spec.h"
@@ -26,6 +29,15 @@ class TestBackEnd {
     /// The current test count. If it exceeds @var maxTests, the symbolic executor will stop.
     int64_t testCount = 0;
 
+    /// The file to which checkpoints are written, if checkpoints are enabled.
+    std::optional<std::filesystem::path> checkpointPath;
+
+    /// The time the last checkpoint was written.
+    std::chrono::steady_clock::time_point lastCheckpoint;
+
+    /// Writes a checkpoint if checkpoints are enabled and the checkpoint interval has passed.
+    void checkpointIfDue();
+
  protected:
     /// ProgramInfo is used to access some target specific information for test generation.
     const ProgramInfo &programInfo;
@@ -115,6 +127,21 @@ class TestBackEnd {
     /// enabled.
     void printPerformanceReport(bool write) const;
 
+    /// Blocks until all tests generated so far are on disk. Reports an error if some test could
+    /// not be written.
+    void flushTests();
+
+    /// Periodically write checkpoints of the exploration to @p path. The symbolic executor must
+    /// support checkpoints.
+    void enableCheckpoints(std::filesystem::path path);
+
+    /// Writes a checkpoint of the exploration to the checkpoint file. The tests generated so far
+    /// are flushed first, so the checkpoint never counts tests which are not on disk.
+    void saveCheckpoint();
+
+    /// Continues the test numbering and coverage of @p checkpoint.
+    void restoreCheckpoint(const Checkpoint &checkpoint);
+
     /// Accessors.
     [[nodiscard]] int64_t getTestCount() const;
 };
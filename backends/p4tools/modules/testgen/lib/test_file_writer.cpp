@@ -0,0 +1,190 @@
+#include "backends/p4tools/modules/testgen/lib/test_file_writer.h"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+#include "lib/error.h"
+#include "lib/exceptions.h"
+
+namespace P4Tools::P4Testgen {
+
+namespace {
+
+/// Writes @p size, followed by the @p size bytes at @p data, to @p out.
+/// @returns false if the write failed.
+bool writeField(FILE *out, const void *data, uint32_t size) {
+    return fwrite(&size, sizeof(size), 1, out) == 1 &&
+           (size == 0 || fwrite(data, 1, size, out) == size);
+}
+
+/// Reads a field written by @ref writeField from @p in into @p buffer.
+/// @returns false at the end of the input or if the field is incomplete.
+bool readField(FILE *in, std::vector<uint8_t> &buffer) {
+    uint32_t size = 0;
+    if (fread(&size, sizeof(size), 1, in) != 1) {
+        return false;
+    }
+    buffer.resize(size);
+    return size == 0 || fread(buffer.data(), 1, size, in) == size;
+}
+
+}  // namespace
+
+TestFileWriter::TestFileWriter(bool async) : async(async) {}
+
+TestFileWriter::~TestFileWriter() { flush(); }
+
+bool TestFileWriter::hasTemplate(const std::string &name) const {
+    return templates.find(name) != templates.end();
+}
+
+void TestFileWriter::addTemplate(const std::string &name, const std::string &templateString) {
+    BUG_CHECK(writerPid < 0, "Template %1% is added while the writer process is running.", name);
+    templates.insert_or_assign(name, env.parse(templateString));
+}
+
+void TestFileWriter::render(const std::string &name, const inja::json &data,
+                            const std::filesystem::path &file, bool append) {
+    if (!append || file != currentFile || !currentStream.is_open()) {
+        if (currentStream.is_open()) {
+            currentStream.close();
+            ok = ok && !currentStream.fail();
+        }
+        currentFile = file;
+        currentStream.open(file, append ? std::ios::out | std::ios::app : std::ios::out);
+    }
+    auto it = templates.find(name);
+    BUG_CHECK(it != templates.end(), "Unknown test template %1%.", name);
+    env.render_to(currentStream, it->second, data);
+    ok = ok && !currentStream.fail();
+}
+
+void TestFileWriter::startWriter() {
+    int fds[2];
+    if (pipe(fds) < 0) {
+        ::warning("Unable to start the test writer process: %1%. Writing tests synchronously.",
+                  strerror(errno));
+        async = false;
+        return;
+    }
+    // If the writer process exits early, writes to the pipe must fail with EPIPE rather than
+    // terminate the exploration.
+    std::signal(SIGPIPE, SIG_IGN);
+    // Flush before forking so buffered output is not duplicated in the child.
+    std::cout.flush();
+    std::cerr.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        ::warning("Unable to start the test writer process: %1%. Writing tests synchronously.",
+                  strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        async = false;
+        return;
+    }
+    if (pid == 0) {
+        close(fds[1]);
+        runWriter(fds[0]);
+    }
+    close(fds[0]);
+    writerPid = pid;
+    writerPipe = fdopen(fds[1], "w");
+    BUG_CHECK(writerPipe != nullptr, "Unable to open the pipe to the test writer process.");
+}
+
+void TestFileWriter::runWriter(int fd) {
+    FILE *input = fdopen(fd, "r");
+    // Each test is a record of the template name, the file, the append flag and the data.
+    std::vector<uint8_t> name;
+    std::vector<uint8_t> file;
+    std::vector<uint8_t> append;
+    std::vector<uint8_t> data;
+    while (input != nullptr && readField(input, name)) {
+        if (!readField(input, file) || !readField(input, append) || append.size() != 1 ||
+            !readField(input, data)) {
+            std::cerr << "Test writer: incomplete test." << std::endl;
+            ok = false;
+            break;
+        }
+        try {
+            render(std::string(name.begin(), name.end()), inja::json::from_msgpack(data),
+                   std::string(file.begin(), file.end()), append[0] != 0);
+        } catch (const std::exception &e) {
+            std::cerr << "Test writer: " << e.what() << std::endl;
+            ok = false;
+        }
+    }
+    if (currentStream.is_open()) {
+        currentStream.close();
+        ok = ok && !currentStream.fail();
+    }
+    std::cerr.flush();
+    // Do not run the parent's exit handlers in the writer.
+    _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+}
+
+bool TestFileWriter::hasWritten(const std::filesystem::path &file) const {
+    return writtenFiles.find(file) != writtenFiles.end();
+}
+
+void TestFileWriter::markWritten(const std::filesystem::path &file) { writtenFiles.insert(file); }
+
+void TestFileWriter::write(const std::string &name, const inja::json &data,
+                           const std::filesystem::path &file) {
+    BUG_CHECK(hasTemplate(name), "Unknown test template %1%.", name);
+    bool append = !writtenFiles.insert(file).second;
+    if (async && writerPid < 0) {
+        startWriter();
+    }
+    if (!async) {
+        render(name, data, file, append);
+        return;
+    }
+    auto fileName = file.string();
+    uint8_t appendFlag = append ? 1 : 0;
+    encoded.clear();
+    inja::json::to_msgpack(data, encoded);
+    if (!writeField(writerPipe, name.data(), name.size()) ||
+        !writeField(writerPipe, fileName.data(), fileName.size()) ||
+        !writeField(writerPipe, &appendFlag, sizeof(appendFlag)) ||
+        !writeField(writerPipe, encoded.data(), encoded.size())) {
+        // The writer process has exited. Tests it has not written are lost, but the remaining
+        // ones can still be written.
+        ::warning("Unable to pass a test to the test writer process: %1%. Writing tests "
+                  "synchronously.",
+                  strerror(errno));
+        flush();
+        ok = false;
+        async = false;
+        render(name, data, file, append);
+    }
+}
+
+bool TestFileWriter::flush() {
+    if (writerPid >= 0) {
+        ok = fclose(writerPipe) == 0 && ok;
+        writerPipe = nullptr;
+        int status = 0;
+        ok = waitpid(writerPid, &status, 0) >= 0 && WIFEXITED(status) &&
+             WEXITSTATUS(status) == EXIT_SUCCESS && ok;
+        writerPid = -1;
+    }
+    if (currentStream.is_open()) {
+        currentStream.close();
+        ok = ok && !currentStream.fail();
+    }
+    currentFile.clear();
+    return ok;
+}
+
+}  // namespace P4Tools::P4Testgen
@@ -0,0 +1,111 @@
+#ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_TEST_FILE_WRITER_H_
+#define BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_TEST_FILE_WRITER_H_
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <inja/inja.hpp>
+
+namespace P4Tools::P4Testgen {
+
+/// Renders tests with precompiled Inja templates and writes them to disk.
+///
+/// In asynchronous mode, rendering and I/O are done by a writer process. Each test is streamed
+/// to it through a pipe as a record of length-prefixed fields, with the test data encoded as
+/// MessagePack, which is cheaper to produce and decode than JSON text. The pipe buffer bounds the
+/// number of tests in flight:
+/// the exploration only blocks when the writer falls behind by more than the pipe holds. The
+/// writer is a process rather than a thread because the IR, cstrings and the garbage collector
+/// are not thread-safe. It is forked when the first test is written after a @ref flush, so it
+/// inherits all templates registered up to that point.
+class TestFileWriter {
+ public:
+    explicit TestFileWriter(bool async);
+
+    TestFileWriter(const TestFileWriter &) = delete;
+
+    TestFileWriter(TestFileWriter &&) = delete;
+
+    TestFileWriter &operator=(const TestFileWriter &) = delete;
+
+    TestFileWriter &operator=(TestFileWriter &&) = delete;
+
+    ~TestFileWriter();
+
+    /// @returns true if a template named @p name has been registered.
+    [[nodiscard]] bool hasTemplate(const std::string &name) const;
+
+    /// Parses @p templateString and registers it as @p name. Templates must be registered
+    /// before the first test that uses them is written.
+    void addTemplate(const std::string &name, const std::string &templateString);
+
+    /// Renders @p data with the template @p name into @p file. The file is truncated when it is
+    /// first written by this writer, and appended to afterwards.
+    void write(const std::string &name, const inja::json &data, const std::filesystem::path &file);
+
+    /// @returns true if @p file has been written by this writer.
+    [[nodiscard]] bool hasWritten(const std::filesystem::path &file) const;
+
+    /// Records that @p file already holds tests, e.g., of the run that a --resume continues, so
+    /// that tests are appended to it rather than replacing it.
+    void markWritten(const std::filesystem::path &file);
+
+    /// Blocks until all tests passed to @ref write are on disk.
+    /// @returns false if some test could not be written.
+    bool flush();
+
+ private:
+    /// Renders and writes a single test. Keeps the last file open, so consecutive tests in the
+    /// same file do not reopen it.
+    void render(const std::string &name, const inja::json &data, const std::filesystem::path &file,
+                bool append);
+
+    /// Forks the writer process.
+    void startWriter();
+
+    /// The loop of the writer process. Reads tests from @p fd until it is closed.
+    [[noreturn]] void runWriter(int fd);
+
+    /// Whether tests are written by a writer process.
+    bool async;
+
+    /// The environment the templates are parsed and rendered in.
+    inja::Environment env;
+
+    /// The registered templates, by name.
+    std::map<std::string, inja::Template> templates;
+
+    /// The files written so far. Whether a file is truncated is decided here rather than by the
+    /// writer process, which is restarted after every @ref flush.
+    std::set<std::filesystem::path> writtenFiles;
+
+    /// The file tests are currently written to.
+    std::filesystem::path currentFile;
+
+    /// The stream of @var currentFile.
+    std::ofstream currentStream;
+
+    /// Whether all writes have succeeded so far.
+    bool ok = true;
+
+    /// The writer process, or -1 if it is not running.
+    pid_t writerPid = -1;
+
+    /// The write end of the pipe to the writer process.
+    FILE *writerPipe = nullptr;
+
+    /// The buffer the data of a test is encoded into before it is passed to the writer process.
+    std::vector<uint8_t> encoded;
+};
+
+}  // namespace P4Tools::P4Testgen
+
+#endif /* BACKENDS_P4TOOLS_MODULES_TESTGEN_LIB_TEST_FILE_WRITER_H_ */
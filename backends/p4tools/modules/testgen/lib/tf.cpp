@@ -11,10 +11,15 @@
 #include "lib/log.h"
 #include "lib/timer.h"
 
+#include "backends/p4tools/modules/testgen/options.h"
+
 namespace P4Tools::P4Testgen {
 
 TF::TF(std::filesystem::path basePath, std::optional<unsigned int> seed = std::nullopt)
-    : basePath(std::move(basePath)), seed(seed) {}
+    : basePath(std::move(basePath)),
+      seed(seed),
+      fileWriter(TestgenOptions::get().asyncOutput),
+      testsPerFile(TestgenOptions::get().testsPerFile) {}
 
 void TF::printPerformanceReport(bool write) const {
     // Do not emit a report if performance logging is not enabled.
@@ -24,7 +29,14 @@ void TF::printPerformanceReport(bool write) const {
     printFeature("performance", 4, "============ Timers ============");
     inja::json dataJson;
     inja::json timerList = inja::json::array();
+    size_t backendMilliseconds = 0;
     for (const auto &c : Util::getTimers()) {
+        static const std::string BACKEND_TIMER = "backend";
+        if (c.timerName.size() >= BACKEND_TIMER.size() &&
+            c.timerName.compare(c.timerName.size() - BACKEND_TIMER.size(), BACKEND_TIMER.size(),
+                                BACKEND_TIMER) == 0) {
+            backendMilliseconds = c.milliseconds;
+        }
         inja::json timerData;
         timerData["time"] = c.milliseconds;
         if (c.timerName.empty()) {
@@ -42,6 +54,42 @@ void TF::printPerformanceReport(bool write) const {
         }
         timerList.emplace_back(timerData);
     }
+    const auto &counters = Utils::getCounters();
+    if (!counters.empty()) {
+        printFeature("performance", 4, "============ Counters ============");
+    }
+    for (const auto &[name, value] : counters) {
+        printFeature("performance", 4, "%s: %i", name, value);
+        // Report the hit rate of every cache which counts its hits and misses.
+        static const std::string HITS_SUFFIX = "_hits";
+        if (name.size() <= HITS_SUFFIX.size() ||
+            name.compare(name.size() - HITS_SUFFIX.size(), HITS_SUFFIX.size(), HITS_SUFFIX) != 0) {
+            continue;
+        }
+        auto cacheName = name.substr(0, name.size() - HITS_SUFFIX.size());
+        auto misses = counters.find(cacheName + "_misses");
+        if (misses == counters.end() || value + misses->second == 0) {
+            continue;
+        }
+        printFeature("performance", 4, "%s hit rate: %0.2f %%", cacheName,
+                     100.0 * static_cast<double>(value) /
+                         static_cast<double>(value + misses->second));
+    }
+    auto branchBytes = counters.find("branch_state_bytes");
+    auto branchStates = counters.find("branch_states");
+    if (branchBytes != counters.end() && branchStates != counters.end() &&
+        branchStates->second > 0) {
+        printFeature("performance", 4, "Memory per pending branch: %i bytes",
+                     branchBytes->second / branchStates->second);
+    }
+    // The exploration waits for the test framework while a test is output. With --async-output,
+    // rendering and writing the test are not part of this.
+    auto generatedTests = counters.find("generated_tests");
+    if (generatedTests != counters.end() && backendMilliseconds > 0) {
+        printFeature("performance", 4, "Test output throughput: %0.0f tests/s",
+                     1000.0 * static_cast<double>(generatedTests->second) /
+                         static_cast<double>(backendMilliseconds));
+    }
     if (write) {
         dataJson["timers"] = timerList;
         static const std::string TEST_CASE(R"""(Timer,Total Time,Percentage
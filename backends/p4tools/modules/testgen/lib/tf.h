@@ -19,6 +19,7 @@
 #include "ir/ir.h"
 #include "lib/cstring.h"
 
+#include "backends/p4tools/modules/testgen/lib/test_file_writer.h"
 #include "backends/p4tools/modules/testgen/lib/test_object.h"
 #include "backends/p4tools/modules/testgen/lib/test_spec.h"
 
@@ -34,9 +35,32 @@ class TF {
     /// The seed used by the testgen.
     std::optional<unsigned int> seed;
 
+    /// Renders the tests and writes them to disk.
+    TestFileWriter fileWriter;
+
+    /// The number of consecutive tests written into the same file.
+    size_t testsPerFile;
+
+    /// The number of tests written by the run that this run resumes, see @ref resume.
+    size_t resumedTests = 0;
+
     /// Creates a generic test framework.
     TF(std::filesystem::path basePath, std::optional<unsigned int> seed);
 
+    /// @returns the index of the first test in the file test @p testIdx is written to. Every
+    /// test has its own file, unless --tests-per-file is set.
+    [[nodiscard]] size_t getFileIndex(size_t testIdx) const {
+        return testIdx - testIdx % testsPerFile;
+    }
+
+    /// Prepares @p file, the file test @p testIdx is written to. If the file is at or before the
+    /// last file of the resumed run, it already holds tests of that run and is appended to.
+    void continueResumedFile(const std::filesystem::path &file, size_t testIdx) {
+        if (resumedTests > 0 && getFileIndex(testIdx) <= getFileIndex(resumedTests - 1)) {
+            fileWriter.markWritten(file);
+        }
+    }
+
     /// Converts the traces of this test into a string representation and Inja object.
     static inja::json getTrace(const TestSpec *testSpec) {
         inja::json traceList = inja::json::array();
@@ -146,6 +170,14 @@ class TF {
     virtual void outputTest(const TestSpec *spec, cstring selectedBranches, size_t testIdx,
                             float currentCoverage) = 0;
 
+    /// Continues a run which has written @p testCount tests. The next test is appended to the
+    /// last file of that run if the file is not full yet.
+    void resume(size_t testCount) { resumedTests = testCount; }
+
+    /// Blocks until all tests output so far are on disk.
+    /// @returns false if some test could not be written.
+    bool flush() { return fileWriter.flush(); }
+
     /// Print out some performance numbers if logging feature "performance" is enabled.
     /// Also log performance numbers to a separate file in the test folder if @param write is
     /// enabled.
@@ -58,6 +58,172 @@ TestgenOptions::TestgenOptions()
         "Sets the maximum number of tests to be generated [default: 1]. Setting the value to 0 "
         "will generate tests until no more paths can be found.");
 
+    registerOption(
+        "--workers", "workers",
+        [this](const char *arg) {
+            int64_t workersTmp = 0;
+            try {
+                workersTmp = std::stoll(arg);
+                if (workersTmp < 1) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+            } catch (std::invalid_argument &) {
+                ::error("Invalid input value %1% for --workers. Expected positive integer.", arg);
+                return false;
+            }
+            workers = workersTmp;
+            return true;
+        },
+        "Explore the program with the given number of worker processes [default: 1]. The top of "
+        "the execution tree is explored once, then each worker repeatedly takes the next "
+        "unexplored subtree from a queue shared by all workers until none is left. Every worker "
+        "has its own solver. Tests of worker i are written with the suffix \"_i\"; --max-tests "
+        "is shared by all workers.");
+
+    registerOption(
+        "--shard", "shard",
+        [this](const char *arg) {
+            std::string shardStr(arg);
+            auto separator = shardStr.find('/');
+            try {
+                if (separator == std::string::npos) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+                auto indexTmp = std::stoll(shardStr.substr(0, separator));
+                auto countTmp = std::stoll(shardStr.substr(separator + 1));
+                if (indexTmp < 0 || countTmp < 1 || indexTmp >= countTmp) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+                shardIndex = indexTmp;
+                numShards = countTmp;
+            } catch (std::invalid_argument &) {
+                ::error("Invalid input value %1% for --shard. Expected i/N with 0 <= i < N.", arg);
+                return false;
+            }
+            return true;
+        },
+        "Explore only shard i of N of the execution tree, given as \"i/N\". Every shard explores "
+        "the top of the tree and takes every N-th of the subtrees below it, so shards of the same "
+        "program, options and seed never generate the same path. Tests and the coverage of shard "
+        "i are written to the directory \"shard_i\" in the output directory. Shards do not "
+        "communicate, so --max-tests is divided between them and all N shards together "
+        "generate at most --max-tests tests.");
+
+    registerOption(
+        "--shards", "localShards",
+        [this](const char *arg) {
+            int64_t shardsTmp = 0;
+            try {
+                shardsTmp = std::stoll(arg);
+                if (shardsTmp < 1) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+            } catch (std::invalid_argument &) {
+                ::error("Invalid input value %1% for --shards. Expected positive integer.", arg);
+                return false;
+            }
+            localShards = shardsTmp;
+            return true;
+        },
+        "Coordinator mode: run the given number of shards as local processes, then merge their "
+        "coverage into \"coverage.json\" in the output directory. Like --workers, the shards "
+        "take the subtrees from a shared queue and share --max-tests.");
+
+    registerOption(
+        "--merge-shards", "mergeShards",
+        [this](const char *arg) {
+            int64_t shardsTmp = 0;
+            try {
+                shardsTmp = std::stoll(arg);
+                if (shardsTmp < 1) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+            } catch (std::invalid_argument &) {
+                ::error("Invalid input value %1% for --merge-shards. Expected positive integer.",
+                        arg);
+                return false;
+            }
+            mergeShards = shardsTmp;
+            return true;
+        },
+        "Do not generate tests. Merge the coverage of the given number of shards, whose "
+        "\"shard_i\" directories have been collected in the output directory, into "
+        "\"coverage.json\".");
+
+    registerOption(
+        "--checkpoint", "checkpointFile",
+        [this](const char *arg) {
+            checkpointFile = arg;
+            return true;
+        },
+        "Periodically save the state of the exploration to the given file: the pending branches, "
+        "the covered nodes, the number of generated tests and the state of the random number "
+        "generator. Only supported by the DFS and RANDOM_BACKTRACK path selection policies, and "
+        "not with --workers, --shard or --shards.");
+
+    registerOption(
+        "--checkpoint-interval", "checkpointInterval",
+        [this](const char *arg) {
+            int64_t intervalTmp = 0;
+            try {
+                intervalTmp = std::stoll(arg);
+                if (intervalTmp < 0) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+            } catch (std::invalid_argument &) {
+                ::error(
+                    "Invalid input value %1% for --checkpoint-interval. Expected non-negative "
+                    "integer.",
+                    arg);
+                return false;
+            }
+            checkpointInterval = intervalTmp;
+            return true;
+        },
+        "Minimum number of seconds between two checkpoints [default: 60]. A checkpoint is "
+        "always written when the exploration ends.");
+
+    registerOption(
+        "--resume", nullptr,
+        [this](const char *) {
+            resume = true;
+            return true;
+        },
+        "Continue the exploration saved in the --checkpoint file. Test numbering continues where "
+        "the saved run stopped, so the tests of that run are not generated again. If the saved "
+        "run used --seed, the same seed must be given.");
+
+    registerOption(
+        "--tests-per-file", "testsPerFile",
+        [this](const char *arg) {
+            int64_t testsPerFileTmp = 0;
+            try {
+                testsPerFileTmp = std::stoll(arg);
+                if (testsPerFileTmp < 1) {
+                    throw std::invalid_argument("Invalid input.");
+                }
+            } catch (std::invalid_argument &) {
+                ::error("Invalid input value %1% for --tests-per-file. Expected positive integer.",
+                        arg);
+                return false;
+            }
+            testsPerFile = testsPerFileTmp;
+            return true;
+        },
+        "Write this many consecutive tests into the same file [default: 1]. The file is named "
+        "after the first test it contains. Supported by the STF, Protobuf and Metadata test "
+        "back ends. With --resume, tests are appended to the last file of the saved run until it "
+        "is full.");
+
+    registerOption(
+        "--async-output", nullptr,
+        [this](const char *) {
+            asyncOutput = true;
+            return true;
+        },
+        "Render and write tests in a separate process, so the exploration does not wait for the "
+        "templates to be rendered or for the disk.");
+
     registerOption(
         "--stop-metric", "stopMetric",
         [this](const char *arg) {
@@ -287,9 +453,10 @@ TestgenOptions::TestgenOptions()
         "--print-performance-report", nullptr,
         [](const char *) {
             P4Testgen::enablePerformanceLogging();
+            Utils::enableCounters();
             return true;
         },
-        "Print timing report summary at the end of the program.");
+        "Print timing report summary and performance counters at the end of the program.");
 
     registerOption(
         "--dcg", "DCG",
@@ -298,7 +465,8 @@ TestgenOptions::TestgenOptions()
             return true;
         },
         R"(Build a DCG for input graph. This control flow graph directed cyclic graph can be used
-        for statement reachability analysis.)");
+        for statement reachability analysis. The coverage-guided path selection policies rank
+        branches by the statements they can reach in the DCG.)");
 
     registerOption(
         "--pattern", "pattern",
@@ -325,6 +493,25 @@ TestgenOptions::TestgenOptions()
         },
         "Produce only tests that violate the condition defined in assert calls. This will either "
         "produce no tests or only tests that contain counter examples.");
+
+    registerOption(
+        "--disable-constraint-simplifier", nullptr,
+        [this](const char * /*arg*/) {
+            simplifyConstraints = false;
+            return true;
+        },
+        "Pass branch conditions to the solver without the rewrite-based simplifier, which "
+        "decides branches that repeat or contradict a condition of their path.");
+
+    registerOption(
+        "--solver-cache", nullptr,
+        [this](const char * /*arg*/) {
+            solverCache = true;
+            return true;
+        },
+        "Split solver queries into independent parts and answer repeated parts from a cache. "
+        "Models of earlier queries along the same path are reused without invoking the solver "
+        "when they satisfy the new constraint.");
 }
 
 }  // namespace P4Tools
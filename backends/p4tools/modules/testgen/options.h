@@ -21,6 +21,39 @@ class TestgenOptions : public AbstractP4cToolOptions {
     /// Maximum number of tests to be generated. Defaults to 1.
     int64_t maxTests = 1;
 
+    /// Number of worker processes which explore disjoint subtrees of the execution tree in
+    /// parallel. Each worker has its own solver. Defaults to 1.
+    uint64_t workers = 1;
+
+    /// Index of the shard of the execution tree explored by this process. See @var numShards.
+    uint64_t shardIndex = 0;
+
+    /// Number of shards the execution tree is split into. Shards are explored by independent
+    /// processes, possibly on different hosts. 1 disables sharding.
+    uint64_t numShards = 1;
+
+    /// Coordinator mode: run this many shards as local processes and merge their coverage.
+    /// 0 if disabled.
+    uint64_t localShards = 0;
+
+    /// Only merge the coverage of this many shards, which have already been run. 0 if disabled.
+    uint64_t mergeShards = 0;
+
+    /// File to which the state of the exploration is saved periodically. Empty if disabled.
+    std::string checkpointFile;
+
+    /// Minimum number of seconds between two checkpoints. Defaults to 60.
+    uint64_t checkpointInterval = 60;
+
+    /// Continue the exploration saved in @var checkpointFile instead of starting a new one.
+    bool resume = false;
+
+    /// Number of consecutive tests written into the same file. Defaults to 1.
+    uint64_t testsPerFile = 1;
+
+    /// Render and write tests in a separate process, so the exploration does not wait on disk.
+    bool asyncOutput = false;
+
     /// Selects the path selection policy for test generation
     P4Testgen::PathSelectionPolicy pathSelectionPolicy = P4Testgen::PathSelectionPolicy::DepthFirst;
 
@@ -74,6 +107,14 @@ class TestgenOptions : public AbstractP4cToolOptions {
     /// This will either produce no tests or only tests that contain counter examples.
     bool assertionModeEnabled = false;
 
+    /// Simplify path constraints and decide trivial branches before invoking the solver. This is
+    /// active by default.
+    bool simplifyConstraints = true;
+
+    /// Answer solver queries from a cache of independent sub-queries where possible. Off by
+    /// default.
+    bool solverCache = false;
+
     /// Specifies, which IR nodes to track for coverage in the targeted P4 program.
     /// Multiple options are possible. Currently supported: STATEMENTS, TABLE_ENTRIES.
     P4::Coverage::CoverageOptions coverageOptions;
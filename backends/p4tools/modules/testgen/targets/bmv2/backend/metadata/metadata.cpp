@@ -138,7 +138,7 @@ void Metadata::computeTraceData(const TestSpec *testSpec, inja::json &dataJson)
 }
 
 void Metadata::emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_t testId,
-                            const std::string &testCase, float currentCoverage) {
+                            float currentCoverage) {
     inja::json dataJson;
     if (selectedBranches != nullptr) {
         dataJson["selected_branches"] = selectedBranches.c_str();
@@ -173,18 +173,25 @@ void Metadata::emitTestcase(const TestSpec *testSpec, cstring selectedBranches,
 
     LOG5("Metadata back end: emitting testcase:" << std::setw(4) << dataJson);
 
-    inja::render_to(metadataFile, testCase, dataJson);
-    metadataFile.flush();
+    auto metadataFile = basePath;
+    auto fileIdx = getFileIndex(testId);
+    metadataFile.concat("_" + std::to_string(fileIdx));
+    metadataFile.replace_extension(".yml");
+    continueResumedFile(metadataFile, testId);
+    // Tests which share a file are separate YAML documents.
+    if (fileWriter.hasWritten(metadataFile)) {
+        fileWriter.write("separator", inja::json::object(), metadataFile);
+    }
+    fileWriter.write("test", dataJson, metadataFile);
 }
 
 void Metadata::outputTest(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
                           float currentCoverage) {
-    auto incrementedbasePath = basePath;
-    incrementedbasePath.concat("_" + std::to_string(testIdx));
-    incrementedbasePath.replace_extension(".yml");
-    metadataFile = std::ofstream(incrementedbasePath);
-    std::string testCase = getTestCaseTemplate();
-    emitTestcase(testSpec, selectedBranches, testIdx, testCase, currentCoverage);
+    if (!fileWriter.hasTemplate("test")) {
+        fileWriter.addTemplate("test", getTestCaseTemplate());
+        fileWriter.addTemplate("separator", "---\n");
+    }
+    emitTestcase(testSpec, selectedBranches, testIdx, currentCoverage);
 }
 
 }  // namespace P4Tools::P4Testgen::Bmv2
@@ -2,7 +2,6 @@
 
 #include <algorithm>
 #include <filesystem>
-#include <fstream>
 #include <iomanip>
 #include <list>
 #include <map>
@@ -379,7 +378,7 @@ entities : [
 }
 
 void Protobuf::emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
-                            const std::string &testCase, float currentCoverage) {
+                            float currentCoverage) {
     inja::json dataJson;
     if (selectedBranches != nullptr) {
         dataJson["selected_branches"] = selectedBranches.c_str();
@@ -402,16 +401,18 @@ void Protobuf::emitTestcase(const TestSpec *testSpec, cstring selectedBranches,
 
     LOG5("Protobuf test back end: emitting testcase:" << std::setw(4) << dataJson);
     auto protobufFile = basePath;
-    protobufFile.replace_extension("_" + std::to_string(testIdx) + ".proto");
-    auto protobufFileStream = std::ofstream(protobufFile);
-    inja::render_to(protobufFileStream, testCase, dataJson);
-    protobufFileStream.flush();
+    auto fileIdx = getFileIndex(testIdx);
+    protobufFile.replace_extension("_" + std::to_string(fileIdx) + ".proto");
+    continueResumedFile(protobufFile, testIdx);
+    fileWriter.write("test", dataJson, protobufFile);
 }
 
 void Protobuf::outputTest(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
                           float currentCoverage) {
-    std::string testCase = getTestCaseTemplate();
-    emitTestcase(testSpec, selectedBranches, testIdx, testCase, currentCoverage);
+    if (!fileWriter.hasTemplate("test")) {
+        fileWriter.addTemplate("test", getTestCaseTemplate());
+    }
+    emitTestcase(testSpec, selectedBranches, testIdx, currentCoverage);
 }
 
 }  // namespace P4Tools::P4Testgen::Bmv2
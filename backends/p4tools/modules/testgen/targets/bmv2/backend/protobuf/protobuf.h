@@ -54,7 +54,7 @@ class Protobuf : public TF {
     /// @param currentCoverage contains statistics  about the current coverage of this test and its
     /// preceding tests.
     void emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
-                      const std::string &testCase, float currentCoverage);
+                      float currentCoverage);
 
     /// @returns the inja test case template as a string.
     static std::string getTestCaseTemplate();
@@ -20,6 +20,7 @@
 
 #include "backends/p4tools/modules/testgen/lib/exceptions.h"
 #include "backends/p4tools/modules/testgen/lib/tf.h"
+#include "backends/p4tools/modules/testgen/options.h"
 #include "backends/p4tools/modules/testgen/targets/bmv2/test_spec.h"
 
 namespace P4Tools::P4Testgen::Bmv2 {
@@ -310,8 +311,8 @@ class AbstractTest(bt.P4RuntimeTest):
         dataJson["seed"] = *seed;
     }
 
-    inja::render_to(ptfFileStream, PREAMBLE, dataJson);
-    ptfFileStream.flush();
+    fileWriter.addTemplate("preamble", PREAMBLE);
+    fileWriter.write("preamble", dataJson, ptfFile);
 }
 
 std::string PTF::getTestCaseTemplate() {
@@ -418,7 +419,7 @@ class Test{{test_id}}(AbstractTest):
 }
 
 void PTF::emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
-                       const std::string &testCase, float currentCoverage) {
+                       float currentCoverage) {
     inja::json dataJson;
     if (selectedBranches != nullptr) {
         dataJson["selected_branches"] = selectedBranches.c_str();
@@ -446,21 +447,23 @@ void PTF::emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_
 
     LOG5("PTF backend: emitting testcase:" << std::setw(4) << dataJson);
 
-    inja::render_to(ptfFileStream, testCase, dataJson);
-    ptfFileStream.flush();
+    fileWriter.write("test", dataJson, ptfFile);
 }
 
 void PTF::outputTest(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
                      float currentCoverage) {
     if (!preambleEmitted) {
-        auto ptfFile = basePath;
+        ptfFile = basePath;
+        // A resumed run must not overwrite the tests of the runs before it.
+        if (TestgenOptions::get().resume) {
+            ptfFile.concat("_" + std::to_string(testIdx));
+        }
         ptfFile.replace_extension(".py");
-        ptfFileStream = std::ofstream(ptfFile);
+        fileWriter.addTemplate("test", getTestCaseTemplate());
         emitPreamble();
         preambleEmitted = true;
     }
-    std::string testCase = getTestCaseTemplate();
-    emitTestcase(testSpec, selectedBranches, testIdx, testCase, currentCoverage);
+    emitTestcase(testSpec, selectedBranches, testIdx, currentCoverage);
 }
 
 }  // namespace P4Tools::P4Testgen::Bmv2
@@ -1,6 +1,5 @@
 #include "backends/p4tools/modules/testgen/targets/bmv2/backend/stf/stf.h"
 
-#include <fstream>
 #include <iomanip>
 #include <list>
 #include <map>
@@ -264,7 +263,7 @@ expect {{verify.eg_port}} {{verify.exp_pkt}}$
 }
 
 void STF::emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
-                       const std::string &testCase, float currentCoverage) {
+                       float currentCoverage) {
     inja::json dataJson;
     if (selectedBranches != nullptr) {
         dataJson["selected_branches"] = selectedBranches.c_str();
@@ -293,16 +292,18 @@ void STF::emitTestcase(const TestSpec *testSpec, cstring selectedBranches, size_
 
     LOG5("STF test back end: emitting testcase:" << std::setw(4) << dataJson);
     auto stfFile = basePath;
-    stfFile.replace_extension("_" + std::to_string(testIdx) + ".stf");
-    auto stfFileStream = std::ofstream(stfFile);
-    inja::render_to(stfFileStream, testCase, dataJson);
-    stfFileStream.flush();
+    auto fileIdx = getFileIndex(testIdx);
+    stfFile.replace_extension("_" + std::to_string(fileIdx) + ".stf");
+    continueResumedFile(stfFile, testIdx);
+    fileWriter.write("test", dataJson, stfFile);
 }
 
 void STF::outputTest(const TestSpec *testSpec, cstring selectedBranches, size_t testIdx,
                      float currentCoverage) {
-    std::string testCase = getTestCaseTemplate();
-    emitTestcase(testSpec, selectedBranches, testIdx, testCase, currentCoverage);
+    if (!fileWriter.hasTemplate("test")) {
+        fileWriter.addTemplate("test", getTestCaseTemplate());
+    }
+    emitTestcase(testSpec, selectedBranches, testIdx, currentCoverage);
 }
 
 }  // namespace P4Tools::P4Testgen::Bmv2
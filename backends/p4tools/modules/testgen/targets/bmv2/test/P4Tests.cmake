@@ -37,6 +37,9 @@ set(EXTRA_OPTS "--strict --print-traces --seed 1000 --max-tests 10 ")
 # ASSERT_ASSUME TESTS
 include(${CMAKE_CURRENT_LIST_DIR}/AssumeAssertTests.cmake)
 
+# PARALLEL TESTS
+include(${CMAKE_CURRENT_LIST_DIR}/ParallelTests.cmake)
+
 # Protobuf
 if(P4TOOLS_TESTGEN_BMV2_TEST_PROTOBUF)
   p4tools_add_tests(
@@ -0,0 +1,56 @@
+# Tests which check that parallel and sharded explorations reach the same coverage and generate
+# the same number of tests as a serial exploration of the whole execution tree.
+
+# Add a test which explores ${p4test} exhaustively: serially, with local shards, with --workers
+# and with independent shards which are merged afterwards.
+# Arguments:
+#   - alias is the name of the test. Must be unique across the test suite.
+#   - p4test is the P4 program to explore.
+#   - shards is the number of shards and workers.
+function(p4tools_add_parallel_test alias p4test shards)
+  set(__tag "testgen-p4c-bmv2-parallel")
+  p4c_test_set_name(__testname ${__tag} ${alias})
+  set(__testfile "${P4TESTGEN_DIR}/${__tag}/${alias}.test")
+  set(__testfolder "${P4TESTGEN_DIR}/${__tag}/${alias}.out")
+  set(__args "--target bmv2 --arch v1model -I${P4C_BINARY_DIR}/p4include --test-backend STF --seed 1000 --max-tests 0 --track-coverage STATEMENTS")
+  math(EXPR __lastShard "${shards} - 1")
+  file(WRITE ${__testfile} "#! /usr/bin/env bash\n")
+  file(APPEND ${__testfile} "# Generated file, modify with care\n\n")
+  file(APPEND ${__testfile} "set -e\n")
+  file(APPEND ${__testfile} "cd ${P4C_BINARY_DIR}\n")
+  file(APPEND ${__testfile} "rm -rf ${__testfolder}\n")
+  file(APPEND ${__testfile} "${P4TESTGEN_DRIVER} ${__args} --shards 1 --out-dir ${__testfolder}/serial ${p4test}\n")
+  file(APPEND ${__testfile} "${P4TESTGEN_DRIVER} ${__args} --shards ${shards} --out-dir ${__testfolder}/local ${p4test}\n")
+  file(APPEND ${__testfile} "${P4TESTGEN_DRIVER} ${__args} --workers ${shards} --out-dir ${__testfolder}/workers ${p4test}\n")
+  file(APPEND ${__testfile} "for shard in $(seq 0 ${__lastShard})\n")
+  file(APPEND ${__testfile} "do\n")
+  file(APPEND ${__testfile} "\t${P4TESTGEN_DRIVER} ${__args} --shard \${shard}/${shards} --out-dir ${__testfolder}/merged ${p4test}\n")
+  file(APPEND ${__testfile} "done\n")
+  file(APPEND ${__testfile} "${P4TESTGEN_DRIVER} ${__args} --merge-shards ${shards} --out-dir ${__testfolder}/merged ${p4test}\n")
+  # Every path is explored exactly once, so all runs cover the same nodes with the same number
+  # of tests.
+  file(APPEND ${__testfile} "python3 - ${__testfolder} <<'END'\n")
+  file(APPEND ${__testfile} "import json, pathlib, sys\n")
+  file(APPEND ${__testfile} "out = pathlib.Path(sys.argv[1])\n")
+  file(APPEND ${__testfile} "runs = {run: json.loads((out / run / 'coverage.json').read_text()) for run in ('serial', 'local', 'merged')}\n")
+  file(APPEND ${__testfile} "serial = runs['serial']\n")
+  file(APPEND ${__testfile} "assert serial['covered_nodes'], 'The serial run covers no nodes.'\n")
+  file(APPEND ${__testfile} "for run, coverage in runs.items():\n")
+  file(APPEND ${__testfile} "    assert coverage['covered_nodes'] == serial['covered_nodes'], run + ': the covered nodes differ.'\n")
+  file(APPEND ${__testfile} "    assert coverage['tests'] == serial['tests'], run + ': the number of tests differs.'\n")
+  file(APPEND ${__testfile} "serialFiles = len(list((out / 'serial').glob('shard_0/*.stf')))\n")
+  file(APPEND ${__testfile} "workerFiles = len(list((out / 'workers').glob('*.stf')))\n")
+  file(APPEND ${__testfile} "assert workerFiles == serialFiles, 'workers: the number of tests differs.'\n")
+  file(APPEND ${__testfile} "END\n")
+  execute_process(COMMAND chmod +x ${__testfile})
+  add_test(
+    NAME ${__testname}
+    COMMAND ${__tag}/${alias}.test
+    WORKING_DIRECTORY ${P4TESTGEN_DIR}
+  )
+  set_tests_properties(${__testname} PROPERTIES LABELS "${__tag}" TIMEOUT 300)
+endfunction(p4tools_add_parallel_test)
+
+p4tools_add_parallel_test(
+  "bmv2_table_ternary" "${CMAKE_CURRENT_LIST_DIR}/p4-programs/bmv2_table_ternary.p4" 4
+)
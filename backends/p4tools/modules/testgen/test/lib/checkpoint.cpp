@@ -0,0 +1,42 @@
+#include "backends/p4tools/modules/testgen/test/lib/checkpoint.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "backends/p4tools/modules/testgen/lib/checkpoint.h"
+
+namespace Test {
+
+namespace {
+
+using P4Tools::P4Testgen::Checkpoint;
+
+/// A saved checkpoint is read back unchanged.
+TEST_F(CheckpointTest, SaveAndLoad) {
+    auto path = std::filesystem::temp_directory_path() / "p4testgen_checkpoint_test.json";
+    Checkpoint checkpoint;
+    checkpoint.testCount = 42;
+    checkpoint.seed = 1000;
+    checkpoint.randomState = "1 2 3";
+    checkpoint.coveredNodes = {"a.p4:3:4/objects:2/body:2", "a.p4:7:4/objects:2/body:3"};
+    checkpoint.pendingPaths = {{1, 2}, {2}, {1, 1, 3}};
+    ASSERT_TRUE(checkpoint.save(path));
+
+    auto loaded = Checkpoint::load(path);
+    std::filesystem::remove(path);
+    ASSERT_TRUE(loaded.has_value());
+    EXPECT_EQ(loaded->testCount, 42);
+    EXPECT_EQ(loaded->seed, std::optional<uint32_t>(1000));
+    EXPECT_EQ(loaded->randomState, "1 2 3");
+    EXPECT_EQ(loaded->coveredNodes, checkpoint.coveredNodes);
+    EXPECT_EQ(loaded->pendingPaths, checkpoint.pendingPaths);
+}
+
+}  // namespace
+
+}  // namespace Test
@@ -0,0 +1,93 @@
+#include "backends/p4tools/modules/testgen/test/lib/constraint_simplifier.h"
+
+#include <gtest/gtest.h>
+
+#include <optional>
+#include <vector>
+
+#include "backends/p4tools/common/lib/constraint_simplifier.h"
+#include "backends/p4tools/common/lib/variables.h"
+#include "ir/ir.h"
+#include "ir/irutils.h"
+
+namespace Test {
+
+namespace {
+
+using P4Tools::ConstraintSimplifier;
+using P4Tools::ToolsVariables;
+
+/// @returns true if @p expr is the boolean literal @p value.
+bool isLiteral(const IR::Expression *expr, bool value) {
+    const auto *boolLiteral = expr->to<IR::BoolLiteral>();
+    return boolLiteral != nullptr && boolLiteral->value == value;
+}
+
+/// Boolean rewrites fold contradictions, tautologies and redundant muxes.
+TEST_F(ConstraintSimplifierTest, Simplify) {
+    const auto *boolType = IR::Type_Boolean::get();
+    const auto *typeBits = IR::getBitType(8);
+    const auto *valid = ToolsVariables::getSymbolicVariable(boolType, 0, "simplify_valid");
+    const auto *field = ToolsVariables::getSymbolicVariable(typeBits, 0, "simplify_field");
+
+    const auto *contradiction = new IR::LAnd(boolType, valid, new IR::LNot(boolType, valid));
+    EXPECT_TRUE(isLiteral(ConstraintSimplifier::simplify(contradiction), false));
+
+    const auto *tautology = new IR::LOr(boolType, valid, new IR::LNot(boolType, valid));
+    EXPECT_TRUE(isLiteral(ConstraintSimplifier::simplify(tautology), true));
+
+    const auto *repeated = new IR::LAnd(boolType, valid, valid);
+    EXPECT_TRUE(ConstraintSimplifier::simplify(repeated)->equiv(*valid));
+
+    const auto *selfEqual = new IR::Equ(boolType, field, field);
+    EXPECT_TRUE(isLiteral(ConstraintSimplifier::simplify(selfEqual), true));
+
+    const auto *mux = new IR::Mux(boolType, valid, IR::getBoolLiteral(true),
+                                  IR::getBoolLiteral(false));
+    EXPECT_TRUE(ConstraintSimplifier::simplify(mux)->equiv(*valid));
+
+    // Taint stands for an unknown value, so two taints are not equal.
+    const auto *taint = ToolsVariables::getTaintExpression(typeBits);
+    const auto *taintEqual = new IR::Equ(boolType, taint, taint);
+    EXPECT_FALSE(ConstraintSimplifier::simplify(taintEqual)->is<IR::BoolLiteral>());
+}
+
+/// Constraints which repeat or contradict a condition of the path are decided.
+TEST_F(ConstraintSimplifierTest, Decide) {
+    const auto *boolType = IR::Type_Boolean::get();
+    const auto *typeBits = IR::getBitType(8);
+    const auto *valid = ToolsVariables::getSymbolicVariable(boolType, 0, "decide_valid");
+    const auto *field = ToolsVariables::getSymbolicVariable(typeBits, 0, "decide_field");
+    const auto *other = ToolsVariables::getSymbolicVariable(typeBits, 0, "decide_other");
+    auto fieldIs = [&](const IR::Expression *var, int value) {
+        return new IR::Equ(boolType, var, IR::getConstant(typeBits, value));
+    };
+    auto fieldIsNot = [&](const IR::Expression *var, int value) {
+        return new IR::Neq(boolType, var, IR::getConstant(typeBits, value));
+    };
+
+    std::vector<const IR::Expression *> path = {new IR::LAnd(boolType, valid, fieldIs(field, 4))};
+    EXPECT_EQ(ConstraintSimplifier::decide(path, valid), std::optional<bool>(true));
+    EXPECT_EQ(ConstraintSimplifier::decide(path, new IR::LNot(boolType, valid)),
+              std::optional<bool>(false));
+    EXPECT_EQ(ConstraintSimplifier::decide(path, fieldIs(field, 4)), std::optional<bool>(true));
+    EXPECT_EQ(ConstraintSimplifier::decide(path, fieldIs(field, 5)), std::optional<bool>(false));
+    EXPECT_EQ(ConstraintSimplifier::decide(path, fieldIsNot(field, 5)),
+              std::optional<bool>(true));
+    EXPECT_EQ(ConstraintSimplifier::decide(path, fieldIs(other, 4)), std::nullopt);
+
+    path = {fieldIsNot(field, 4)};
+    EXPECT_EQ(ConstraintSimplifier::decide(path, fieldIs(field, 4)), std::optional<bool>(false));
+    EXPECT_EQ(ConstraintSimplifier::decide(path, fieldIs(field, 5)), std::nullopt);
+
+    // Only the given part of the path is assumed to hold.
+    path = {valid, fieldIs(field, 4)};
+    EXPECT_EQ(ConstraintSimplifier::decide(path.begin(), path.end() - 1, fieldIs(field, 4)),
+              std::nullopt);
+    EXPECT_EQ(ConstraintSimplifier::decide(path.begin(), path.end() - 1, valid),
+              std::optional<bool>(true));
+}
+
+}  // namespace
+
+}  // namespace Test
@@ -0,0 +1,13 @@
+#ifndef BACKENDS_P4TOOLS_MODULES_TESTGEN_TEST_LIB_CONSTRAINT_SIMPLIFIER_H_
+#define BACKENDS_P4TOOLS_MODULES_TESTGEN_TEST_LIB_CONSTRAINT_SIMPLIFIER_H_
+
+#include "backends/p4tools/modules/testgen/test/gtest_utils.h"
+
+namespace Test {
+
+/// Helper methods to build configurations for constraint simplifier tests.
+class ConstraintSimplifierTest : public P4ToolsTest {};
+
+}  // namespace Test
+
+#endif /* BACKENDS_P4TOOLS_MODULES_TESTGEN_TEST_LIB_CONSTRAINT_SIMPLIFIER_H_ */
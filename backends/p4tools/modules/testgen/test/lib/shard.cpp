@@ -0,0 +1,52 @@
+#include "backends/p4tools/modules/testgen/test/lib/shard.h"
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "backends/p4tools/modules/testgen/lib/shard.h"
+
+namespace Test {
+
+namespace {
+
+using P4Tools::P4Testgen::ShardCoverage;
+
+/// Merging unites the covered nodes and adds up the tests of all shards.
+TEST_F(ShardTest, Merge) {
+    auto outputDir = std::filesystem::temp_directory_path() / "p4testgen_shard_test";
+    std::vector<std::vector<std::string>> covered = {
+        {"a.p4:4:8/objects:3/body:2", "a.p4:1:8/objects:1/body:2"},
+        {"a.p4:2:8/objects:2/body:2", "a.p4:4:8/objects:3/body:2"},
+        {}};
+    for (size_t shardIndex = 0; shardIndex < covered.size(); shardIndex++) {
+        auto shardDir = ShardCoverage::getDirectory(outputDir, shardIndex);
+        std::filesystem::create_directories(shardDir);
+        ShardCoverage coverage;
+        coverage.shardIndex = shardIndex;
+        coverage.numShards = covered.size();
+        coverage.testCount = 2;
+        coverage.coverableNodes = 10;
+        coverage.coveredNodes = covered[shardIndex];
+        ASSERT_TRUE(coverage.save(ShardCoverage::getFile(shardDir)));
+    }
+
+    auto merged = ShardCoverage::merge(outputDir, covered.size());
+    ASSERT_TRUE(merged.has_value());
+    EXPECT_EQ(merged->testCount, 6);
+    EXPECT_EQ(merged->coverableNodes, 10U);
+    EXPECT_EQ(merged->coveredNodes,
+              std::vector<std::string>({"a.p4:1:8/objects:1/body:2", "a.p4:2:8/objects:2/body:2",
+                                        "a.p4:4:8/objects:3/body:2"}));
+
+    auto reloaded = ShardCoverage::load(ShardCoverage::getFile(outputDir));
+    std::filesystem::remove_all(outputDir);
+    ASSERT_TRUE(reloaded.has_value());
+    EXPECT_EQ(reloaded->coveredNodes, merged->coveredNodes);
+}
+
+}  // namespace
+
+}  // namespace Test
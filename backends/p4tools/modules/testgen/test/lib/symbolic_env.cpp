@@ -0,0 +1,106 @@
+#include "backends/p4tools/modules/testgen/test/lib/symbolic_env.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "backends/p4tools/common/lib/persistent.h"
+#include "backends/p4tools/common/lib/symbolic_env.h"
+#include "backends/p4tools/common/lib/variables.h"
+#include "ir/ir.h"
+#include "ir/irutils.h"
+
+namespace Test {
+
+namespace {
+
+using P4Tools::SharedTailList;
+using P4Tools::SymbolicEnv;
+using P4Tools::ToolsVariables;
+
+const IR::Constant *getValue(const SymbolicEnv &env, const IR::StateVariable &var) {
+    return env.get(var)->checkedTo<IR::Constant>();
+}
+
+/// Copies of an environment share their bindings, but updates to one copy are not visible in
+/// the other.
+TEST_F(SymbolicEnvTest, CopiesAreIndependent) {
+    const auto *type = IR::getBitType(8);
+    std::vector<const IR::StateVariable *> vars;
+    for (int idx = 0; idx < 16; idx++) {
+        vars.push_back(&ToolsVariables::getStateVariable(type, "var" + std::to_string(idx)));
+    }
+
+    SymbolicEnv parent;
+    for (const auto *var : vars) {
+        parent.set(*var, IR::getConstant(type, 1));
+    }
+    SymbolicEnv child(parent);
+    EXPECT_EQ(child.getOwnedSize(), 0U);
+    child.set(*vars[0], IR::getConstant(type, 2));
+    parent.set(*vars[1], IR::getConstant(type, 3));
+    EXPECT_EQ(child.getOwnedSize(), 1U);
+
+    EXPECT_EQ(getValue(parent, *vars[0])->asInt(), 1);
+    EXPECT_EQ(getValue(parent, *vars[1])->asInt(), 3);
+    EXPECT_EQ(getValue(child, *vars[0])->asInt(), 2);
+    EXPECT_EQ(getValue(child, *vars[1])->asInt(), 1);
+
+    // A long chain of copies still sees the latest binding of each variable.
+    SymbolicEnv chain(child);
+    for (int idx = 0; idx < 100; idx++) {
+        chain.set(*vars[idx % vars.size()], IR::getConstant(type, idx));
+        SymbolicEnv copy(chain);
+        chain = copy;
+    }
+    EXPECT_EQ(getValue(chain, *vars[3])->asInt(), 99);
+    EXPECT_EQ(getValue(chain, *vars[4])->asInt(), 84);
+    EXPECT_EQ(getValue(child, *vars[3])->asInt(), 1);
+
+    auto flattened = chain.getInternalMap();
+    EXPECT_EQ(flattened.size(), vars.size());
+    EXPECT_EQ(flattened.at(*vars[3])->checkedTo<IR::Constant>()->asInt(), 99);
+}
+
+/// Appending to a copy of a list does not change the original.
+TEST_F(SymbolicEnvTest, SharedTailList) {
+    SharedTailList<int> list;
+    list.push_back(1);
+    list.push_back(2);
+    auto copy = list;
+    copy.push_back(3);
+    list.push_back(4);
+    EXPECT_EQ(list.toVector(), std::vector<int>({1, 2, 4}));
+    EXPECT_EQ(copy.toVector(), std::vector<int>({1, 2, 3}));
+
+    // Appending after a read keeps the elements of the list and its copies apart.
+    auto other = list;
+    list.push_back(5);
+    other.push_back(6);
+    EXPECT_EQ(list.toVector(), std::vector<int>({1, 2, 4, 5}));
+    EXPECT_EQ(other.toVector(), std::vector<int>({1, 2, 4, 6}));
+    other.push_back(7);
+    EXPECT_EQ(list.toVector(), std::vector<int>({1, 2, 4, 5}));
+    EXPECT_EQ(other.toVector(), std::vector<int>({1, 2, 4, 6, 7}));
+}
+
+/// Reading the most recent elements of a list does not materialize it.
+TEST_F(SymbolicEnvTest, SharedTailListSuffix) {
+    SharedTailList<int> list;
+    list.push_back(1);
+    list.push_back(2);
+    auto copy = list;
+    copy.push_back(3);
+    copy.push_back(4);
+    EXPECT_EQ(copy.suffix(2), std::vector<int>({3, 4}));
+    EXPECT_EQ(copy.suffix(4), std::vector<int>());
+    EXPECT_EQ(copy.suffix(0), std::vector<int>({1, 2, 3, 4}));
+    EXPECT_EQ(copy.materializedCapacity(), 0U);
+    EXPECT_EQ(copy.toVector().size(), 4U);
+    EXPECT_GE(copy.materializedCapacity(), 4U);
+}
+
+}  // namespace
+
+}  // namespace Test
@@ -38,7 +38,7 @@ TEST_F(TaintTest, Taint01) {
         const auto *taintExpression = ToolsVariables::getTaintExpression(typeBits);
         const auto *constantVar = IR::getConstant(typeBits, 2);
         const auto *expr = new IR::Add(constantVar, taintExpression);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), expr);
+        const auto *taintedExpr = Taint::propagateTaint(env, expr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -46,7 +46,7 @@ TEST_F(TaintTest, Taint01) {
         const auto *constantVar1 = IR::getConstant(typeBits, 2);
         const auto *constantVar2 = IR::getConstant(typeBits, 2);
         const auto *expr = new IR::Add(constantVar1, constantVar2);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), expr);
+        const auto *taintedExpr = Taint::propagateTaint(env, expr);
         const auto *expectedExpr = IR::getConstant(typeBits, 2);
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -73,7 +73,7 @@ TEST_F(TaintTest, Taint02) {
         const auto *expr =
             new IR::Concat(IR::getBitType(16), IR::getConstant(typeBits, 2), taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 15, 8);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = IR::getConstant(typeBits, 0);
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -81,7 +81,7 @@ TEST_F(TaintTest, Taint02) {
         const auto *expr =
             new IR::Concat(IR::getBitType(16), taintExpression, IR::getConstant(typeBits, 2));
         const auto *slicedExpr = new IR::Slice(expr, 7, 0);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = IR::getConstant(typeBits, 0);
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -103,7 +103,7 @@ TEST_F(TaintTest, Taint03) {
         const auto *expr =
             new IR::Concat(IR::getBitType(16), IR::getConstant(typeBits, 2), taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 7, 0);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -111,7 +111,7 @@ TEST_F(TaintTest, Taint03) {
         const auto *expr =
             new IR::Concat(IR::getBitType(16), taintExpression, IR::getConstant(typeBits, 2));
         const auto *slicedExpr = new IR::Slice(expr, 15, 8);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -133,7 +133,7 @@ TEST_F(TaintTest, Taint04) {
         const auto *expr =
             new IR::Concat(IR::getBitType(16), IR::getConstant(typeBits, 2), taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 11, 4);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -141,7 +141,7 @@ TEST_F(TaintTest, Taint04) {
         const auto *expr =
             new IR::Concat(IR::getBitType(16), taintExpression, IR::getConstant(typeBits, 2));
         const auto *slicedExpr = new IR::Slice(expr, 11, 4);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -164,7 +164,7 @@ TEST_F(TaintTest, Taint05) {
         const auto *expr = new IR::Concat(IR::getBitType(16), taintExpression, constantVar);
         expr = new IR::Concat(IR::getBitType(24), taintExpression, expr);
         const auto *slicedExpr = new IR::Slice(expr, 11, 4);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -172,7 +172,7 @@ TEST_F(TaintTest, Taint05) {
         const auto *expr = new IR::Concat(IR::getBitType(16), taintExpression, constantVar);
         expr = new IR::Concat(IR::getBitType(24), taintExpression, expr);
         const auto *slicedExpr = new IR::Slice(expr, 19, 12);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -195,7 +195,7 @@ TEST_F(TaintTest, Taint06) {
         const auto *expr = new IR::Concat(IR::getBitType(16), constantVar, taintExpression);
         expr = new IR::Concat(IR::getBitType(24), expr, constantVar);
         const auto *slicedExpr = new IR::Slice(expr, 11, 4);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -203,7 +203,7 @@ TEST_F(TaintTest, Taint06) {
         const auto *expr = new IR::Concat(IR::getBitType(16), constantVar, taintExpression);
         expr = new IR::Concat(IR::getBitType(24), expr, constantVar);
         const auto *slicedExpr = new IR::Slice(expr, 19, 12);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = taintExpression;
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -228,7 +228,7 @@ TEST_F(TaintTest, Taint07) {
         expr = new IR::Concat(IR::getBitType(24), expr, taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 11, 4);
         slicedExpr = new IR::Slice(slicedExpr, 9, 8);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = IR::getConstant(IR::getBitType(2), 0);
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -237,7 +237,7 @@ TEST_F(TaintTest, Taint07) {
         expr = new IR::Concat(IR::getBitType(24), expr, taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 19, 12);
         slicedExpr = new IR::Slice(slicedExpr, 7, 5);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = IR::getConstant(IR::getBitType(3), 0);
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -261,7 +261,7 @@ TEST_F(TaintTest, Taint08) {
         expr = new IR::Concat(IR::getBitType(24), expr, taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 11, 4);
         slicedExpr = new IR::Slice(slicedExpr, 4, 3);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = ToolsVariables::getTaintExpression(IR::getBitType(2));
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -270,7 +270,7 @@ TEST_F(TaintTest, Taint08) {
         expr = new IR::Concat(IR::getBitType(24), expr, taintExpression);
         const auto *slicedExpr = new IR::Slice(expr, 19, 12);
         slicedExpr = new IR::Slice(slicedExpr, 2, 0);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), slicedExpr);
+        const auto *taintedExpr = Taint::propagateTaint(env, slicedExpr);
         const auto *expectedExpr = ToolsVariables::getTaintExpression(IR::getBitType(3));
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
@@ -325,7 +325,7 @@ TEST_F(TaintTest, Taint10) {
         const auto *constantVar1 = IR::getConstant(typeBits, 2);
         const auto *constantVar2 = IR::getConstant(typeBits, 2);
         const auto *expr = new IR::Slice(new IR::Add(constantVar1, constantVar2), 3, 0);
-        const auto *taintedExpr = Taint::propagateTaint(env.getInternalMap(), expr);
+        const auto *taintedExpr = Taint::propagateTaint(env, expr);
         const auto *expectedExpr = IR::getConstant(IR::getBitType(4), 0);
         ASSERT_TRUE(taintedExpr->equiv(*expectedExpr));
     }
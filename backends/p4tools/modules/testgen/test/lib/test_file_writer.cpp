@@ -0,0 +1,123 @@
+#include "backends/p4tools/modules/testgen/test/lib/test_file_writer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <inja/inja.hpp>
+
+#include "backends/p4tools/modules/testgen/lib/test_file_writer.h"
+
+namespace Test {
+
+namespace {
+
+using P4Tools::P4Testgen::TestFileWriter;
+
+/// @returns the contents of @p file.
+std::string readFile(const std::filesystem::path &file) {
+    std::ifstream stream(file);
+    return {std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>()};
+}
+
+/// Writes two files, the first of which holds two tests, and checks their contents. Both files
+/// exist before the run and are truncated when they are first written.
+void checkWriter(bool async) {
+    auto outputDir = std::filesystem::temp_directory_path() / "p4testgen_file_writer_test";
+    std::filesystem::create_directories(outputDir);
+    auto first = outputDir / "test_0.stf";
+    auto second = outputDir / "test_2.stf";
+    for (const auto &file : {first, second}) {
+        std::ofstream stale(file);
+        stale << "stale\n";
+    }
+
+    TestFileWriter writer(async);
+    writer.addTemplate("test", "# test {{test_id}}\npacket {{packet}}\n");
+    // Test 2 is aborted, so test 3 is the first test written into the second file.
+    for (int testId : {0, 1, 3}) {
+        inja::json data;
+        data["test_id"] = testId;
+        data["packet"] = "0a\n0b";
+        writer.write("test", data, testId < 2 ? first : second);
+    }
+    EXPECT_TRUE(writer.flush());
+    EXPECT_TRUE(writer.hasWritten(second));
+
+    EXPECT_EQ(readFile(first), "# test 0\npacket 0a\n0b\n# test 1\npacket 0a\n0b\n");
+    EXPECT_EQ(readFile(second), "# test 3\npacket 0a\n0b\n");
+
+    // Writing after a flush continues where the writer left off.
+    inja::json data;
+    data["test_id"] = 4;
+    data["packet"] = "0c";
+    writer.write("test", data, second);
+    EXPECT_TRUE(writer.flush());
+    EXPECT_EQ(readFile(second), "# test 3\npacket 0a\n0b\n# test 4\npacket 0c\n");
+
+    // A resumed run appends to the files which hold tests of the run before it.
+    TestFileWriter resumed(async);
+    resumed.addTemplate("test", "# test {{test_id}}\npacket {{packet}}\n");
+    resumed.markWritten(second);
+    data["test_id"] = 5;
+    resumed.write("test", data, second);
+    EXPECT_TRUE(resumed.flush());
+    EXPECT_EQ(readFile(second),
+              "# test 3\npacket 0a\n0b\n# test 4\npacket 0c\n# test 5\npacket 0c\n");
+    std::filesystem::remove_all(outputDir);
+}
+
+/// Measures how many tests per second the exploration can pass to the writer and records the
+/// result as a test property. Tests are batched into files of 100 tests.
+void measureThroughput(bool async) {
+    static constexpr int TEST_COUNT = 10000;
+    static constexpr int TESTS_PER_FILE = 100;
+    auto outputDir = std::filesystem::temp_directory_path() / "p4testgen_file_writer_throughput";
+    std::filesystem::create_directories(outputDir);
+
+    TestFileWriter writer(async);
+    writer.addTemplate("test",
+                       "# test {{test_id}}\n## for packet in packets\npacket {{packet}}\n"
+                       "## endfor\n");
+    inja::json data;
+    data["packets"] = inja::json::array({"0a0b0c0d0e0f", "000102030405", "ffffffffffff"});
+    auto start = std::chrono::steady_clock::now();
+    for (int testId = 0; testId < TEST_COUNT; testId++) {
+        data["test_id"] = testId;
+        auto fileIdx = testId - testId % TESTS_PER_FILE;
+        writer.write("test", data, outputDir / ("test_" + std::to_string(fileIdx) + ".stf"));
+    }
+    auto submitted = std::chrono::steady_clock::now();
+    EXPECT_TRUE(writer.flush());
+    auto written = std::chrono::steady_clock::now();
+
+    auto testsPerSecond = [](std::chrono::steady_clock::duration duration) {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+        return static_cast<int>(TEST_COUNT * 1000000.0 / static_cast<double>(micros + 1));
+    };
+    // The exploration only waits for the submission; the writer finishes in the background.
+    ::testing::Test::RecordProperty("submitted_tests_per_second", testsPerSecond(submitted - start));
+    ::testing::Test::RecordProperty("written_tests_per_second", testsPerSecond(written - start));
+
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(outputDir),
+                            std::filesystem::directory_iterator()),
+              TEST_COUNT / TESTS_PER_FILE);
+    EXPECT_NE(readFile(outputDir / "test_9900.stf").find("# test 9999\n"), std::string::npos);
+    std::filesystem::remove_all(outputDir);
+}
+
+TEST_F(TestFileWriterTest, Synchronous) { checkWriter(false); }
+
+TEST_F(TestFileWriterTest, Asynchronous) { checkWriter(true); }
+
+TEST_F(TestFileWriterTest, SynchronousThroughput) { measureThroughput(false); }
+
+TEST_F(TestFileWriterTest, AsynchronousThroughput) { measureThroughput(true); }
+
+}  // namespace
+
+}  // namespace Test
@@ -21,6 +21,7 @@
 #include "lib/compile_context.h"
 #include "lib/enumerator.h"
 #include "lib/exceptions.h"
+#include "midend/coverage.h"
 #include "test/gtest/env.h"
 
 namespace Test {
@@ -223,6 +224,53 @@ TEST_F(P4CReachability, testTableAndActions) {
     ASSERT_TRUE(!dcg->isReachable(egress, myAction7));
 }
 
+TEST_F(P4CReachability, testReachabilityIndex) {
+    auto result = loadExampleForReachability(
+        "backends/p4tools/modules/testgen/targets/bmv2/test/p4-programs/bmv2_hit.p4");
+    const auto *program = get<0>(result);
+    ASSERT_TRUE(program);
+    const auto *dcg = std::get<1>(result);
+    ASSERT_TRUE(dcg);
+    auto hash = std::get<2>(result);
+    P4::Coverage::CollectNodes collectNodes({true, false});
+    program->apply(collectNodes);
+    const auto &coverableNodes = collectNodes.getCoverableNodes();
+    P4Tools::ReachabilityIndex index(*dcg, coverableNodes);
+    ASSERT_TRUE(index.numComponents() > 0);
+    std::vector<const IR::Node *> vertices;
+    for (const auto *name : {"ingress", "egress", "ingress.hit_table", "ingress.MyAction3",
+                             "ingress.MyAction7"}) {
+        const auto *vertex = getFromHash(hash, name);
+        ASSERT_TRUE(vertex);
+        vertices.push_back(vertex);
+    }
+    // The index agrees with the search of the DCG.
+    for (const auto *start : vertices) {
+        for (const auto *element : vertices) {
+            auto reachable = index.isReachable(start, element);
+            ASSERT_TRUE(reachable.has_value());
+            ASSERT_EQ(reachable.value(), dcg->isReachable(start, element));
+        }
+    }
+    // Nodes outside of the DCG are not indexed.
+    ASSERT_FALSE(index.isReachable(vertices[0], new IR::EmptyStatement()).has_value());
+    ASSERT_EQ(index.getReachableNodes(new IR::EmptyStatement()), nullptr);
+    const auto *ingress = vertices[0];
+    const auto *egress = vertices[1];
+    const auto *ingressNodes = index.getReachableNodes(ingress);
+    const auto *egressNodes = index.getReachableNodes(egress);
+    ASSERT_TRUE(ingressNodes);
+    ASSERT_TRUE(egressNodes);
+    // Only coverable nodes are collected.
+    ASSERT_FALSE(ingressNodes->hasNodesNotIn(coverableNodes));
+    // Everything reachable from egress is reachable from ingress, but not the other way round.
+    ASSERT_FALSE(egressNodes->hasNodesNotIn(*ingressNodes));
+    ASSERT_TRUE(ingressNodes->hasNodesNotIn(*egressNodes));
+    // Once all nodes reachable from ingress are covered, nothing is left to cover.
+    ASSERT_EQ(ingressNodes->countNotIn(*ingressNodes), 0U);
+    ASSERT_EQ(ingressNodes->countNotIn(P4::Coverage::CoverageSet()), ingressNodes->size());
+}
+
 TEST_F(P4CReachability, testSwitchStatement) {
     auto result = loadExampleForReachability("testdata/p4_16_samples/basic_routing-bmv2.p4");
     const auto *program = get<0>(result);
@@ -328,7 +376,8 @@ TEST_F(P4CReachability, testReachabilityEngine) {
     const auto hash = std::get<2>(result);
     std::string strBehavior = "ingress.MyAction1 + ingress.MyAction2;";
     strBehavior += "ingress.table2";
-    P4Tools::ReachabilityEngine engine(*dcg, strBehavior);
+    P4Tools::ReachabilityIndex index(*dcg, P4::Coverage::CoverageSet());
+    P4Tools::ReachabilityEngine engine(*dcg, index, strBehavior);
     auto *engineState = P4Tools::ReachabilityEngineState::getInitial();
     // Initialize engine.
     const auto *ingress = getFromHash(hash, "ingress");
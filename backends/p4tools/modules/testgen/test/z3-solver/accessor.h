@@ -33,6 +33,12 @@ class Z3SolverAccessor {
     /// Gets checkpoints that have been made. Used by GTests only.
     std::vector<size_t> &getCheckpoints() { return solver.checkpoints; }
 
+    /// Gets the number of cached expression translations. Used by GTests only.
+    size_t getTranslationCacheSize() { return solver.translationCache.size(); }
+
+    /// Gets the stack of declared variables. Used by GTests only.
+    const Z3DeclaredVariablesMap &getDeclaredVars() { return solver.declaredVarsById; }
+
  private:
     /// Pointer to a solver.
     Z3Solver &solver;
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <optional>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -10,11 +11,17 @@
 #include <boost/multiprecision/number.hpp>
 #include <boost/multiprecision/traits/explicit_conversion.hpp>
 
+#include "backends/p4tools/common/core/caching_solver.h"
 #include "backends/p4tools/common/core/z3_solver.h"
 #include "backends/p4tools/common/lib/model.h"
+#include "backends/p4tools/common/lib/util.h"
 #include "ir/declaration.h"
 #include "ir/indexed_vector.h"
 #include "ir/ir.h"
+#include "ir/irutils.h"
+#include "ir/json_generator.h"
+#include "ir/json_loader.h"
+#include "ir/json_parser.h"
 #include "lib/big_int_util.h"
 #include "lib/cstring.h"
 #include "lib/enumerator.h"
@@ -28,6 +35,7 @@
 
 namespace Test {
 
+using P4Tools::CachingSolver;
 using P4Tools::Model;
 using P4Tools::Z3Solver;
 using P4Tools::Z3SolverAccessor;
@@ -206,6 +214,107 @@ TEST_F(Z3SolverTest, Assertion2Model) {
     ASSERT_TRUE((intA1 + intAddToA) % 16 < intB1);
 }
 
+/// Test that translations are reused after the assertions have been popped.
+TEST_F(Z3SolverTest, TranslationCache) {
+    ASSERT_TRUE(opLss);
+
+    Z3Solver solver;
+    Z3SolverAccessor solverAccessor(solver);
+
+    std::vector<const P4Tools::Constraint *> asserts;
+    asserts.push_back(opLss);
+    ASSERT_EQ(solver.checkSat(asserts), true);
+    // hdr.h.a + 4w15 < hdr.h.b has five nodes.
+    auto cacheSize = solverAccessor.getTranslationCacheSize();
+    ASSERT_EQ(cacheSize, 5U);
+
+    // Pop everything, then assert the same expression again.
+    ASSERT_EQ(solver.checkSat({}), true);
+    ASSERT_EQ(solver.checkSat(asserts), true);
+    ASSERT_EQ(solverAccessor.getTranslationCacheSize(), cacheSize);
+
+    // The variables were not declared again, but must still be part of the model.
+    auto symbolMap = solver.getSymbolicMapping();
+    ASSERT_EQ(symbolMap.size(), 2U);
+    ASSERT_GT(symbolMap.count(opLss->right->to<IR::SymbolicVariable>()), 0U);
+}
+
+/// Test that a reused translation declares its variables in the current context again, so that
+/// they are part of the serialized solver state.
+TEST_F(Z3SolverTest, TranslationCacheDeclarations) {
+    ASSERT_TRUE(opLss);
+
+    Z3Solver solver;
+    Z3SolverAccessor solverAccessor(solver);
+
+    std::vector<const P4Tools::Constraint *> asserts;
+    asserts.push_back(opLss);
+    ASSERT_EQ(solver.checkSat(asserts), true);
+    ASSERT_EQ(solver.checkSat({}), true);
+    ASSERT_EQ(solver.checkSat(asserts), true);
+
+    // One context for the top level and one for the assertion, which declares both variables.
+    const auto &declarations = solverAccessor.getDeclaredVars();
+    ASSERT_EQ(declarations.size(), 2U);
+    ASSERT_EQ(declarations.back().size(), 2U);
+
+    std::stringstream out;
+    JSONGenerator json(out);
+    solver.toJSON(json);
+    JSONLoader loader(out);
+    JSONLoader declarationsLoader(loader, "declarations");
+    ASSERT_TRUE(declarationsLoader.json);
+    const auto *declarationsJson = declarationsLoader.json->to<JsonVector>();
+    ASSERT_TRUE(declarationsJson);
+    ASSERT_EQ(declarationsJson->size(), 2U);
+    const auto *latestJson = declarationsJson->back()->to<JsonVector>();
+    ASSERT_TRUE(latestJson);
+    ASSERT_EQ(latestJson->size(), 2U);
+}
+
+/// Test that the caching solver splits queries into independent components and caches them.
+TEST_F(Z3SolverTest, CachingSolver) {
+    P4Tools::Utils::enableCounters();
+    ASSERT_TRUE(opLss);
+
+    Z3Solver z3Solver;
+    CachingSolver solver(z3Solver);
+
+    const auto *type = IR::getBitType(4);
+    const auto *varC = new IR::SymbolicVariable(type, "c");
+    const auto *opEqu = new IR::Equ(varC, IR::getConstant(type, 3));
+    std::vector<const P4Tools::Constraint *> asserts = {opLss, opEqu};
+    ASSERT_EQ(solver.checkSat(asserts), true);
+    auto symbolMap = solver.getSymbolicMapping();
+    ASSERT_EQ(symbolMap.size(), 3U);
+    ASSERT_EQ(symbolMap.at(varC)->checkedTo<IR::Constant>()->asInt(), 3);
+
+    // Both components are answered from the cache.
+    const auto &counters = P4Tools::Utils::getCounters();
+    auto hits = counters.count("solver_query_cache_hits") != 0
+                    ? counters.at("solver_query_cache_hits")
+                    : 0;
+    ASSERT_EQ(solver.checkSat({opEqu, opLss}), true);
+    ASSERT_EQ(counters.at("solver_query_cache_hits"), hits + 2);
+    ASSERT_EQ(solver.getSymbolicMapping().size(), 3U);
+
+    // A contradiction in one component makes the whole query unsatisfiable.
+    const auto *opNeq = new IR::Neq(varC, IR::getConstant(type, 3));
+    ASSERT_EQ(solver.checkSat({opLss, opEqu, opNeq}), false);
+    EXPECT_THROW(solver.getSymbolicMapping(), Util::CompilerBug);
+
+    // A constraint which holds under the cached model of the rest of its component reuses that
+    // model without invoking the underlying solver.
+    auto reuses = counters.count("solver_model_reuses") != 0 ? counters.at("solver_model_reuses")
+                                                              : 0;
+    auto z3Calls = counters.at("z3_check_sat_calls");
+    const auto *opLssC = new IR::Lss(varC, IR::getConstant(type, 5));
+    ASSERT_EQ(solver.checkSat({opEqu, opLssC}), true);
+    ASSERT_EQ(counters.at("solver_model_reuses"), reuses + 1);
+    ASSERT_EQ(counters.at("z3_check_sat_calls"), z3Calls);
+    ASSERT_EQ(solver.getSymbolicMapping().at(varC)->checkedTo<IR::Constant>()->asInt(), 3);
+}
+
 }  // anonymous namespace
 
 }  // namespace Test
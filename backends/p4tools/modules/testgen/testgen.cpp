@@ -1,18 +1,32 @@
 #include "backends/p4tools/modules/testgen/testgen.h"
 
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
 #include <filesystem>
+#include <functional>
 #include <iostream>
+#include <new>
 #include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "backends/p4tools/common/core/caching_solver.h"
 #include "backends/p4tools/common/core/solver.h"
 #include "backends/p4tools/common/core/z3_solver.h"
 #include "backends/p4tools/common/lib/util.h"
 #include "frontends/common/parser_options.h"
 #include "lib/cstring.h"
 #include "lib/error.h"
+#include "lib/timer.h"
+#include "midend/coverage.h"
 
 #include "backends/p4tools/modules/testgen/core/program_info.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/depth_first.h"
@@ -23,7 +37,11 @@
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/selected_branches.h"
 #include "backends/p4tools/modules/testgen/core/symbolic_executor/symbolic_executor.h"
 #include "backends/p4tools/modules/testgen/core/target.h"
+#include "backends/p4tools/modules/testgen/lib/checkpoint.h"
+#include "backends/p4tools/modules/testgen/lib/execution_state.h"
+#include "backends/p4tools/modules/testgen/lib/final_state.h"
 #include "backends/p4tools/modules/testgen/lib/logging.h"
+#include "backends/p4tools/modules/testgen/lib/shard.h"
 #include "backends/p4tools/modules/testgen/lib/test_backend.h"
 #include "backends/p4tools/modules/testgen/options.h"
 #include "backends/p4tools/modules/testgen/register.h"
@@ -55,57 +73,199 @@ SymbolicExecutor *pickExecutionEngine(const TestgenOptions &testgenOptions,
     return new DepthFirstSearch(solver, *programInfo);
 }
 
-int Testgen::mainImpl(const IR::P4Program *program) {
-    // Register all available testgen targets.
-    // These are discovered by CMAKE, which fills out the register.h.in file.
-    registerTestgenTargets();
+namespace {
 
-    const auto *programInfo = TestgenTarget::initProgram(program);
-    if (programInfo == nullptr) {
-        ::error("Program not supported by target device and architecture.");
-        return EXIT_FAILURE;
+/// @returns the share of the test budget @p maxTests of shard @p shardIndex of @p numShards,
+/// or std::nullopt if the budget is too small to give this shard a test. A budget of 0 means
+/// unlimited and is passed on to every shard.
+std::optional<int64_t> getShardTests(int64_t maxTests, uint64_t shardIndex, uint64_t numShards) {
+    if (maxTests <= 0) {
+        return 0;
     }
-    if (::errorCount() > 0) {
-        ::error("Testgen: Encountered errors during preprocessing. Exiting");
-        return EXIT_FAILURE;
+    auto total = static_cast<int64_t>(numShards);
+    auto index = static_cast<int64_t>(shardIndex);
+    auto shardTests = maxTests / total + (index < maxTests % total ? 1 : 0);
+    if (shardTests == 0) {
+        return std::nullopt;
     }
+    return shardTests;
+}
 
-    // Print basic information for each test.
-    enableInformationLogging();
+/// Work shared by the worker processes of one run. It lives in anonymous shared memory, which
+/// the workers inherit from the process that forks them, so it only holds lock-free atomics.
+struct SharedWork {
+    /// The index of the next subtree to explore.
+    std::atomic<uint64_t> nextSubtree{0};
 
-    // Get the options and the seed.
-    const auto &testgenOptions = TestgenOptions::get();
-    auto seed = Utils::getCurrentSeed();
-    if (seed) {
-        printFeature("test_info", 4, "============ Program seed %1% =============\n", *seed);
+    /// The number of tests which may still be generated. Negative if the budget is unlimited.
+    std::atomic<int64_t> remainingTests{-1};
+
+    /// Reserves a test of the budget. @returns false if the budget is exhausted.
+    bool reserveTest() {
+        auto remaining = remainingTests.load();
+        while (remaining != 0) {
+            if (remaining < 0 || remainingTests.compare_exchange_weak(remaining, remaining - 1)) {
+                return true;
+            }
+        }
+        return false;
     }
 
-    // Get the filename of the input file and remove the extension
-    // This assumes that inputFile is not null.
-    auto const inputFile = P4CContext::get().options().file;
-    auto testPath = std::filesystem::path(inputFile.c_str()).stem();
-    // Create the directory, if the directory string is valid and if it does not exist.
-    cstring testDirStr = testgenOptions.outputDir;
-    if (!testDirStr.isNullOrEmpty()) {
-        auto testDir = std::filesystem::path(testDirStr.c_str());
-        std::filesystem::create_directories(testDir);
-        testPath = testDir / testPath;
+    /// Gives back a test reserved with reserveTest, which was not generated.
+    void releaseTest() {
+        if (remainingTests.load() >= 0) {
+            remainingTests++;
+        }
     }
-    // Need to declare the solver here to ensure its lifetime.
+
+    /// @returns true if no test can be reserved anymore.
+    [[nodiscard]] bool isExhausted() const { return remainingTests.load() == 0; }
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<int64_t>::is_always_lock_free,
+              "SharedWork is shared between processes and must not use locks.");
+
+/// The part of the execution tree explored by one process.
+struct Partition {
+    /// The states at the top of the execution tree, see SymbolicExecutor::expandFrontier. The
+    /// process explores some of their subtrees. Empty if the process explores the whole tree.
+    std::vector<std::reference_wrapper<ExecutionState>> frontier;
+
+    /// If set, the subtrees are taken from the queue of the shared work, and the tests from its
+    /// budget.
+    SharedWork *sharedWork = nullptr;
+
+    /// Otherwise, the process explores the subtrees whose index modulo @var count is
+    /// @var index.
+    uint64_t index = 0;
+    uint64_t count = 1;
+
+    /// @returns the index of the next subtree to explore after the subtree @p last, or
+    /// std::nullopt if there is none.
+    std::optional<size_t> next(std::optional<size_t> last) const {
+        size_t subtree = 0;
+        if (sharedWork != nullptr) {
+            subtree = sharedWork->nextSubtree++;
+        } else {
+            subtree = last.has_value() ? *last + count : index;
+        }
+        if (subtree >= frontier.size()) {
+            return std::nullopt;
+        }
+        return subtree;
+    }
+};
+
+/// @returns the states at the top of the execution tree, enough to give each of @p numWorkers
+/// workers several subtrees. This keeps the work balanced when some subtrees are much smaller
+/// than others.
+std::vector<std::reference_wrapper<ExecutionState>> getFrontier(const ProgramInfo *programInfo,
+                                                                uint64_t numWorkers) {
     Z3Solver solver;
-    auto *symExec = pickExecutionEngine(testgenOptions, programInfo, solver);
+    auto *symExec = pickExecutionEngine(TestgenOptions::get(), programInfo, solver);
+    return symExec->expandFrontier(numWorkers * 16);
+}
+
+/// Writes the coverage of shard @p shardIndex of @p numShards into @p shardDir.
+void saveShardCoverage(const ProgramInfo *programInfo, const std::filesystem::path &shardDir,
+                       uint64_t shardIndex, uint64_t numShards, int64_t testCount,
+                       const P4::Coverage::CoverageSet &visitedNodes) {
+    ShardCoverage coverage;
+    coverage.shardIndex = shardIndex;
+    coverage.numShards = numShards;
+    coverage.testCount = testCount;
+    coverage.coverableNodes = programInfo->getCoverableNodes().size();
+    coverage.coveredNodes = P4::Coverage::getStableIds(visitedNodes);
+    coverage.save(ShardCoverage::getFile(shardDir));
+}
+
+/// Generates the tests of the part @p partition of the execution tree. If @p shard is set, the
+/// process is this shard and writes its coverage next to its tests.
+int generateTests(const ProgramInfo *programInfo, const std::filesystem::path &testPath,
+                  std::optional<uint32_t> seed, const Partition &partition,
+                  std::optional<uint64_t> shard = std::nullopt) {
+    const auto &testgenOptions = TestgenOptions::get();
+    // Need to declare the solver here to ensure its lifetime.
+    Z3Solver z3Solver;
+    AbstractSolver *solver = &z3Solver;
+    // Optionally, queries go through a cache which splits them into independent parts.
+    std::optional<CachingSolver> cachingSolver;
+    if (testgenOptions.solverCache) {
+        solver = &cachingSolver.emplace(z3Solver);
+    }
+    auto *symExec = pickExecutionEngine(testgenOptions, programInfo, *solver);
 
     // Define how to handle the final state for each test. This is target defined.
     auto *testBackend = TestgenTarget::getTestBackend(*programInfo, *symExec, testPath, seed);
     // Each test back end has a different run function.
     // We delegate execution to the symbolic executor.
-    auto callBack = [testBackend](auto &&finalState) {
-        return testBackend->run(std::forward<decltype(finalState)>(finalState));
+    bool terminated = false;
+    auto *sharedWork = partition.sharedWork;
+    auto callBack = [testBackend, sharedWork, &terminated](const FinalState &finalState) {
+        if (sharedWork == nullptr) {
+            terminated = testBackend->run(finalState);
+            return terminated;
+        }
+        if (!sharedWork->reserveTest()) {
+            terminated = true;
+            return terminated;
+        }
+        auto testCount = testBackend->getTestCount();
+        terminated = testBackend->run(finalState);
+        if (testBackend->getTestCount() == testCount) {
+            sharedWork->releaseTest();
+        }
+        terminated = terminated || sharedWork->isExhausted();
+        return terminated;
     };
 
+    if (!testgenOptions.checkpointFile.empty()) {
+        auto checkpointPath = std::filesystem::path(testgenOptions.checkpointFile);
+        if (testgenOptions.resume) {
+            auto checkpoint = Checkpoint::load(checkpointPath);
+            if (!checkpoint.has_value()) {
+                return EXIT_FAILURE;
+            }
+            if (checkpoint->seed != seed) {
+                ::error("Checkpoint %1% was saved by a run with another --seed. Resume it with the "
+                        "same seed.",
+                        checkpointPath.string());
+                return EXIT_FAILURE;
+            }
+            // An exploration without pending paths has finished.
+            if (checkpoint->pendingPaths.empty() ||
+                (testgenOptions.maxTests > 0 && checkpoint->testCount >= testgenOptions.maxTests)) {
+                printInfo("Checkpoint %1%: the exploration is already complete.",
+                          checkpointPath.string());
+                return EXIT_SUCCESS;
+            }
+            testBackend->restoreCheckpoint(*checkpoint);
+            if (!symExec->restorePendingPaths(checkpoint->pendingPaths)) {
+                ::error("Checkpoint %1%: unable to replay any pending path.",
+                        checkpointPath.string());
+                return EXIT_FAILURE;
+            }
+            // The replay may have used the random number generator.
+            if (checkpoint->seed.has_value()) {
+                Utils::setRandomState(checkpoint->randomState);
+            }
+        }
+        testBackend->enableCheckpoints(checkpointPath);
+    }
+
     try {
+        // Time the exploration apart from the compilation of the program.
+        Util::ScopedTimer explorationTimer("exploration");
         // Run the symbolic executor with given exploration strategy.
-        symExec->run(callBack);
+        if (partition.frontier.empty()) {
+            symExec->run(callBack);
+        } else {
+            for (auto subtree = partition.next(std::nullopt); subtree.has_value() && !terminated;
+                 subtree = partition.next(subtree)) {
+                symExec->setInitialState(partition.frontier[*subtree]);
+                symExec->run(callBack);
+            }
+        }
     } catch (...) {
         if (testgenOptions.trackBranches) {
             // Print list of the selected branches and store all information into
@@ -116,6 +276,14 @@ int Testgen::mainImpl(const IR::P4Program *program) {
         }
         throw;
     }
+    testBackend->flushTests();
+    if (!testgenOptions.checkpointFile.empty()) {
+        testBackend->saveCheckpoint();
+    }
+    if (shard.has_value()) {
+        saveShardCoverage(programInfo, testPath.parent_path(), *shard, partition.count,
+                          testBackend->getTestCount(), symExec->getVisitedNodes());
+    }
     // Emit a performance report, if desired.
     testBackend->printPerformanceReport(true);
 
@@ -129,4 +297,215 @@ int Testgen::mainImpl(const IR::P4Program *program) {
     return ::errorCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
 }
 
+/// Runs @p numWorkers worker processes and waits for all of them. The top of the execution tree
+/// is explored once, by this process, and the workers inherit the states below it. Each worker
+/// then repeatedly takes the next unexplored subtree from a shared queue, so workers which
+/// finish early take over the remaining subtrees. The test budget is shared the same way.
+/// IR nodes and cstrings are not thread-safe, so processes, rather than threads, provide the
+/// isolation. Workers write their tests with the suffix "_i", or, if @p sharded is set, into
+/// the directory of their shard.
+int runWorkers(const ProgramInfo *programInfo, const std::filesystem::path &testPath,
+               std::optional<uint32_t> seed, uint64_t numWorkers, bool sharded) {
+    auto &testgenOptions = TestgenOptions::get();
+    Partition partition;
+    partition.count = numWorkers;
+    partition.frontier = getFrontier(programInfo, numWorkers);
+    if (::errorCount() > 0) {
+        return EXIT_FAILURE;
+    }
+    void *memory = mmap(nullptr, sizeof(SharedWork), PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        ::error("Testgen: Unable to share work between workers: %1%", strerror(errno));
+        return EXIT_FAILURE;
+    }
+    partition.sharedWork = new (memory) SharedWork();
+    if (testgenOptions.maxTests > 0) {
+        partition.sharedWork->remainingTests = testgenOptions.maxTests;
+    }
+    // Only the shared budget limits the workers.
+    testgenOptions.maxTests = 0;
+
+    std::vector<pid_t> workers;
+    for (uint64_t workerIndex = 0; workerIndex < numWorkers; workerIndex++) {
+        // Flush before forking so buffered output is not duplicated in the children.
+        std::cout.flush();
+        std::cerr.flush();
+        pid_t pid = fork();
+        if (pid < 0) {
+            ::error("Testgen: Unable to start worker %1%: %2%", workerIndex, strerror(errno));
+            break;
+        }
+        if (pid == 0) {
+            auto workerPath = testPath;
+            std::optional<uint64_t> shard;
+            if (sharded) {
+                auto shardDir = ShardCoverage::getDirectory(testPath.parent_path(), workerIndex);
+                std::filesystem::create_directories(shardDir);
+                workerPath = shardDir / testPath.filename();
+                shard = workerIndex;
+            } else {
+                workerPath += "_" + std::to_string(workerIndex);
+            }
+            int result = EXIT_FAILURE;
+            try {
+                result = generateTests(programInfo, workerPath, seed, partition, shard);
+            } catch (const std::exception &e) {
+                std::cerr << "Worker " << workerIndex << ": " << e.what() << std::endl;
+            }
+            std::cout.flush();
+            std::cerr.flush();
+            // Do not run the parent's exit handlers in the child.
+            _exit(result);
+        }
+        workers.push_back(pid);
+    }
+
+    int result = ::errorCount() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    for (auto pid : workers) {
+        int status = 0;
+        if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status) ||
+            WEXITSTATUS(status) != EXIT_SUCCESS) {
+            result = EXIT_FAILURE;
+        }
+    }
+    munmap(memory, sizeof(SharedWork));
+    return result;
+}
+
+/// Merges the coverage of @p numShards shards in @p outputDir and reports it.
+int mergeShards(const ProgramInfo *programInfo, const std::filesystem::path &outputDir,
+                uint64_t numShards) {
+    auto merged = ShardCoverage::merge(outputDir, numShards);
+    if (!merged.has_value()) {
+        return EXIT_FAILURE;
+    }
+    const auto &coverableNodes = programInfo->getCoverableNodes();
+    if (merged->coverableNodes != coverableNodes.size()) {
+        ::error("The shards were run on a different program or with different coverage options.");
+        return EXIT_FAILURE;
+    }
+    printInfo("============ Merged %1% shards: %2% tests ============", numShards,
+              merged->testCount);
+    P4::Coverage::printCoverageReport(coverableNodes, merged->getCoveredNodes(coverableNodes));
+    return EXIT_SUCCESS;
+}
+
+}  // namespace
+
+int Testgen::mainImpl(const IR::P4Program *program) {
+    // Register all available testgen targets.
+    // These are discovered by CMAKE, which fills out the register.h.in file.
+    registerTestgenTargets();
+
+    const auto *programInfo = TestgenTarget::initProgram(program);
+    if (programInfo == nullptr) {
+        ::error("Program not supported by target device and architecture.");
+        return EXIT_FAILURE;
+    }
+    if (::errorCount() > 0) {
+        ::error("Testgen: Encountered errors during preprocessing. Exiting");
+        return EXIT_FAILURE;
+    }
+
+    // Print basic information for each test.
+    enableInformationLogging();
+
+    // Get the options and the seed.
+    auto &testgenOptions = TestgenOptions::get();
+    auto seed = Utils::getCurrentSeed();
+    if (seed) {
+        printFeature("test_info", 4, "============ Program seed %1% =============\n", *seed);
+    }
+
+    // Get the filename of the input file and remove the extension
+    // This assumes that inputFile is not null.
+    auto const inputFile = P4CContext::get().options().file;
+    auto testPath = std::filesystem::path(inputFile.c_str()).stem();
+    // Create the directory, if the directory string is valid and if it does not exist.
+    cstring testDirStr = testgenOptions.outputDir;
+    if (!testDirStr.isNullOrEmpty()) {
+        auto testDir = std::filesystem::path(testDirStr.c_str());
+        std::filesystem::create_directories(testDir);
+        testPath = testDir / testPath;
+    }
+    if (testgenOptions.resume && testgenOptions.checkpointFile.empty()) {
+        ::error("--resume requires --checkpoint.");
+        return EXIT_FAILURE;
+    }
+    auto outputDir = testPath.parent_path();
+    if (testgenOptions.mergeShards > 0) {
+        return mergeShards(programInfo, outputDir, testgenOptions.mergeShards);
+    }
+    bool sharded = testgenOptions.localShards > 0 || testgenOptions.numShards > 1;
+    bool parallel = sharded || testgenOptions.workers > 1;
+    if (sharded && testgenOptions.workers > 1) {
+        ::error("--workers cannot be combined with --shard or --shards. Use more shards instead.");
+        return EXIT_FAILURE;
+    }
+    if (parallel && !testgenOptions.selectedBranches.empty()) {
+        ::error(
+            "--input-branches replays a single path and cannot be used with --workers, --shard or "
+            "--shards.");
+        return EXIT_FAILURE;
+    }
+    if (!testgenOptions.checkpointFile.empty()) {
+        if (parallel) {
+            ::error("--checkpoint cannot be used with --workers, --shard or --shards.");
+            return EXIT_FAILURE;
+        }
+        const auto &policy = testgenOptions.pathSelectionPolicy;
+        if ((policy != PathSelectionPolicy::DepthFirst &&
+             policy != PathSelectionPolicy::RandomBacktrack) ||
+            !testgenOptions.selectedBranches.empty()) {
+            ::error(
+                "--checkpoint is only supported by the DFS and RANDOM_BACKTRACK path selection "
+                "policies.");
+            return EXIT_FAILURE;
+        }
+    }
+    if (testgenOptions.localShards == 1) {
+        // A single shard is explored by this process.
+        auto shardDir = ShardCoverage::getDirectory(outputDir, 0);
+        std::filesystem::create_directories(shardDir);
+        auto result = generateTests(programInfo, shardDir / testPath.filename(), seed, {}, 0);
+        if (result != EXIT_SUCCESS) {
+            return result;
+        }
+        return mergeShards(programInfo, outputDir, 1);
+    }
+    if (testgenOptions.localShards > 1) {
+        auto result = runWorkers(programInfo, testPath, seed, testgenOptions.localShards, true);
+        if (result != EXIT_SUCCESS) {
+            return result;
+        }
+        return mergeShards(programInfo, outputDir, testgenOptions.localShards);
+    }
+    if (testgenOptions.numShards > 1) {
+        auto shardDir = ShardCoverage::getDirectory(outputDir, testgenOptions.shardIndex);
+        std::filesystem::create_directories(shardDir);
+        // Shards on other hosts can not share the budget. Divide --max-tests between the shards,
+        // so that the merged run generates at most --max-tests tests.
+        auto shardTests = getShardTests(testgenOptions.maxTests, testgenOptions.shardIndex,
+                                        testgenOptions.numShards);
+        if (!shardTests.has_value()) {
+            saveShardCoverage(programInfo, shardDir, testgenOptions.shardIndex,
+                              testgenOptions.numShards, 0, {});
+            return EXIT_SUCCESS;
+        }
+        testgenOptions.maxTests = *shardTests;
+        // Every shard computes the same frontier and explores every N-th subtree of it.
+        Partition partition;
+        partition.index = testgenOptions.shardIndex;
+        partition.count = testgenOptions.numShards;
+        partition.frontier = getFrontier(programInfo, testgenOptions.numShards);
+        return generateTests(programInfo, shardDir / testPath.filename(), seed, partition,
+                             testgenOptions.shardIndex);
+    }
+    if (testgenOptions.workers > 1) {
+        return runWorkers(programInfo, testPath, seed, testgenOptions.workers, false);
+    }
+    return generateTests(programInfo, testPath, seed, {});
+}
+
 }  // namespace P4Tools::P4Testgen
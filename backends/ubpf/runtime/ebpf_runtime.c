@@ -27,6 +27,8 @@ limitations under the License.
 #define DELIM   '_'
 
 static int debug = 0;
+static uint64_t benchmark_iterations = 0;
+static const char *benchmark_json = NULL;
 
 void usage(char *name) {
     fprintf(stderr, "This program expects a pcap file pattern, "
@@ -34,11 +36,13 @@ void usage(char *name) {
             "in the order given by the packet time,"
             "then feeds the individual packets into a filter function, "
             "and returns the output.\n");
-    fprintf(stderr, "Usage: %s [-d] -f file.pcap -n num_pcaps\n", name);
+    fprintf(stderr, "Usage: %s [-d] [-b iterations [-j file.json]] -f file.pcap -n num_pcaps\n", name);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "\t-d: Turn on debug messages\n");
     fprintf(stderr, "\t-f: The input pcap file\n");
     fprintf(stderr, "\t-n: Specifies the number of input pcap files\n");
+    fprintf(stderr, "\t-b: Benchmark the program, replaying the packets the given number of times\n");
+    fprintf(stderr, "\t-j: Write the benchmark results to the given JSON file instead of stdout\n");
     exit(EXIT_FAILURE);
 }
 
@@ -57,9 +61,10 @@ static pcap_list_t *get_packets(const char *pcap_base, uint16_t num_pcaps, pcap_
     return merge_and_delete_lists(tmp_list_array, merged_list);
 }
 
-void launch_runtime(const char *pcap_name, uint16_t num_pcaps) {
+int launch_runtime(const char *pcap_name, uint16_t num_pcaps) {
+    int status = EXIT_SUCCESS;
     if (num_pcaps == 0)
-        return;
+        return status;
     /* Initialize the list of input packets */
     pcap_list_t *input_list = allocate_pkt_list();
 
@@ -79,9 +84,14 @@ void launch_runtime(const char *pcap_name, uint16_t num_pcaps) {
     /* Sort the list */
     sort_pcap_list(input_list);
     /* Run the "program" and retrieve output lists */
-    RUN(entry, pcap_base, num_pcaps, input_list, debug);
+    if (benchmark_iterations > 0)
+        /* Replay the packets and report the results, no output is written */
+        status = BENCHMARK(entry, input_list, benchmark_iterations, benchmark_json);
+    else
+        RUN(entry, pcap_base, num_pcaps, input_list, debug);
     /* Delete the list of input packets */
     delete_list(input_list);
+    return status;
 }
 
 int main(int argc, char **argv) {
@@ -90,7 +100,7 @@ int main(int argc, char **argv) {
     int c;
     opterr = 0;
 
-    while ((c = getopt (argc, argv, "dn:f:")) != -1) {
+    while ((c = getopt (argc, argv, "dn:f:b:j:")) != -1) {
         switch (c) {
             case 'd':
             debug = 1;
@@ -107,6 +117,12 @@ int main(int argc, char **argv) {
             case 'f':
                 pcap_name = optarg;
             break;
+            case 'b':
+                benchmark_iterations = strtoull(optarg, (char **)NULL, 10);
+            break;
+            case 'j':
+                benchmark_json = optarg;
+            break;
             case '?':
                 if (optopt == 'f')
                     fprintf(stderr, "The input trace file is missing. "
@@ -133,7 +149,5 @@ int main(int argc, char **argv) {
     setup_control_plane();
 #endif
 
-    launch_runtime(pcap_name, num_pcaps);
-
-    return EXIT_SUCCESS;
+    return launch_runtime(pcap_name, num_pcaps);
 }
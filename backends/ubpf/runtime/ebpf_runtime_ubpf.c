@@ -15,10 +15,20 @@ limitations under the License.
 */
 
 #include <stdlib.h>
+#include <string.h>
 #include "ebpf_runtime_ubpf.h"
+#include "../../ebpf/runtime/ebpf_benchmark.h"
 
 
 #define PCAPOUT "_out.pcap"
+#define BATCH_SIZE 64
+
+struct std_meta {
+    uint32_t input_port;
+    uint32_t packet_length;
+    uint32_t output_action;
+    uint32_t output_port;
+};
 
 pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int debug) {
     pcap_list_t *output_pkts = allocate_pkt_list();
@@ -26,15 +36,12 @@ pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int
     for (uint32_t i = 0; i < list_len; i++) {
         /* Parse each packet in the list and check the result */
         struct dp_packet dp;
-        struct std_meta {
-            uint32_t input_port;
-            uint32_t packet_length;
-            uint32_t output_action;
-            uint32_t output_port;
-        };
         struct std_meta md;
         pcap_pkt *input_pkt = get_packet(pkt_list, i);
-        dp.data = (void *) input_pkt->data;
+        /* The program may resize the packet with realloc(), so it runs on
+           a heap copy of the data, which the input packet may not be. */
+        dp.data = malloc(input_pkt->pcap_hdr.len);
+        memcpy(dp.data, input_pkt->data, input_pkt->pcap_hdr.len);
         dp.size_ = input_pkt->pcap_hdr.len;
 
         md.input_port = input_pkt->ifindex;
@@ -42,14 +49,18 @@ pcap_list_t *feed_packets(packet_filter ebpf_filter, pcap_list_t *pkt_list, int
         md.output_port = 0;
 
         int result = ebpf_filter(&dp, (struct standard_metadata *) &md);
-        /* Updating input_pkt's length */
-        input_pkt->pcap_hdr.len = dp.size_;
-        input_pkt->pcap_hdr.caplen = dp.size_;
         if (result != 0) {
-            /* We copy the entire content to emulate an outgoing packet */
-            pcap_pkt *out_pkt = copy_pkt(input_pkt);
+            /* The outgoing packet takes over the data of the program */
+            pcap_pkt *out_pkt = malloc(sizeof(pcap_pkt));
+            *out_pkt = *input_pkt;
+            out_pkt->data = dp.data;
+            out_pkt->pcap_hdr.len = dp.size_;
+            out_pkt->pcap_hdr.caplen = dp.size_;
             out_pkt->ifindex = md.output_port;
+            out_pkt->mapping = NULL;
             output_pkts = append_packet(output_pkts, out_pkt);
+        } else {
+            free(dp.data);
         }
         if (debug)
             printf("Result of the eBPF parsing is: %d\n", result);
@@ -80,4 +91,37 @@ void *run_and_record_output(packet_filter entry, const char *pcap_base, pcap_lis
     write_pkts_to_pcaps(pcap_base, output_array, debug);
     /* Delete the array, including the data it is holding */
     delete_array(output_array);
-}
\ No newline at end of file
+}
+
+int benchmark_filter(packet_filter entry, pcap_list_t *pkt_list, uint64_t iterations, const char *json_file) {
+    uint32_t list_len = get_pkt_list_length(pkt_list);
+    struct benchmark_result result = { .packets = list_len, .iterations = iterations };
+    struct dp_packet dps[BATCH_SIZE];
+    struct std_meta mds[BATCH_SIZE];
+    benchmark_reset_table_stats();
+    for (uint64_t it = 0; it < iterations; it++) {
+        for (uint32_t start = 0; start < list_len; start += BATCH_SIZE) {
+            uint32_t batch_len = list_len - start < BATCH_SIZE ? list_len - start : BATCH_SIZE;
+            /* Programs may modify and resize the packets, each call gets a fresh heap copy */
+            for (uint32_t i = 0; i < batch_len; i++) {
+                pcap_pkt *input_pkt = get_packet(pkt_list, start + i);
+                dps[i].data = malloc(input_pkt->pcap_hdr.len);
+                memcpy(dps[i].data, input_pkt->data, input_pkt->pcap_hdr.len);
+                dps[i].size_ = input_pkt->pcap_hdr.len;
+                mds[i].input_port = input_pkt->ifindex;
+                mds[i].packet_length = dps[i].size_;
+                mds[i].output_action = 0;
+                mds[i].output_port = 0;
+            }
+            uint64_t begin_ns = benchmark_ns();
+            uint64_t begin_cycles = benchmark_cycles();
+            for (uint32_t i = 0; i < batch_len; i++)
+                result.passed += entry(&dps[i], (struct standard_metadata *) &mds[i]) != 0;
+            result.elapsed_cycles += benchmark_cycles() - begin_cycles;
+            result.elapsed_ns += benchmark_ns() - begin_ns;
+            for (uint32_t i = 0; i < batch_len; i++)
+                free(dps[i].data);
+        }
+    }
+    return benchmark_write_json(json_file, &result);
+}
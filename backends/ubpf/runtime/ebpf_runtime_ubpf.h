@@ -28,16 +28,17 @@ extern uint64_t entry(void *, struct standard_metadata *);
 typedef uint64_t (*packet_filter)(void *dp, struct standard_metadata *std_meta);
 
 void *run_and_record_output(packet_filter entry, const char *pcap_base, pcap_list_t *pkt_list, int debug);
+int benchmark_filter(packet_filter entry, pcap_list_t *pkt_list, uint64_t iterations, const char *json_file);
 
 static void inline init_ubpf_table_test(char *name, unsigned int key_size, unsigned int value_size) {
-    struct bpf_table tbl = {
-        .name = name,
-        .type = 0,
-        .key_size = key_size,
-        .value_size = value_size,
-        .bpf_map = NULL
-    };
-    registry_add(&tbl);
+    /* The registry keeps a pointer to the table, it must outlive this function */
+    struct bpf_table *tbl = calloc(1, sizeof(struct bpf_table));
+    tbl->name = name;
+    tbl->type = 0;
+    tbl->key_size = key_size;
+    tbl->value_size = value_size;
+    tbl->bpf_map = NULL;
+    registry_add(tbl);
 }
 
 
@@ -58,6 +59,8 @@ static void inline init_ubpf_table_test(char *name, unsigned int key_size, unsig
 
 #define RUN(entry, pcap_base, num_pcaps, input_list, debug) \
     run_and_record_output(entry, pcap_base, input_list, debug)
+#define BENCHMARK(entry, input_list, iterations, json_file) \
+    benchmark_filter(entry, input_list, iterations, json_file)
 #define INIT_EBPF_TABLES(debug)
 #define DELETE_EBPF_TABLES(debug)
 
@@ -27,7 +27,7 @@ override INCLUDES+= -I./$(SRCDIR) -include ebpf_runtime_$(TARGET).h
 # Optimization flags to save space
 override CFLAGS+=-O2 -g # -Wall -Werror
 LIBS+=-lpcap
-SOURCES=$(EBPFDIR)/ebpf_registry.c  $(EBPFDIR)/ebpf_map.c $(BPFNAME).c $(EXTERNOBJ)
+SOURCES=$(EBPFDIR)/ebpf_registry.c  $(EBPFDIR)/ebpf_map.c $(EBPFDIR)/ebpf_benchmark.c $(BPFNAME).c $(EXTERNOBJ)
 SRC_BASE+=$(SRCDIR)/ebpf_runtime.c $(EBPFDIR)/pcap_util.c $(SOURCES)
 SRC_BASE+=$(SRCDIR)/ebpf_runtime_$(TARGET).c
 OBJECTS = $(SRC_BASE:%.c=$(BUILDDIR)/%.o)
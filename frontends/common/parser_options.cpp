@@ -23,6 +23,7 @@ limitations under the License.
 #include <sys/types.h>
 #include <sys/wait.h>
 
+#include <cstdlib>
 #include <regex>
 #include <unordered_set>
 
@@ -378,6 +379,18 @@ const char *ParserOptions::getIncludePath() {
     return path.c_str();
 }
 
+// Returns the preprocessor invocation for @options, without the input file.
+static std::string preprocessorCommand(ParserOptions &options) {
+#ifdef __clang__
+    std::string cmd("cc -E -x c -Wno-comment");
+#else
+    std::string cmd("cpp");
+#endif
+    cmd += cstring(" -C -undef -nostdinc -x assembler-with-cpp") + " " +
+           options.preprocessor_options + options.getIncludePath();
+    return cmd;
+}
+
 FILE *ParserOptions::preprocess() {
     FILE *in = nullptr;
 
@@ -385,16 +398,11 @@ FILE *ParserOptions::preprocess() {
         file = "<stdin>";
         in = stdin;
     } else {
-#ifdef __clang__
-        std::string cmd("cc -E -x c -Wno-comment");
-#else
-        std::string cmd("cpp");
-#endif
+        std::string cmd = preprocessorCommand(*this);
 
         if (file == nullptr) file = "";
         if (file.find(' ')) file = cstring("\"") + file + "\"";
-        cmd += cstring(" -C -undef -nostdinc -x assembler-with-cpp") + " " + preprocessor_options +
-               getIncludePath() + " " + file;
+        cmd += cstring(" ") + file;
 
         if (Log::verbose()) std::cerr << "Invoking preprocessor " << std::endl << cmd << std::endl;
         in = popen(cmd.c_str(), "r");
@@ -418,6 +426,51 @@ FILE *ParserOptions::preprocess() {
     return in;
 }
 
+std::optional<std::string> ParserOptions::preprocess(cstring sourceFile,
+                                                     const std::string &source) {
+    char inputName[] = "/tmp/p4c-preprocess-XXXXXX";
+    int fd = mkstemp(inputName);
+    if (fd < 0) {
+        ::error(ErrorType::ERR_IO, "Error creating the preprocessor input for %1%", sourceFile);
+        return std::nullopt;
+    }
+    // Positions in the output refer to sourceFile, not to the temporary file.
+    std::string contents = "#line 1 \"" + std::string(sourceFile.c_str()) + "\"\n" + source;
+    bool written = write(fd, contents.data(), contents.size()) ==
+                   static_cast<ssize_t>(contents.size());
+    close(fd);
+
+    std::optional<std::string> result;
+    if (!written) {
+        ::error(ErrorType::ERR_IO, "Error writing the preprocessor input for %1%", sourceFile);
+    } else {
+        std::string cmd = preprocessorCommand(*this);
+        // Includes are searched next to the source file, as if it was preprocessed directly.
+        auto folder = Util::PathName(sourceFile).getFolder();
+        if (!folder.isNullOrEmpty()) cmd += cstring(" -I") + folder.toString();
+        cmd += std::string(" ") + inputName;
+        if (Log::verbose()) std::cerr << "Invoking preprocessor " << std::endl << cmd << std::endl;
+        FILE *in = popen(cmd.c_str(), "r");
+        if (in == nullptr) {
+            ::error(ErrorType::ERR_IO, "Error invoking preprocessor");
+        } else {
+            std::string output;
+            char buffer[4096];
+            size_t count;
+            while ((count = fread(buffer, 1, sizeof(buffer), in)) > 0) output.append(buffer, count);
+            int exitCode = pclose(in);
+            if (exitCode != 0) {
+                ::error(ErrorType::ERR_IO, "Preprocessor returned exit code %1% for %2%",
+                        exitCode, sourceFile);
+            } else {
+                result = std::move(output);
+            }
+        }
+    }
+    unlink(inputName);
+    return result;
+}
+
 void ParserOptions::closeInput(FILE *inputStream) const {
     if (close_input) {
         int exitCode = pclose(inputStream);
@@ -19,7 +19,9 @@ limitations under the License.
 #ifndef FRONTENDS_COMMON_PARSER_OPTIONS_H_
 #define FRONTENDS_COMMON_PARSER_OPTIONS_H_
 
+#include <optional>
 #include <set>
+#include <string>
 #include <unordered_map>
 
 #include "ir/configuration.h"
@@ -79,6 +81,9 @@ class ParserOptions : public Util::Options {
     const char *getIncludePath() override;
     // Returns the output of the preprocessor.
     FILE *preprocess();
+    // Returns the output of the preprocessor for @source, which is preprocessed as if it were
+    // the contents of @sourceFile, or std::nullopt if the preprocessor failed.
+    std::optional<std::string> preprocess(cstring sourceFile, const std::string &source);
     // Closes the input stream returned by preprocess.
     void closeInput(FILE *input) const;
     // True if we are compiling a P4 v1.0 or v1.1 program
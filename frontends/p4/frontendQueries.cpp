@@ -0,0 +1,249 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "frontends/p4/frontendQueries.h"
+
+#include "frontends/common/constantFolding.h"
+#include "frontends/common/parseInput.h"
+#include "frontends/common/parser_options.h"
+#include "frontends/common/resolveReferences/resolveReferences.h"
+#include "frontends/p4/createBuiltins.h"
+#include "frontends/p4/directCalls.h"
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "ir/pass_manager.h"
+#include "lib/error.h"
+#include "lib/log.h"
+
+namespace P4 {
+
+namespace {
+
+/// Finds the innermost node of class T whose source range contains a position.
+template <class T>
+class FindInnermost : public Inspector {
+    SourcePosition position;
+
+    bool preorder(const T *node) override {
+        const auto &srcInfo = node->srcInfo;
+        if (!srcInfo.isValid() || position < srcInfo.getStart() || srcInfo.getEnd() < position)
+            return true;
+        if (result == nullptr || (result->srcInfo.getStart() <= srcInfo.getStart() &&
+                                  srcInfo.getEnd() <= result->srcInfo.getEnd()))
+            result = node;
+        return true;
+    }
+
+ public:
+    const T *result = nullptr;
+
+    explicit FindInnermost(const SourcePosition &position) : position(position) {
+        setName("FindInnermost");
+    }
+};
+
+/// Collects the calls of an action and its references in action lists.
+class FindActionCalls : public Inspector {
+    const ReferenceMap *refMap;
+    const IR::IDeclaration *action;
+    std::vector<const IR::Expression *> &calls;
+
+    bool isAction(const IR::Expression *expression) const {
+        const auto *path = expression->to<IR::PathExpression>();
+        return path != nullptr && refMap->getDeclaration(path->path, false) == action;
+    }
+
+    bool preorder(const IR::MethodCallExpression *call) override {
+        if (isAction(call->method)) calls.push_back(call);
+        return true;
+    }
+    bool preorder(const IR::ActionListElement *element) override {
+        // Elements with arguments are MethodCallExpressions, which are handled above.
+        if (isAction(element->expression)) calls.push_back(element->expression);
+        return true;
+    }
+
+ public:
+    FindActionCalls(const ReferenceMap *refMap, const IR::IDeclaration *action,
+                    std::vector<const IR::Expression *> &calls)
+        : refMap(refMap), action(action), calls(calls) {
+        setName("FindActionCalls");
+    }
+};
+
+/// Resolves the names in some of the top-level declarations of a program only.  The names
+/// they use are looked up in the enclosing scopes as usual.
+class ResolveObjects : public ResolveReferences {
+    const std::set<const IR::Node *> &objects;
+
+ public:
+    ResolveObjects(ReferenceMap *refMap, const std::set<const IR::Node *> &objects)
+        : ResolveReferences(refMap), objects(objects) {
+        setName("ResolveObjects");
+    }
+
+    using ResolveReferences::preorder;
+    bool preorder(const IR::P4Program *program) override {
+        for (const auto *object : program->objects) {
+            if (objects.count(object) != 0) visit(object);
+        }
+        return false;
+    }
+};
+
+/// @returns the top-level declaration of @p program whose source range contains @p position.
+const IR::Node *findObjectAt(const IR::P4Program *program, const SourcePosition &position) {
+    for (const auto *object : program->objects) {
+        const auto &srcInfo = object->srcInfo;
+        if (srcInfo.isValid() && srcInfo.getStart() <= position && position <= srcInfo.getEnd())
+            return object;
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+void FrontEndQueries::invalidate() {
+    parsed = builtins = typed = nullptr;
+    parseFailed = builtinsFailed = typeFailed = false;
+    refMap.clear();
+    resolvedObjects.clear();
+    typedRefMap.clear();
+    typeMap.clear();
+    declarationCache.clear();
+    typeCache.clear();
+    callersCache.clear();
+}
+
+bool FrontEndQueries::setSource(std::string newSource) {
+    if (newSource == source) return false;
+    source = std::move(newSource);
+    invalidate();
+    return true;
+}
+
+const IR::P4Program *FrontEndQueries::getProgram() {
+    if (parsed != nullptr || parseFailed) return parsed;
+    LOG2("FrontEndQueries: parsing " << sourceFile);
+    // Like parseP4File, includes and macros are expanded first.
+    auto &options = P4CContext::get().options();
+    std::optional<std::string> input = source;
+    if (!options.doNotPreprocess) input = options.preprocess(sourceFile, source);
+    if (input) parsed = parseP4String(sourceFile.c_str(), 1, *input, version);
+    parseFailed = parsed == nullptr;
+    return parsed;
+}
+
+const IR::P4Program *FrontEndQueries::getBuiltinsProgram() {
+    if (builtins != nullptr || builtinsFailed) return builtins;
+    const auto *program = getProgram();
+    if (program == nullptr) {
+        builtinsFailed = true;
+        return nullptr;
+    }
+    unsigned initialErrorCount = ::errorCount();
+    program = program->apply(CreateBuiltins());
+    builtinsFailed = program == nullptr || ::errorCount() > initialErrorCount;
+    if (!builtinsFailed) builtins = program;
+    return builtins;
+}
+
+void FrontEndQueries::resolve(const std::vector<const IR::Node *> &objects) {
+    std::set<const IR::Node *> pending;
+    for (const auto *object : objects) {
+        if (resolvedObjects.count(object) == 0) pending.insert(object);
+    }
+    if (pending.empty()) return;
+    LOG2("FrontEndQueries: resolving names in " << pending.size() << " declarations of "
+                                                << sourceFile);
+    ResolveObjects resolveObjects(&refMap, pending);
+    getBuiltinsProgram()->apply(resolveObjects);
+    resolvedObjects.insert(pending.begin(), pending.end());
+}
+
+const IR::P4Program *FrontEndQueries::getTypedProgram() {
+    if (typed != nullptr || typeFailed) return typed;
+    const auto *program = getBuiltinsProgram();
+    if (program == nullptr) {
+        typeFailed = true;
+        return nullptr;
+    }
+    LOG2("FrontEndQueries: inferring types in " << sourceFile);
+    unsigned initialErrorCount = ::errorCount();
+    // The smallest prefix of the FrontEnd pipeline after which all expressions have types.
+    PassManager passes({
+        new ConstantFolding(&typedRefMap, nullptr),
+        new InstantiateDirectCalls(&typedRefMap),
+        new ResolveReferences(&typedRefMap),
+        new TypeInference(&typedRefMap, &typeMap, false),
+    });
+    passes.setStopOnError(true);
+    program = program->apply(passes);
+    typeFailed = program == nullptr || ::errorCount() > initialErrorCount;
+    if (!typeFailed) typed = program;
+    return typed;
+}
+
+const IR::IDeclaration *FrontEndQueries::getDeclarationAt(const SourcePosition &position) {
+    auto it = declarationCache.find(position);
+    if (it != declarationCache.end()) return it->second;
+    const IR::IDeclaration *result = nullptr;
+    const auto *program = getBuiltinsProgram();
+    const auto *object = program != nullptr ? findObjectAt(program, position) : nullptr;
+    if (object != nullptr) {
+        resolve({object});
+        FindInnermost<IR::PathExpression> find(position);
+        object->apply(find);
+        if (find.result != nullptr) result = refMap.getDeclaration(find.result->path, false);
+    }
+    declarationCache.emplace(position, result);
+    return result;
+}
+
+const IR::Type *FrontEndQueries::getTypeAt(const SourcePosition &position) {
+    auto it = typeCache.find(position);
+    if (it != typeCache.end()) return it->second;
+    const IR::Type *result = nullptr;
+    if (const auto *program = getTypedProgram()) {
+        FindInnermost<IR::Expression> find(position);
+        program->apply(find);
+        if (find.result != nullptr) result = typeMap.getType(find.result, false);
+    }
+    typeCache.emplace(position, result);
+    return result;
+}
+
+const std::vector<const IR::Expression *> &FrontEndQueries::getCallersOf(
+    const IR::IDeclaration *action) {
+    auto it = callersCache.find(action);
+    if (it != callersCache.end()) return it->second;
+    auto &calls = callersCache[action];
+    const auto *program = getBuiltinsProgram();
+    if (program == nullptr || action == nullptr) return calls;
+
+    // An action declared in a control can only be used in that control.
+    std::vector<const IR::Node *> region(program->objects.begin(), program->objects.end());
+    for (const auto *object : program->objects) {
+        const auto *control = object->to<IR::P4Control>();
+        if (control == nullptr) continue;
+        for (const auto *local : control->controlLocals) {
+            if (local == action->getNode()) region = {object};
+        }
+    }
+    resolve(region);
+    FindActionCalls find(&refMap, action, calls);
+    for (const auto *object : region) object->apply(find);
+    return calls;
+}
+
+}  // namespace P4
@@ -0,0 +1,113 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef FRONTENDS_P4_FRONTENDQUERIES_H_
+#define FRONTENDS_P4_FRONTENDQUERIES_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "frontends/common/options.h"
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/p4/typeMap.h"
+#include "ir/ir.h"
+#include "lib/source_file.h"
+
+namespace P4 {
+
+/**
+ * Demand-driven access to frontend information about a P4 program, for editors and other
+ * tools which need name resolution and types, but not the full FrontEnd pipeline.
+ *
+ * The program is processed in stages, each computed only when a query needs it and cached
+ * until the source changes:
+ *  - parsed:   the output of the preprocessor and the parser, as in parseP4File;
+ *  - builtins: builtins created;
+ *  - resolved: names resolved, one top-level declaration at a time, only in the declarations
+ *              a query looks at (enough for declaration and caller queries);
+ *  - typed:    direct calls instantiated, constants folded and types inferred in the whole
+ *              program (needed for type queries).
+ * None of the other frontend passes (inlining, side-effect removal, specialization, ...)
+ * are run.  Query results are memoized as well.
+ *
+ * Nodes are identified by source position: the typed stage rewrites the program, so the
+ * position is the only identity stable across stages.  A position designates the innermost
+ * node of the requested kind whose source range contains it.
+ */
+class FrontEndQueries {
+    cstring sourceFile;
+    std::string source;
+    CompilerOptions::FrontendVersion version;
+
+    const IR::P4Program *parsed = nullptr;
+    const IR::P4Program *builtins = nullptr;
+    const IR::P4Program *typed = nullptr;
+    /// Set when computing the corresponding stage has reported errors.
+    bool parseFailed = false;
+    bool builtinsFailed = false;
+    bool typeFailed = false;
+
+    /// References of the resolved top-level declarations of the builtins stage.
+    ReferenceMap refMap;
+    /// The top-level declarations whose names are resolved in refMap.
+    std::set<const IR::Node *> resolvedObjects;
+    ReferenceMap typedRefMap;
+    TypeMap typeMap;
+
+    std::map<SourcePosition, const IR::IDeclaration *> declarationCache;
+    std::map<SourcePosition, const IR::Type *> typeCache;
+    std::map<const IR::IDeclaration *, std::vector<const IR::Expression *>> callersCache;
+
+    /// Discards all stages and memoized results.
+    void invalidate();
+    const IR::P4Program *getBuiltinsProgram();
+    /// Resolves the names in the top-level declarations @p objects of the builtins stage,
+    /// unless they are resolved already.
+    void resolve(const std::vector<const IR::Node *> &objects);
+    const IR::P4Program *getTypedProgram();
+
+ public:
+    FrontEndQueries(
+        cstring sourceFile, std::string source,
+        CompilerOptions::FrontendVersion version = CompilerOptions::FrontendVersion::P4_16)
+        : sourceFile(sourceFile), source(std::move(source)), version(version) {}
+
+    /// Replaces the program text.  Cached results are discarded only if the text changed.
+    /// @returns true if the text changed.
+    bool setSource(std::string newSource);
+
+    /// @returns the parsed program, or nullptr if it contains syntax errors.
+    const IR::P4Program *getProgram();
+
+    /// @returns the declaration the innermost path expression at @p position refers to, or
+    /// nullptr if there is no such path expression.
+    const IR::IDeclaration *getDeclarationAt(const SourcePosition &position);
+
+    /// @returns the type of the innermost expression at @p position, or nullptr if there is no
+    /// such expression or the program does not type-check.
+    const IR::Type *getTypeAt(const SourcePosition &position);
+
+    /// @returns all the calls of @p action (MethodCallExpressions) and its references in table
+    /// action lists (PathExpressions), in program order.  @p action is a declaration returned
+    /// by getDeclarationAt.  Only the names in the control declaring the action are resolved,
+    /// or in the whole program for a top-level action.
+    const std::vector<const IR::Expression *> &getCallersOf(const IR::IDeclaration *action);
+};
+
+}  // namespace P4
+
+#endif /* FRONTENDS_P4_FRONTENDQUERIES_H_ */
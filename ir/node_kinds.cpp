@@ -0,0 +1,119 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "ir/node_kinds.h"
+
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+#include "ir/ir.h"
+#include "ir/visitor.h"
+#include "lib/exceptions.h"
+
+namespace IR {
+
+namespace {
+
+struct KindRegistry {
+    std::unordered_map<std::type_index, size_t> kinds;
+    std::vector<const Node *> samples;
+};
+
+KindRegistry &registry() {
+    static KindRegistry *rv = new KindRegistry;
+    return *rv;
+}
+
+/// Computes the kinds of a subtree bottom-up, reusing the cached kinds of subtrees which have
+/// been indexed before.
+class ComputeSubtreeKinds : public Inspector {
+    std::unordered_map<const Node *, bitvec> &subtrees;
+    std::vector<bitvec> stack;
+
+    bool preorder(const Node *node) override {
+        auto it = subtrees.find(node);
+        if (it != subtrees.end()) {
+            stack.back() |= it->second;
+            return false;
+        }
+        stack.emplace_back();
+        stack.back().setbit(NodeKindIndex::kindOf(node));
+        return true;
+    }
+    void postorder(const Node *node) override {
+        bitvec kinds = std::move(stack.back());
+        stack.pop_back();
+        stack.back() |= kinds;
+        subtrees.emplace(node, std::move(kinds));
+    }
+    void revisit(const Node *node) override { stack.back() |= subtrees.at(node); }
+
+ public:
+    explicit ComputeSubtreeKinds(std::unordered_map<const Node *, bitvec> &subtrees)
+        : subtrees(subtrees) {
+        setName("ComputeSubtreeKinds");
+        // The bottom entry collects the kinds of the root.
+        stack.emplace_back();
+    }
+};
+
+}  // namespace
+
+size_t NodeKindIndex::kindOf(const Node *node) {
+    auto &reg = registry();
+    auto result = reg.kinds.emplace(std::type_index(typeid(*node)), reg.samples.size());
+    if (result.second) reg.samples.push_back(node);
+    return result.first->second;
+}
+
+size_t NodeKindIndex::numKinds() { return registry().samples.size(); }
+
+const Node *NodeKindIndex::sampleOf(size_t kind) {
+    auto &reg = registry();
+    BUG_CHECK(kind < reg.samples.size(), "Node kind %1% out of range", kind);
+    return reg.samples[kind];
+}
+
+const bitvec &SubtreeKinds::get(const Node *node) {
+    auto it = subtrees.find(node);
+    if (it != subtrees.end()) return it->second;
+    ComputeSubtreeKinds compute(subtrees);
+    node->apply(compute);
+    return subtrees.at(node);
+}
+
+const bitvec &NodeKindSet::get() const {
+    size_t numKinds = NodeKindIndex::numKinds();
+    for (; knownKinds < numKinds; knownKinds++) {
+        const auto *sample = NodeKindIndex::sampleOf(knownKinds);
+        for (const auto &matches : matchers) {
+            if (matches(sample)) {
+                kinds.setbit(knownKinds);
+                break;
+            }
+        }
+    }
+    return kinds;
+}
+
+bool NodeKindSet::mayOccurIn(const Node *node) const {
+    if (empty()) return true;
+    if (subtrees == nullptr) subtrees = std::make_shared<SubtreeKinds>();
+    // Compute the subtree first: it may register new kinds.
+    const auto &subtree = subtrees->get(node);
+    return subtree.intersects(get());
+}
+
+}  // namespace IR
@@ -0,0 +1,91 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#ifndef _IR_NODE_KINDS_H_
+#define _IR_NODE_KINDS_H_
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "ir/node.h"
+#include "lib/bitvec.h"
+
+namespace IR {
+
+/// Dense numbering of the node kinds (concrete IR classes).  Every concrete class gets a kind
+/// number the first time a node of that class is seen.
+class NodeKindIndex {
+ public:
+    /// @returns the kind number of the concrete class of @p node.
+    static size_t kindOf(const Node *node);
+
+    /// @returns the number of kinds registered so far.
+    static size_t numKinds();
+
+    /// @returns a node of kind @p kind (the first one seen).
+    static const Node *sampleOf(size_t kind);
+};
+
+/// The kinds occurring in each subtree of an IR tree, as bit vectors over the NodeKindIndex
+/// numbering.  Subtrees are computed on first use and cached by node pointer, so a cache is only
+/// valid while the tree it was computed for is neither modified nor freed.  Inspectors keep one
+/// for the duration of a single apply().
+class SubtreeKinds {
+    std::unordered_map<const Node *, bitvec> subtrees;
+
+ public:
+    /// @returns the kinds of all nodes in the subtree rooted at @p node, i.e., all the nodes
+    /// an Inspector reaches through visit_children.
+    const bitvec &get(const Node *node);
+};
+
+/// A set of node kinds described by IR classes, which may be abstract classes or interfaces.
+/// The kind numbers matching the classes are computed lazily and extended as new kinds are
+/// registered in the NodeKindIndex.
+class NodeKindSet {
+    std::vector<std::function<bool(const Node *)>> matchers;
+    mutable bitvec kinds;
+    mutable size_t knownKinds = 0;
+    /// Shared by the clones of an Inspector, like its set of visited nodes.
+    mutable std::shared_ptr<SubtreeKinds> subtrees;
+
+ public:
+    template <class T>
+    void add() {
+        matchers.push_back([](const Node *node) { return node->is<T>(); });
+        knownKinds = 0;
+        kinds.clear();
+    }
+
+    /// @returns true if no classes were added; an empty set means "all kinds".
+    bool empty() const { return matchers.empty(); }
+
+    /// @returns the numbers of all registered kinds which match one of the classes.
+    const bitvec &get() const;
+
+    /// Drops the cached subtrees.  Called when an Inspector starts visiting another tree.
+    void clearSubtrees() {
+        if (!empty()) subtrees = std::make_shared<SubtreeKinds>();
+    }
+
+    /// @returns true if the subtree rooted at @p node may contain a node of the set.
+    bool mayOccurIn(const Node *node) const;
+};
+
+}  // namespace IR
+
+#endif /* _IR_NODE_KINDS_H_ */
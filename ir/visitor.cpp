@@ -202,6 +202,7 @@ Visitor::profile_t Modifier::init_apply(const IR::Node *root) {
 Visitor::profile_t Inspector::init_apply(const IR::Node *root) {
     auto rv = Visitor::init_apply(root);
     visited = std::make_shared<visited_t>();
+    relevantKinds.clearSubtrees();
     return rv;
 }
 Visitor::profile_t Transform::init_apply(const IR::Node *root) {
@@ -344,7 +345,7 @@ const IR::Node *Modifier::apply_visitor(const IR::Node *n, const char *name) {
 
 const IR::Node *Inspector::apply_visitor(const IR::Node *n, const char *name) {
     if (ctxt) ctxt->child_name = name;
-    if (n && !join_flows(n)) {
+    if (n && (relevantKinds.empty() || relevantKinds.mayOccurIn(n)) && !join_flows(n)) {
         PushContext local(ctxt, n);
         auto vp = visited->emplace(n, info_t{false, visitDagOnce});
         if (!vp.second && !vp.first->second.done) {
@@ -32,6 +32,7 @@ limitations under the License.
 #include "ir/gen-tree-macro.h"
 #include "ir/ir-tree-macros.h"
 #include "ir/node.h"
+#include "ir/node_kinds.h"
 #include "ir/vector.h"
 #include "lib/castable.h"
 #include "lib/cstring.h"
@@ -393,8 +394,24 @@ class Inspector : public virtual Visitor {
     };
     typedef std::unordered_map<const IR::Node *, info_t> visited_t;
     std::shared_ptr<visited_t> visited;
+    // node kinds this inspector is interested in; empty means all kinds
+    IR::NodeKindSet relevantKinds;
     bool check_clone(const Visitor *) override;
 
+ protected:
+    // Restricts the traversal to subtrees that contain a node of one of the classes T...
+    // (according to the IR::NodeKindIndex); all other subtrees are skipped without calling
+    // any visit function.  Only for inspectors whose visit functions for all other node
+    // classes do nothing; not for ControlFlowVisitors.
+    // The subtree kinds are computed by a full walk of the tree in every apply(), so the
+    // restricted application is slower than an unrestricted one (measured by the
+    // NodeKindIndex.costOfOneApplication test).  No inspector uses it until the kinds can be
+    // kept across applications.
+    template <class... T>
+    void visitOnlySubtreesWith() {
+        (relevantKinds.add<T>(), ...);
+    }
+
  public:
     profile_t init_apply(const IR::Node *root) override;
     const IR::Node *apply_visitor(const IR::Node *, const char *name = 0) override;
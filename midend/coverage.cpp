@@ -1,7 +1,10 @@
 #include "midend/coverage.h"
 
+#include <algorithm>
 #include <ostream>
+#include <set>
 
+#include "lib/exceptions.h"
 #include "lib/log.h"
 
 namespace P4::Coverage {
@@ -10,12 +13,98 @@ bool SourceIdCmp::operator()(const IR::Node *s1, const IR::Node *s2) const {
     return s1->clone_id < s2->clone_id;
 }
 
+CoverageIndex &CoverageIndex::get() {
+    static CoverageIndex INSTANCE;
+    return INSTANCE;
+}
+
+void CoverageIndex::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    indices.clear();
+    nodes.clear();
+    paths.clear();
+}
+
+size_t CoverageIndex::registerNode(const IR::Node *node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto result = indices.emplace(node->clone_id, nodes.size());
+    if (result.second) {
+        nodes.push_back(node);
+    }
+    return result.first->second;
+}
+
+std::optional<size_t> CoverageIndex::findIndex(const IR::Node *node) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = indices.find(node->clone_id);
+    if (it == indices.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const IR::Node *CoverageIndex::getNode(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    BUG_CHECK(index < nodes.size(), "Coverage index %1% out of range.", index);
+    return nodes[index];
+}
+
+void CoverageIndex::setPath(const IR::Node *node, std::string path) {
+    auto index = registerNode(node);
+    std::lock_guard<std::mutex> lock(mutex);
+    paths.emplace(index, std::move(path));
+}
+
+std::optional<std::string> CoverageIndex::getPath(size_t index) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = paths.find(index);
+    if (it == paths.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t CoverageIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return nodes.size();
+}
+
+size_t CoverageSet::count(const IR::Node *node) const {
+    auto index = CoverageIndex::get().findIndex(node);
+    return index.has_value() && bits.getbit(*index) ? 1 : 0;
+}
+
+CoverageSet::const_iterator CoverageSet::find(const IR::Node *node) const {
+    if (count(node) == 0) {
+        return end();
+    }
+    return const_iterator(&bits, static_cast<int>(*CoverageIndex::get().findIndex(node)));
+}
+
 CollectNodes::CollectNodes(CoverageOptions coverageOptions) : coverageOptions(coverageOptions) {}
 
+void CollectNodes::collect(const IR::Node *node) {
+    coverableNodes.insert(node);
+    // The ancestors of the node, from the program down.
+    std::vector<const Visitor::Context *> ancestors;
+    for (const auto *ctxt = getContext(); ctxt != nullptr; ctxt = ctxt->parent) {
+        ancestors.push_back(ctxt);
+    }
+    std::string path;
+    for (auto it = ancestors.rbegin(); it != ancestors.rend(); ++it) {
+        path += "/";
+        if ((*it)->child_name != nullptr) {
+            path += (*it)->child_name;
+        }
+        path += ":" + std::to_string((*it)->child_index);
+    }
+    CoverageIndex::get().setPath(node, std::move(path));
+}
+
 bool CollectNodes::preorder(const IR::AssignmentStatement *stmt) {
     // Only track statements, which have a valid source position in the P4 program.
     if (coverageOptions.coverStatements && stmt->getSourceInfo().isValid()) {
-        coverableNodes.insert(stmt);
+        collect(stmt);
     }
     return true;
 }
@@ -23,7 +112,7 @@ bool CollectNodes::preorder(const IR::AssignmentStatement *stmt) {
 bool CollectNodes::preorder(const IR::Entry *entry) {
     // Only track entries, which have a valid source position in the P4 program.
     if (coverageOptions.coverTableEntries && entry->getSourceInfo().isValid()) {
-        coverableNodes.insert(entry);
+        collect(entry);
     }
     return true;
 }
@@ -31,7 +120,7 @@ bool CollectNodes::preorder(const IR::Entry *entry) {
 bool CollectNodes::preorder(const IR::MethodCallStatement *stmt) {
     // Only track statements, which have a valid source position in the P4 program.
     if (coverageOptions.coverStatements && stmt->getSourceInfo().isValid()) {
-        coverableNodes.insert(stmt);
+        collect(stmt);
     }
     return true;
 }
@@ -39,11 +128,57 @@ bool CollectNodes::preorder(const IR::MethodCallStatement *stmt) {
 bool CollectNodes::preorder(const IR::ExitStatement *stmt) {
     // Only track statements, which have a valid source position in the P4 program.
     if (coverageOptions.coverStatements && stmt->getSourceInfo().isValid()) {
-        coverableNodes.insert(stmt);
+        collect(stmt);
     }
     return true;
 }
 
+std::string getStableId(const IR::Node *node) {
+    unsigned line = 0;
+    unsigned column = 0;
+    const auto &srcInfo = node->getSourceInfo();
+    std::string file;
+    if (srcInfo.isValid()) {
+        auto fileName = srcInfo.toSourcePositionData(&line, &column);
+        if (!fileName.isNullOrEmpty()) {
+            file = fileName.c_str();
+        }
+    }
+    auto id = file + ":" + std::to_string(line) + ":" + std::to_string(column);
+    auto &index = CoverageIndex::get();
+    if (auto number = index.findIndex(node)) {
+        if (auto path = index.getPath(*number)) {
+            id += *path;
+        }
+    }
+    return id;
+}
+
+std::vector<std::string> getStableIds(const CoverageSet &nodes) {
+    std::vector<std::string> ids;
+    ids.reserve(nodes.size());
+    for (const auto *node : nodes) {
+        ids.push_back(getStableId(node));
+    }
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+CoverageSet findStableIds(const CoverageSet &nodes, const std::vector<std::string> &ids,
+                          std::vector<std::string> *unknownIds) {
+    std::set<std::string> remaining(ids.begin(), ids.end());
+    CoverageSet result;
+    for (const auto *node : nodes) {
+        if (remaining.erase(getStableId(node)) != 0) {
+            result.insert(node);
+        }
+    }
+    if (unknownIds != nullptr) {
+        unknownIds->assign(remaining.begin(), remaining.end());
+    }
+    return result;
+}
+
 void printCoverageReport(const CoverageSet &all, const CoverageSet &visited) {
     if (all.empty()) {
         return;
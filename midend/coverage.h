@@ -1,11 +1,17 @@
 #ifndef MIDEND_COVERAGE_H_
 #define MIDEND_COVERAGE_H_
 
-#include <set>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "ir/ir.h"
 #include "ir/visitor.h"
+#include "lib/bitvec.h"
 #include "lib/source_file.h"
 
 /// This file is a collection of utilities for coverage tracking in P4 programs.
@@ -27,9 +33,132 @@ struct CoverageOptions {
     bool coverTableEntries = false;
 };
 
-/// Set of nodes used for coverage purposes. Compares nodes based on their
-/// clone_id to take node modifications into account.
-using CoverageSet = std::set<const IR::Node *, SourceIdCmp>;
+/// Dense numbering of the nodes used for coverage purposes. Nodes are identified by their
+/// clone_id to take node modifications into account: all copies of a node share one number.
+/// The first node registered under a number is kept as its representative. Coverable nodes are
+/// registered by the coverage collectors, so their numbers form a dense prefix.
+/// The index is shared by all CoverageSets, so every access is guarded by a mutex.
+class CoverageIndex {
+    /// Guards indices and nodes.
+    mutable std::mutex mutex;
+
+    /// Maps the clone_id of a node to its number.
+    std::unordered_map<int, size_t> indices;
+
+    /// Maps a number to the representative node.
+    std::vector<const IR::Node *> nodes;
+
+    /// Maps a number to the structural path of its node in the program, if it is known.
+    std::unordered_map<size_t, std::string> paths;
+
+    CoverageIndex() = default;
+
+ public:
+    /// @returns the global index.
+    static CoverageIndex &get();
+
+    /// Forgets all registered nodes. Must be called before the coverage of another program is
+    /// collected; CoverageSets created before the reset are meaningless afterwards.
+    void reset();
+
+    /// @returns the number of @p node. Assigns a fresh number if @p node is not registered yet.
+    size_t registerNode(const IR::Node *node);
+
+    /// @returns the number of @p node, if it is registered.
+    [[nodiscard]] std::optional<size_t> findIndex(const IR::Node *node) const;
+
+    /// @returns the representative node of number @p index.
+    [[nodiscard]] const IR::Node *getNode(size_t index) const;
+
+    /// Records the structural path of @p node in the program, see getStableId.
+    void setPath(const IR::Node *node, std::string path);
+
+    /// @returns the structural path recorded for number @p index, if any.
+    [[nodiscard]] std::optional<std::string> getPath(size_t index) const;
+
+    /// @returns the number of registered nodes.
+    [[nodiscard]] size_t size() const;
+};
+
+/// Set of nodes used for coverage purposes, stored as a bit vector over the CoverageIndex
+/// numbering. Copying, merging, and comparing sets is word-parallel. Iterating the set yields
+/// the representative node of every member.
+class CoverageSet {
+    bitvec bits;
+
+    explicit CoverageSet(bitvec bits) : bits(std::move(bits)) {}
+
+ public:
+    class const_iterator {
+        const bitvec *bits;
+        /// The CoverageIndex number of the current member, -1 at the end.
+        int idx;
+
+     public:
+        const_iterator(const bitvec *bits, int idx) : bits(bits), idx(idx) {}
+        const IR::Node *operator*() const { return CoverageIndex::get().getNode(idx); }
+        /// @returns the CoverageIndex number of the current member.
+        [[nodiscard]] int index() const { return idx; }
+        const_iterator &operator++() {
+            idx = bits->ffs(idx + 1);
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return idx == other.idx; }
+        bool operator!=(const const_iterator &other) const { return idx != other.idx; }
+    };
+    using iterator = const_iterator;
+    using value_type = const IR::Node *;
+
+    CoverageSet() = default;
+
+    /// Adds @p node to the set. @returns true if the node was not a member before.
+    bool insert(const IR::Node *node) {
+        auto idx = CoverageIndex::get().registerNode(node);
+        if (bits.getbit(idx)) {
+            return false;
+        }
+        bits.setbit(idx);
+        return true;
+    }
+    bool emplace(const IR::Node *node) { return insert(node); }
+    template <typename Iterator>
+    void insert(Iterator begin, Iterator end) {
+        for (; begin != end; ++begin) insert(*begin);
+    }
+
+    /// Adds all members of @p other to this set.
+    CoverageSet &operator|=(const CoverageSet &other) {
+        bits |= other.bits;
+        return *this;
+    }
+
+    /// @returns the members of this set which are not members of @p other.
+    CoverageSet operator-(const CoverageSet &other) const { return CoverageSet(bits - other.bits); }
+
+    /// @returns 1 if @p node is a member of the set, 0 otherwise.
+    [[nodiscard]] size_t count(const IR::Node *node) const;
+
+    /// @returns the number of members of this set which are not members of @p other.
+    [[nodiscard]] size_t countNotIn(const CoverageSet &other) const {
+        return (bits - other.bits).popcount();
+    }
+
+    /// @returns true if this set has a member which is not a member of @p other.
+    [[nodiscard]] bool hasNodesNotIn(const CoverageSet &other) const {
+        return !other.bits.contains(bits);
+    }
+
+    [[nodiscard]] size_t size() const { return bits.popcount(); }
+    [[nodiscard]] bool empty() const { return bits.empty(); }
+    [[nodiscard]] const_iterator begin() const { return const_iterator(&bits, bits.ffs()); }
+    [[nodiscard]] const_iterator end() const { return const_iterator(&bits, -1); }
+
+    /// @returns an iterator to the member matching @p node, or end() if there is none.
+    [[nodiscard]] const_iterator find(const IR::Node *node) const;
+
+    bool operator==(const CoverageSet &other) const { return bits == other.bits; }
+    bool operator!=(const CoverageSet &other) const { return bits != other.bits; }
+};
 
 /// CollectNodes iterates across selected nodes in the P4 program and collects them in a
 /// "CoverageSet". The nodes to collect are specified as options to the collector.
@@ -40,6 +169,9 @@ class CollectNodes : public Inspector {
     /// Specifies, which IR nodes to track with this particular visitor.
     CoverageOptions coverageOptions;
 
+    /// Adds @p node to the coverable nodes and records its structural path.
+    void collect(const IR::Node *node);
+
     /// Statement coverage.
     bool preorder(const IR::AssignmentStatement *stmt) override;
     bool preorder(const IR::MethodCallStatement *stmt) override;
@@ -55,6 +187,21 @@ class CollectNodes : public Inspector {
     const CoverageSet &getCoverableNodes();
 };
 
+/// @returns an identifier of @p node which is the same in every process that runs on the same
+/// program with the same options: the source position of the node and, for coverable nodes, the
+/// path from the program to the node recorded by CollectNodes (the child names and indices of
+/// its ancestors). Unlike CoverageIndex numbers and clone ids, it does not depend on the order
+/// in which nodes are allocated or registered.
+std::string getStableId(const IR::Node *node);
+
+/// @returns the stable identifiers of the members of @p nodes, sorted.
+std::vector<std::string> getStableIds(const CoverageSet &nodes);
+
+/// @returns the members of @p nodes whose stable identifiers are in @p ids. Identifiers which do
+/// not match a member are stored in @p unknownIds, if it is given.
+CoverageSet findStableIds(const CoverageSet &nodes, const std::vector<std::string> &ids,
+                          std::vector<std::string> *unknownIds = nullptr);
+
 /// Produces detailed final coverage log.
 void printCoverageReport(const CoverageSet &all, const CoverageSet &visited);
 
@@ -1016,6 +1016,9 @@ void ExpressionEvaluator::postorder(const IR::PathExpression *expression) {
     SymbolicValue *result;
     if (type->is<IR::Type_Error>())
         result = new SymbolicEnum(type, decl->getName());
+    else if (readOnly)
+        // The value may be shared; a read-only evaluation never modifies it.
+        result = const_cast<SymbolicValue *>(valueMap->read(decl));
     else
         result = valueMap->get(decl);
     set(expression, result);
@@ -1042,6 +1045,7 @@ void ExpressionEvaluator::postorder(const IR::MethodCallExpression *expression)
         CHECK_NULL(node);
         auto structVar = get(node);
         if (name == IR::Type_Header::setInvalid || name == IR::Type_Header::setValid) {
+            BUG_CHECK(!readOnly, "%1%: side effect in a read-only evaluation", expression);
             auto hv = structVar->checkedTo<SymbolicHeader>();
             if (auto member = node->to<IR::Member>()) {
                 if (auto hu = get(member->expr)->to<SymbolicHeaderUnion>()) {
@@ -1054,6 +1058,7 @@ void ExpressionEvaluator::postorder(const IR::MethodCallExpression *expression)
             set(expression, SymbolicVoid::get());
             return;
         } else if (name == IR::Type_Stack::push_front || name == IR::Type_Stack::pop_front) {
+            BUG_CHECK(!readOnly, "%1%: side effect in a read-only evaluation", expression);
             BUG_CHECK(base->is<SymbolicArray>(), "%1%: expected an array", base);
             auto array = base->to<SymbolicArray>();
             BUG_CHECK(expression->arguments->size() == 1, "%1%: not one argument?", expression);
@@ -1088,6 +1093,7 @@ void ExpressionEvaluator::postorder(const IR::MethodCallExpression *expression)
         if (em->originalExternType->name.name == P4CoreLibrary::instance().packetIn.name) {
             // packet methods
             if (em->method->name.name == P4CoreLibrary::instance().packetIn.extract.name) {
+                BUG_CHECK(!readOnly, "%1%: side effect in a read-only evaluation", expression);
                 // We know that after an extract terminates the header argument
                 // is always valid.
                 auto arg0 = expression->arguments->at(0);
@@ -1167,6 +1173,7 @@ void ExpressionEvaluator::postorder(const IR::MethodCallExpression *expression)
     // in arguments are unchanged, and the out arguments have an unknown value.
     for (auto p : *mi->substitution.getParametersInArgumentOrder()) {
         if (p->direction == IR::Direction::Out || p->direction == IR::Direction::InOut) {
+            BUG_CHECK(!readOnly, "%1%: side effect in a read-only evaluation", expression);
             auto arg = mi->substitution.lookup(p);
             auto val = get(arg->expression);
             val->setAllUnknown();
@@ -16,6 +16,10 @@ limitations under the License.
 #ifndef _MIDEND_INTERPRETER_H_
 #define _MIDEND_INTERPRETER_H_
 
+#include <functional>
+#include <map>
+#include <set>
+
 #include "frontends/common/resolveReferences/referenceMap.h"
 #include "frontends/p4/coreLibrary.h"
 #include "frontends/p4/typeMap.h"
@@ -87,25 +91,48 @@ class SymbolicValueFactory {
 };
 
 class ValueMap final : public IHasDbPrint {
+    // Variables whose values may be shared with another ValueMap.  Shared values are never
+    // modified: they are copied when first accessed through the non-const get(), while read()
+    // returns them without copying.
+    mutable std::set<const IR::IDeclaration *> shared;
+
  public:
     std::map<const IR::IDeclaration *, SymbolicValue *> map;
+    // Copy-on-write: only the variables are copied, values are copied lazily when accessed.
     ValueMap *clone() const {
         auto result = new ValueMap();
-        for (auto v : map) result->map.emplace(v.first, v.second->clone());
+        result->map = map;
+        for (auto v : map) shared.emplace(v.first);
+        result->shared = shared;
         return result;
     }
     ValueMap *filter(std::function<bool(const IR::IDeclaration *, const SymbolicValue *)> filter) {
         auto result = new ValueMap();
         for (auto v : map)
-            if (filter(v.first, v.second)) result->map.emplace(v.first, v.second);
+            if (filter(v.first, v.second)) {
+                result->map.emplace(v.first, v.second);
+                result->shared.emplace(v.first);
+                shared.emplace(v.first);
+            }
         return result;
     }
     void set(const IR::IDeclaration *left, SymbolicValue *right) {
         CHECK_NULL(left);
         CHECK_NULL(right);
         map[left] = right;
+        shared.erase(left);
     }
-    SymbolicValue *get(const IR::IDeclaration *left) const {
+    // The result may be modified by the caller, so a shared value is copied first.
+    SymbolicValue *get(const IR::IDeclaration *left) {
+        CHECK_NULL(left);
+        auto it = map.find(left);
+        if (it == map.end()) return nullptr;
+        if (shared.erase(left)) it->second = it->second->clone();
+        return it->second;
+    }
+    const SymbolicValue *get(const IR::IDeclaration *left) const { return read(left); }
+    // Read access: a shared value is not copied, so the result must not be modified.
+    const SymbolicValue *read(const IR::IDeclaration *left) const {
         CHECK_NULL(left);
         return ::get(map, left);
     }
@@ -124,7 +151,9 @@ class ValueMap final : public IHasDbPrint {
         for (auto d : map) {
             auto v = other->get(d.first);
             CHECK_NULL(v);
-            change = change || d.second->merge(v);
+            // Merging a value with itself does not change it.
+            if (d.second == v) continue;
+            change = change || get(d.first)->merge(v);
         }
         return change;
     }
@@ -133,6 +162,8 @@ class ValueMap final : public IHasDbPrint {
         for (auto v : map) {
             auto ov = other->get(v.first);
             CHECK_NULL(ov);
+            // Values which were not modified since a clone are still shared.
+            if (v.second == ov) continue;
             if (!v.second->equals(ov)) return false;
         }
         return true;
@@ -145,6 +176,9 @@ class ExpressionEvaluator : public Inspector {
     ValueMap *valueMap;
     const SymbolicValueFactory *factory;
     bool evaluatingLeftValue = false;
+    // The evaluated expressions have no side effects: variables are read without copying the
+    // values they share with other ValueMaps, and the results must not be modified.
+    bool readOnly;
 
     std::map<const IR::Expression *, SymbolicValue *> value;
 
@@ -171,8 +205,9 @@ class ExpressionEvaluator : public Inspector {
     void setNonConstant(const IR::Expression *expression);
 
  public:
-    ExpressionEvaluator(ReferenceMap *refMap, TypeMap *typeMap, ValueMap *valueMap)
-        : refMap(refMap), typeMap(typeMap), valueMap(valueMap) {
+    ExpressionEvaluator(ReferenceMap *refMap, TypeMap *typeMap, ValueMap *valueMap,
+                        bool readOnly = false)
+        : refMap(refMap), typeMap(typeMap), valueMap(valueMap), readOnly(readOnly) {
         CHECK_NULL(refMap);
         CHECK_NULL(typeMap);
         CHECK_NULL(valueMap);
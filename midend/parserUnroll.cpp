@@ -2,6 +2,7 @@
 
 #include "interpreter.h"
 #include "ir/ir.h"
+#include "lib/exceptions.h"
 #include "lib/hash.h"
 #include "lib/stringify.h"
 
@@ -169,7 +170,7 @@ class ParserStateRewriter : public Transform {
         auto basetype = getTypeArray(expression->left);
         if (!basetype->is<IR::Type_Stack>()) return expression;
         IR::ArrayIndex *newExpression = expression->clone();
-        ExpressionEvaluator ev(refMap, typeMap, valueMap);
+        ExpressionEvaluator ev(refMap, typeMap, valueMap, true);
         auto *value = ev.evaluate(expression->right, false);
         if (!value->is<SymbolicInteger>()) return expression;
         auto *res = value->to<SymbolicInteger>()->constant->clone();
@@ -542,9 +543,13 @@ class ParserSymbolicInterpreter {
             // TODO: really try to match cases; today we are conservative
             auto se = select->to<IR::SelectExpression>();
             IR::Vector<IR::SelectCase> newSelectCases;
-            ExpressionEvaluator ev(refMap, typeMap, valueMap);
+            // Selecting does not modify the state, so shared values are not copied.
+            ExpressionEvaluator ev(refMap, typeMap, valueMap, true);
             try {
                 ev.evaluate(se->select, true);
+            } catch (Util::CompilerBug &) {
+                // A side effect in the read-only evaluation is a bug, not an unknown value.
+                throw;
             } catch (...) {
                 // Ignore throws from evaluator.
                 // If an index of a header stack is not substituted then
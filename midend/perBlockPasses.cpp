@@ -0,0 +1,162 @@
+#include "midend/perBlockPasses.h"
+
+#include <map>
+#include <set>
+
+#include "frontends/p4/typeChecking/typeChecker.h"
+#include "lib/error.h"
+#include "lib/log.h"
+
+namespace P4 {
+
+bool PerBlockPassManager::isBlock(const IR::Node *node) {
+    return node->is<IR::P4Parser>() || node->is<IR::P4Control>();
+}
+
+const IR::Node *PerBlockPassManager::makeStub(const IR::Node *block) {
+    if (const auto *parser = block->to<IR::P4Parser>()) {
+        IR::IndexedVector<IR::ParserState> states;
+        states.push_back(new IR::ParserState(IR::ParserState::start,
+                                             new IR::PathExpression(IR::ParserState::accept)));
+        return new IR::P4Parser(parser->srcInfo, parser->name, parser->type,
+                                parser->constructorParams, IR::IndexedVector<IR::Declaration>(),
+                                states);
+    }
+    if (const auto *control = block->to<IR::P4Control>()) {
+        return new IR::P4Control(control->srcInfo, control->name, control->type,
+                                 control->constructorParams, IR::IndexedVector<IR::Declaration>(),
+                                 new IR::BlockStatement());
+    }
+    BUG("%1%: unexpected block", block);
+}
+
+const IR::P4Program *PerBlockPassManager::makeSlice(const IR::P4Program *program,
+                                                    const IR::Node *block) {
+    IR::Vector<IR::Node> objects;
+    for (const auto *object : program->objects) {
+        if (object == block || !isBlock(object)) {
+            objects.push_back(object);
+        } else {
+            objects.push_back(makeStub(object));
+        }
+    }
+    return new IR::P4Program(program->srcInfo, objects);
+}
+
+const IR::Node *PerBlockPassManager::runOnProgram(const IR::P4Program *program) {
+    auto *pipeline = makePipeline(refMap, typeMap);
+    CHECK_NULL(pipeline);
+    pipeline->addDebugHooks(debugHooks, true);
+    const IR::Node *result = program->apply(*pipeline);
+    if (result == nullptr) return result;
+    // As after reassembly, the caller's maps describe the resulting program.
+    TypeChecking typeChecking(refMap, typeMap);
+    result = result->apply(typeChecking);
+    runDebugHooks("PerBlockPassManager", result);
+    return result;
+}
+
+const IR::Node *PerBlockPassManager::apply_visitor(const IR::Node *node, const char *) {
+    running = false;
+    const auto *program = node->to<IR::P4Program>();
+    BUG_CHECK(program != nullptr, "%1%: PerBlockPassManager must be applied to a P4Program", node);
+
+    unsigned initialErrorCount = ::errorCount();
+    std::set<const IR::Node *> original(program->objects.begin(), program->objects.end());
+    IR::Vector<IR::Node> objects;
+    // New top-level declarations inserted so far, by name.
+    std::map<cstring, const IR::Node *> newDeclarations;
+    bool changed = false;
+
+    for (const auto *object : program->objects) {
+        if (!isBlock(object)) {
+            objects.push_back(object);
+            continue;
+        }
+        cstring blockName = object->to<IR::IDeclaration>()->getName();
+        LOG1("Running per-block pipeline on " << blockName);
+
+        ReferenceMap blockRefMap;
+        blockRefMap.setIsV1(refMap->isV1());
+        TypeMap blockTypeMap;
+        auto *pipeline = makePipeline(&blockRefMap, &blockTypeMap);
+        CHECK_NULL(pipeline);
+        pipeline->addDebugHooks(debugHooks, true);
+
+        const auto *slice = makeSlice(program, object);
+        const auto *result = slice->apply(*pipeline);
+        if (stop_on_error && ::errorCount() > initialErrorCount) return program;
+        const auto *resultProgram = result ? result->to<IR::P4Program>() : nullptr;
+        BUG_CHECK(resultProgram != nullptr, "%1%: per-block pipeline did not produce a program",
+                  blockName);
+
+        const IR::Node *newBlock = nullptr;
+        for (const auto *resultObject : resultProgram->objects) {
+            if (original.count(resultObject) != 0) continue;
+            const auto *decl = resultObject->to<IR::IDeclaration>();
+            if (isBlock(resultObject)) {
+                BUG_CHECK(decl != nullptr, "%1%: block without a name", resultObject);
+                if (decl->getName() == blockName) newBlock = resultObject;
+                // Anything else is one of the stubs.
+                continue;
+            }
+            // The object is either a shared declaration which was rewritten or a new one.
+            const IR::Node *rewritten = nullptr;
+            for (const auto *sharedObject : program->objects) {
+                if (isBlock(sharedObject)) continue;
+                const auto *sharedDecl = sharedObject->to<IR::IDeclaration>();
+                if (decl != nullptr && sharedDecl != nullptr &&
+                    sharedDecl->getName() == decl->getName() &&
+                    sharedObject->node_type_name() == resultObject->node_type_name()) {
+                    rewritten = sharedObject;
+                    break;
+                }
+                if (decl == nullptr && sharedDecl == nullptr &&
+                    sharedObject->node_type_name() == resultObject->node_type_name()) {
+                    rewritten = sharedObject;
+                    break;
+                }
+            }
+            if (rewritten == nullptr) {
+                if (decl != nullptr) {
+                    auto it = newDeclarations.find(decl->getName());
+                    if (it != newDeclarations.end()) {
+                        // Created by an earlier slice as well.
+                        if (it->second->equiv(*resultObject)) continue;
+                        LOG1("Slices declare different objects named " << decl->getName()
+                                                                        << ", running on the "
+                                                                           "whole program");
+                        return runOnProgram(program);
+                    }
+                    newDeclarations.emplace(decl->getName(), resultObject);
+                }
+                // New top-level declarations go in front of the block that needs them.
+                objects.push_back(resultObject);
+                changed = true;
+                continue;
+            }
+            if (!rewritten->equiv(*resultObject)) {
+                LOG1("Per-block pipeline of " << blockName << " rewrote " << rewritten
+                                              << ", running on the whole program");
+                return runOnProgram(program);
+            }
+        }
+        if (newBlock == nullptr) {
+            objects.push_back(object);
+        } else {
+            objects.push_back(newBlock);
+            changed = true;
+        }
+    }
+
+    if (!changed) return program;
+
+    const IR::Node *merged = new IR::P4Program(program->srcInfo, objects);
+    // The per-slice maps are discarded; recompute the caller's maps for the merged program.
+    TypeChecking typeChecking(refMap, typeMap);
+    merged = merged->apply(typeChecking);
+    runDebugHooks("PerBlockPassManager", merged);
+    return merged;
+}
+
+}  // namespace P4
@@ -0,0 +1,75 @@
+#ifndef MIDEND_PERBLOCKPASSES_H_
+#define MIDEND_PERBLOCKPASSES_H_
+
+#include <functional>
+
+#include "frontends/common/resolveReferences/referenceMap.h"
+#include "frontends/p4/typeMap.h"
+#include "ir/ir.h"
+#include "ir/pass_manager.h"
+
+namespace P4 {
+
+/**
+ * Runs a sub-pipeline separately on every top-level P4Parser and P4Control of a program
+ * and reassembles the result into a new P4Program.
+ *
+ * For each block a "slice" of the program is built: all shared top-level declarations
+ * (types, externs, constants, top-level actions, instantiations) are kept as-is, the block
+ * itself is kept, and all other parsers and controls are replaced by empty stubs with the same
+ * signature.  The sub-pipeline is created by @p makePipeline for every slice, with a fresh
+ * ReferenceMap and TypeMap, so no analysis state is shared between blocks.
+ *
+ * Only passes that rewrite a single parser or control at a time are suitable
+ * (e.g. ParsersUnroll, LocalCopyPropagation, SimplifyControlFlow, Predication,
+ * RemoveComplexExpressions).  New top-level declarations created by the sub-pipeline are
+ * inserted in front of the block that produced them.  A declaration created by several slices
+ * is only inserted once.  If a slice rewrites a shared declaration, or if two slices create
+ * different declarations with the same name, the blocks cannot be reassembled and the
+ * sub-pipeline is run once on the whole program instead.
+ *
+ * After reassembly the caller's @p refMap and @p typeMap are recomputed by type-checking the
+ * new program.
+ *
+ * This is a restructuring only, it does not make the midend faster: the slices are processed
+ * one after the other (IR node allocation and cstring interning are not thread-safe), and the
+ * reassembled program is type-checked again.
+ */
+class PerBlockPassManager : public PassManager {
+ public:
+    /// Creates the sub-pipeline for one slice, bound to the given per-slice maps.
+    using PipelineFactory = std::function<PassManager *(ReferenceMap *, TypeMap *)>;
+
+ private:
+    ReferenceMap *refMap;
+    TypeMap *typeMap;
+    PipelineFactory makePipeline;
+
+    /// @returns true if @p node is a block the sub-pipeline is run on.
+    static bool isBlock(const IR::Node *node);
+
+    /// @returns a block with the same name and signature as @p block, but an empty body.
+    static const IR::Node *makeStub(const IR::Node *block);
+
+    /// @returns the slice of @p program used to process @p block.
+    static const IR::P4Program *makeSlice(const IR::P4Program *program, const IR::Node *block);
+
+    /// Runs the sub-pipeline on the whole @p program with the caller's maps.
+    const IR::Node *runOnProgram(const IR::P4Program *program);
+
+ public:
+    PerBlockPassManager(ReferenceMap *refMap, TypeMap *typeMap, PipelineFactory makePipeline)
+        : refMap(refMap), typeMap(typeMap), makePipeline(makePipeline) {
+        CHECK_NULL(refMap);
+        CHECK_NULL(typeMap);
+        BUG_CHECK(makePipeline, "PerBlockPassManager needs a pipeline factory");
+        setName("PerBlockPassManager");
+    }
+
+    const IR::Node *apply_visitor(const IR::Node *node, const char *name = nullptr) override;
+    PerBlockPassManager *clone() const override { return new PerBlockPassManager(*this); }
+};
+
+}  // namespace P4
+
+#endif /* MIDEND_PERBLOCKPASSES_H_ */
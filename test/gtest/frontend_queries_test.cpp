@@ -0,0 +1,145 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "frontends/p4/frontendQueries.h"
+
+#include "gtest/gtest.h"
+#include "helpers.h"
+#include "ir/ir.h"
+#include "lib/error.h"
+
+using namespace P4;
+
+namespace Test {
+
+class P4CFrontEndQueries : public P4CTest {};
+
+namespace {
+
+/// @returns the calls in @p program, in program order.
+std::vector<const IR::MethodCallExpression *> calls(const IR::P4Program *program) {
+    std::vector<const IR::MethodCallExpression *> result;
+    program->apply(Inspector::forAllMatching<IR::MethodCallExpression>(
+        [&](const IR::MethodCallExpression *call) { result.push_back(call); }));
+    return result;
+}
+
+const IR::MethodCallExpression *firstCall(const IR::P4Program *program) {
+    auto all = calls(program);
+    return all.empty() ? nullptr : all.front();
+}
+
+}  // namespace
+
+TEST_F(P4CFrontEndQueries, queries) {
+    std::string source = P4_SOURCE(R"(
+        control c(inout bit<8> x) {
+            action a() { x = x + 8w1; }
+            table t { actions = { a; } }
+            apply { a(); t.apply(); }
+        }
+    )");
+    FrontEndQueries queries("queries.p4", source);
+
+    const auto *program = queries.getProgram();
+    ASSERT_TRUE(program != nullptr && ::errorCount() == 0);
+
+    const auto *call = firstCall(program);
+    ASSERT_TRUE(call != nullptr);
+    const auto &position = call->method->srcInfo.getStart();
+    const auto *decl = queries.getDeclarationAt(position);
+    ASSERT_TRUE(decl != nullptr);
+    EXPECT_TRUE(decl->is<IR::P4Action>());
+    EXPECT_EQ(decl->getName(), "a");
+
+    // The action call in the apply block and the reference in the table.
+    EXPECT_EQ(queries.getCallersOf(decl).size(), 2u);
+
+    const auto *type = queries.getTypeAt(position);
+    ASSERT_TRUE(type != nullptr);
+    EXPECT_TRUE(type->is<IR::Type_Action>());
+    EXPECT_EQ(::errorCount(), 0u);
+
+    // Unchanged text keeps the cached results.
+    EXPECT_FALSE(queries.setSource(source));
+    EXPECT_EQ(queries.getProgram(), program);
+
+    // An edit invalidates them.
+    EXPECT_TRUE(queries.setSource(source + "\naction b() {}\n"));
+    program = queries.getProgram();
+    ASSERT_TRUE(program != nullptr);
+    decl = queries.getDeclarationAt(firstCall(program)->method->srcInfo.getStart());
+    ASSERT_TRUE(decl != nullptr);
+    EXPECT_EQ(queries.getCallersOf(decl).size(), 2u);
+}
+
+TEST_F(P4CFrontEndQueries, callersByDeclaration) {
+    std::string source = P4_SOURCE(R"(
+        control c1(inout bit<8> x) {
+            action a() { x = 8w1; }
+            apply { a(); }
+        }
+        control c2(inout bit<8> x) {
+            action a() { x = 8w2; }
+            table t { actions = { a; } }
+            apply { a(); t.apply(); }
+        }
+    )");
+    FrontEndQueries queries("callers.p4", source);
+    const auto *program = queries.getProgram();
+    ASSERT_TRUE(program != nullptr && ::errorCount() == 0);
+
+    // c1's a(), c2's a() and t.apply().
+    auto all = calls(program);
+    ASSERT_EQ(all.size(), 3u);
+    const auto *a1 = queries.getDeclarationAt(all[0]->method->srcInfo.getStart());
+    const auto *a2 = queries.getDeclarationAt(all[1]->method->srcInfo.getStart());
+    ASSERT_TRUE(a1 != nullptr && a2 != nullptr);
+    EXPECT_NE(a1, a2);
+
+    // Actions with the same name in different controls have separate callers.
+    EXPECT_EQ(queries.getCallersOf(a1).size(), 1u);
+    EXPECT_EQ(queries.getCallersOf(a2).size(), 2u);
+    EXPECT_EQ(::errorCount(), 0u);
+}
+
+TEST_F(P4CFrontEndQueries, preprocessed) {
+    std::string source = P4_SOURCE(P4Headers::CORE, R"(
+#define VALUE 8w1
+        control c(inout bit<8> x) {
+            action a() { x = VALUE; }
+            table t { actions = { a; NoAction; } default_action = NoAction(); }
+            apply { t.apply(); }
+        }
+    )");
+    FrontEndQueries queries("preprocessed.p4", source);
+    const auto *program = queries.getProgram();
+    ASSERT_TRUE(program != nullptr && ::errorCount() == 0);
+
+    // The call of NoAction refers to the declaration in core.p4.
+    const IR::MethodCallExpression *noAction = nullptr;
+    for (const auto *call : calls(program)) {
+        const auto *path = call->method->to<IR::PathExpression>();
+        if (path != nullptr && path->path->name == "NoAction") noAction = call;
+    }
+    ASSERT_TRUE(noAction != nullptr);
+    const auto *decl = queries.getDeclarationAt(noAction->method->srcInfo.getStart());
+    ASSERT_TRUE(decl != nullptr);
+    EXPECT_TRUE(decl->is<IR::P4Action>());
+    // The default action and the reference in the action list.
+    EXPECT_EQ(queries.getCallersOf(decl).size(), 2u);
+    EXPECT_EQ(::errorCount(), 0u);
+}
+
+}  // namespace Test
@@ -0,0 +1,106 @@
+/*
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include "midend/interpreter.h"
+
+#include "gtest/gtest.h"
+#include "ir/ir.h"
+
+namespace Test {
+
+namespace {
+
+const IR::Type_Bits *byteType() { return IR::Type_Bits::get(8); }
+
+P4::SymbolicInteger *byteValue(int value) {
+    return new P4::SymbolicInteger(new IR::Constant(byteType(), value));
+}
+
+int64_t valueOf(const P4::SymbolicValue *value) {
+    return value->to<P4::SymbolicInteger>()->constant->asInt64();
+}
+
+}  // namespace
+
+TEST(ValueMap, cloneSharesValuesUntilWritten) {
+    auto *x = new IR::Declaration_Variable("x", byteType());
+    auto *y = new IR::Declaration_Variable("y", byteType());
+    P4::ValueMap original;
+    original.set(x, byteValue(1));
+    original.set(y, byteValue(2));
+
+    auto *copy = original.clone();
+    EXPECT_EQ(copy->read(x), original.read(x));
+    EXPECT_EQ(copy->read(y), original.read(y));
+    EXPECT_TRUE(copy->equals(&original));
+
+    // Writing through the copy leaves the original alone.
+    copy->get(x)->assign(byteValue(3));
+    EXPECT_NE(copy->read(x), original.read(x));
+    EXPECT_EQ(valueOf(original.read(x)), 1);
+    EXPECT_EQ(valueOf(copy->read(x)), 3);
+    // Unmodified variables are still shared.
+    EXPECT_EQ(copy->read(y), original.read(y));
+
+    // Writing through the original leaves the copy alone.
+    original.get(y)->assign(byteValue(4));
+    EXPECT_EQ(valueOf(original.read(y)), 4);
+    EXPECT_EQ(valueOf(copy->read(y)), 2);
+    EXPECT_FALSE(copy->equals(&original));
+}
+
+TEST(ValueMap, setUnsharesVariable) {
+    auto *x = new IR::Declaration_Variable("x", byteType());
+    P4::ValueMap original;
+    original.set(x, byteValue(1));
+    auto *copy = original.clone();
+
+    auto *replacement = byteValue(5);
+    copy->set(x, replacement);
+    // A value set after the clone is owned by the map and is not copied on access.
+    EXPECT_EQ(copy->get(x), replacement);
+    EXPECT_EQ(valueOf(original.read(x)), 1);
+}
+
+TEST(ValueMap, cloneOfClone) {
+    auto *x = new IR::Declaration_Variable("x", byteType());
+    P4::ValueMap original;
+    original.set(x, byteValue(1));
+    auto *first = original.clone();
+    auto *second = first->clone();
+
+    second->get(x)->assign(byteValue(7));
+    EXPECT_EQ(valueOf(original.read(x)), 1);
+    EXPECT_EQ(valueOf(first->read(x)), 1);
+    EXPECT_EQ(valueOf(second->read(x)), 7);
+
+    first->get(x)->assign(byteValue(8));
+    EXPECT_EQ(valueOf(original.read(x)), 1);
+    EXPECT_EQ(valueOf(second->read(x)), 7);
+}
+
+TEST(ValueMap, mergeCopiesSharedValue) {
+    auto *x = new IR::Declaration_Variable("x", byteType());
+    P4::ValueMap original;
+    original.set(x, byteValue(1));
+    auto *copy = original.clone();
+    copy->get(x)->assign(byteValue(2));
+
+    // Merging different constants makes the value unknown, but only in the merged map.
+    EXPECT_TRUE(copy->merge(&original));
+    EXPECT_EQ(valueOf(original.read(x)), 1);
+    EXPECT_TRUE(copy->read(x)->to<P4::SymbolicInteger>()->isUnknown());
+}
+
+}  // namespace Test
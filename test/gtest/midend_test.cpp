@@ -24,6 +24,9 @@ limitations under the License.
 #include "ir/ir.h"
 #include "lib/log.h"
 #include "midend/convertEnums.h"
+#include "midend/coverage.h"
+#include "midend/local_copyprop.h"
+#include "midend/perBlockPasses.h"
 #include "midend/replaceSelectRange.h"
 
 using namespace P4;
@@ -37,6 +40,28 @@ class EnumOn32Bits : public ChooseEnumRepresentation {
     unsigned enumSize(unsigned) const override { return 32; }
 };
 
+// Adds "const bit<8> N = 3;" in front of the program.
+class AddConstant : public Transform {
+ public:
+    const IR::Node *postorder(IR::P4Program *program) override {
+        auto type = IR::Type_Bits::get(8);
+        program->objects.insert(program->objects.begin(),
+                                new IR::Declaration_Constant("N", type, new IR::Constant(type, 3)));
+        return program;
+    }
+};
+
+// Changes the value of the top-level constant K to 2.
+class RewriteConstant : public Transform {
+ public:
+    const IR::Node *postorder(IR::Declaration_Constant *constant) override {
+        if (constant->name == "K" && getParent<IR::P4Program>() != nullptr) {
+            constant->initializer = new IR::Constant(constant->type, 2);
+        }
+        return constant;
+    }
+};
+
 }  // namespace
 
 class P4CMidend : public P4CTest {};
@@ -287,4 +312,126 @@ TEST_F(P4CMidend, replaceSelectRangeSigned5) {
         {{0, 15}}, [](CollectRangesAndMasks collect) { ASSERT_EQ(collect.masks.size(), 1u); });
 }
 
+// run a control-local pass separately on each control and reassemble the program
+TEST_F(P4CMidend, perBlockPassManager) {
+    std::string program = P4_SOURCE(R"(
+        control c1(inout bit<8> x) { apply { bit<8> t = 8w1; x = t; } }
+        control c2(inout bit<8> y) { apply { bit<8> u = 8w2; y = u; } }
+        control ct(inout bit<8> v);
+        package top(ct _c1, ct _c2);
+        top(c1(), c2()) main;
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    TypeMap typeMap;
+    PassManager passes = {
+        new TypeChecking(&refMap, &typeMap),
+        new P4::PerBlockPassManager(&refMap, &typeMap,
+                                    [](ReferenceMap *blockRefMap, TypeMap *blockTypeMap) {
+                                        return new P4::LocalCopyPropagation(blockRefMap,
+                                                                            blockTypeMap);
+                                    }),
+    };
+    auto result = pgm->apply(passes);
+    ASSERT_TRUE(result != nullptr && ::errorCount() == 0);
+    ASSERT_EQ(result->objects.size(), pgm->objects.size());
+
+    // Both controls were rewritten, and the copies were propagated in each of them.
+    unsigned constantAssignments = 0;
+    forAllMatching<IR::AssignmentStatement>(result, [&](const IR::AssignmentStatement *assign) {
+        if (assign->right->is<IR::Constant>()) constantAssignments++;
+    });
+    ASSERT_EQ(constantAssignments, 2u);
+    // The caller's maps describe the reassembled program.
+    ASSERT_GT(typeMap.size(), 0u);
+}
+
+// the same new declaration created for every block is inserted once
+TEST_F(P4CMidend, perBlockPassManagerNewDeclarations) {
+    std::string program = P4_SOURCE(R"(
+        control c1(inout bit<8> x) { apply { x = 8w1; } }
+        control c2(inout bit<8> y) { apply { y = 8w2; } }
+        control ct(inout bit<8> v);
+        package top(ct _c1, ct _c2);
+        top(c1(), c2()) main;
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    TypeMap typeMap;
+    PassManager passes = {
+        new TypeChecking(&refMap, &typeMap),
+        new P4::PerBlockPassManager(&refMap, &typeMap,
+                                    [](ReferenceMap *, TypeMap *) {
+                                        return new PassManager({new AddConstant()});
+                                    }),
+    };
+    auto result = pgm->apply(passes);
+    ASSERT_TRUE(result != nullptr && ::errorCount() == 0);
+    ASSERT_EQ(result->objects.size(), pgm->objects.size() + 1);
+    unsigned constants = 0;
+    forAllMatching<IR::Declaration_Constant>(result, [&](const IR::Declaration_Constant *) {
+        constants++;
+    });
+    ASSERT_EQ(constants, 1u);
+}
+
+// a pipeline rewriting a shared declaration is run on the whole program
+TEST_F(P4CMidend, perBlockPassManagerSharedDeclaration) {
+    std::string program = P4_SOURCE(R"(
+        const bit<8> K = 8w1;
+        control c1(inout bit<8> x) { apply { x = K; } }
+        control c2(inout bit<8> y) { apply { y = K; } }
+        control ct(inout bit<8> v);
+        package top(ct _c1, ct _c2);
+        top(c1(), c2()) main;
+    )");
+    auto pgm = P4::parseP4String(program, CompilerOptions::FrontendVersion::P4_16);
+    ASSERT_TRUE(pgm != nullptr && ::errorCount() == 0);
+
+    ReferenceMap refMap;
+    TypeMap typeMap;
+    PassManager passes = {
+        new TypeChecking(&refMap, &typeMap),
+        new P4::PerBlockPassManager(&refMap, &typeMap,
+                                    [](ReferenceMap *, TypeMap *) {
+                                        return new PassManager({new RewriteConstant()});
+                                    }),
+    };
+    auto result = pgm->apply(passes);
+    ASSERT_TRUE(result != nullptr && ::errorCount() == 0);
+    ASSERT_EQ(result->objects.size(), pgm->objects.size());
+    const IR::Declaration_Constant *k = nullptr;
+    forAllMatching<IR::Declaration_Constant>(
+        result, [&](const IR::Declaration_Constant *constant) { k = constant; });
+    ASSERT_TRUE(k != nullptr);
+    ASSERT_EQ(k->initializer->to<IR::Constant>()->asInt(), 2);
+}
+
+TEST_F(P4CMidend, coverageStableIds) {
+    std::string source = P4_SOURCE(R"(
+        control c(inout bit<8> x) {
+            action a() { x = 1; x = 2; }
+            apply { a(); x = 3; }
+        }
+    )");
+    auto collect = [&source]() {
+        P4::Coverage::CoverageIndex::get().reset();
+        const auto *program = parseP4String(source, CompilerOptions::FrontendVersion::P4_16);
+        EXPECT_TRUE(program != nullptr);
+        P4::Coverage::CollectNodes collectNodes({true, false});
+        program->apply(collectNodes);
+        return P4::Coverage::getStableIds(collectNodes.getCoverableNodes());
+    };
+    auto first = collect();
+    ASSERT_EQ(first.size(), 4u);
+    // A second parse allocates nodes with other ids, the stable identifiers do not change.
+    for (int i = 0; i < 10; i++) new IR::EmptyStatement();
+    EXPECT_EQ(collect(), first);
+    P4::Coverage::CoverageIndex::get().reset();
+}
+
 }  // namespace Test
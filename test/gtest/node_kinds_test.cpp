@@ -0,0 +1,143 @@
+#include "ir/node_kinds.h"
+
+#include <chrono>
+#include <iostream>
+
+#include "gtest/gtest.h"
+#include "ir/ir.h"
+#include "ir/visitor.h"
+
+namespace Test {
+
+namespace {
+
+/// Counts the nodes visited and the Add expressions found.
+class CountAdds : public Inspector {
+ public:
+    unsigned visited = 0;
+    unsigned adds = 0;
+
+    explicit CountAdds(bool prune) {
+        if (prune) visitOnlySubtreesWith<IR::Add>();
+    }
+    bool preorder(const IR::Node *) override {
+        visited++;
+        return true;
+    }
+    bool preorder(const IR::Add *) override {
+        visited++;
+        adds++;
+        return true;
+    }
+};
+
+/// Counts the nodes visited and the Mul expressions found.
+class CountMuls : public Inspector {
+ public:
+    unsigned visited = 0;
+    unsigned muls = 0;
+
+    explicit CountMuls(bool prune) {
+        if (prune) visitOnlySubtreesWith<IR::Mul>();
+    }
+    bool preorder(const IR::Node *) override {
+        visited++;
+        return true;
+    }
+    bool preorder(const IR::Mul *) override {
+        visited++;
+        muls++;
+        return true;
+    }
+};
+
+const IR::Node *makeTree() {
+    auto *a = new IR::PathExpression("a");
+    auto *b = new IR::PathExpression("b");
+    auto *add = new IR::Add(a, b);
+    auto *sub = new IR::Sub(new IR::Sub(a, b), new IR::Mul(a, b));
+    return new IR::Vector<IR::Expression>({sub, add});
+}
+
+/// @returns a tree of @p size additions of @p size subtractions each, without any Mul.
+const IR::Node *makeLargeTree(unsigned size) {
+    auto *tree = new IR::Vector<IR::Expression>();
+    for (unsigned i = 0; i < size; i++) {
+        const IR::Expression *expr = new IR::PathExpression("a");
+        for (unsigned j = 0; j < size; j++) expr = new IR::Sub(expr, new IR::PathExpression("b"));
+        tree->push_back(new IR::Add(expr, new IR::PathExpression("c")));
+    }
+    return tree;
+}
+
+/// @returns the time in microseconds of applying @p inspector to @p tree @p count times.
+int64_t timeApplications(const IR::Node *tree, Inspector &inspector, unsigned count) {
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned i = 0; i < count; i++) tree->apply(inspector);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+}
+
+}  // namespace
+
+TEST(NodeKindIndex, subtreeKinds) {
+    const auto *tree = makeTree();
+    auto *add = new IR::Add(new IR::PathExpression("x"), new IR::PathExpression("y"));
+    IR::SubtreeKinds subtrees;
+    const auto &kinds = subtrees.get(tree);
+    EXPECT_TRUE(kinds.getbit(IR::NodeKindIndex::kindOf(add)));
+    EXPECT_TRUE(kinds.getbit(IR::NodeKindIndex::kindOf(tree)));
+
+    IR::NodeKindSet mulOnly;
+    mulOnly.add<IR::Mul>();
+    IR::NodeKindSet operations;
+    operations.add<IR::Operation_Binary>();
+    EXPECT_FALSE(mulOnly.mayOccurIn(add));
+    EXPECT_TRUE(operations.mayOccurIn(add));
+    EXPECT_TRUE(mulOnly.mayOccurIn(tree));
+}
+
+TEST(NodeKindIndex, prunedInspector) {
+    const auto *tree = makeTree();
+    CountAdds full(false);
+    tree->apply(full);
+    CountAdds pruned(true);
+    tree->apply(pruned);
+    EXPECT_EQ(full.adds, 1u);
+    EXPECT_EQ(pruned.adds, 1u);
+    EXPECT_LT(pruned.visited, full.visited);
+}
+
+TEST(NodeKindIndex, subtreesPerApply) {
+    // A tree mutated in place between two applications must not be pruned with the kinds
+    // computed for the first one.
+    auto *vec = new IR::Vector<IR::Expression>();
+    vec->push_back(new IR::PathExpression("a"));
+    CountAdds pruned(true);
+    vec->apply(pruned);
+    EXPECT_EQ(pruned.adds, 0u);
+    vec->push_back(new IR::Add(new IR::PathExpression("x"), new IR::PathExpression("y")));
+    pruned.adds = 0;
+    vec->apply(pruned);
+    EXPECT_EQ(pruned.adds, 1u);
+}
+
+TEST(NodeKindIndex, costOfOneApplication) {
+    // Measures an inspector looking for a node kind that does not occur in a large tree, with
+    // and without restricting it to the subtrees with that kind. The restricted inspector
+    // indexes the whole tree in every application before it skips it.
+    const auto *tree = makeLargeTree(300);
+    CountMuls full(false);
+    CountMuls pruned(true);
+    auto fullTime = timeApplications(tree, full, 10);
+    auto prunedTime = timeApplications(tree, pruned, 10);
+    RecordProperty("full_us", static_cast<int>(fullTime));
+    RecordProperty("pruned_us", static_cast<int>(prunedTime));
+    std::cout << "unrestricted: " << fullTime << "us, restricted: " << prunedTime << "us"
+              << std::endl;
+    EXPECT_EQ(full.muls, 0u);
+    EXPECT_EQ(pruned.muls, 0u);
+    EXPECT_EQ(pruned.visited, 0u);
+}
+
+}  // namespace Test
@@ -30,6 +30,8 @@ P4C_DIR=$(readlink -f ${THIS_DIR}/..)
 : "${INSTALL_PTF_EBPF_DEPENDENCIES:=OFF}"
 # Whether to build the P4Tools back end and platform.
 : "${ENABLE_TEST_TOOLS:=OFF}"
+# Whether to build the P4Testgen throughput benchmark.
+: "${ENABLE_TESTGEN_BENCHMARK:=OFF}"
 
 # Whether to treat warnings as errors.
 : "${ENABLE_WERROR:=ON}"
@@ -233,6 +235,8 @@ CMAKE_FLAGS+="-DCMAKE_UNITY_BUILD=${CMAKE_UNITY_BUILD} "
 CMAKE_FLAGS+="-DBUILD_STATIC_RELEASE=${BUILD_STATIC_RELEASE} "
 # Toggle the installation of the tools back end.
 CMAKE_FLAGS+="-DENABLE_TEST_TOOLS=${ENABLE_TEST_TOOLS} "
+# Toggle the P4Testgen throughput benchmark.
+CMAKE_FLAGS+="-DENABLE_TESTGEN_BENCHMARK=${ENABLE_TESTGEN_BENCHMARK} "
 # RELEASE should be default, but we want to make sure.
 CMAKE_FLAGS+="-DCMAKE_BUILD_TYPE=RELEASE "
 # Treat warnings as errors.